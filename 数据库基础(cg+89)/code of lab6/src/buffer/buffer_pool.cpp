@@ -0,0 +1,626 @@
+#include "buffer/buffer_pool.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "common/query_counters.h"
+#include "glog/logging.h"//
+#include "page/bitmap_page.h"
+
+//Instance给出的各页大小缓冲池，它们分用同一份内存预算
+static std::mutex instances_latch;
+static std::unordered_map<uint32_t, std::unique_ptr<BufferPool>> instances;
+static constexpr size_t SHARED_POOL_BYTES = static_cast<size_t>(DEFAULT_BUFFER_POOL_SIZE) * DEFAULT_PAGE_SIZE;
+
+BufferPool::BufferPool(size_t pool_size, uint32_t page_size)
+    : pool_size_(pool_size), frame_limit_(pool_size), page_size_(page_size), page_table_(pool_size) {
+  ASSERT(DiskManager::IsValidPageSize(page_size_), "Invalid page size.");
+  //所有帧的数据放在一整块按页对齐的内存里，Page数组只剩元数据
+  frames_size_ = (pool_size_ * page_size_ + FRAME_REGION_ALIGN - 1) / FRAME_REGION_ALIGN * FRAME_REGION_ALIGN;
+  //内存按需分配，用不到的帧不占物理内存：新映射的内存本来就是零，帧只在换给另一页时才清零
+  void *frames =
+      mmap(nullptr, frames_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  ASSERT(frames != MAP_FAILED, "Failed to allocate the frames of the buffer pool.");
+#ifdef MADV_HUGEPAGE
+  //大内存池用大页减少TLB miss，内核不支持时忽略
+  if (frames_size_ >= HUGE_PAGE_SIZE) {
+    madvise(frames, frames_size_, MADV_HUGEPAGE);
+  }
+#endif
+  frames_ = reinterpret_cast<char *>(frames);
+  pages_ = new Page[pool_size_];
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].SetFrame(frames_ + i * page_size_);
+  }
+  replacer_ = new SetReplacer(pool_size_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    free_list_.emplace_back(i);
+  }
+  batch_.reserve(BGWRITER_MAX_PAGES);
+  batch_data_.resize(BGWRITER_MAX_PAGES * page_size_);
+  //每种页大小的缓冲池各有一组指标
+  MetricsRegistry *metrics = MetricsRegistry::Instance();
+  metric_labels_ = "page_size=\"" + std::to_string(page_size_) + "\"";
+  hits_metric_ = metrics->GetCounter("minisql_buffer_hits_total", "Page requests found in the buffer pool",
+                                     metric_labels_);
+  misses_metric_ = metrics->GetCounter("minisql_buffer_misses_total", "Page requests read from disk",
+                                       metric_labels_);
+  evictions_metric_ = metrics->GetCounter("minisql_buffer_evictions_total",
+                                          "Pages evicted to make room for another page", metric_labels_);
+  eviction_writes_metric_ = metrics->GetCounter("minisql_buffer_eviction_writes_total",
+                                                "Dirty pages written by the query evicting them", metric_labels_);
+  batch_writes_metric_ = metrics->GetCounter(
+      "minisql_buffer_batch_writes_total",
+      "Dirty pages written in batches by the background writer, checkpoints and flushes", metric_labels_);
+  metrics->SetGauge("minisql_buffer_frames", "Frames of the buffer pool that may hold pages", metric_labels_,
+                    [this] { return static_cast<double>(frame_limit_.load(std::memory_order_relaxed)); });
+  metrics->SetGauge("minisql_buffer_dirty_pages", "Dirty pages in the buffer pool", metric_labels_,
+                    [this] { return static_cast<double>(DirtyPageCount()); });
+  writer_thread_ = std::thread(&BufferPool::BackgroundWriter, this);
+}
+
+BufferPool::~BufferPool() {
+  {
+    std::lock_guard<std::mutex> lock(writer_latch_);
+    writer_stop_ = true;
+  }
+  writer_cv_.notify_all();
+  writer_thread_.join();
+  MetricsRegistry::Instance()->RemoveGauge("minisql_buffer_frames", metric_labels_);
+  MetricsRegistry::Instance()->RemoveGauge("minisql_buffer_dirty_pages", metric_labels_);
+  //后台写线程已把大部分脏页写回，这里按页号合并写出剩下的
+  WriteDirtyPages(INVALID_DB_ID, false);
+  delete[] pages_;
+  munmap(frames_, frames_size_);
+  delete replacer_;
+}
+
+BufferPool *BufferPool::Instance(uint32_t page_size) {
+  //每种页大小一个缓冲池，各自按整份预算留出地址空间，实际能用的帧数由Rebalance分配
+  std::lock_guard<std::mutex> guard(instances_latch);
+  auto &buffer_pool = instances[page_size];
+  if (buffer_pool == nullptr) {
+    size_t pool_size = std::max<size_t>(SHARED_POOL_BYTES / page_size, 1);
+    buffer_pool = std::make_unique<BufferPool>(pool_size, page_size);
+    buffer_pool->shared_ = true;
+  }
+  return buffer_pool.get();
+}
+
+void BufferPool::Rebalance() {
+  //有库的缓冲池平分预算，没有库的缓冲池不留帧
+  std::lock_guard<std::mutex> guard(instances_latch);
+  size_t live = 0;
+  for (auto &entry : instances) {
+    std::lock_guard<std::recursive_mutex> pool_guard(entry.second->latch_);
+    live += !entry.second->disks_.empty();
+  }
+  for (auto &entry : instances) {
+    BufferPool *pool = entry.second.get();
+    std::lock_guard<std::recursive_mutex> pool_guard(pool->latch_);
+    pool->SetFrameLimit(pool->disks_.empty() ? 0 : std::max<size_t>(SHARED_POOL_BYTES / live / pool->page_size_, 1));
+  }
+}
+
+void BufferPool::SetFrameLimit(size_t frame_limit) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  frame_limit = std::min(frame_limit, pool_size_);
+  size_t old_limit = frame_limit_.load();
+  //最后一次unpin不加锁就读上限，上限要先于下面的占用写好
+  frame_limit_.store(frame_limit);
+  if (frame_limit >= old_limit) {
+    //新放开的帧中空着的进free list(空帧上的pin只是查找过期，马上会放开)，仍被pin的帧unpin后照常进替换器
+    for (size_t i = old_limit; i < frame_limit; i++) {
+      if (pages_[i].page_id_ == INVALID_PAGE_ID) {
+        free_list_.push_back(static_cast<frame_id_t>(i));
+      }
+    }
+    return;
+  }
+  //超出上限的帧：未被pin的立即写回丢弃，被pin的等unpin时再丢弃
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= frame_limit; });
+  size_t begin = frame_limit;
+  for (size_t i = frame_limit; i < old_limit; i++) {
+    frame_id_t frame_id = static_cast<frame_id_t>(i);
+    RemoveFromReplacer(frame_id);
+    if (!ClaimFrame(frame_id)) {
+      DiscardFrames(begin, i);
+      begin = i + 1;
+      continue;
+    }
+    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+      DropFrame(frame_id);
+    }
+    pages_[i].pin_count_.store(0);
+  }
+  DiscardFrames(begin, old_limit);
+}
+
+void BufferPool::DropFrame(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  if (page.is_dirty_) {
+    FlushPage(page.db_id_, page.page_id_);
+    eviction_writes_metric_->AddLatched();
+  }
+  evictions_metric_->AddLatched();
+  page_table_.Erase(PageKey(page.db_id_, page.page_id_));
+  RemoveFromReplacer(frame_id);
+  page.page_id_ = INVALID_PAGE_ID;
+  page.is_dirty_ = false;
+}
+
+void BufferPool::DiscardFrames(size_t begin, size_t end) {
+  //匿名内存丢弃后再访问时是全零页，正好是空帧该有的内容
+  if (begin < end) {
+    madvise(frames_ + begin * page_size_, (end - begin) * page_size_, MADV_DONTNEED);
+  }
+}
+
+uint32_t BufferPool::AddDatabase(DiskManager *disk_manager) {
+  ASSERT(disk_manager->GetPageSize() == page_size_, "Page size of the database differs from the buffer pool.");
+  uint32_t db_id;
+  bool first;
+  {
+    std::lock_guard<std::recursive_mutex> guard(latch_);
+    db_id = next_db_id_++;
+    first = disks_.empty();
+    disks_[db_id] = disk_manager;
+  }
+  if (shared_ && first) {
+    Rebalance();
+  }
+  return db_id;
+}
+
+void BufferPool::RemoveDatabase(uint32_t db_id) {
+  WriteDirtyPages(db_id, false);
+  bool last;
+  {
+    std::lock_guard<std::recursive_mutex> guard(latch_);
+    //库关闭后它的页不会再被访问，直接归还到free list
+    for (size_t i = 0; i < pool_size_; i++) {
+      Page &page = pages_[i];
+      if (page.db_id_ != db_id || page.page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      WaitClaimFrame(static_cast<frame_id_t>(i));
+      page_table_.Erase(PageKey(db_id, page.page_id_));
+      RemoveFromReplacer(static_cast<frame_id_t>(i));
+      page.ResetMemory(page_size_);
+      page.page_id_ = INVALID_PAGE_ID;
+      page.is_dirty_ = false;
+      page.pin_count_.store(0);
+      if (i < frame_limit_) {
+        free_list_.push_back(static_cast<frame_id_t>(i));
+      }
+    }
+    disks_.erase(db_id);
+    last = disks_.empty();
+  }
+  //最后一个库关闭后这个缓冲池的内存让给其他页大小
+  if (shared_ && last) {
+    Rebalance();
+  }
+}
+
+/**
+ * TODO: Student Implement
+ */
+Page *BufferPool::FetchPage(uint32_t db_id, page_id_t page_id) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  frame_id_t frame_id;
+  uint64_t key = PageKey(db_id, page_id);
+  //命中时不加latch_，帧正在换页时TryPin失败，走下面加锁的路径
+  if (page_table_.Find(key, &frame_id) && TryPin(frame_id, key)) {//存在
+    LocalQueryCounters().buffer_hits_++;
+    hits_metric_->Add();
+    return &pages_[frame_id];
+  }
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  //等latch_时别的线程可能已经读入了这一页，持有latch_时没有帧在换页，找到了就能pin上
+  if (page_table_.Find(key, &frame_id) && TryPin(frame_id, key)) {
+    LocalQueryCounters().buffer_hits_++;
+    hits_metric_->Add();
+    return &pages_[frame_id];
+  }
+  //没有空闲帧、也没有可淘汰的帧
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+  if (!TakeFrame(&frame_id)) {//替换器里的帧都被pin着
+    return nullptr;
+  }
+  LocalQueryCounters().buffer_misses_++;
+  misses_metric_->AddLatched();
+
+  page_table_.Insert(key, frame_id);//新建关联
+  pages_[frame_id].db_id_=db_id;
+  pages_[frame_id].page_id_=page_id;
+  pages_[frame_id].is_dirty_ = false;
+  DiskOf(db_id)->ReadPage(page_id, pages_[frame_id].GetData());//写入内容
+  pages_[frame_id].pin_count_.store(1);//有一个pin，读完后才能被别的线程pin
+  return &pages_[frame_id];
+}
+
+/**
+ * TODO: Student Implement
+ */
+Page *BufferPool::NewPage(uint32_t db_id, page_id_t &page_id) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  // 0.   Make sure you call AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+
+ //test if all be pinned
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+
+  //page_id=AllocatePage();
+  frame_id_t frame_id;
+  if (!TakeFrame(&frame_id)) {
+    return nullptr;
+  }
+  //申请一个新的page_id
+ page_id = DiskOf(db_id)->AllocatePage();
+  page_table_.Insert(PageKey(db_id, page_id), frame_id);//新建关联
+  pages_[frame_id].db_id_=db_id;
+  pages_[frame_id].page_id_=page_id;
+  pages_[frame_id].is_dirty_=false;
+  pages_[frame_id].pin_count_.store(1);//有一个pin
+  return &pages_[frame_id];
+}
+
+/**
+ * TODO: Student Implement
+ */
+bool BufferPool::DeletePage(uint32_t db_id, page_id_t page_id) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  // 0.   Make sure you call DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  frame_id_t frame_id;
+  uint64_t key = PageKey(db_id, page_id);
+  if (!page_table_.Find(key, &frame_id)) {//不存在
+    DiskOf(db_id)->DeAllocatePage(page_id);//在磁盘中删除
+    return true;
+  }
+  //can't delete
+    if (!ClaimFrame(frame_id))
+      return false;
+    pages_[frame_id].ResetMemory(page_size_);
+    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    pages_[frame_id].is_dirty_ = false;
+  page_table_.Erase(key);//断开连接
+  RemoveFromReplacer(frame_id);//从lru中删除
+  pages_[frame_id].pin_count_.store(0);
+  if (static_cast<size_t>(frame_id) < frame_limit_) {
+    free_list_.push_back(frame_id);//放入freelist
+  } else {
+    DiscardFrames(frame_id, frame_id + 1);
+  }
+  DiskOf(db_id)->DeAllocatePage(page_id);//在磁盘中删除
+  return false;
+}
+
+/**
+ * TODO: Student Implement
+ */
+bool BufferPool::UnpinPage(uint32_t db_id, page_id_t page_id, bool is_dirty) {
+  //不加latch_：调用者pin着这一页，它的帧不会换页
+  frame_id_t frame_id;
+  uint64_t key = PageKey(db_id, page_id);
+  if (!page_table_.Find(key, &frame_id)) {//不存在
+    return false;
+  }
+  else {//without pin, false
+    if (pages_[frame_id].GetPinCount() <= 0)
+      return false;
+  }
+  //先标脏再放开pin，占用这一帧的线程一定能看到脏标记
+  if (is_dirty)
+    pages_[frame_id].is_dirty_ = true;
+  return ReleasePin(frame_id);
+}
+
+/**
+ * TODO: Student Implement
+ */
+bool BufferPool::FlushPage(uint32_t db_id, page_id_t page_id) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  if(page_id==INVALID_PAGE_ID) return false;
+  frame_id_t frame_id;
+  uint64_t key = PageKey(db_id, page_id);
+  if (!page_table_.Find(key, &frame_id)) {//不存在
+    return false;
+  }
+  else {
+    //未被pin的页写时占用它(淘汰时已被占用)；先重置dirty标识再写，写的同时被修改的页unpin时会重新标脏
+    bool claimed = ClaimFrame(frame_id);
+    if(pages_[frame_id].is_dirty_.exchange(false))
+    {
+      DiskOf(db_id)->WritePage(page_id , pages_[frame_id].data_);
+    }
+    if (claimed) {
+      pages_[frame_id].pin_count_.store(0);
+    }
+  }
+  return true;
+}
+
+bool BufferPool::TryPin(frame_id_t frame_id, uint64_t key) {
+  Page &page = pages_[frame_id];
+  int pins = page.pin_count_.load();
+  do {
+    if (pins < 0) {//正在换页
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pins, pins + 1));
+  //pin住后帧不会再换页，再确认查到的不是换页前过期的关联
+  if (PageKey(page.db_id_, page.page_id_) != key) {
+    ReleasePin(frame_id);
+    return false;
+  }
+  return true;
+}
+
+bool BufferPool::ReleasePin(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  int pins = page.pin_count_.load();
+  do {
+    if (pins <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pins, pins - 1));
+  //还有别的pin，或者帧仍在替换器里，不用加锁
+  if (pins > 1 || (static_cast<size_t>(frame_id) < frame_limit_.load() && page.in_replacer_.load())) {
+    return true;
+  }
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  if (page.pin_count_.load() != 0) {//又被pin上了，留给那个pin的最后一次unpin
+    return true;
+  }
+  if (static_cast<size_t>(frame_id) >= frame_limit_) {//缓冲池缩小时还被pin着的帧，现在丢弃
+    if (ClaimFrame(frame_id)) {
+      if (page.page_id_ != INVALID_PAGE_ID) {
+        DropFrame(frame_id);
+      }
+      DiscardFrames(frame_id, frame_id + 1);
+      page.pin_count_.store(0);
+    }
+  } else if (page.page_id_ != INVALID_PAGE_ID && !page.in_replacer_.load()) {//put into lru
+    replacer_->Unpin(frame_id);
+    page.in_replacer_.store(true);
+  }
+  return true;
+}
+
+void BufferPool::WaitClaimFrame(frame_id_t frame_id) {
+  for (int spin = 0; !ClaimFrame(frame_id); spin++) {
+    ASSERT(spin < CLAIM_MAX_SPINS, "Frame without a page, or of a closed database, is still pinned.");
+    std::this_thread::yield();
+  }
+}
+
+bool BufferPool::TakeFrame(frame_id_t *frame_id) {
+  //find the place to set the page from free-list
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.back();
+    free_list_.pop_back();
+    //查找过期的线程可能刚pin上这个空帧，它发现页不对会马上放开
+    WaitClaimFrame(*frame_id);
+    return true;
+  }
+  //find the place to set the page from replacer
+  if (!PickVictim(frame_id)) {
+    return false;
+  }
+  Page &page = pages_[*frame_id];
+  evictions_metric_->AddLatched();
+  if (page.IsDirty()) {  // if the page is dirty, flush it to disk(have been changed)
+    FlushPage(page.db_id_, page.GetPageId());
+    eviction_writes_metric_->AddLatched();
+    //后台写线程没跟上，提前唤醒它
+    WakeWriter();
+  }
+  page.ResetMemory(page_size_);//清零
+  page_table_.Erase(PageKey(page.db_id_, page.GetPageId()));//去掉关联
+  return true;
+}
+
+void BufferPool::FlushAllPages(uint32_t db_id) {
+  WriteDirtyPages(db_id, false);
+}
+
+void BufferPool::BackgroundWriter() {
+  auto next_checkpoint = std::chrono::steady_clock::now() + std::chrono::seconds(CHECKPOINT_INTERVAL_SECONDS);
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(writer_latch_);
+      writer_cv_.wait_for(lock, std::chrono::milliseconds(BGWRITER_DELAY_MS),
+                          [&] { return writer_stop_ || writer_wakeup_; });
+      if (writer_stop_) {
+        return;
+      }
+      writer_wakeup_.store(false);
+    }
+    if (std::chrono::steady_clock::now() >= next_checkpoint) {
+      //模糊检查点：逐批写出所有未被pin的脏页，期间查询照常进行
+      WriteDirtyPages(INVALID_DB_ID, true);
+      next_checkpoint = std::chrono::steady_clock::now() + std::chrono::seconds(CHECKPOINT_INTERVAL_SECONDS);
+    } else {
+      //一批写满说明脏页产生得比写出快，接着写下一批，每批之间放开latch_
+      size_t written;
+      do {
+        std::lock_guard<std::recursive_mutex> guard(latch_);
+        written = CleanPages();
+      } while (written == BGWRITER_MAX_PAGES && !IsWriterStopping());
+    }
+  }
+}
+
+bool BufferPool::PickVictim(frame_id_t *frame_id) {
+  //不加锁的pin不会把帧移出替换器，候选被pin着时占用失败，把它移出替换器，它最后一次unpin时再放回
+  auto claim = [&](frame_id_t candidate) {
+    RemoveFromReplacer(candidate);
+    if (!ClaimFrame(candidate)) {
+      return false;
+    }
+    *frame_id = candidate;
+    return true;
+  };
+  //后台写线程已写回的页可以直接淘汰，在接下来的几个候选中先找干净页
+  frame_id_t victims[BGWRITER_MAX_PAGES];
+  size_t victim_count = replacer_->PeekVictims(victims, BGWRITER_MAX_PAGES);
+  for (size_t i = 0; i < victim_count; i++) {
+    if (!pages_[victims[i]].is_dirty_ && pages_[victims[i]].pin_count_ == 0 && claim(victims[i])) {
+      return true;
+    }
+  }
+  //候选都是脏页时，从缓冲池中再找一个未被pin的干净页
+  for (size_t step = 0; step < BGWRITER_MAX_PAGES; step++) {
+    Page &page = pages_[evict_hand_];
+    frame_id_t candidate = static_cast<frame_id_t>(evict_hand_);
+    evict_hand_ = (evict_hand_ + 1) % pool_size_;
+    if (static_cast<size_t>(candidate) < frame_limit_ && page.pin_count_ == 0 && page.page_id_ != INVALID_PAGE_ID &&
+        !page.is_dirty_ && claim(candidate)) {
+      return true;
+    }
+  }
+  frame_id_t candidate;
+  while (replacer_->Victim(&candidate)) {
+    if (claim(candidate)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t BufferPool::CleanPages() {
+  batch_.clear();
+  auto add = [&](frame_id_t frame_id) {
+    if (pages_[frame_id].is_dirty_ && pages_[frame_id].pin_count_ == 0 &&
+        std::find(batch_.begin(), batch_.end(), frame_id) == batch_.end()) {
+      batch_.push_back(frame_id);
+    }
+  };
+  //先写替换器马上要淘汰的页
+  frame_id_t victims[BGWRITER_MAX_PAGES];
+  size_t victim_count = replacer_->PeekVictims(victims, BGWRITER_MAX_PAGES);
+  for (size_t i = 0; i < victim_count; i++) {
+    add(victims[i]);
+  }
+  //再从上次停下的位置轮转扫描整个缓冲池，慢慢写出其余脏页
+  for (size_t step = 0; step < pool_size_ && batch_.size() < BGWRITER_MAX_PAGES; step++) {
+    add(static_cast<frame_id_t>(writer_hand_));
+    writer_hand_ = (writer_hand_ + 1) % pool_size_;
+  }
+  size_t count = batch_.size();
+  WriteBatch();
+  return count;
+}
+
+void BufferPool::WriteDirtyPages(uint32_t db_id, bool unpinned_only) {
+  size_t frame_id = 0;
+  while (frame_id < pool_size_) {
+    //每批单独加锁，批与批之间前台可以继续使用缓冲池
+    std::lock_guard<std::recursive_mutex> guard(latch_);
+    batch_.clear();
+    for (; frame_id < pool_size_ && batch_.size() < BGWRITER_MAX_PAGES; frame_id++) {
+      Page &page = pages_[frame_id];
+      if (page.is_dirty_ && (db_id == INVALID_DB_ID || page.db_id_ == db_id) &&
+          (!unpinned_only || page.pin_count_ == 0)) {
+        batch_.push_back(static_cast<frame_id_t>(frame_id));
+      }
+    }
+    WriteBatch();
+  }
+}
+
+void BufferPool::WriteBatch() {
+  if (batch_.empty()) {
+    return;
+  }
+  //按库和页号排序，同一个库磁盘上相邻的页一次写出
+  std::sort(batch_.begin(), batch_.end(), [&](frame_id_t a, frame_id_t b) {
+    return PageKey(pages_[a].db_id_, pages_[a].page_id_) < PageKey(pages_[b].db_id_, pages_[b].page_id_);
+  });
+  page_id_t page_ids[BGWRITER_MAX_PAGES];
+  for (size_t i = 0; i < batch_.size(); i++) {
+    Page &page = pages_[batch_[i]];
+    page_ids[i] = page.page_id_;
+    //未被pin的页复制时占用它，不加锁的pin等复制完再进来；被pin的页可能正被修改，先清脏标记，改完unpin时会重新标脏
+    bool claimed = ClaimFrame(batch_[i]);
+    page.is_dirty_.exchange(false);
+    memcpy(batch_data_.data() + i * page_size_, page.data_, page_size_);
+    if (claimed) {
+      page.pin_count_.store(0);
+    }
+  }
+  size_t begin = 0;
+  while (begin < batch_.size()) {
+    uint32_t db_id = pages_[batch_[begin]].db_id_;
+    size_t end = begin + 1;
+    while (end < batch_.size() && pages_[batch_[end]].db_id_ == db_id) {
+      end++;
+    }
+    DiskOf(db_id)->WritePages(page_ids + begin, batch_data_.data() + begin * page_size_, end - begin);
+    begin = end;
+  }
+  batch_writes_metric_->AddLatched(batch_.size());
+  batch_.clear();
+}
+
+bool BufferPool::IsWriterStopping() {
+  std::lock_guard<std::mutex> lock(writer_latch_);
+  return writer_stop_;
+}
+
+void BufferPool::WakeWriter() {
+  //已经叫醒过就不再通知，前台连续写页时不必每次都切换线程
+  if (!writer_wakeup_.exchange(true)) {
+    std::lock_guard<std::mutex> lock(writer_latch_);
+    writer_cv_.notify_one();
+  }
+}
+
+size_t BufferPool::DirtyPageCount() {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  size_t count = 0;
+  for (size_t i = 0; i < pool_size_; i++) {
+    count += pages_[i].is_dirty_;
+  }
+  return count;
+}
+
+bool BufferPool::IsPageFree(uint32_t db_id, page_id_t page_id) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  return DiskOf(db_id)->IsPageFree(page_id);
+}
+
+// Only used for debug
+bool BufferPool::CheckAllUnpinned(uint32_t db_id) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  bool res = true;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].db_id_ == db_id && pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].pin_count_ != 0) {
+      res = false;
+      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+    }
+  }
+  return res;
+}
@@ -67,6 +67,19 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   
 }
 
+size_t LRUReplacer::PeekVictims(frame_id_t *frame_ids, size_t max_count) {
+  //链表头是最近unpin的frame，淘汰从链表尾开始
+  vector<frame_id_t> order;
+  for (lru_list *p = head; p != nullptr; p = p->next) {
+    order.push_back(p->f_id);
+  }
+  size_t count = 0;
+  for (auto it = order.rbegin(); it != order.rend() && count < max_count; ++it) {
+    frame_ids[count++] = *it;
+  }
+  return count;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -0,0 +1,171 @@
+#include "buffer/page_table.h"
+
+#include <thread>
+
+PageTable::PageTable(size_t max_entries) {
+  capacity_ = STRIPE_COUNT;
+  while (capacity_ < 2 * max_entries) {
+    capacity_ <<= 1;
+  }
+  mask_ = capacity_ - 1;
+  max_used_ = capacity_ / 4 * 3;
+  for (auto &slots : slots_) {
+    slots = new Slot[capacity_];
+    for (size_t i = 0; i < capacity_; i++) {
+      slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+      slots[i].frame_id.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+      slots[i].version.store(0, std::memory_order_relaxed);
+    }
+  }
+  current_.store(slots_[0]);
+}
+
+PageTable::~PageTable() {
+  for (auto &slots : slots_) {
+    delete[] slots;
+  }
+}
+
+PageTable::Slot *PageTable::Probe(Slot *slots, uint64_t key) const {
+  for (size_t i = HomeOf(key), n = 0; n < capacity_; i = (i + 1) & mask_, n++) {
+    uint64_t slot_key = slots[i].key.load(std::memory_order_acquire);
+    if (slot_key == key) {
+      return &slots[i];
+    }
+    if (slot_key == EMPTY_KEY) {
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+bool PageTable::Find(uint64_t key, frame_id_t *frame_id) const {
+  while (true) {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    if (version & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    Slot *slot = Probe(current_.load(std::memory_order_acquire), key);
+    frame_id_t found_frame_id = INVALID_FRAME_ID;
+    bool found = false;
+    uint32_t slot_version = 0;
+    if (slot != nullptr) {
+      slot_version = slot->version.load(std::memory_order_acquire);
+      if (slot_version & 1) {
+        continue;
+      }
+      found_frame_id = slot->frame_id.load(std::memory_order_relaxed);
+      // the slot may have been erased before its version was read
+      found = slot->key.load(std::memory_order_relaxed) == key;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // the slot may have been erased and given the key again with another frame while it was read
+    if (slot != nullptr && slot->version.load(std::memory_order_relaxed) != slot_version) {
+      continue;
+    }
+    // a rebuild may have reused the array the lookup ran on, look again then
+    if (version_.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+    if (found) {
+      *frame_id = found_frame_id;
+    }
+    return found;
+  }
+}
+
+bool PageTable::Insert(uint64_t key, frame_id_t frame_id) {
+  size_t home = HomeOf(key);
+  std::unique_lock<std::mutex> lock(stripe_latches_[home % STRIPE_COUNT]);
+  // the array only changes while every stripe latch is held
+  Slot *slots = current_.load(std::memory_order_relaxed);
+  if (Probe(slots, key) != nullptr) {
+    return false;
+  }
+  for (size_t i = home, n = 0; n < capacity_; i = (i + 1) & mask_, n++) {
+    uint64_t slot_key = slots[i].key.load(std::memory_order_relaxed);
+    if (slot_key != EMPTY_KEY && slot_key != TOMBSTONE_KEY) {
+      continue;
+    }
+    bool was_empty = slot_key == EMPTY_KEY;
+    if (was_empty && used_.fetch_add(1) >= max_used_) {
+      used_.fetch_sub(1);
+      lock.unlock();
+      {
+        std::unique_lock<std::mutex> locks[STRIPE_COUNT];
+        for (size_t s = 0; s < STRIPE_COUNT; s++) {
+          locks[s] = std::unique_lock<std::mutex>(stripe_latches_[s]);
+        }
+        // another writer may have rebuilt the table while we waited
+        if (used_.load() >= max_used_) {
+          Rebuild();
+        }
+      }
+      return Insert(key, frame_id);
+    }
+    // writers of other stripes may go for the same slot
+    if (!slots[i].key.compare_exchange_strong(slot_key, RESERVED_KEY)) {
+      if (was_empty) {
+        used_.fetch_sub(1);
+      }
+      continue;
+    }
+    WriteSlot(&slots[i], key, frame_id);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  ASSERT(false, "Page table is full.");
+  return false;
+}
+
+bool PageTable::Erase(uint64_t key) {
+  std::lock_guard<std::mutex> lock(stripe_latches_[HomeOf(key) % STRIPE_COUNT]);
+  Slot *slot = Probe(current_.load(std::memory_order_relaxed), key);
+  if (slot == nullptr) {
+    return false;
+  }
+  WriteSlot(slot, TOMBSTONE_KEY, INVALID_FRAME_ID);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+void PageTable::WriteSlot(Slot *slot, uint64_t key, frame_id_t frame_id) {
+  uint32_t version = slot->version.load(std::memory_order_relaxed);
+  slot->version.store(version + 1, std::memory_order_relaxed);
+  // lookups which read the slot below have to see the odd version once they read it again
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->frame_id.store(frame_id, std::memory_order_relaxed);
+  slot->key.store(key, std::memory_order_release);
+  slot->version.store(version + 2, std::memory_order_release);
+}
+
+void PageTable::Rebuild() {
+  Slot *old_slots = current_.load(std::memory_order_relaxed);
+  Slot *new_slots = old_slots == slots_[0] ? slots_[1] : slots_[0];
+  // lookups which still run on the spare array since the last rebuild have to see the version change
+  // once they read anything written below
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < capacity_; i++) {
+    new_slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+  }
+  size_t used = 0;
+  for (size_t i = 0; i < capacity_; i++) {
+    uint64_t key = old_slots[i].key.load(std::memory_order_relaxed);
+    if (key == EMPTY_KEY || key == TOMBSTONE_KEY) {
+      continue;
+    }
+    size_t j = HomeOf(key);
+    while (new_slots[j].key.load(std::memory_order_relaxed) != EMPTY_KEY) {
+      j = (j + 1) & mask_;
+    }
+    new_slots[j].frame_id.store(old_slots[i].frame_id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    new_slots[j].key.store(key, std::memory_order_relaxed);
+    used++;
+  }
+  ASSERT(used < max_used_, "Page table holds more keys than it was sized for.");
+  version_.fetch_add(1, std::memory_order_release);
+  current_.store(new_slots, std::memory_order_release);
+  version_.fetch_add(1, std::memory_order_release);
+  used_.store(used);
+}
@@ -58,6 +58,17 @@ void SetReplacer::Unpin(frame_id_t frame_id) {
   }
 }
 
+size_t SetReplacer::PeekVictims(frame_id_t *frame_ids, size_t max_count) {
+  //与Victim相同从victim_末尾取，跳过已被pin的过期记录
+  size_t count = 0;
+  for (auto it = victim_.rbegin(); it != victim_.rend() && count < max_count; ++it) {
+    if (unpin_.find(*it) != unpin_.end()) {
+      frame_ids[count++] = *it;
+    }
+  }
+  return count;
+}
+
 /**
  * TODO: Student Implement
  */
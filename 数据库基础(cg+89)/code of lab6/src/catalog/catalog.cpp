@@ -1,8 +1,8 @@
 #include "catalog/catalog.h"
 
 void CatalogMeta::SerializeTo(char *buf) const {
-  ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
-  MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
+  ASSERT(GetSerializedSize() <= MIN_PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
+  MACH_WRITE_UINT32(buf, compact_rows_ ? CATALOG_METADATA_MAGIC_NUM_COMPACT : CATALOG_METADATA_MAGIC_NUM);
   buf += 4;
   MACH_WRITE_UINT32(buf, table_meta_pages_.size());
   buf += 4;
@@ -26,7 +26,8 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf) {
   // check valid
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
-  ASSERT(magic_num == CATALOG_METADATA_MAGIC_NUM, "Failed to deserialize catalog metadata from disk.");
+  ASSERT(magic_num == CATALOG_METADATA_MAGIC_NUM || magic_num == CATALOG_METADATA_MAGIC_NUM_COMPACT,
+         "Failed to deserialize catalog metadata from disk.");
   // get table and index nums
   uint32_t table_nums = MACH_READ_UINT32(buf);
   buf += 4;
@@ -34,6 +35,7 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf) {
   buf += 4;
   // create metadata and read value
   CatalogMeta *meta = new CatalogMeta();
+  meta->compact_rows_ = magic_num == CATALOG_METADATA_MAGIC_NUM_COMPACT;
   for (uint32_t i = 0; i < table_nums; i++) {
     auto table_id = MACH_READ_FROM(table_id_t, buf);
     buf += 4;
@@ -96,6 +98,48 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
 
     next_index_id_ = catalog_meta_->GetNextIndexId();
     next_table_id_ = catalog_meta_->GetNextTableId();
+
+    // 旧版本数据库中的元组仍为旧行格式，打开时原地升级一次，全部升级后才更新magic number
+    if (!catalog_meta_->compact_rows_) {
+      uint32_t legacy_rows = 0;
+      for (auto &iter : tables_) {
+        legacy_rows += iter.second->GetTableHeap()->UpgradeRowFormat(nullptr);
+      }
+      catalog_meta_->compact_rows_ = legacy_rows == 0;
+      if (legacy_rows != 0) {
+        LOG(WARNING) << legacy_rows << " rows left in legacy row format, will retry on next open";
+      }
+    }
+
+    // 旧版本的索引键按字段比较、页内定长存放，无法沿用，释放旧页后从表中重建
+    // art索引只在内存中，每次打开时同样从表中重建
+    for (auto &iter : indexes_) {
+      IndexInfo *index_info = iter.second;
+      IndexMetadata *index_meta = index_info->GetMetadata();
+      bool in_memory = index_info->GetIndexType() == "art";
+      if (!index_meta->HasLegacyKeys() && !in_memory) {
+        continue;
+      }
+      Index *index = index_info->GetIndex();
+      if (index_info->GetIndexType() == "bptree") {
+        dynamic_cast<BPlusTreeIndex *>(index)->DestroyLegacy();
+      } else if (!in_memory) {
+        index->Destroy();
+      }
+      TableHeap *table_heap = index_info->GetTableInfo()->GetTableHeap();
+      for (auto row_iter = table_heap->Begin(nullptr); !(row_iter == table_heap->End()); ++row_iter) {
+        Row key_row;
+        row_iter.GetView().Project(index->GetKeySchema(), &key_row);
+        index->InsertEntry(key_row, row_iter.GetRowId(), nullptr);
+      }
+      if (!index_meta->HasLegacyKeys()) {
+        continue;
+      }
+      index_meta->ClearLegacyKeys();
+      page_id_t meta_page_id = catalog_meta_->index_meta_pages_[iter.first];
+      index_meta->SerializeTo(buffer_pool_manager_->FetchPage(meta_page_id)->GetData());
+      buffer_pool_manager_->UnpinPage(meta_page_id, true);
+    }
   }
 
   FlushCatalogMetaPage();
@@ -136,7 +180,8 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   //ASSERT(k== 0, "Not able to allocate page");
   //EXPECT_EQ(k,1000);
   TableMetadata *table_meta = TableMetadata::Create(next_table_id_, table_name,
-                                                    table_heap->GetFirstPageId(), newschema);
+                                                    table_heap->GetFirstPageId(), newschema,
+                                                    table_heap->GetDirectoryPageId());
 
   table_info->Init(table_meta, table_heap);
 
@@ -209,14 +254,22 @@ dberr_t CatalogManager::GetIndexNames( std::vector<string> &index_names) {
 }
     }
   }
+  return DB_SUCCESS;
 }
 /**
  * TODO: Student Implement
  */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info, const string &index_type) {
+                                    IndexInfo *&index_info, const string &index_type, bool unique) {
   // ASSERT(false, "Not Implemented yet");
+  if (index_type != "bptree" && index_type != "betree" && index_type != "hash" && index_type != "art") {
+    return DB_FAILED;
+  }
+  // 哈希索引只支持唯一键
+  if (index_type == "hash" && !unique) {
+    return DB_FAILED;
+  }
   if(table_names_.count(table_name) == 0) {
     return DB_TABLE_NOT_EXIST;
   }
@@ -262,7 +315,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   }
 
   // Deal with IndexInfo & indexMeta
-  IndexMetadata *index_meta = IndexMetadata::Create(next_index_id_, index_name, table_id, key_map);
+  IndexMetadata *index_meta = IndexMetadata::Create(next_index_id_, index_name, table_id, key_map, index_type, unique);
   page_id_t page_id;
   Page *page = buffer_pool_manager_->NewPage(page_id);
   ASSERT(page != nullptr, "Not able to allocate new page");
@@ -407,6 +460,42 @@ dberr_t CatalogManager::FlushCatalogMetaPage() const {
   return DB_FAILED;
 }
 
+dberr_t CatalogManager::VacuumTable(const string &table_name, uint32_t &moved_rows, uint32_t &released_pages) {
+  TableInfo *table_info = nullptr;
+  if (GetTable(table_name, table_info) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  std::vector<IndexInfo *> index_infos;
+  GetTableIndexes(table_name, index_infos);
+  moved_rows = 0;
+  dberr_t result = DB_SUCCESS;
+  // 元组搬到新页后row id改变，所有索引中删去旧的row id再插入新的
+  // 某个索引插不进新的row id时，已改过的索引改回旧的row id，元组留在原处，整理到此为止
+  table_info->GetTableHeap()->Vacuum(
+      [&](Row &row, const RowId &old_rid) {
+        std::vector<Row> keys(index_infos.size());
+        for (size_t i = 0; i < index_infos.size(); i++) {
+          Index *index = index_infos[i]->GetIndex();
+          row.GetKeyFromRow(table_info->GetSchema(), index->GetKeySchema(), keys[i]);
+          index->RemoveEntry(keys[i], old_rid, nullptr);
+          result = index->InsertEntry(keys[i], row.GetRowId(), nullptr);
+          if (result == DB_SUCCESS) {
+            continue;
+          }
+          index->InsertEntry(keys[i], old_rid, nullptr);
+          for (size_t j = 0; j < i; j++) {
+            index_infos[j]->GetIndex()->RemoveEntry(keys[j], row.GetRowId(), nullptr);
+            index_infos[j]->GetIndex()->InsertEntry(keys[j], old_rid, nullptr);
+          }
+          return false;
+        }
+        moved_rows++;
+        return true;
+      },
+      released_pages, nullptr);
+  return result;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -419,9 +508,16 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   ASSERT(buf != nullptr, "Buffer not get");
   TableMetadata::DeserializeFrom(buf, table_meta);
   ASSERT(table_meta != nullptr, "Unable to deserialize table_meta_data");
-  buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, false);
-
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(), log_manager_, lock_manager_);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+
+  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(), log_manager_, lock_manager_,
+                                           table_meta->GetDirectoryPageId());
+  // 旧版本的表没有页目录，打开时由table heap建立，这里把目录页记入元数据
+  if (table_meta->GetDirectoryPageId() != table_heap->GetDirectoryPageId()) {
+    table_meta->SetDirectoryPageId(table_heap->GetDirectoryPageId());
+    table_meta->SerializeTo(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
 
   // Initialize table_info
   table_info->Init(table_meta, table_heap);
@@ -443,17 +539,15 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
   ASSERT(buf != nullptr, "Buffer not get");
   IndexMetadata::DeserializeFrom(buf, index_meta);
   ASSERT(index_meta != nullptr, "Unable to deserialize index_meta_data");
-  buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, false);
+  buffer_pool_manager_->UnpinPage(page_id, false);
   //Schema *table_schema=tables_[index_meta->GetTableId()]->GetSchema();
   //Schema *index_schema=Schema::ShallowCopySchema(table_schema, index_meta->GetKeyMapping());
 
   // Initialize index_info
   index_info->Init(index_meta, tables_[index_meta->GetTableId()], buffer_pool_manager_);
   indexes_.insert(pair<index_id_t, IndexInfo *>(index_id, index_info));
-  unordered_map<string, index_id_t> map_index_id;
-  map_index_id.insert(pair<string, index_id_t>(index_info->GetIndexName(), index_id));
-  index_names_.insert(pair<string,  unordered_map<string, index_id_t> >(index_info->GetTableInfo()->GetTableName(),
-                                                                       map_index_id));
+  // 同一张表可能有多个索引，不能整体insert覆盖
+  index_names_[index_info->GetTableInfo()->GetTableName()][index_info->GetIndexName()] = index_id;
   return DB_SUCCESS;
   return DB_FAILED;
 }
@@ -1,20 +1,26 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, const std::string &index_type, bool unique)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      index_type_(index_type),
+      unique_(unique),
+      legacy_keys_(false) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, const std::string &index_type, bool unique) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, index_type, unique);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
     char *p = buf;
     uint32_t ofs = GetSerializedSize();
-    ASSERT(ofs <= PAGE_SIZE, "Failed to serialize index info.");
+    ASSERT(ofs <= MIN_PAGE_SIZE, "Failed to serialize index info.");
     // magic num
-    MACH_WRITE_UINT32(buf, INDEX_METADATA_MAGIC_NUM);
+    MACH_WRITE_UINT32(buf, INDEX_METADATA_COMPARABLE_MAGIC_NUM);
     buf += 4;
     // index id
     MACH_WRITE_TO(index_id_t, buf, index_id_);
@@ -35,6 +41,14 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
         MACH_WRITE_UINT32(buf, col_index);
         buf += 4;
     }
+    // index type
+    MACH_WRITE_UINT32(buf, index_type_.length());
+    buf += 4;
+    MACH_WRITE_STRING(buf, index_type_);
+    buf += index_type_.length();
+    // unique
+    MACH_WRITE_UINT32(buf, unique_);
+    buf += 4;
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
@@ -43,7 +57,7 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t IndexMetadata::GetSerializedSize() const {
-    return 4 * (key_map_.size() + 5) + index_name_.length();
+    return 4 * (key_map_.size() + 7) + index_name_.length() + index_type_.length();
     //return 0;
 }
 
@@ -55,7 +69,9 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     // magic num
     uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
-    ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
+    ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM || magic_num == INDEX_METADATA_TYPED_MAGIC_NUM ||
+               magic_num == INDEX_METADATA_UNIQUE_MAGIC_NUM || magic_num == INDEX_METADATA_COMPARABLE_MAGIC_NUM,
+           "Failed to deserialize index info.");
     // index id
     index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
     buf += 4;
@@ -77,8 +93,23 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
         buf += 4;
         key_map.push_back(key_index);
     }
+    // index type
+    std::string index_type = "bptree";
+    if (magic_num != INDEX_METADATA_MAGIC_NUM) {
+        len = MACH_READ_UINT32(buf);
+        buf += 4;
+        index_type.assign(buf, len);
+        buf += len;
+    }
+    // unique
+    bool unique = true;
+    if (magic_num == INDEX_METADATA_UNIQUE_MAGIC_NUM || magic_num == INDEX_METADATA_COMPARABLE_MAGIC_NUM) {
+        unique = MACH_READ_UINT32(buf) != 0;
+        buf += 4;
+    }
     // allocate space for index meta data
-    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, index_type, unique);
+    index_meta->legacy_keys_ = magic_num != INDEX_METADATA_COMPARABLE_MAGIC_NUM;
     return buf - p;
 }
 
@@ -88,23 +119,25 @@ Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const stri
     max_size += col->GetLength();
   }
 
-  if (index_type == "bptree") {
-    if (max_size <= 8)
-      max_size = 16;
-    else if (max_size <= 24)
-      max_size = 32;
-    else if (max_size <= 56)
-      max_size = 64;
-    else if (max_size <= 120)
-      max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
-    else {
-      LOG(ERROR) << "GenericKey size is too large";
-      return nullptr;
-    }
-  } else {
+  if (index_type != "bptree" && index_type != "betree" && index_type != "hash" && index_type != "art") {
+    return nullptr;
+  }
+  if (max_size > 248) {
+    LOG(ERROR) << "GenericKey size is too large";
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  // room for the encoded key, and the RowId appended to every key of a non-unique index
+  max_size = KeyManager::GetMaxKeySize(key_schema_, meta_data_->IsUnique());
+  if (index_type == "hash") {
+    ASSERT(meta_data_->IsUnique(), "Hash index only support unique key.");
+    return new HashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  }
+  if (index_type == "art") {
+    return new ArtIndex(meta_data_->index_id_, key_schema_, max_size, meta_data_->IsUnique());
+  }
+  if (index_type == "betree") {
+    return new BeTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, meta_data_->IsUnique());
+  }
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager,
+                            meta_data_->IsUnique());
 }
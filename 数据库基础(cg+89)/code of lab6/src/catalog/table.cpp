@@ -3,9 +3,9 @@
 uint32_t TableMetadata::SerializeTo(char *buf) const {
     char *p = buf;
     uint32_t ofs = GetSerializedSize();
-    ASSERT(ofs <= PAGE_SIZE, "Failed to serialize table info.");
+    ASSERT(ofs <= MIN_PAGE_SIZE, "Failed to serialize table info.");
     // magic num
-    MACH_WRITE_UINT32(buf, TABLE_METADATA_MAGIC_NUM);
+    MACH_WRITE_UINT32(buf, TABLE_METADATA_DIRECTORY_MAGIC_NUM);
     //uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
     // table id
@@ -21,6 +21,9 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
     buf += 4;
     // table schema
     buf += schema_->SerializeTo(buf);
+    // page directory
+    MACH_WRITE_TO(page_id_t, buf, directory_page_id_);
+    buf += 4;
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
@@ -30,7 +33,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t TableMetadata::GetSerializedSize() const {
-    return  16 + schema_->GetSerializedSize() + table_name_.length();
+    return  20 + schema_->GetSerializedSize() + table_name_.length();
     //return 0;
 }
 
@@ -42,7 +45,7 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // magic num
     uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
-    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "Failed to deserialize table info.");
+    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM || magic_num == TABLE_METADATA_DIRECTORY_MAGIC_NUM, "Failed to deserialize table info.");
     // table id
     table_id_t table_id = MACH_READ_FROM(table_id_t, buf);
     buf += 4;
@@ -57,9 +60,15 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // table schema
     TableSchema *schema = nullptr;
     buf += TableSchema::DeserializeFrom(buf, schema);
+    // page directory, tables written before it existed get one when they are opened
+    page_id_t directory_page_id = INVALID_PAGE_ID;
+    if (magic_num == TABLE_METADATA_DIRECTORY_MAGIC_NUM) {
+        directory_page_id = MACH_READ_FROM(page_id_t, buf);
+        buf += 4;
+    }
     // allocate space for table metadata
     //ASSERT(magic_num == 0, "Failed to deserialize table info.");
-        table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+        table_meta = new TableMetadata(table_id, table_name, root_page_id, schema, directory_page_id);
     return buf - p;
 }
 
@@ -69,11 +78,16 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                     TableSchema *schema) {
+                                     TableSchema *schema, page_id_t directory_page_id) {
     TableSchema *schema1=schema->DeepCopySchema(schema);
   // allocate space for table metadata
-  return new TableMetadata(table_id, table_name, root_page_id, schema1);
+  return new TableMetadata(table_id, table_name, root_page_id, schema1, directory_page_id);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-    : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             page_id_t directory_page_id)
+    : table_id_(table_id),
+      table_name_(table_name),
+      root_page_id_(root_page_id),
+      schema_(schema),
+      directory_page_id_(directory_page_id) {}
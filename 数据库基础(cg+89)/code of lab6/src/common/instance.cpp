@@ -3,7 +3,7 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t page_size, BufferPool *buffer_pool)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/"+db_file_name_;
@@ -11,8 +11,11 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     remove(db_file_name_.c_str());
   }
   // Initialize components
-  disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  disk_mgr_ = new DiskManager(db_file_name_, page_size);
+  if (buffer_pool == nullptr) {
+    buffer_pool = BufferPool::Instance(disk_mgr_->GetPageSize());
+  }
+  bpm_ = new BufferPoolManager(buffer_pool, disk_mgr_);
 
   // Allocate static page for db storage engine
   if (init) {
@@ -0,0 +1,207 @@
+#include "common/metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+/** the le bounds of the buckets written out for Prometheus, powers of two of nanoseconds from 1us to 17s */
+constexpr int EXPORT_FIRST_SHIFT = 10;
+constexpr int EXPORT_LAST_SHIFT = 34;
+constexpr int EXPORT_SHIFT_STEP = 2;
+
+std::string FormatSeconds(double seconds) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.12g", seconds);
+  return buf;
+}
+
+/** a duration in the unit that keeps it readable */
+std::string FormatDuration(double ns) {
+  char buf[32];
+  if (ns < 1e3) {
+    snprintf(buf, sizeof(buf), "%.0fns", ns);
+  } else if (ns < 1e6) {
+    snprintf(buf, sizeof(buf), "%.1fus", ns / 1e3);
+  } else if (ns < 1e9) {
+    snprintf(buf, sizeof(buf), "%.2fms", ns / 1e6);
+  } else {
+    snprintf(buf, sizeof(buf), "%.2fs", ns / 1e9);
+  }
+  return buf;
+}
+
+/** name{labels}, with extra appended to the labels */
+std::string Series(const std::string &name, const std::string &labels, const std::string &extra = "") {
+  std::string all = labels.empty() ? extra : (extra.empty() ? labels : labels + "," + extra);
+  return all.empty() ? name : name + "{" + all + "}";
+}
+}  // namespace
+
+uint64_t Histogram::Count() const {
+  uint64_t count = 0;
+  for (auto &bucket : buckets_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t Histogram::BucketEnd(size_t bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+  uint64_t begin = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+  return begin + ((1ULL << shift) - 1);
+}
+
+uint64_t Histogram::Quantile(double q) const {
+  uint64_t counts[BUCKET_COUNT];
+  uint64_t total = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // the rank of the value wanted, from 1 to total
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      // the end of the last bucket may be beyond anything recorded
+      return std::min(BucketEnd(i), Max());
+    }
+  }
+  return Max();
+}
+
+uint64_t Histogram::CountBelow(uint64_t bound) const {
+  uint64_t count = 0;
+  for (size_t i = 0; i < BUCKET_COUNT && BucketEnd(i) < bound; i++) {
+    count += buckets_[i].load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+MetricsRegistry *MetricsRegistry::Instance() {
+  static auto *registry = new MetricsRegistry();
+  return registry;
+}
+
+MetricsRegistry::Metric &MetricsRegistry::GetMetric(const std::string &name, const std::string &help,
+                                                    const std::string &labels, Type type) {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_.emplace(name, Family{help, type, {}}).first;
+  }
+  ASSERT(it->second.type_ == type, "Metric registered with another type.");
+  return it->second.metrics_[labels];
+}
+
+Counter *MetricsRegistry::GetCounter(const std::string &name, const std::string &help, const std::string &labels) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Metric &metric = GetMetric(name, help, labels, Type::kCounter);
+  if (metric.counter_ == nullptr) {
+    metric.counter_ = std::make_unique<Counter>();
+  }
+  return metric.counter_.get();
+}
+
+Histogram *MetricsRegistry::GetHistogram(const std::string &name, const std::string &help,
+                                         const std::string &labels) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Metric &metric = GetMetric(name, help, labels, Type::kHistogram);
+  if (metric.histogram_ == nullptr) {
+    metric.histogram_ = std::make_unique<Histogram>();
+  }
+  return metric.histogram_.get();
+}
+
+void MetricsRegistry::SetGauge(const std::string &name, const std::string &help, const std::string &labels,
+                               std::function<double()> read) {
+  std::lock_guard<std::mutex> guard(latch_);
+  GetMetric(name, help, labels, Type::kGauge).gauge_ = std::move(read);
+}
+
+void MetricsRegistry::RemoveGauge(const std::string &name, const std::string &labels) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    return;
+  }
+  it->second.metrics_.erase(labels);
+  if (it->second.metrics_.empty()) {
+    families_.erase(it);
+  }
+}
+
+void MetricsRegistry::WriteText(std::ostream &out) {
+  std::lock_guard<std::mutex> guard(latch_);
+  static const char *type_names[] = {"counter", "gauge", "histogram"};
+  for (auto &family : families_) {
+    const std::string &name = family.first;
+    out << "# HELP " << name << " " << family.second.help_ << "\n";
+    out << "# TYPE " << name << " " << type_names[static_cast<int>(family.second.type_)] << "\n";
+    for (auto &entry : family.second.metrics_) {
+      const std::string &labels = entry.first;
+      const Metric &metric = entry.second;
+      switch (family.second.type_) {
+        case Type::kCounter:
+          out << Series(name, labels) << " " << metric.counter_->Value() << "\n";
+          break;
+        case Type::kGauge:
+          out << Series(name, labels) << " " << metric.gauge_() << "\n";
+          break;
+        case Type::kHistogram: {
+          const Histogram *histogram = metric.histogram_.get();
+          for (int shift = EXPORT_FIRST_SHIFT; shift <= EXPORT_LAST_SHIFT; shift += EXPORT_SHIFT_STEP) {
+            uint64_t bound = 1ULL << shift;
+            out << Series(name + "_bucket", labels, "le=\"" + FormatSeconds(bound / 1e9) + "\"") << " "
+                << histogram->CountBelow(bound) << "\n";
+          }
+          uint64_t count = histogram->Count();
+          out << Series(name + "_bucket", labels, "le=\"+Inf\"") << " " << count << "\n";
+          out << Series(name + "_sum", labels) << " " << FormatSeconds(histogram->Sum() / 1e9) << "\n";
+          out << Series(name + "_count", labels) << " " << count << "\n";
+          break;
+        }
+      }
+    }
+  }
+}
+
+void MetricsRegistry::Describe(std::vector<std::pair<std::string, std::string>> *lines) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto &family : families_) {
+    for (auto &entry : family.second.metrics_) {
+      std::string series = Series(family.first, entry.first);
+      const Metric &metric = entry.second;
+      switch (family.second.type_) {
+        case Type::kCounter:
+          lines->emplace_back(series, std::to_string(metric.counter_->Value()));
+          break;
+        case Type::kGauge: {
+          char buf[32];
+          snprintf(buf, sizeof(buf), "%g", metric.gauge_());
+          lines->emplace_back(series, buf);
+          break;
+        }
+        case Type::kHistogram: {
+          const Histogram *histogram = metric.histogram_.get();
+          uint64_t count = histogram->Count();
+          std::string text = "count=" + std::to_string(count);
+          if (count > 0) {
+            text += " mean=" + FormatDuration(static_cast<double>(histogram->Sum()) / count) +
+                    " p50=" + FormatDuration(histogram->Quantile(0.5)) +
+                    " p90=" + FormatDuration(histogram->Quantile(0.9)) +
+                    " p99=" + FormatDuration(histogram->Quantile(0.99)) + " max=" + FormatDuration(histogram->Max());
+          }
+          lines->emplace_back(series, text);
+          break;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,109 @@
+#include "common/rowid_bitmap.h"
+
+#include <algorithm>
+
+RowIdBitmap::RowIdBitmap(std::vector<RowId> &rids) {
+  std::sort(rids.begin(), rids.end());
+  for (const auto &rid : rids) {
+    if (pages_.empty() || pages_.back() != rid.GetPageId()) {
+      pages_.push_back(rid.GetPageId());
+      offsets_.push_back(words_.size());
+    }
+    size_t word = offsets_[offsets_.size() - 2] + rid.GetSlotNum() / WORD_BITS;
+    if (word >= words_.size()) {
+      words_.resize(word + 1, 0);
+      offsets_.back() = words_.size();
+    }
+    words_[word] |= uint64_t(1) << (rid.GetSlotNum() % WORD_BITS);
+  }
+}
+
+size_t RowIdBitmap::Cardinality() const {
+  size_t count = 0;
+  for (auto word : words_) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+void RowIdBitmap::AppendContainer(page_id_t page_id, const uint64_t *words, size_t count) {
+  // trailing empty words are dropped, a container always ends with a set bit
+  while (count > 0 && words[count - 1] == 0) {
+    count--;
+  }
+  if (count == 0) {
+    return;
+  }
+  pages_.push_back(page_id);
+  words_.insert(words_.end(), words, words + count);
+  offsets_.push_back(words_.size());
+}
+
+RowIdBitmap RowIdBitmap::And(const RowIdBitmap &other) const {
+  RowIdBitmap result;
+  std::vector<uint64_t> words;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < pages_.size() && j < other.pages_.size()) {
+    if (pages_[i] < other.pages_[j]) {
+      i++;
+    } else if (pages_[i] > other.pages_[j]) {
+      j++;
+    } else {
+      size_t count = std::min(offsets_[i + 1] - offsets_[i], other.offsets_[j + 1] - other.offsets_[j]);
+      words.resize(count);
+      for (size_t k = 0; k < count; k++) {
+        words[k] = words_[offsets_[i] + k] & other.words_[other.offsets_[j] + k];
+      }
+      result.AppendContainer(pages_[i], words.data(), count);
+      i++;
+      j++;
+    }
+  }
+  return result;
+}
+
+RowIdBitmap RowIdBitmap::Or(const RowIdBitmap &other) const {
+  RowIdBitmap result;
+  std::vector<uint64_t> words;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < pages_.size() || j < other.pages_.size()) {
+    if (j == other.pages_.size() || (i < pages_.size() && pages_[i] < other.pages_[j])) {
+      result.AppendContainer(pages_[i], &words_[offsets_[i]], offsets_[i + 1] - offsets_[i]);
+      i++;
+    } else if (i == pages_.size() || pages_[i] > other.pages_[j]) {
+      result.AppendContainer(other.pages_[j], &other.words_[other.offsets_[j]],
+                             other.offsets_[j + 1] - other.offsets_[j]);
+      j++;
+    } else {
+      size_t count = offsets_[i + 1] - offsets_[i];
+      size_t other_count = other.offsets_[j + 1] - other.offsets_[j];
+      words.assign(std::max(count, other_count), 0);
+      for (size_t k = 0; k < count; k++) {
+        words[k] = words_[offsets_[i] + k];
+      }
+      for (size_t k = 0; k < other_count; k++) {
+        words[k] |= other.words_[other.offsets_[j] + k];
+      }
+      result.AppendContainer(pages_[i], words.data(), words.size());
+      i++;
+      j++;
+    }
+  }
+  return result;
+}
+
+void RowIdBitmap::ToRowIds(std::vector<RowId> &result) const {
+  result.reserve(result.size() + Cardinality());
+  for (size_t i = 0; i < pages_.size(); i++) {
+    for (uint32_t k = offsets_[i]; k < offsets_[i + 1]; k++) {
+      uint64_t word = words_[k];
+      while (word != 0) {
+        uint32_t bit = __builtin_ctzll(word);
+        result.emplace_back(pages_[i], (k - offsets_[i]) * WORD_BITS + bit);
+        word &= word - 1;
+      }
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include "common/thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+/** pool and index of the worker running on this thread, nullptr outside any pool */
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_worker = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_count) {
+  ASSERT(thread_count > 0, "A thread pool needs a thread.");
+  for (size_t i = 0; i < thread_count; i++) {
+    queues_.emplace_back(new Queue());
+  }
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back(&ThreadPool::Run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool &ThreadPool::Instance() {
+  static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+  return pool;
+}
+
+void ThreadPool::Submit(Task task) {
+  size_t index = current_pool == this ? current_worker : next_queue_++ % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->latch_);
+    queues_[index]->tasks_.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    pending_++;
+  }
+  cv_.notify_one();
+}
+
+bool ThreadPool::TryPop(size_t self, Task *task) {
+  for (size_t i = 0; i < queues_.size(); i++) {
+    Queue &queue = *queues_[(self + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.latch_);
+    if (queue.tasks_.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      *task = std::move(queue.tasks_.front());
+      queue.tasks_.pop_front();
+    } else {
+      *task = std::move(queue.tasks_.back());
+      queue.tasks_.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::Run(size_t self) {
+  current_pool = this;
+  current_worker = self;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [&] { return stop_ || pending_ > 0; });
+      if (pending_ == 0) {
+        return;
+      }
+      // claim a task before looking for it, another worker may be taking the last one
+      pending_--;
+    }
+    Task task;
+    while (!TryPop(self, &task)) {
+      std::this_thread::yield();
+    }
+    task();
+  }
+}
@@ -0,0 +1,30 @@
+#include "executor/executors/analyze_executor.h"
+
+#include <chrono>
+
+AnalyzeExecutor::AnalyzeExecutor(ExecuteContext *exec_ctx, std::unique_ptr<AbstractExecutor> &&child_executor,
+                                 ExecutorStats *stats)
+    : AbstractExecutor(exec_ctx), child_executor_(std::move(child_executor)), stats_(stats) {}
+
+void AnalyzeExecutor::Init() {
+  QueryCounters before = LocalQueryCounters();
+  auto start = std::chrono::steady_clock::now();
+  child_executor_->Init();
+  stats_->time_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count();
+  stats_->counters_ += LocalQueryCounters() - before;
+  // parents such as the delete executor reach into the table of their child
+  table_info = child_executor_->table_info;
+}
+
+bool AnalyzeExecutor::Next(Row *row, RowId *rid) {
+  QueryCounters before = LocalQueryCounters();
+  auto start = std::chrono::steady_clock::now();
+  bool produced = child_executor_->Next(row, rid);
+  stats_->time_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count();
+  stats_->counters_ += LocalQueryCounters() - before;
+  stats_->next_calls_++;
+  stats_->rows_ += produced;
+  return produced;
+}
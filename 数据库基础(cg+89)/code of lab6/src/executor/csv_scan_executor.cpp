@@ -0,0 +1,139 @@
+#include "executor/executors/csv_scan_executor.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+CsvScanExecutor::CsvScanExecutor(ExecuteContext *exec_ctx, const CsvScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void CsvScanExecutor::Init() {
+  in_.open(plan_->GetFileName(), std::ios::in | std::ios::binary);
+  if (!in_.is_open()) {
+    throw std::logic_error("Failed to open file: " + plan_->GetFileName());
+  }
+  buffer_.resize(BUFFER_SIZE);
+  pos_ = len_ = 0;
+  line_no_ = 0;
+}
+
+bool CsvScanExecutor::FillBuffer() {
+  in_.read(buffer_.data(), buffer_.size());
+  len_ = in_.gcount();
+  pos_ = 0;
+  return len_ > 0;
+}
+
+int CsvScanExecutor::ReadField(bool *quoted) {
+  field_.clear();
+  *quoted = false;
+  int c = GetChar();
+  if (c == '"') {
+    *quoted = true;
+    while (true) {
+      c = GetChar();
+      if (c == EOF) {
+        Error("unterminated quoted field");
+      }
+      if (c == '"') {
+        c = GetChar();
+        if (c != '"') {
+          break;
+        }
+      }
+      if (c == '\n') {
+        line_no_++;
+      }
+      field_.push_back(static_cast<char>(c));
+    }
+    if (c == '\r') {
+      c = GetChar();
+    }
+    if (c != ',' && c != '\n' && c != EOF) {
+      Error("unexpected character after quoted field");
+    }
+    return c;
+  }
+  while (c != ',' && c != '\n' && c != EOF) {
+    field_.push_back(static_cast<char>(c));
+    c = GetChar();
+  }
+  if (!field_.empty() && field_.back() == '\r') {
+    field_.pop_back();
+  }
+  return c;
+}
+
+void CsvScanExecutor::AppendField(Row *row, uint32_t idx, bool quoted) {
+  const Column *column = plan_->OutputSchema()->GetColumn(idx);
+  TypeId type_id = column->GetType();
+  if (field_.empty() && !quoted) {
+    row->GetFields().push_back(row->NewField(type_id));
+    return;
+  }
+  const char *begin = field_.c_str();
+  char *end = nullptr;
+  errno = 0;
+  switch (type_id) {
+    case kTypeInt: {
+      long value = strtol(begin, &end, 10);
+      if (end == begin || *end != '\0' || errno != 0 || value < INT_MIN || value > INT_MAX) {
+        Error("invalid int value \"" + field_ + "\" for column " + column->GetName());
+      }
+      row->GetFields().push_back(row->NewField(kTypeInt, static_cast<int32_t>(value)));
+      break;
+    }
+    case kTypeFloat: {
+      float value = strtof(begin, &end);
+      if (end == begin || *end != '\0' || errno != 0) {
+        Error("invalid float value \"" + field_ + "\" for column " + column->GetName());
+      }
+      row->GetFields().push_back(row->NewField(kTypeFloat, value));
+      break;
+    }
+    case kTypeChar: {
+      if (field_.size() > column->GetLength()) {
+        Error("value too long for column " + column->GetName());
+      }
+      row->GetFields().push_back(row->NewCharField(field_.data(), field_.size()));
+      break;
+    }
+    default:
+      Error("unsupported column type");
+  }
+}
+
+bool CsvScanExecutor::Next(Row *row, RowId *rid) {
+  bool quoted;
+  int c;
+  // skip empty lines, stop at the end of the file
+  do {
+    line_no_++;
+    c = ReadField(&quoted);
+    if (c == EOF && field_.empty() && !quoted) {
+      return false;
+    }
+  } while (c == '\n' && field_.empty() && !quoted);
+  row->destroy();
+  row->SetRowId(INVALID_ROWID);
+  uint32_t column_count = plan_->OutputSchema()->GetColumnCount();
+  uint32_t idx = 0;
+  while (true) {
+    if (idx == column_count) {
+      Error("more than " + std::to_string(column_count) + " fields");
+    }
+    AppendField(row, idx++, quoted);
+    if (c != ',') {
+      break;
+    }
+    c = ReadField(&quoted);
+  }
+  if (idx != column_count) {
+    Error("expected " + std::to_string(column_count) + " fields, found " + std::to_string(idx));
+  }
+  return true;
+}
+
+void CsvScanExecutor::Error(const std::string &msg) const {
+  throw std::logic_error(plan_->GetFileName() + ", line " + std::to_string(line_no_) + ": " + msg);
+}
@@ -22,19 +22,22 @@ void DeleteExecutor::Init() {
 bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
 
  RowId delete_rid;
+ //子执行器读出的行和它的索引键放在row_heap_里，每删一行释放一次
+ Row child_row(&row_heap_);
  //child_executor_->table_iterator=child_executor_->table_info->GetTableHeap()->Begin(exec_ctx_->GetTransaction());
-  while(child_executor_->Next(row,&delete_rid)){
+  while(child_executor_->Next(&child_row,&delete_rid)){
     vector<IndexInfo*>index_infos;
-    exec_ctx_->GetCatalog()->GetIndexes(index_infos);
+    exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableName(),index_infos);
     for(auto it:index_infos){
-      Row key_row;
-      row->GetKeyFromRow(table_info->GetSchema(),it->GetIndex()->GetKeySchema(),key_row);
-      it->GetIndex()->RemoveEntry(key_row,row->GetRowId(),exec_ctx_->GetTransaction());
+      Row key_row(&row_heap_);
+      child_row.GetKeyFromRow(table_info->GetSchema(),it->GetIndex()->GetKeySchema(),key_row);
+      it->GetIndex()->RemoveEntry(key_row,child_row.GetRowId(),exec_ctx_->GetTransaction());
 
     }
     //row->GetRowId();
      child_executor_->table_info->GetTableHeap()->ApplyDelete(delete_rid,exec_ctx_->GetTransaction());
-
+    child_row.destroy();
+    row_heap_.Reset();
 
   }
   return false;
@@ -0,0 +1,68 @@
+#include "executor/exchange.h"
+
+Gather::Gather(ThreadPool *pool, size_t morsel_count, size_t dop, MorselFunc morsel_func)
+    : pool_(pool), morsel_count_(morsel_count), dop_(dop), morsel_func_(std::move(morsel_func)) {
+  ASSERT(dop_ > 0, "A parallel pipeline needs a worker.");
+  std::lock_guard<std::mutex> lock(latch_);
+  Schedule();
+}
+
+Gather::~Gather() {
+  std::unique_lock<std::mutex> lock(latch_);
+  cancelled_ = true;
+  cv_.wait(lock, [&] { return running_ == 0; });
+}
+
+void Gather::Schedule() {
+  while (!cancelled_ && started_ < morsel_count_ && running_ < dop_ && started_ < next_ + 2 * dop_) {
+    size_t morsel = started_++;
+    running_++;
+    pool_->Submit([this, morsel] { RunMorsel(morsel); });
+  }
+}
+
+void Gather::RunMorsel(size_t morsel) {
+  Batch batch;
+  std::exception_ptr error;
+  QueryCounters before = LocalQueryCounters();
+  try {
+    morsel_func_(morsel, &batch);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  QueryCounters used = LocalQueryCounters() - before;
+  std::lock_guard<std::mutex> lock(latch_);
+  running_--;
+  worker_counters_ += used;
+  if (error != nullptr && !cancelled_) {
+    cancelled_ = true;
+    error_ = error;
+  }
+  if (!cancelled_) {
+    ready_.emplace(morsel, std::move(batch));
+    Schedule();
+  }
+  // notify under the latch, the destructor may free this as soon as the latch is released
+  cv_.notify_all();
+}
+
+bool Gather::Next(Batch *batch) {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [&] { return cancelled_ || next_ == morsel_count_ || ready_.count(next_) != 0; });
+  LocalQueryCounters() += worker_counters_;
+  worker_counters_ = QueryCounters();
+  if (error_ != nullptr) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+  if (cancelled_ || next_ == morsel_count_) {
+    return false;
+  }
+  auto iter = ready_.find(next_);
+  *batch = std::move(iter->second);
+  ready_.erase(iter);
+  next_++;
+  Schedule();
+  return true;
+}
@@ -4,47 +4,78 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <thread>
 
+#include "common/metrics.h"
 #include "common/result_writer.h"
+#include "executor/executors/analyze_executor.h"
+#include "executor/executors/csv_scan_executor.h"
 #include "executor/executors/delete_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
+#include "executor/executors/parallel_seq_scan_executor.h"
 #include "executor/executors/seq_scan_executor.h"
 #include "executor/executors/update_executor.h"
 #include "executor/executors/values_executor.h"
 #include "glog/logging.h"
 #include "planner/planner.h"
+#include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
-ExecuteEngine::ExecuteEngine() {
-  char path[] = "./databases";
-  DIR *dir;
-  if((dir = opendir(path)) == nullptr) {
-    mkdir("./databases", 0777);
-    dir = opendir(path);
-  }
+/** one worker per core unless the session sets parallel_workers */
+static uint32_t DefaultParallelWorkers() {
+  return std::min<uint32_t>(std::max(std::thread::hardware_concurrency(), 1u), MAX_PARALLEL_WORKERS);
+}
 
-  struct dirent *stdir;
-  while((stdir = readdir(dir)) != nullptr) {
-    if( strcmp( stdir->d_name , "." ) == 0 ||
-        strcmp( stdir->d_name , "..") == 0 ||
-        stdir->d_name[0] == '.')
-      continue;
-    //cout<<stdir->d_name<<endl;
-    dbs_[stdir->d_name] = new DBStorageEngine(stdir->d_name, false);
-  }
+/** the file of a database, see DBStorageEngine */
+static std::string DatabaseFile(const std::string &db_name) {
+  return "./databases/" + db_name;
+}
 
-  closedir(dir);
+static bool DatabaseExists(const std::string &db_name) {
+  struct stat stat_buf;
+  return stat(DatabaseFile(db_name).c_str(), &stat_buf) == 0 && S_ISREG(stat_buf.st_mode);
+}
+
+ExecuteEngine::ExecuteEngine() : parallel_workers_(DefaultParallelWorkers()) {
+  // databases are opened by use, so startup does not depend on how many there are
+  mkdir("./databases", 0777);
+}
+
+std::unique_ptr<ExecuteContext> ExecuteEngine::MakeExecuteContext() {
+  auto context = dbs_[current_db_]->MakeExecuteContext(nullptr);
+  context->SetParallelWorkers(parallel_workers_);
+  return context;
 }
 
 std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *exec_ctx,
                                                                 const AbstractPlanNodeRef &plan) {
+  auto executor = CreatePlanExecutor(exec_ctx, plan);
+  // under explain analyze every executor is measured, its parent calls it through the wrapper
+  ExecutorStats *stats = exec_ctx->GetExecutorStats(plan.get());
+  if (stats != nullptr) {
+    return std::make_unique<AnalyzeExecutor>(exec_ctx, std::move(executor), stats);
+  }
+  return executor;
+}
+
+std::unique_ptr<AbstractExecutor> ExecuteEngine::CreatePlanExecutor(ExecuteContext *exec_ctx,
+                                                                    const AbstractPlanNodeRef &plan) {
   switch (plan->GetType()) {
     // Create a new sequential scan executor
     case PlanType::SeqScan: {
       return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()));
     }
+    case PlanType::ParallelSeqScan: {
+      return std::make_unique<ParallelSeqScanExecutor>(exec_ctx,
+                                                       dynamic_cast<const ParallelSeqScanPlanNode *>(plan.get()));
+    }
     // Create a new index scan executor
     case PlanType::IndexScan: {
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
@@ -69,6 +100,9 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     case PlanType::Values: {
       return std::make_unique<ValuesExecutor>(exec_ctx, dynamic_cast<const ValuesPlanNode *>(plan.get()));
     }
+    case PlanType::CsvScan: {
+      return std::make_unique<CsvScanExecutor>(exec_ctx, dynamic_cast<const CsvScanPlanNode *>(plan.get()));
+    }
     default:
       throw std::logic_error("Unsupported plan type.");
   }
@@ -84,12 +118,18 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
 
     executor->Init();
     RowId rid{};
-    Row row{};
+    // the row being produced lives in a scratch arena released after each row, only rows kept
+    // for the result set are copied into the arena of the query
+    ArenaMemHeap row_heap;
+    Row row(&row_heap);
     while (executor->Next(&row, &rid)) {
 
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        result_set->emplace_back(exec_ctx->GetHeap());
+        result_set->back() = row;
       }
+      row.destroy();
+      row_heap.Reset();
     }
   } catch (const exception &ex) {
     std::cout << "Error Encountered in Executor Execution: " << ex.what() << std::endl;
@@ -108,7 +148,20 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   auto start_time = std::chrono::system_clock::now();
   unique_ptr<ExecuteContext> context(nullptr);
   if(!current_db_.empty())
-    context = dbs_[current_db_]->MakeExecuteContext(nullptr);
+    context = MakeExecuteContext();
+  switch (ast->type_) {
+    case kNodeDropDB:
+    case kNodeUseDB:
+    case kNodeCreateTable:
+    case kNodeDropTable:
+    case kNodeCreateIndex:
+    case kNodeDropIndex:
+      // cached plans hold pointers to the catalog, tables and indexes
+      plan_cache_.Clear();
+      break;
+    default:
+      break;
+  }
   switch (ast->type_) {
     case kNodeCreateDB:
       return ExecuteCreateDatabase(ast, context.get());
@@ -145,11 +198,23 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   }
   // Plan the query.
   Planner planner(context.get());
-  std::vector<Row> result_set{};
   try {
     planner.PlanQuery(ast);
-    // Execute the query.
-    ExecutePlan(planner.plan_, &result_set, nullptr, context.get());
+  } catch (const exception &ex) {
+    std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
+    return DB_FAILED;
+  }
+  return ExecuteQuery(planner.plan_, context.get(), start_time);
+}
+
+dberr_t ExecuteEngine::ExecuteQuery(const AbstractPlanNodeRef &plan, ExecuteContext *context,
+                                    std::chrono::system_clock::time_point start_time) {
+  std::vector<Row> result_set{};
+  try {
+    // Execute the query, the executor has already reported why it failed.
+    if (ExecutePlan(plan, &result_set, nullptr, context) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
   } catch (const exception &ex) {
     std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
     return DB_FAILED;
@@ -161,8 +226,9 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   std::stringstream ss;
   ResultWriter writer(ss);
 
-  if (planner.plan_->GetType() == PlanType::SeqScan || planner.plan_->GetType() == PlanType::IndexScan) {
-    auto schema = planner.plan_->OutputSchema();
+  if (plan->GetType() == PlanType::SeqScan || plan->GetType() == PlanType::ParallelSeqScan ||
+      plan->GetType() == PlanType::IndexScan) {
+    auto schema = plan->OutputSchema();
     auto num_of_columns = schema->GetColumnCount();
     if (!result_set.empty()) {
       // find the max width for each column
@@ -205,6 +271,719 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   return DB_SUCCESS;
 }
 
+/** the first word of sql if it is a known statement, for the labels of the statement metrics */
+static std::string StatementKind(const std::string &sql) {
+  static const std::set<std::string> kinds = {"select", "insert", "update", "delete", "create", "drop", "use",
+                                              "show", "copy", "prepare", "execute", "deallocate", "explain", "set",
+                                              "vacuum", "begin", "commit", "rollback", "execfile"};
+  size_t begin = sql.find_first_not_of(" \t\v\n\f\r");
+  std::string word;
+  for (size_t i = begin; i != std::string::npos && i < sql.size() && isalpha(sql[i]); i++) {
+    word += static_cast<char>(tolower(sql[i]));
+  }
+  return kinds.count(word) > 0 ? word : "other";
+}
+
+dberr_t ExecuteEngine::ExecuteSql(const std::string &sql) {
+  // autovacuum only runs between statements
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  std::string labels = "statement=\"" + StatementKind(sql) + "\"";
+  MetricsRegistry *metrics = MetricsRegistry::Instance();
+  dberr_t result;
+  {
+    ScopedTimer timer(metrics->GetHistogram("minisql_statement_duration_seconds", "Time to run a statement", labels));
+    result = ExecuteStatement(sql);
+  }
+  if (result != DB_SUCCESS && result != DB_QUIT) {
+    metrics->GetCounter("minisql_statement_errors_total", "Statements that failed", labels)->Add();
+  }
+  return result;
+}
+
+dberr_t ExecuteEngine::ExecuteStatement(const std::string &sql) {
+  size_t begin = sql.find_first_not_of(" \t\v\n\f\r");
+  if (begin != std::string::npos && sql.compare(begin, 4, "copy") == 0 &&
+      (begin + 4 == sql.size() || !(isalnum(sql[begin + 4]) || sql[begin + 4] == '_'))) {
+    return ExecuteCopy(sql.substr(begin + 4));
+  }
+  std::vector<SqlToken> tokens;
+  if (!TokenizeSql(sql, &tokens) || tokens.empty() || tokens[0].type_ != SqlToken::kWord) {
+    // let the parser report the error
+    return ExecuteParsed(sql);
+  }
+  // the lexer only knows strings quoted with ", statements it parses from the text get single-quoted strings requoted
+  std::string parsed_sql;
+  if (sql.find('\'') == std::string::npos || !RenderSql(tokens, &parsed_sql)) {
+    parsed_sql = sql;
+  }
+  auto &command = tokens[0].val_;
+  if (command == "prepare") {
+    return ExecutePrepare(tokens);
+  }
+  if (command == "execute") {
+    return ExecuteExecute(tokens);
+  }
+  if (command == "deallocate") {
+    return ExecuteDeallocate(tokens);
+  }
+  if (command == "set") {
+    return ExecuteSet(tokens);
+  }
+  if (command == "vacuum") {
+    return ExecuteVacuum(tokens);
+  }
+  if (command == "explain") {
+    return ExecuteExplain(tokens);
+  }
+  if (command == "show" && tokens.size() > 1 && tokens[1].val_ == "stats") {
+    return ExecuteShowStats(tokens);
+  }
+  if (command == "create" && tokens.size() > 3 && tokens[1].val_ == "database" && tokens[3].val_ == "with") {
+    return ExecuteCreateDatabase(tokens);
+  }
+  if (current_db_.empty() ||
+      (command != "select" && command != "insert" && command != "update" && command != "delete")) {
+    return ExecuteParsed(parsed_sql);
+  }
+  SqlTemplate tmpl;
+  MakeSqlTemplate(tokens, 0, tokens.size(), &tmpl);
+  if (!tmpl.params_.empty()) {
+    cout << "Parameters can only be used in prepared statements." << endl;
+    return DB_FAILED;
+  }
+  if (tmpl.literals_.size() > PlanCache::MAX_CACHED_LITERALS) {
+    // large multi-row inserts are unlikely to repeat, do not let them flush the cache
+    return ExecuteParsed(parsed_sql);
+  }
+  return ExecuteTemplate(tmpl, tmpl.literals_, &parsed_sql);
+}
+
+dberr_t ExecuteEngine::ExecuteCopy(const std::string &args) {
+  // copy <table> from '<file>' | "<file>"
+  size_t i = 0, n = args.size();
+  auto skip_spaces = [&]() {
+    while (i < n && isspace(args[i])) {
+      i++;
+    }
+  };
+  auto read_word = [&]() {
+    skip_spaces();
+    size_t begin = i;
+    while (i < n && (isalnum(args[i]) || args[i] == '_')) {
+      i++;
+    }
+    return args.substr(begin, i - begin);
+  };
+  std::string table_name = read_word();
+  std::string from = read_word();
+  skip_spaces();
+  std::string file_name;
+  bool valid = !table_name.empty() && from == "from" && i < n && (args[i] == '\'' || args[i] == '"');
+  if (valid) {
+    size_t end = args.find(args[i], i + 1);
+    valid = end != std::string::npos && end > i + 1;
+    if (valid) {
+      file_name = args.substr(i + 1, end - i - 1);
+      i = end + 1;
+      skip_spaces();
+      if (i < n && args[i] == ';') {
+        i++;
+        skip_spaces();
+      }
+      valid = i == n;
+    }
+  }
+  if (!valid) {
+    cout << "Usage: copy <table> from '<file>';" << endl;
+    return DB_FAILED;
+  }
+  if (current_db_.empty()) {
+    cout << "You are not using any database,please choose one" << endl;
+    return DB_FAILED;
+  }
+  auto start_time = std::chrono::system_clock::now();
+  auto context = MakeExecuteContext();
+  TableInfo *table_info = nullptr;
+  if (context->GetCatalog()->GetTable(table_name, table_info) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  auto scan_plan = std::make_shared<CsvScanPlanNode>(table_info->GetSchema(), file_name);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, scan_plan, table_name);
+  return ExecuteQuery(insert_plan, context.get(), start_time);
+}
+
+dberr_t ExecuteEngine::ExecuteParsed(const std::string &sql) {
+  // create buffer for sql input
+  YY_BUFFER_STATE bp = yy_scan_string(sql.c_str());
+  if (bp == nullptr) {
+    LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+    exit(1);
+  }
+  yy_switch_to_buffer(bp);
+
+  // init parser module
+  MinisqlParserInit();
+
+  // parse
+  yyparse();
+
+  // parse result handle
+  if (MinisqlParserGetError()) {
+    // error
+    printf("%s\n", MinisqlParserGetErrorMessage());
+  } else {
+#ifdef ENABLE_PARSER_DEBUG
+    static TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
+    printf("[INFO] Sql syntax parse ok!\n");
+    SyntaxTreePrinter printer(MinisqlGetParserRootNode());
+    printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id_++]);
+#endif
+  }
+
+  auto result = Execute(MinisqlGetParserRootNode());
+
+  // clean memory after parse
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  return result;
+}
+
+PlanCache::Entry *ExecuteEngine::GetCachedPlan(const SqlTemplate &tmpl, ExecuteContext *context,
+                                               bool *parameterizable) {
+  auto entry = plan_cache_.Get(tmpl.key_);
+  if (entry != nullptr) {
+    return entry;
+  }
+  YY_BUFFER_STATE bp = yy_scan_string(tmpl.text_.c_str());
+  if (bp == nullptr) {
+    LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+    exit(1);
+  }
+  yy_switch_to_buffer(bp);
+  MinisqlParserInit();
+  yyparse();
+  PlanCache::Entry new_entry;
+  bool parsed = !MinisqlParserGetError() && MinisqlGetParserRootNode() != nullptr;
+  try {
+    if (parsed) {
+      Planner planner(context, &new_entry.params_);
+      planner.PlanQuery(MinisqlGetParserRootNode());
+      new_entry.plan_ = planner.plan_;
+    }
+  } catch (...) {
+    MinisqlParserFinish();
+    yy_delete_buffer(bp);
+    yylex_destroy();
+    throw;
+  }
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  if (!parsed) {
+    return nullptr;
+  }
+  // every literal must have become a parameter of the plan
+  if (new_entry.params_.size() != tmpl.literals_.size() ||
+      std::find(new_entry.params_.begin(), new_entry.params_.end(), nullptr) != new_entry.params_.end()) {
+    if (parameterizable != nullptr) {
+      *parameterizable = false;
+      return nullptr;
+    }
+    throw std::logic_error("the statement can not be parameterized");
+  }
+  return plan_cache_.Put(tmpl.key_, std::move(new_entry));
+}
+
+dberr_t ExecuteEngine::ExecuteTemplate(const SqlTemplate &tmpl, const std::vector<SqlLiteral> &literals,
+                                       const std::string *sql) {
+  if (current_db_.empty()) {
+    cout << "You are not using any database,please choose one" << endl;
+    return DB_FAILED;
+  }
+  auto start_time = std::chrono::system_clock::now();
+  auto context = MakeExecuteContext();
+  PlanCache::Entry *entry = nullptr;
+  bool parameterizable = true;
+  try {
+    entry = GetCachedPlan(tmpl, context.get(), sql != nullptr ? &parameterizable : nullptr);
+    if (entry != nullptr) {
+      entry->Bind(literals);
+    }
+  } catch (const exception &ex) {
+    std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
+    return DB_FAILED;
+  }
+  if (entry == nullptr) {
+    // the plan can not be shared between literals, plan the statement as typed
+    return parameterizable ? DB_FAILED : ExecuteParsed(*sql);
+  }
+  return ExecuteQuery(entry->plan_, context.get(), start_time);
+}
+
+dberr_t ExecuteEngine::ExecutePrepare(const std::vector<SqlToken> &tokens) {
+  // prepare <name> as <statement>
+  if (tokens.size() < 4 || tokens[1].type_ != SqlToken::kWord || tokens[2].val_ != "as" ||
+      tokens[2].type_ != SqlToken::kWord) {
+    cout << "Usage: prepare <name> as <statement>;" << endl;
+    return DB_FAILED;
+  }
+  auto &command = tokens[3].val_;
+  if (tokens[3].type_ != SqlToken::kWord ||
+      (command != "select" && command != "insert" && command != "update" && command != "delete")) {
+    cout << "Only select, insert, update and delete can be prepared." << endl;
+    return DB_FAILED;
+  }
+  if (current_db_.empty()) {
+    cout << "You are not using any database,please choose one" << endl;
+    return DB_FAILED;
+  }
+  SqlTemplate tmpl;
+  MakeSqlTemplate(tokens, 3, tokens.size(), &tmpl);
+  // plan it now, so that errors are reported by prepare and the first execute hits the cache
+  auto context = MakeExecuteContext();
+  try {
+    if (GetCachedPlan(tmpl, context.get()) == nullptr) {
+      return DB_FAILED;
+    }
+  } catch (const exception &ex) {
+    std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
+    return DB_FAILED;
+  }
+  prepared_[tokens[1].val_] = std::move(tmpl);
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteExecute(const std::vector<SqlToken> &tokens) {
+  // execute <name> [(<value>, ...)]
+  if (tokens.size() < 2 || tokens[1].type_ != SqlToken::kWord) {
+    cout << "Usage: execute <name> [(<value>, ...)];" << endl;
+    return DB_FAILED;
+  }
+  auto it = prepared_.find(tokens[1].val_);
+  if (it == prepared_.end()) {
+    cout << "Prepared statement " << tokens[1].val_ << " does not exist." << endl;
+    return DB_FAILED;
+  }
+  const SqlTemplate &tmpl = it->second;
+  std::vector<SqlLiteral> args;
+  size_t i = 2;
+  if (i < tokens.size() && tokens[i].val_ == "(") {
+    for (i++; i < tokens.size() && tokens[i].val_ != ")"; i++) {
+      auto &token = tokens[i];
+      if (token.type_ == SqlToken::kNumber) {
+        args.push_back({kNodeNumber, token.val_});
+      } else if (token.type_ == SqlToken::kString) {
+        args.push_back({kNodeString, token.val_});
+      } else if (token.type_ == SqlToken::kWord && token.val_ == "null") {
+        args.push_back({kNodeNull, ""});
+      } else {
+        cout << "Invalid parameter " << token.val_ << "." << endl;
+        return DB_FAILED;
+      }
+      if (i + 1 < tokens.size() && tokens[i + 1].val_ == ",") {
+        i++;
+      }
+    }
+    if (i == tokens.size()) {
+      cout << "Missing )." << endl;
+      return DB_FAILED;
+    }
+    i++;
+  }
+  if (i < tokens.size() && tokens[i].val_ == ";") {
+    i++;
+  }
+  if (i != tokens.size()) {
+    cout << "Usage: execute <name> [(<value>, ...)];" << endl;
+    return DB_FAILED;
+  }
+  if (args.size() != tmpl.params_.size()) {
+    cout << "Prepared statement " << tokens[1].val_ << " expects " << tmpl.params_.size() << " parameters, "
+         << args.size() << " given." << endl;
+    return DB_FAILED;
+  }
+  std::vector<SqlLiteral> literals = tmpl.literals_;
+  for (size_t k = 0; k < args.size(); k++) {
+    literals[tmpl.params_[k]] = std::move(args[k]);
+  }
+  return ExecuteTemplate(tmpl, literals);
+}
+
+dberr_t ExecuteEngine::ExecuteDeallocate(const std::vector<SqlToken> &tokens) {
+  // deallocate [prepare] <name>
+  size_t i = tokens.size() > 1 && tokens[1].val_ == "prepare" ? 2 : 1;
+  if (i >= tokens.size() || tokens[i].type_ != SqlToken::kWord || prepared_.erase(tokens[i].val_) == 0) {
+    cout << "Prepared statement does not exist." << endl;
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+/** write the metrics to file_name, through a temporary file so a reader never sees half of them */
+static bool WriteStatsFile(const std::string &file_name) {
+  std::string temp_name = file_name + ".tmp";
+  {
+    std::ofstream out(temp_name, std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    MetricsRegistry::Instance()->WriteText(out);
+    if (!out) {
+      return false;
+    }
+  }
+  return std::rename(temp_name.c_str(), file_name.c_str()) == 0;
+}
+
+dberr_t ExecuteEngine::ExecuteSet(const std::vector<SqlToken> &tokens) {
+  // set <name> [=|to] <value>
+  size_t i = tokens.size() > 2 && (tokens[2].val_ == "=" || tokens[2].val_ == "to") ? 3 : 2;
+  if (i >= tokens.size() ||
+      (tokens[1].val_ != "parallel_workers" && tokens[1].val_ != "autovacuum" && tokens[1].val_ != "stats_file")) {
+    cout << "Usage: set parallel_workers = <n> | default; or set autovacuum = on | off; "
+         << "or set stats_file = '<file>' | off;" << endl;
+    return DB_FAILED;
+  }
+  const SqlToken &value = tokens[i];
+  if (tokens[1].val_ == "stats_file") {
+    if (value.type_ != SqlToken::kString && !(value.type_ == SqlToken::kWord && value.val_ == "off")) {
+      cout << "stats_file must be a quoted file name or off." << endl;
+      return DB_FAILED;
+    }
+    StopStatsDump();
+    if (value.type_ == SqlToken::kString) {
+      // the first dump tells at once whether the file can be written
+      if (!WriteStatsFile(value.val_)) {
+        cout << "Can not write the stats file " << value.val_ << "." << endl;
+        return DB_FAILED;
+      }
+      stats_dump_ = true;
+      stats_thread_ = std::thread(&ExecuteEngine::DumpStats, this, value.val_);
+    }
+    return DB_SUCCESS;
+  }
+  if (tokens[1].val_ == "autovacuum") {
+    if (value.val_ != "on" && value.val_ != "off") {
+      cout << "autovacuum must be on or off." << endl;
+      return DB_FAILED;
+    }
+    StopAutoVacuum();
+    if (value.val_ == "on") {
+      autovacuum_ = true;
+      autovacuum_thread_ = std::thread(&ExecuteEngine::AutoVacuum, this);
+    }
+    return DB_SUCCESS;
+  }
+  uint32_t parallel_workers;
+  if (value.type_ == SqlToken::kWord && value.val_ == "default") {
+    parallel_workers = DefaultParallelWorkers();
+  } else if (value.type_ == SqlToken::kNumber && value.val_.find_first_not_of("0123456789") == string::npos &&
+             value.val_.size() <= 3 && stoi(value.val_) >= 1 && stoi(value.val_) <= MAX_PARALLEL_WORKERS) {
+    parallel_workers = stoi(value.val_);
+  } else {
+    cout << "parallel_workers must be between 1 and " << MAX_PARALLEL_WORKERS << "." << endl;
+    return DB_FAILED;
+  }
+  if (parallel_workers != parallel_workers_) {
+    // cached plans were made for the old degree of parallelism
+    plan_cache_.Clear();
+    parallel_workers_ = parallel_workers;
+  }
+  return DB_SUCCESS;
+}
+
+/** the schema of a table, to name the columns of an expression on it */
+static const Schema *SchemaOfTable(CatalogManager *catalog, const std::string &table_name) {
+  TableInfo *table_info = nullptr;
+  return catalog->GetTable(table_name, table_info) == DB_SUCCESS ? table_info->GetSchema() : nullptr;
+}
+
+/** the indexes an index scan looks into for the comparisons of expr */
+static void CollectScanIndexes(const IndexScanPlanNode *plan, const AbstractExpressionRef &expr,
+                               std::set<std::string> *index_names) {
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    CollectScanIndexes(plan, expr->GetChildAt(0), index_names);
+    CollectScanIndexes(plan, expr->GetChildAt(1), index_names);
+    return;
+  }
+  IndexInfo *index = plan->FindIndex(expr);
+  if (index != nullptr) {
+    index_names->insert(index->GetIndexName() + "(" + index->GetIndexType() + ")");
+  }
+}
+
+/** one line of explain for plan */
+static std::string DescribePlan(const AbstractPlanNode *plan, CatalogManager *catalog) {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+    case PlanType::ParallelSeqScan: {
+      auto scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      std::string text;
+      TableInfo *table_info = nullptr;
+      if (plan->GetType() == PlanType::ParallelSeqScan &&
+          catalog->GetTable(scan_plan->GetTableName(), table_info) == DB_SUCCESS &&
+          ParallelSeqScanExecutor::ScansInParallel(table_info->GetTableHeap())) {
+        auto parallel_plan = dynamic_cast<const ParallelSeqScanPlanNode *>(plan);
+        text = "ParallelSeqScan on " + scan_plan->GetTableName() + "  workers: " +
+               std::to_string(parallel_plan->GetWorkerCount());
+      } else {
+        text = "SeqScan on " + scan_plan->GetTableName();
+      }
+      if (scan_plan->GetPredicate() != nullptr) {
+        text += "  filter: " + scan_plan->GetPredicate()->ToString(SchemaOfTable(catalog, scan_plan->GetTableName()));
+      }
+      return text;
+    }
+    case PlanType::IndexScan: {
+      auto scan_plan = dynamic_cast<const IndexScanPlanNode *>(plan);
+      std::set<std::string> index_names;
+      CollectScanIndexes(scan_plan, scan_plan->GetPredicate(), &index_names);
+      std::string text = "IndexScan on " + scan_plan->GetTableName() + " using";
+      for (auto &index_name : index_names) {
+        text += (index_name == *index_names.begin() ? " " : ", ") + index_name;
+      }
+      const Schema *schema = SchemaOfTable(catalog, scan_plan->GetTableName());
+      return text + "  cond: " + scan_plan->GetPredicate()->ToString(schema);
+    }
+    case PlanType::Insert:
+      return "Insert on " + dynamic_cast<const InsertPlanNode *>(plan)->GetTableName();
+    case PlanType::Delete:
+      return "Delete on " + dynamic_cast<const DeletePlanNode *>(plan)->GetTableName();
+    case PlanType::Update: {
+      auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan);
+      const Schema *schema = SchemaOfTable(catalog, update_plan->GetTableName());
+      std::map<uint32_t, AbstractExpressionRef> update_attrs(update_plan->GetUpdateAttr().begin(),
+                                                             update_plan->GetUpdateAttr().end());
+      std::string text = "Update on " + update_plan->GetTableName() + "  set:";
+      for (auto &attr : update_attrs) {
+        text += (attr.first == update_attrs.begin()->first ? " " : ", ") +
+                ColumnValueExpression(0, attr.first, kTypeInt).ToString(schema) + " = " +
+                attr.second->ToString(schema);
+      }
+      return text;
+    }
+    case PlanType::Values:
+      return "Values  rows: " + std::to_string(dynamic_cast<const ValuesPlanNode *>(plan)->GetValues().size());
+    case PlanType::CsvScan:
+      return "CsvScan of '" + dynamic_cast<const CsvScanPlanNode *>(plan)->GetFileName() + "'";
+    default:
+      return "Unknown plan";
+  }
+}
+
+/** print the plan tree, with the figures of each executor if the query was analyzed in context */
+static void PrintPlan(const AbstractPlanNode *plan, CatalogManager *catalog, ExecuteContext *context, int depth) {
+  std::string indent(depth * 2, ' ');
+  std::string line = indent + (depth > 0 ? "-> " : "") + DescribePlan(plan, catalog);
+  ExecutorStats *stats = context != nullptr ? context->GetExecutorStats(plan) : nullptr;
+  if (stats == nullptr) {
+    cout << line << endl;
+  } else {
+    const QueryCounters &counters = stats->counters_;
+    printf("%s  (rows=%llu next=%llu time=%.3f ms)\n", line.c_str(), static_cast<unsigned long long>(stats->rows_),
+           static_cast<unsigned long long>(stats->next_calls_), stats->time_ns_ / 1e6);
+    printf("%s     buffer hits=%llu misses=%llu  pages read=%llu written=%llu  allocated=%llu bytes\n",
+           indent.c_str(), static_cast<unsigned long long>(counters.buffer_hits_),
+           static_cast<unsigned long long>(counters.buffer_misses_),
+           static_cast<unsigned long long>(counters.pages_read_),
+           static_cast<unsigned long long>(counters.pages_written_),
+           static_cast<unsigned long long>(counters.bytes_allocated_));
+  }
+  for (auto &child : plan->GetChildren()) {
+    PrintPlan(child.get(), catalog, context, depth + 1);
+  }
+}
+
+dberr_t ExecuteEngine::ExecuteExplain(const std::vector<SqlToken> &tokens) {
+  // explain [analyze] <select | insert | update | delete statement>
+  bool analyze = tokens.size() > 1 && tokens[1].type_ == SqlToken::kWord && tokens[1].val_ == "analyze";
+  size_t begin = analyze ? 2 : 1;
+  if (begin >= tokens.size() || tokens[begin].type_ != SqlToken::kWord ||
+      (tokens[begin].val_ != "select" && tokens[begin].val_ != "insert" && tokens[begin].val_ != "update" &&
+       tokens[begin].val_ != "delete")) {
+    cout << "Usage: explain [analyze] <select, insert, update or delete statement>;" << endl;
+    return DB_FAILED;
+  }
+  if (current_db_.empty()) {
+    cout << "You are not using any database,please choose one" << endl;
+    return DB_FAILED;
+  }
+  SqlTemplate tmpl;
+  MakeSqlTemplate(tokens, begin, tokens.size(), &tmpl);
+  if (!tmpl.params_.empty()) {
+    cout << "Parameters can only be used in prepared statements." << endl;
+    return DB_FAILED;
+  }
+  auto context = MakeExecuteContext();
+  PlanCache::Entry *entry = nullptr;
+  try {
+    entry = GetCachedPlan(tmpl, context.get());
+    if (entry == nullptr) {
+      return DB_FAILED;
+    }
+    entry->Bind(tmpl.literals_);
+  } catch (const exception &ex) {
+    std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
+    return DB_FAILED;
+  }
+  CatalogManager *catalog = context->GetCatalog();
+  if (!analyze) {
+    PrintPlan(entry->plan_.get(), catalog, nullptr, 0);
+    return DB_SUCCESS;
+  }
+  // run the statement for real, the rows of a select are counted but not printed
+  context->EnableAnalyze();
+  auto start_time = std::chrono::steady_clock::now();
+  dberr_t result = ExecutePlan(entry->plan_, nullptr, nullptr, context.get());
+  double duration_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+  PrintPlan(entry->plan_.get(), catalog, context.get(), 0);
+  printf("Execution time: %.3f ms\n", duration_ms);
+  return result;
+}
+
+dberr_t ExecuteEngine::ExecuteVacuum(const std::vector<SqlToken> &tokens) {
+  // vacuum [<table>]
+  if (current_db_.empty()) {
+    cout << "You are not using any database,please choose one" << endl;
+    return DB_FAILED;
+  }
+  CatalogManager *catalog = dbs_[current_db_]->catalog_mgr_;
+  std::vector<std::string> table_names;
+  if (tokens.size() > 1 && tokens[1].type_ == SqlToken::kWord) {
+    table_names.push_back(tokens[1].val_);
+  } else {
+    catalog->GetTableNames(table_names);
+  }
+  for (auto &table_name : table_names) {
+    uint32_t moved_rows, released_pages;
+    dberr_t result = catalog->VacuumTable(table_name, moved_rows, released_pages);
+    if (result != DB_SUCCESS) {
+      if (result != DB_TABLE_NOT_EXIST) {
+        cout << "Table " << table_name << ": vacuum stopped after " << moved_rows << " rows moved, "
+             << released_pages << " pages released, an index could not take a moved row." << endl;
+      }
+      return result;
+    }
+    cout << "Table " << table_name << ": " << moved_rows << " rows moved, " << released_pages << " pages released."
+         << endl;
+  }
+  return DB_SUCCESS;
+}
+
+void ExecuteEngine::AutoVacuum() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(autovacuum_latch_);
+      if (autovacuum_cv_.wait_for(lock, std::chrono::seconds(AUTOVACUUM_NAP_SECONDS), [&] { return !autovacuum_; })) {
+        return;
+      }
+    }
+    // a running statement may be waiting for this thread to stop, so never wait for it
+    std::unique_lock<std::recursive_mutex> guard(latch_, std::try_to_lock);
+    if (!guard.owns_lock()) {
+      continue;
+    }
+    for (auto &db : dbs_) {
+      if (db.second == nullptr) {
+        continue;
+      }
+      CatalogManager *catalog = db.second->catalog_mgr_;
+      std::vector<TableInfo *> tables;
+      catalog->GetTables(tables);
+      for (auto table_info : tables) {
+        if (table_info->GetTableHeap()->GetDeletedTuples() < AUTOVACUUM_MIN_DELETED_TUPLES) {
+          continue;
+        }
+        uint32_t moved_rows, released_pages;
+        if (catalog->VacuumTable(table_info->GetTableName(), moved_rows, released_pages) != DB_SUCCESS) {
+          LOG(WARNING) << "autovacuum " << db.first << "." << table_info->GetTableName() << " stopped after "
+                       << moved_rows << " rows moved, an index could not take a moved row";
+          continue;
+        }
+        LOG(INFO) << "autovacuum " << db.first << "." << table_info->GetTableName() << ": " << moved_rows
+                  << " rows moved, " << released_pages << " pages released";
+      }
+    }
+  }
+}
+
+void ExecuteEngine::StopAutoVacuum() {
+  {
+    std::lock_guard<std::mutex> lock(autovacuum_latch_);
+    autovacuum_ = false;
+  }
+  autovacuum_cv_.notify_all();
+  if (autovacuum_thread_.joinable()) {
+    autovacuum_thread_.join();
+  }
+}
+
+void ExecuteEngine::DumpStats(const std::string &file_name) {
+  while (true) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(stats_latch_);
+      stopping = stats_cv_.wait_for(lock, std::chrono::seconds(STATS_DUMP_INTERVAL_SECONDS),
+                                    [&] { return !stats_dump_; });
+    }
+    if (!WriteStatsFile(file_name)) {
+      LOG(WARNING) << "can not write the stats file " << file_name;
+    }
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+void ExecuteEngine::StopStatsDump() {
+  {
+    std::lock_guard<std::mutex> lock(stats_latch_);
+    stats_dump_ = false;
+  }
+  stats_cv_.notify_all();
+  if (stats_thread_.joinable()) {
+    stats_thread_.join();
+  }
+}
+
+dberr_t ExecuteEngine::ExecuteShowStats(const std::vector<SqlToken> &tokens) {
+  // show stats [<word>]
+  std::vector<std::pair<std::string, std::string>> lines;
+  MetricsRegistry::Instance()->Describe(&lines);
+  if (tokens.size() > 2 && tokens[2].type_ == SqlToken::kWord) {
+    const std::string &word = tokens[2].val_;
+    lines.erase(std::remove_if(lines.begin(), lines.end(),
+                               [&](const auto &line) { return line.first.find(word) == std::string::npos; }),
+                lines.end());
+  }
+  if (!lines.empty()) {
+    std::stringstream ss;
+    ResultWriter writer(ss);
+    vector<int> data_width = {static_cast<int>(strlen("metric")), static_cast<int>(strlen("value"))};
+    for (auto &line : lines) {
+      data_width[0] = max(data_width[0], static_cast<int>(line.first.size()));
+      data_width[1] = max(data_width[1], static_cast<int>(line.second.size()));
+    }
+    writer.Divider(data_width);
+    writer.BeginRow();
+    writer.WriteHeaderCell("metric", data_width[0]);
+    writer.WriteHeaderCell("value", data_width[1]);
+    writer.EndRow();
+    writer.Divider(data_width);
+    for (auto &line : lines) {
+      writer.BeginRow();
+      writer.WriteCell(line.first, data_width[0]);
+      writer.WriteCell(line.second, data_width[1]);
+      writer.EndRow();
+    }
+    writer.Divider(data_width);
+    std::cout << writer.stream_.rdbuf();
+  }
+  std::cout << lines.size() << " metrics." << std::endl;
+  return DB_SUCCESS;
+}
+
 void ExecuteEngine::ExecuteInformation(dberr_t result) {
   switch (result) {
     case DB_ALREADY_EXIST:
@@ -231,6 +1010,9 @@ void ExecuteEngine::ExecuteInformation(dberr_t result) {
     case DB_KEY_NOT_FOUND:
       cout << "Key not exists." << endl;
       break;
+    case DB_INDEX_FULL:
+      cout << "Index is full." << endl;
+      break;
     case DB_QUIT:
       cout << "Bye." << endl;
       break;
@@ -250,11 +1032,35 @@ dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *co
     return DB_FAILED;
   }
   std::string db_name = string(ast->child_->val_);
-  if (dbs_.count(db_name)) {
+  return CreateDatabase(db_name, DEFAULT_PAGE_SIZE);
+}
+
+dberr_t ExecuteEngine::ExecuteCreateDatabase(const std::vector<SqlToken> &tokens) {
+  // create database <name> with page_size [=] <n> [;]
+  size_t i = tokens.size() > 5 && tokens[5].val_ == "=" ? 6 : 5;
+  bool valid = tokens[2].type_ == SqlToken::kWord && tokens.size() > 4 && tokens[4].val_ == "page_size" &&
+               i < tokens.size() && tokens[i].type_ == SqlToken::kNumber &&
+               tokens[i].val_.find_first_not_of("0123456789") == string::npos && tokens[i].val_.size() <= 6 &&
+               (i + 1 == tokens.size() || (i + 2 == tokens.size() && tokens[i + 1].val_ == ";"));
+  if (!valid) {
+    cout << "Usage: create database <name> with page_size = <n>;" << endl;
+    return DB_FAILED;
+  }
+  uint32_t page_size = stoi(tokens[i].val_);
+  if (!DiskManager::IsValidPageSize(page_size)) {
+    cout << "page_size must be a power of two between " << MIN_PAGE_SIZE << " and " << MAX_PAGE_SIZE << "." << endl;
+    return DB_FAILED;
+  }
+  return CreateDatabase(tokens[2].val_, page_size);
+}
+
+dberr_t ExecuteEngine::CreateDatabase(const std::string &db_name, uint32_t page_size) {
+  if (DatabaseExists(db_name)) {
     return DB_ALREADY_EXIST;
   }
 
-  DBStorageEngine* db = new DBStorageEngine(db_name,true);
+  //页大小写在库文件的元数据页里，之后打开时按它选缓冲池
+  DBStorageEngine* db = new DBStorageEngine(db_name, true, page_size);
   dbs_[db_name] = db;
   cout<<"Create database successfully"<<endl;
   return DB_SUCCESS;
@@ -273,13 +1079,20 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *cont
   }
 
   std::string db_name = string(ast->child_->val_);
-  if (!dbs_.count(db_name)) {
+  if (!DatabaseExists(db_name)) {
 
     return DB_NOT_EXIST;
   }
 
-  delete dbs_[db_name];
-  dbs_.erase(db_name);
+  //库可能从未被打开过，打开过的先关闭再删除文件
+  if (dbs_.count(db_name)) {
+    delete dbs_[db_name];
+    dbs_.erase(db_name);
+  }
+  if (current_db_ == db_name) {
+    current_db_.clear();
+  }
+  remove(DatabaseFile(db_name).c_str());
   cout<<"Drop database successfully "<<endl;
   return DB_SUCCESS;
 
@@ -293,10 +1106,20 @@ dberr_t ExecuteEngine::ExecuteShowDatabases(pSyntaxNode ast, ExecuteContext *con
   LOG(INFO) << "ExecuteShowDatabases" << std::endl;
 #endif
   printf("DATABASES:\n");
-  for (auto it : dbs_) {
-    cout<<it.first<<endl;
-
+  //未打开的库也要列出，直接读数据库目录
+  DIR *dir = opendir("./databases");
+  if (dir == nullptr) {
+    return DB_SUCCESS;
   }
+  struct dirent *stdir;
+  while((stdir = readdir(dir)) != nullptr) {
+    if( strcmp( stdir->d_name , "." ) == 0 ||
+        strcmp( stdir->d_name , "..") == 0 ||
+        stdir->d_name[0] == '.')
+      continue;
+    cout<<stdir->d_name<<endl;
+  }
+  closedir(dir);
 
   return DB_SUCCESS;
 
@@ -315,8 +1138,17 @@ dberr_t ExecuteEngine::ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *conte
   }
   std::string db_name =ast->child_->val_;//获取nameif(!this->dbs_.count(name)) return DB NOT_EXIST;
   if(!this->dbs_.count(db_name)) {
-    cout << "Database do not exist" << endl;
-    return DB_NOT_EXIST;
+    if (!DatabaseExists(db_name)) {
+      cout << "Database do not exist" << endl;
+      return DB_NOT_EXIST;
+    }
+    //第一次使用时才打开，旧版本写的库文件在打开时升级，新版本写的或损坏的文件打不开
+    try {
+      dbs_[db_name] = new DBStorageEngine(db_name, false);
+    } catch (const exception &ex) {
+      cout << "Failed to open database " << db_name << ": " << ex.what() << endl;
+      return DB_FAILED;
+    }
   }
   current_db_ = db_name;
   cout<<"Use database successfully"<<endl;
@@ -536,10 +1368,45 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
   string index_name=val_vector[0];
   string table_name=val_vector[1];
   vector<string> index_keys;
+  string index_type = "bptree";
   //cout<<index_name<<endl;
   //cout<<table_name<<endl;
-  for (int i = 3; i < val_vector.size() ; i++){
-    index_keys.push_back(val_vector[i]);
+  for (pSyntaxNode node = ast->child_; node != nullptr; node = node->next_) {
+    if (node->type_ == kNodeColumnList) {
+      for (pSyntaxNode key = node->child_; key != nullptr; key = key->next_) {
+        index_keys.push_back(key->val_);
+      }
+    } else if (node->type_ == kNodeIndexType) {
+      index_type = node->child_->val_;
+    }
+  }
+  if (index_type != "bptree" && index_type != "betree" && index_type != "hash" && index_type != "art") {
+    cout << "Unsupported index type " << index_type << ", use bptree, betree, hash or art." << endl;
+    return DB_FAILED;
+  }
+  // the key is unique if it covers the columns of a primary key or unique index of the table
+  bool unique = false;
+  vector<IndexInfo *> table_indexes;
+  context->GetCatalog()->GetTableIndexes(table_name, table_indexes);
+  for (auto table_index : table_indexes) {
+    if (!table_index->IsUnique()) {
+      continue;
+    }
+    bool covered = true;
+    for (auto column : table_index->GetIndexKeySchema()->GetColumns()) {
+      if (std::find(index_keys.begin(), index_keys.end(), column->GetName()) == index_keys.end()) {
+        covered = false;
+        break;
+      }
+    }
+    if (covered) {
+      unique = true;
+      break;
+    }
+  }
+  if (index_type == "hash" && !unique) {
+    cout << "Hash index needs a unique key, the columns of " << index_name << " do not cover a primary key or unique column." << endl;
+    return DB_FAILED;
   }
  /* for(auto it:index_keys){
     cout<<it<<endl;
@@ -549,18 +1416,27 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
  // IndexInfo *index_info2 = nullptr;
  // std::vector<std::string> index_keys2{"a", "b"};
 
- auto result=context->GetCatalog()->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,"bptree");
+ auto result=context->GetCatalog()->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,index_type,unique);
  if(result==DB_SUCCESS){
    TableInfo* table_info= nullptr;
    context->GetCatalog()->GetTable(table_name,table_info);
    TableHeap* table_heap=table_info->GetTableHeap();
    TableIterator table_iterator=table_heap->Begin(context->GetTransaction());
+   dberr_t insert_result = DB_SUCCESS;
    while(!(table_iterator==(table_info->GetTableHeap()->End()))){
-      Row row=*table_iterator;
       Row new_row;
-      row.GetKeyFromRow(table_info->GetSchema(), index_info->GetIndex()->GetKeySchema(), new_row);
-      index_info->GetIndex()->InsertEntry(new_row, row.GetRowId(), context->GetTransaction());
-      table_iterator ++;
+      table_iterator.GetView().Project(index_info->GetIndex()->GetKeySchema(), &new_row);
+      insert_result = index_info->GetIndex()->InsertEntry(new_row, table_iterator.GetRowId(), context->GetTransaction());
+      if (insert_result != DB_SUCCESS) {
+        break;
+      }
+      ++table_iterator;
+   }
+   //索引装不下表中已有的行时，删掉只建了一半的索引
+   if (insert_result != DB_SUCCESS) {
+     context->GetCatalog()->DropIndex(table_name, index_name);
+     cout << "Failed to add the rows of " << table_name << " to index " << index_name << "." << endl;
+     return insert_result;
    }
     cout<<"Creates index successfully."<<endl;}
   return result;
@@ -632,27 +1508,7 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
   // read file line by line
   std::string line;
   while (std::getline(infile, line)) {
-    // create buffer for sql input
-    const int buf_size = line.size() + 1;
-    char cmd[buf_size];
-    strncpy(cmd, line.c_str(), buf_size);
-
-    // parse SQL statement
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
-    }
-    yy_switch_to_buffer(bp);
-    MinisqlParserInit();
-    yyparse();
-
-    // execute parsed SQL statement
-    auto result = Execute(MinisqlGetParserRootNode());
-    // clean up memory after parsing
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
+    auto result = ExecuteSql(line);
     ExecuteInformation(result);
     if (result == DB_QUIT) {
       break;
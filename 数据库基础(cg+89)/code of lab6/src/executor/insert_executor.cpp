@@ -11,42 +11,102 @@ InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *p
 void InsertExecutor::Init() {
   child_executor_->Init();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(),table_info);
-
-  //TableHeap* table_heap=table_info->GetTableHeap();
+  indexes_.clear();
+  exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableName(), indexes_);
+  batch_heap_.Reset();
+  batch_.clear();
+  batch_.reserve(BATCH_SIZE);
+  for (size_t i = 0; i < BATCH_SIZE; i++) {
+    batch_.emplace_back(&batch_heap_);
+  }
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  while(child_executor_->Next(row,rid)){
-    TableHeap* table_heap=table_info->GetTableHeap();
-    //table_heap->InsertTuple(*row,exec_ctx_->GetTransaction());
-    vector<IndexInfo*>index_infos;
-    exec_ctx_->GetCatalog()->GetIndexes(index_infos);
-    int is_conflict=0;
-    for(auto it:index_infos) {
-      Row key_row;
-      row->GetKeyFromRow(table_info->GetSchema(), it->GetIndex()->GetKeySchema(), key_row);
-      vector<RowId> result;
-      it->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction());
+  size_t count = 0;
+  RowId child_rid;
+  while (child_executor_->Next(&batch_[count], &child_rid)) {
+    if (++count == BATCH_SIZE) {
+      Flush(count);
+      count = 0;
+    }
+  }
+  if (count > 0) {
+    Flush(count);
+  }
+  return false;
+}
 
-      if (result.size() > 0) {
-        is_conflict++;
-        cout << "Conflict on " + it->GetIndexName() << endl;
-        break;
+void InsertExecutor::Flush(size_t count) {
+  TableHeap *table_heap = table_info->GetTableHeap();
+  Transaction *txn = exec_ctx_->GetTransaction();
+  std::vector<Row *> rows(count);
+  for (size_t i = 0; i < count; i++) {
+    rows[i] = &batch_[i];
+  }
+  table_heap->InsertTuples(rows.data(), count, txn);
+  // rows too large for a page are left out of the indexes
+  std::vector<Row *> inserted;
+  std::vector<RowId> row_ids;
+  for (auto r : rows) {
+    if (r->GetRowId().GetPageId() != INVALID_PAGE_ID) {
+      inserted.push_back(r);
+      row_ids.push_back(r->GetRowId());
+    }
+  }
+  std::vector<std::vector<Row>> keys(indexes_.size());
+  std::vector<std::vector<dberr_t>> results(indexes_.size());
+  for (size_t k = 0; k < indexes_.size(); k++) {
+    keys[k].reserve(inserted.size());
+    for (auto r : inserted) {
+      keys[k].emplace_back(&batch_heap_);
+      r->GetKeyFromRow(table_info->GetSchema(), indexes_[k]->GetIndex()->GetKeySchema(), keys[k].back());
+    }
+    indexes_[k]->GetIndex()->InsertEntries(keys[k], row_ids, results[k], txn);
+  }
+  // take rows that hit a unique index out again, then retry them one at a time in their original
+  // order: a row may only have conflicted with another row of the batch that is now gone
+  std::vector<size_t> failed;
+  for (size_t i = 0; i < inserted.size(); i++) {
+    bool conflict = false;
+    for (size_t k = 0; k < indexes_.size() && !conflict; k++) {
+      conflict = results[k][i] != DB_SUCCESS;
+    }
+    if (!conflict) {
+      continue;
+    }
+    for (size_t k = 0; k < indexes_.size(); k++) {
+      if (results[k][i] == DB_SUCCESS) {
+        indexes_[k]->GetIndex()->RemoveEntry(keys[k][i], row_ids[i], txn);
       }
     }
-    if(is_conflict==0){
-      table_heap->InsertTuple(*row,exec_ctx_->GetTransaction());
-
-      for(auto it:index_infos) {
-        Row key_row;
-        row->GetKeyFromRow(table_info->GetSchema(), it->GetIndex()->GetKeySchema(), key_row);
-        it->GetIndex()->InsertEntry(key_row, row->GetRowId(), exec_ctx_->GetTransaction());
+    table_heap->ApplyDelete(row_ids[i], txn);
+    failed.push_back(i);
+  }
+  for (auto i : failed) {
+    Row *r = inserted[i];
+    if (!table_heap->InsertTuple(*r, txn)) {
+      continue;
+    }
+    for (size_t k = 0; k < indexes_.size(); k++) {
+      dberr_t result = indexes_[k]->GetIndex()->InsertEntry(keys[k][i], r->GetRowId(), txn);
+      if (result == DB_SUCCESS) {
+        continue;
       }
-
+      if (result == DB_INDEX_FULL) {
+        cout << "Index " + indexes_[k]->GetIndexName() + " is full" << endl;
+      } else {
+        cout << "Conflict on " + indexes_[k]->GetIndexName() << endl;
+      }
+      for (size_t j = 0; j < k; j++) {
+        indexes_[j]->GetIndex()->RemoveEntry(keys[j][i], r->GetRowId(), txn);
+      }
+      table_heap->ApplyDelete(r->GetRowId(), txn);
+      break;
     }
-
   }
-
-
-  return false;
-}
\ No newline at end of file
+  keys.clear();
+  for (size_t i = 0; i < count; i++) {
+    batch_[i].destroy();
+  }
+  batch_heap_.Reset();
+}
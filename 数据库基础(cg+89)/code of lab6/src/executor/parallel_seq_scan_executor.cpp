@@ -0,0 +1,67 @@
+#include "executor/executors/parallel_seq_scan_executor.h"
+
+#include <algorithm>
+
+#include "executor/executors/seq_scan_executor.h"
+
+ParallelSeqScanExecutor::ParallelSeqScanExecutor(ExecuteContext *exec_ctx, const ParallelSeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+bool ParallelSeqScanExecutor::ScansInParallel(const TableHeap *table_heap) {
+  return table_heap->GetPageIds().size() >= PARALLEL_SCAN_MIN_PAGES;
+}
+
+void ParallelSeqScanExecutor::Init() {
+  gather_.reset();
+  serial_.reset();
+  exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info);
+  TableHeap *table_heap = table_info->GetTableHeap();
+  // small tables are not worth the threads
+  if (!ScansInParallel(table_heap)) {
+    serial_ = std::make_unique<SeqScanExecutor>(exec_ctx_, plan_);
+    serial_->Init();
+    return;
+  }
+  page_ids_ = table_heap->GetPageIds();
+  page_filter_ = SeqScanExecutor::MakePageFilter(plan_->GetPredicate().get(), table_heap->GetZoneMap());
+  batch_.clear();
+  cursor_ = 0;
+  size_t morsel_count = (page_ids_.size() + PARALLEL_SCAN_MORSEL_PAGES - 1) / PARALLEL_SCAN_MORSEL_PAGES;
+  size_t dop = std::max<size_t>(plan_->GetWorkerCount(), 1);
+  gather_ = std::make_unique<Gather>(&ThreadPool::Instance(), morsel_count, dop,
+                                     [this](size_t morsel, Gather::Batch *batch) { ScanMorsel(morsel, batch); });
+}
+
+void ParallelSeqScanExecutor::ScanMorsel(size_t morsel, Gather::Batch *batch) {
+  TableHeap *table_heap = table_info->GetTableHeap();
+  const AbstractExpression *predicate = plan_->GetPredicate().get();
+  const Schema *output_schema = plan_->OutputSchema();
+  size_t begin = morsel * PARALLEL_SCAN_MORSEL_PAGES;
+  size_t end = std::min<size_t>(begin + PARALLEL_SCAN_MORSEL_PAGES, page_ids_.size());
+  // rows of the batch own their fields, the arena of the query is not shared between threads
+  for (size_t i = begin; i < end; i++) {
+    table_heap->ScanPage(page_ids_[i], page_filter_, [&](const RowView &view) {
+      if (predicate == nullptr || predicate->Evaluate(&view).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+        batch->emplace_back();
+        view.Project(output_schema, &batch->back());
+      }
+    }, exec_ctx_->GetTransaction());
+  }
+}
+
+bool ParallelSeqScanExecutor::Next(Row *row, RowId *rid) {
+  if (serial_ != nullptr) {
+    return serial_->Next(row, rid);
+  }
+  while (cursor_ == batch_.size()) {
+    batch_.clear();
+    cursor_ = 0;
+    if (gather_ == nullptr || !gather_->Next(&batch_)) {
+      return false;
+    }
+  }
+  *row = batch_[cursor_];
+  *rid = batch_[cursor_].GetRowId();
+  cursor_++;
+  return true;
+}
@@ -3,6 +3,70 @@
 //
 #include "executor/executors/seq_scan_executor.h"
 
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+//谓词中是否有与zone map记录的列的比较
+static bool UsesZones(const AbstractExpression *expr, const ZoneMap &zone_map) {
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    return UsesZones(expr->GetChildAt(0).get(), zone_map) || UsesZones(expr->GetChildAt(1).get(), zone_map);
+  }
+  return expr->GetType() == ExpressionType::ComparisonExpression &&
+         expr->GetChildAt(0)->GetType() == ExpressionType::ColumnExpression &&
+         zone_map.IsTracked(dynamic_cast<const ColumnValueExpression *>(expr->GetChildAt(0).get())->GetColIdx());
+}
+
+//zone内的值是否可能满足谓词，无法判断时返回true
+static bool ZoneMayMatch(const AbstractExpression *expr, const ZoneMap &zone_map, const ZoneMap::Zone &zone) {
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    bool left = ZoneMayMatch(expr->GetChildAt(0).get(), zone_map, zone);
+    if (dynamic_cast<const LogicExpression *>(expr)->logic_type_ == LogicType::Or) {
+      return left || ZoneMayMatch(expr->GetChildAt(1).get(), zone_map, zone);
+    }
+    return left && ZoneMayMatch(expr->GetChildAt(1).get(), zone_map, zone);
+  }
+  if (expr->GetType() != ExpressionType::ComparisonExpression ||
+      expr->GetChildAt(0)->GetType() != ExpressionType::ColumnExpression ||
+      expr->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression) {
+    return true;
+  }
+  uint32_t col_id = dynamic_cast<const ColumnValueExpression *>(expr->GetChildAt(0).get())->GetColIdx();
+  const Field &constant = dynamic_cast<const ConstantValueExpression *>(expr->GetChildAt(1).get())->val_;
+  std::string op = dynamic_cast<const ComparisonExpression *>(expr)->GetComparisonType();
+  if (!zone_map.IsTracked(col_id) || constant.IsNull() || op == "is" || op == "not") {
+    return true;
+  }
+  //比较运算对null值不成立，没有非null值的页可整页跳过
+  double low = zone.min[col_id];
+  double high = zone.max[col_id];
+  double value = ZoneMap::ValueOf(constant);
+  if (op == "=") {
+    return low <= value && value <= high;
+  } else if (op == "<>") {
+    return low < value || value < high;
+  } else if (op == "<") {
+    return low < value;
+  } else if (op == "<=") {
+    return low <= value;
+  } else if (op == ">") {
+    return high > value;
+  } else if (op == ">=") {
+    return high >= value;
+  }
+  return true;
+}
+
+ZoneMap::PageFilter SeqScanExecutor::MakePageFilter(const AbstractExpression *predicate, const ZoneMap &zone_map) {
+  //谓词涉及数值列时，按zone map跳过不可能满足谓词的整页
+  if (predicate == nullptr || !UsesZones(predicate, zone_map)) {
+    return nullptr;
+  }
+  const ZoneMap *zones = &zone_map;
+  return [predicate, zones](const ZoneMap::Zone &zone) { return ZoneMayMatch(predicate, *zones, zone); };
+}
+
 /**
 * TODO: Student Implement
 */
@@ -19,7 +83,8 @@ void SeqScanExecutor::Init() {
  //cout<<"2"<<endl;
   TableHeap* table_heap=table_info->GetTableHeap();
   //cout<<"4"<<endl;
-  table_iterator=table_heap->Begin(exec_ctx_->GetTransaction());
+  table_iterator=table_heap->Begin(exec_ctx_->GetTransaction(),
+                                   MakePageFilter(plan_->GetPredicate().get(), table_heap->GetZoneMap()));
   //cout<<"3"<<endl;
   // cout <<table_iterator->GetRowId().GetSlotNum()<<endl;
   is_Init=true;
@@ -27,42 +92,23 @@ void SeqScanExecutor::Init() {
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
-  //cout<<"here3"<<endl;
-if (table_iterator == table_info->GetTableHeap()->End()) {
- // cout<<"here"<<endl;
-  is_Init = false;
-  return false;
-}
-  while(!(table_iterator==(table_info->GetTableHeap()->End()))){
-//cout<<"here2"<<endl;
-    *row=*table_iterator;
-  if (plan_ ->GetPredicate() == nullptr){
-    Row new_row;
-
-  row->GetKeyFromRow(table_info ->GetSchema(),plan_ ->OutputSchema(), new_row);
-  new_row.SetRowId(row->GetRowId());
-  *row = new_row;
-  *rid = row->GetRowId();
-  table_iterator ++;
-  return true;
-  }
-  auto eva_res = plan_->GetPredicate()->Evaluate(row);
-  if (eva_res.CompareEquals(Field(kTypeInt,1)) == CmpBool::kTrue){
-
-    Row new_row;
-  row->GetKeyFromRow(table_info ->GetSchema(),plan_->OutputSchema(), new_row);
-  new_row.SetRowId(row->GetRowId());
-  *row = new_row;
-  //row->GetRowId();
-  *rid = row->GetRowId();
-  RowId a=row->GetRowId();
-  table_iterator++;
-  return true;
-  }
-  else{
-      table_iterator ++;
-
+  TableIterator end = table_info->GetTableHeap()->End();
+  if (table_iterator == end) {
+    is_Init = false;
+    return false;
   }
+  //谓词直接在页内元组上求值，只有满足条件的行才会被复制出来
+  while (table_iterator != end) {
+    const RowView &view = table_iterator.GetView();
+    if (plan_->GetPredicate() == nullptr ||
+        plan_->GetPredicate()->Evaluate(&view).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+      view.Project(plan_->OutputSchema(), row);
+      *rid = view.GetRowId();
+      ++table_iterator;
+      return true;
+    }
+    ++table_iterator;
   }
+  is_Init = false;
   return false;
 }
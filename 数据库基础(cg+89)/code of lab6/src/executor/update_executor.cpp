@@ -4,6 +4,16 @@
 
 #include "executor/executors/update_executor.h"
 
+#include <stdexcept>
+
+//新键插不进索引时报给用户的错误
+static std::string IndexError(IndexInfo *index, dberr_t result) {
+  if (result == DB_INDEX_FULL) {
+    return "Index " + index->GetIndexName() + " is full";
+  }
+  return "Conflict on " + index->GetIndexName();
+}
+
 UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -14,37 +24,118 @@ UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *p
 void UpdateExecutor::Init() {
   child_executor_->Init();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(),table_info);
+  //只有键列被SET修改的索引才需要随行更新，其余索引在行原地更新时保持不变
+  index_info_.clear();
+  key_changed_.clear();
+  exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableName(),index_info_);
+  for(auto it:index_info_){
+    bool changed=false;
+    for(uint32_t col:it->GetMetadata()->GetKeyMapping()){
+      changed=changed||plan_->GetUpdateAttr().count(col)>0;
+    }
+    key_changed_.push_back(changed);
+  }
 }
 
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  RowId delete_rid;
-  //child_executor_->table_iterator=child_executor_->table_info->GetTableHeap()->Begin(exec_ctx_->GetTransaction());
-  while(child_executor_->Next(row,rid)){
-    Row new_row=GenerateUpdatedTuple(*row);
-    //new_row.GetFieldCount();
-    //row->GetRowId();
-   // new_row.GetRowId()
-   //row->GetFieldCount();
-    vector<IndexInfo*>index_infos;
-    exec_ctx_->GetCatalog()->GetIndexes(index_infos);
-    for(auto it:index_infos){
-      Row key_row;
-      row->GetKeyFromRow(table_info->GetSchema(),it->GetIndex()->GetKeySchema(),key_row);
-      it->GetIndex()->RemoveEntry(key_row,row->GetRowId(),exec_ctx_->GetTransaction());
-
+  RowId old_rid;
+  TableHeap *table_heap=table_info->GetTableHeap();
+  Transaction *txn=exec_ctx_->GetTransaction();
+  //原位放不下的行先标记删除，扫描结束后再插入到表尾，免得同一次扫描又读到挪走的行
+  std::vector<std::pair<Row,Row>> relocated;
+  //子执行器读出的行、新旧行和索引键放在row_heap_里，每处理完一行释放一次
+  Row child_row(&row_heap_);
+  while(child_executor_->Next(&child_row,&old_rid)){
+    Row old_row(child_row);
+    old_row.SetRowId(old_rid);
+    Row new_row=GenerateUpdatedTuple(old_row);
+    new_row.SetRowId(old_rid);
+    //新行放得下时原地更新，rowid不变，只改键列被SET修改的索引
+    if(table_heap->UpdateTuple(new_row,old_rid,txn)){
+      dberr_t result;
+      IndexInfo *conflict=UpdateIndexes(old_row,new_row,true,&result);
+      if(conflict!=nullptr){
+        table_heap->UpdateTuple(old_row,old_rid,txn);
+        RollbackRelocations(relocated,0);
+        throw std::logic_error(IndexError(conflict,result));
+      }
+    }else{
+      if(!table_heap->MarkDelete(old_rid,txn)){
+        RollbackRelocations(relocated,0);
+        throw std::logic_error("Failed to update a row of table "+plan_->GetTableName());
+      }
+      //要搬的行留到扫描结束，复制到查询的arena里
+      relocated.emplace_back(Row(exec_ctx_->GetHeap()),Row(exec_ctx_->GetHeap()));
+      relocated.back().first=old_row;
+      relocated.back().second=new_row;
     }
-    child_executor_->table_info->GetTableHeap()->ApplyDelete(row->GetRowId(),exec_ctx_->GetTransaction());
-    for(auto itr:index_infos){
-      Row key_row2;
-      new_row.GetKeyFromRow(table_info->GetSchema(),itr->GetIndex()->GetKeySchema(),key_row2);
-      itr->GetIndex()->InsertEntry(key_row2,row->GetRowId(),exec_ctx_->GetTransaction());
-
+    old_row.destroy();
+    new_row.destroy();
+    child_row.destroy();
+    row_heap_.Reset();
+  }
+  //插入成功后才真正删除旧行，失败时旧行和它的索引项都还在
+  for(size_t i=0;i<relocated.size();i++){
+    Row &old_row=relocated[i].first;
+    Row &new_row=relocated[i].second;
+    if(!table_heap->InsertTuple(new_row,txn)){
+      RollbackRelocations(relocated,i);
+      throw std::logic_error("Failed to relocate an updated row of table "+plan_->GetTableName());
+    }
+    dberr_t result;
+    IndexInfo *conflict=UpdateIndexes(old_row,new_row,false,&result);
+    if(conflict!=nullptr){
+      table_heap->ApplyDelete(new_row.GetRowId(),txn);
+      RollbackRelocations(relocated,i);
+      throw std::logic_error(IndexError(conflict,result));
     }
-    child_executor_->table_info->GetTableHeap()->InsertTuple(new_row,exec_ctx_->GetTransaction());
+    table_heap->ApplyDelete(old_row.GetRowId(),txn);
+    row_heap_.Reset();
   }
   return false;
 }
 
+IndexInfo *UpdateExecutor::UpdateIndexes(Row &old_row, Row &new_row, bool in_place, dberr_t *result) {
+  Transaction *txn=exec_ctx_->GetTransaction();
+  Schema *schema=table_info->GetSchema();
+  for(size_t i=0;i<index_info_.size();i++){
+    if(in_place&&!key_changed_[i]){
+      continue;
+    }
+    Index *index=index_info_[i]->GetIndex();
+    Row old_key(&row_heap_);
+    Row new_key(&row_heap_);
+    old_row.GetKeyFromRow(schema,index->GetKeySchema(),old_key);
+    new_row.GetKeyFromRow(schema,index->GetKeySchema(),new_key);
+    index->RemoveEntry(old_key,old_row.GetRowId(),txn);
+    *result=index->InsertEntry(new_key,new_row.GetRowId(),txn);
+    if(*result==DB_SUCCESS){
+      continue;
+    }
+    //唯一索引上新键已存在或索引已满：本索引放回旧键，已改过的索引从新键改回旧键
+    index->InsertEntry(old_key,old_row.GetRowId(),txn);
+    for(size_t j=0;j<i;j++){
+      if(in_place&&!key_changed_[j]){
+        continue;
+      }
+      Index *done=index_info_[j]->GetIndex();
+      old_row.GetKeyFromRow(schema,done->GetKeySchema(),old_key);
+      new_row.GetKeyFromRow(schema,done->GetKeySchema(),new_key);
+      done->RemoveEntry(new_key,new_row.GetRowId(),txn);
+      done->InsertEntry(old_key,old_row.GetRowId(),txn);
+    }
+    return index_info_[i];
+  }
+  return nullptr;
+}
+
+void UpdateExecutor::RollbackRelocations(const std::vector<std::pair<Row, Row>> &relocated, size_t from) {
+  //from之前的行已搬完，之后的行还只是标记删除
+  for(size_t i=from;i<relocated.size();i++){
+    table_info->GetTableHeap()->RollbackDelete(relocated[i].first.GetRowId(),exec_ctx_->GetTransaction());
+  }
+}
+
 Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
   Row new_row = Row(src_row);
   for(auto const &entry : plan_->update_attrs_) {
@@ -14,9 +14,9 @@ void ValuesExecutor::Init() {
 bool ValuesExecutor::Next(Row *row, RowId *rid) {
   if (cursor_ < value_size_) {
     std::vector<Field> values;
-    auto exprs = plan_->GetValues().at(cursor_);
+    const auto &exprs = plan_->GetValues().at(cursor_);
     for (auto expr : exprs) {
-      values.emplace_back(expr->Evaluate(nullptr));
+      values.emplace_back(expr->Evaluate(static_cast<const Row *>(nullptr)));
     }
     *row = Row{values};
     cursor_++;
@@ -0,0 +1,189 @@
+#ifndef MINISQL_BUFFER_POOL_H
+#define MINISQL_BUFFER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/set_replacer.h"
+#include "common/metrics.h"
+#include "page/page.h"
+#include "storage/disk_manager.h"
+
+/**
+ * The frames of the buffer pool, shared by every open database. A page is identified by the id its database got
+ * from AddDatabase and its page id, all databases compete for the same frames under one memory budget.
+ *
+ * A background writer thread cleans dirty unpinned pages, first those the replacer will evict next and then the
+ * rest of the pool round robin, so that eviction seldom has to write. Every CHECKPOINT_INTERVAL_SECONDS it writes
+ * every dirty page without stopping the queries (pages dirtied meanwhile are left to the next round).
+ *
+ * The data of all frames is one contiguous region aligned to the OS page (advised to use huge pages where the kernel
+ * allows it), kept apart from the Page array which only holds the book-keeping of each frame.
+ *
+ * Frames have the page size of the pool, only databases created with that page size can be added to it. The shared
+ * pools of the different page sizes split one memory budget: each reserves the address space of the whole budget, but
+ * only frame_limit_ of its frames may hold pages, and the limits are set again whenever a pool gains its first
+ * database or loses its last. Frames over the limit are written back, dropped and their memory given back to the OS.
+ *
+ * FetchPage of a page already in the pool and UnpinPage do not take latch_: the page table is looked up without a
+ * lock and the pin count of the frame is raised with a compare and swap, then the frame is checked to still hold
+ * the page. Everything that changes the page of a frame (eviction, DeletePage, dropping frames over the limit) first
+ * claims it by swapping a pin count of 0 for -1, which fails while anybody holds a pin, and does so under latch_.
+ * Pinned frames may stay in the replacer, eviction skips those it cannot claim and takes them out; the last unpin
+ * of a frame which is not in the replacer takes latch_ to put it back.
+ *
+ * Hits, misses, evictions and writes are counted in the metrics registry, labeled with the page size of the pool.
+ * The counters other than hits are only bumped under latch_, which lets them skip the locked add.
+ */
+class BufferPool {
+ public:
+  explicit BufferPool(size_t pool_size, uint32_t page_size = DEFAULT_PAGE_SIZE);
+
+  ~BufferPool();
+
+  DISALLOW_COPY(BufferPool)
+
+  /**
+   * The pool of the process for pages of page_size bytes, created on first use. The pools with databases share the
+   * memory of DEFAULT_BUFFER_POOL_SIZE pages of DEFAULT_PAGE_SIZE equally.
+   */
+  static BufferPool *Instance(uint32_t page_size = DEFAULT_PAGE_SIZE);
+
+  inline uint32_t GetPageSize() const { return page_size_; }
+
+  // register the disk file of a database, return the id its pages are known by
+  uint32_t AddDatabase(DiskManager *disk_manager);
+
+  // write back the dirty pages of a database and free its frames, none of them may be pinned
+  void RemoveDatabase(uint32_t db_id);
+
+  Page *FetchPage(uint32_t db_id, page_id_t page_id);
+
+  bool UnpinPage(uint32_t db_id, page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(uint32_t db_id, page_id_t page_id);
+
+  Page *NewPage(uint32_t db_id, page_id_t &page_id);
+
+  bool DeletePage(uint32_t db_id, page_id_t page_id);
+
+  bool IsPageFree(uint32_t db_id, page_id_t page_id);
+
+  bool CheckAllUnpinned(uint32_t db_id);
+
+  // write every dirty page of a database, pinned or not
+  void FlushAllPages(uint32_t db_id);
+
+ private:
+  static inline uint64_t PageKey(uint32_t db_id, page_id_t page_id) {
+    return (static_cast<uint64_t>(db_id) << 32) | static_cast<uint32_t>(page_id);
+  }
+
+  inline DiskManager *DiskOf(uint32_t db_id) { return disks_.at(db_id); }
+
+  // pin a frame found in the page table for key without latch_, false if it is claimed or holds another page
+  bool TryPin(frame_id_t frame_id, uint64_t key);
+
+  // drop a pin of a frame, the last one puts the frame back into the replacer or drops it if it is over
+  // frame_limit_; false if the frame is not pinned
+  bool ReleasePin(frame_id_t frame_id);
+
+  // swap a pin count of 0 for -1 so that nobody can pin the frame while its page changes, latch_ is held by the caller
+  inline bool ClaimFrame(frame_id_t frame_id) {
+    int unpinned = 0;
+    return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, -1);
+  }
+
+  // claim a frame which holds no page or a page nobody may pin any more, waiting for lookups that pinned it
+  // by mistake to let it go, latch_ is held by the caller
+  void WaitClaimFrame(frame_id_t frame_id);
+
+  // take a frame out of the replacer, latch_ is held by the caller
+  inline void RemoveFromReplacer(frame_id_t frame_id) {
+    pages_[frame_id].in_replacer_.store(false);
+    replacer_->Pin(frame_id);
+  }
+
+  // claim a frame for a new page, from the free list or else by evicting a page, false if every frame is pinned,
+  // latch_ is held by the caller
+  bool TakeFrame(frame_id_t *frame_id);
+
+  // claim the first clean frame among the next victims of the replacer or else near evict_hand_,
+  // the victim of the replacer if there is none, false if every frame in the replacer is pinned
+  bool PickVictim(frame_id_t *frame_id);
+
+  void BackgroundWriter();
+
+  // clean up to BGWRITER_MAX_PAGES dirty unpinned pages, the next victims first, latch_ is held by the caller
+  size_t CleanPages();
+
+  // write the dirty pages of db_id (of every database if db_id is INVALID_DB_ID) a batch at a time,
+  // taking latch_ for each batch
+  void WriteDirtyPages(uint32_t db_id, bool unpinned_only);
+
+  // write the pages of batch_ with as few writes as possible and mark them clean, latch_ is held by the caller
+  void WriteBatch();
+
+  // wake the background writer up before its delay is over
+  void WakeWriter();
+
+  bool IsWriterStopping();
+
+  // number of dirty frames, read by the dirty pages gauge
+  size_t DirtyPageCount();
+
+  // let the frames below frame_limit hold pages, dropping the unpinned pages above it
+  void SetFrameLimit(size_t frame_limit);
+
+  // drop the page of a claimed frame over frame_limit_, writing it back if dirty, latch_ is held by the caller
+  void DropFrame(frame_id_t frame_id);
+
+  // give the memory of the frames from begin to end back to the OS, none of them holds a page
+  void DiscardFrames(size_t begin, size_t end);
+
+  // split the memory budget again between the shared pools which have databases
+  static void Rebalance();
+
+  static constexpr uint32_t INVALID_DB_ID = 0;
+  static constexpr size_t FRAME_REGION_ALIGN = 4096;
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+  static constexpr int CLAIM_MAX_SPINS = 1 << 20;  // a mistaken pin is let go at once, one held longer is a bug
+
+  size_t pool_size_;                                             // number of pages in buffer pool
+  std::atomic<size_t> frame_limit_;                              // frames below it may hold pages
+  bool shared_{false};                                           // one of the pools of Instance
+  uint32_t page_size_;                                           // size of each frame in byte
+  char *frames_;                                                 // data of the frames, page_size_ bytes each
+  size_t frames_size_;                                           // size of the mapping of frames_
+  Page *pages_;                                                  // array of page metadata, one per frame
+  std::unordered_map<uint32_t, DiskManager *> disks_;            // disk file of each database
+  uint32_t next_db_id_{INVALID_DB_ID + 1};
+  PageTable page_table_;                                         // to keep track of pages, by PageKey, written under latch_
+  Replacer *replacer_;                                           // to find an unpinned page for replacement
+  std::list<frame_id_t> free_list_;                              // to find a free page for replacement
+  std::recursive_mutex latch_;                                   // to protect shared data structure, and the disk files
+  std::vector<frame_id_t> batch_;                                // frames the background writer writes next
+  std::vector<char> batch_data_;                                 // their pages sorted by database and page id
+  size_t writer_hand_{0};                                        // where the background writer goes on sweeping the pool
+  size_t evict_hand_{0};                                         // where eviction goes on looking for a clean page
+  std::thread writer_thread_;
+  std::mutex writer_latch_;
+  std::condition_variable writer_cv_;
+  bool writer_stop_{false};
+  std::atomic<bool> writer_wakeup_{false};
+  std::string metric_labels_;                                    // labels of the metrics of this pool
+  Counter *hits_metric_;                                         // pages found in the pool
+  Counter *misses_metric_;                                       // pages read from disk into the pool
+  Counter *evictions_metric_;                                    // pages dropped to make room for another
+  Counter *eviction_writes_metric_;                              // of them, dirty ones the query thread wrote itself
+  Counter *batch_writes_metric_;                                 // pages written a batch at a time
+};
+
+#endif  // MINISQL_BUFFER_POOL_H
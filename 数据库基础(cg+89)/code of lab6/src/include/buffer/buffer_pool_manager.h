@@ -1,59 +1,51 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
-#include <list>
-#include <mutex>
-#include <unordered_map>
+#include <memory>
 
-#include "buffer/lru_replacer.h"
-#include "buffer/set_replacer.h"
+#include "buffer/buffer_pool.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 //
 using namespace std;
 
+/**
+ * The pages of one database in a BufferPool. Usually the pool is the one of the process shared by all open
+ * databases, a BufferPoolManager constructed with a pool size has a pool of its own.
+ */
 class BufferPoolManager {
  public:
   explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
 
-  ~BufferPoolManager();
+  BufferPoolManager(BufferPool *buffer_pool, DiskManager *disk_manager);
 
-  Page *FetchPage(page_id_t page_id);
+  ~BufferPoolManager();
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  inline Page *FetchPage(page_id_t page_id) { return buffer_pool_->FetchPage(db_id_, page_id); }
 
-  bool FlushPage(page_id_t page_id);
+  inline bool UnpinPage(page_id_t page_id, bool is_dirty) { return buffer_pool_->UnpinPage(db_id_, page_id, is_dirty); }
 
-  Page *NewPage(page_id_t &page_id);
+  inline bool FlushPage(page_id_t page_id) { return buffer_pool_->FlushPage(db_id_, page_id); }
 
-  bool DeletePage(page_id_t page_id);
+  inline Page *NewPage(page_id_t &page_id) { return buffer_pool_->NewPage(db_id_, page_id); }
 
-  bool IsPageFree(page_id_t page_id);
+  inline bool DeletePage(page_id_t page_id) { return buffer_pool_->DeletePage(db_id_, page_id); }
 
-  bool CheckAllUnpinned();
+  inline bool IsPageFree(page_id_t page_id) { return buffer_pool_->IsPageFree(db_id_, page_id); }
 
- private:
-  /**
-   * Allocate new page (operations like create index/table) For now just keep an increasing counter
-   */
-  page_id_t AllocatePage();
+  inline bool CheckAllUnpinned() { return buffer_pool_->CheckAllUnpinned(db_id_); }
 
-  /**
-   * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
-   */
-  void DeallocatePage(page_id_t page_id);
+  // write every dirty page, pinned or not
+  inline void FlushAllPages() { buffer_pool_->FlushAllPages(db_id_); }
 
-  frame_id_t TryToFindFreePage();
+  // size of the pages of the database in byte
+  inline uint32_t GetPageSize() const { return buffer_pool_->GetPageSize(); }
 
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  std::unique_ptr<BufferPool> own_buffer_pool_;  // the pool if it is not shared
+  BufferPool *buffer_pool_;
+  uint32_t db_id_;                               // id of the database in buffer_pool_
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -33,6 +33,8 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  size_t PeekVictims(frame_id_t *frame_ids, size_t max_count) override;
+
   size_t Size() override;
 
 private:
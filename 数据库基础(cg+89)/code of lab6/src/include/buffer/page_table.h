@@ -0,0 +1,92 @@
+#ifndef MINISQL_PAGE_TABLE_H
+#define MINISQL_PAGE_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * The page table of the buffer pool, mapping a page key to the frame holding the page.
+ *
+ * An open addressing table with linear probing, sized once for the number of frames. Find takes no lock: every write
+ * to a slot bumps its version, odd while the write is under way, and a lookup whose slot version or table version
+ * changed while it read the slot is retried, so an erase and a reinsert of the same key in between are never missed.
+ * Insert and Erase lock the stripe of the home slot of their key only, so writers of different keys rarely wait
+ * for each other; two writers racing for the same free slot are settled with a compare and swap on its key.
+ *
+ * Erased slots become tombstones, which are reused by later inserts. When too few empty slots are left the live
+ * entries are copied into a second slot array, so lookups still running on the old array never see freed memory.
+ *
+ * BufferPool inserts and erases under its latch_, but looks pages up without it on the hit path of FetchPage and in
+ * UnpinPage. The frame a lookup returns may already hold another page by the time it is pinned, the pool checks that.
+ */
+class PageTable {
+ public:
+  /**
+   * @param max_entries the maximum number of keys in the table at the same time
+   */
+  explicit PageTable(size_t max_entries);
+
+  ~PageTable();
+
+  DISALLOW_COPY(PageTable)
+
+  /** @return true and set frame_id if key is in the table */
+  bool Find(uint64_t key, frame_id_t *frame_id) const;
+
+  /** @return false if key is already in the table */
+  bool Insert(uint64_t key, frame_id_t frame_id);
+
+  /** @return false if key is not in the table */
+  bool Erase(uint64_t key);
+
+  /** @return the number of keys in the table */
+  size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> key;
+    std::atomic<frame_id_t> frame_id;
+    std::atomic<uint32_t> version;  // odd while Insert or Erase writes the slot
+  };
+
+  // keys no page can have, the database id of a page key is never all ones
+  static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+  static constexpr uint64_t TOMBSTONE_KEY = UINT64_MAX - 1;
+  static constexpr uint64_t RESERVED_KEY = UINT64_MAX - 2;  // claimed by an insert that is filling in the frame id
+  static constexpr size_t STRIPE_COUNT = 64;
+
+  inline size_t HomeOf(uint64_t key) const {
+    // finalizer of murmur3, page keys of one database only differ in their low bits
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb3fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key & mask_;
+  }
+
+  // the slot holding key in slots, nullptr if there is none
+  Slot *Probe(Slot *slots, uint64_t key) const;
+
+  // set the key and frame id of a slot, its stripe latch is held by the caller
+  static void WriteSlot(Slot *slot, uint64_t key, frame_id_t frame_id);
+
+  // copy the live entries into the spare slot array and make it current, every stripe latch is held by the caller
+  void Rebuild();
+
+  size_t capacity_;
+  size_t mask_;
+  size_t max_used_;                          // rebuild once this many slots are not empty
+  Slot *slots_[2];                           // the current slot array and the spare one
+  std::atomic<Slot *> current_;
+  std::atomic<uint64_t> version_{0};         // odd while a rebuild is switching arrays
+  std::atomic<size_t> used_{0};              // slots which are not empty, tombstones included
+  std::atomic<size_t> size_{0};
+  std::mutex stripe_latches_[STRIPE_COUNT];  // by home slot, protect the keys homed there from concurrent writers
+};
+
+#endif  // MINISQL_PAGE_TABLE_H
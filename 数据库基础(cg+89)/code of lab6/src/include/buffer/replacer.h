@@ -33,6 +33,13 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Look at the frames that will be victimized next, in the order Victim would return them.
+   * @param[out] frame_ids the frame ids, at most max_count of them
+   * @return the number of frame ids written
+   */
+  virtual size_t PeekVictims(frame_id_t *frame_ids, size_t max_count) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
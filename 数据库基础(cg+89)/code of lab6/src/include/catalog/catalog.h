@@ -61,6 +61,9 @@ class CatalogMeta {
 
  private:
   static constexpr uint32_t CATALOG_METADATA_MAGIC_NUM = 89849;
+  /** Same layout, written once every table heap only holds compact rows (see Row) */
+  static constexpr uint32_t CATALOG_METADATA_MAGIC_NUM_COMPACT = 89850;
+  bool compact_rows_{true};
   std::map<table_id_t, page_id_t> table_meta_pages_;
   std::map<index_id_t, page_id_t> index_meta_pages_;
 };
@@ -86,7 +89,7 @@ class CatalogManager {
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn, IndexInfo *&index_info,
-                      const string &index_type);
+                      const string &index_type, bool unique = true);
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -100,6 +103,15 @@ class CatalogManager {
 
   dberr_t GetIndexNames(std::vector<string> &index_names);
 
+  /**
+   * Compact the heap of a table (see TableHeap::Vacuum) and point its indexes at the moved rows. If an index can not
+   * take the new row id of a row, the row stays where it was and the error of the index is returned; the rows moved
+   * before it keep their new row ids.
+   * @param[out] moved_rows rows that got a new row id
+   * @param[out] released_pages pages given back to the disk manager
+   */
+  dberr_t VacuumTable(const std::string &table_name, uint32_t &moved_rows, uint32_t &released_pages);
+
  private:
   dberr_t DropTable(table_id_t table_id);
 
@@ -125,6 +137,7 @@ class CatalogManager {
    for(auto itr:indexes_){
       index_infos.push_back(itr.second);
    }
+   return DB_SUCCESS;
   }
 
 
@@ -6,8 +6,11 @@
 #include "catalog/table.h"
 #include "common/macros.h"
 #include "common/rowid.h"
+#include "index/art_index.h"
 #include "index/b_plus_tree_index.h"
+#include "index/be_tree_index.h"
 #include "index/generic_key.h"
+#include "index/hash_index.h"
 #include "record/schema.h"
 
 class IndexMetadata {
@@ -15,7 +18,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, const std::string &index_type = "bptree",
+                               bool unique = true);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +37,39 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** @return "bptree", "betree", "hash" or "art" */
+  inline const std::string &GetIndexType() const { return index_type_; }
+
+  /** a non-unique index keeps duplicate keys apart by their RowId */
+  inline bool IsUnique() const { return unique_; }
+
+  /** the index was written before keys were encoded to compare bytewise, it has to be rebuilt */
+  inline bool HasLegacyKeys() const { return legacy_keys_; }
+
+  inline void ClearLegacyKeys() { legacy_keys_ = false; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, const std::string &index_type, bool unique);
 
  private:
+  /** metadata written before index types existed, always a b+ tree */
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  /** metadata followed by the index type */
+  static constexpr uint32_t INDEX_METADATA_TYPED_MAGIC_NUM = 344529;
+  /** typed metadata followed by the unique flag, earlier metadata is always unique */
+  static constexpr uint32_t INDEX_METADATA_UNIQUE_MAGIC_NUM = 344530;
+  /** same layout, the keys of the index compare bytewise in slotted b+ tree pages */
+  static constexpr uint32_t INDEX_METADATA_COMPARABLE_MAGIC_NUM = 344531;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  std::string index_type_;
+  bool unique_;
+  bool legacy_keys_;
 };
 
 /**
@@ -70,16 +95,22 @@ class IndexInfo {
     // Step2: mapping index key to key schema
     key_schema_ = Schema::ShallowCopySchema(table_info_->GetSchema(), meta_data_->GetKeyMapping());
     // Step3: call CreateIndex to create the index
-    index_ = CreateIndex(buffer_pool_manager,"bptree");
+    index_ = CreateIndex(buffer_pool_manager, meta_data_->GetIndexType());
     //ASSERT(false, "Not Implemented yet.");
   }
 
   inline Index *GetIndex() { return index_; }
 
+  inline IndexMetadata *GetMetadata() { return meta_data_; }
+
   inline TableInfo *GetTableInfo() const { return table_info_; }
 
   std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+  const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
+  bool IsUnique() const { return meta_data_->IsUnique(); }
+
   std::vector<uint32_t> GetKeyMap(){return meta_data_->GetKeyMapping();}
 
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
@@ -23,7 +23,7 @@ class TableMetadata {
    * will create new table schema and owned by mem heap
    */
   static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                               TableSchema *schema);
+                               TableSchema *schema, page_id_t directory_page_id = INVALID_PAGE_ID);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -33,17 +33,27 @@ class TableMetadata {
 
   inline Schema *GetSchema() const { return schema_; }
 
+  /** @return the first page of the page directory of the table, INVALID_PAGE_ID if it has none yet */
+  inline page_id_t GetDirectoryPageId() const { return directory_page_id_; }
+
+  inline void SetDirectoryPageId(page_id_t directory_page_id) { directory_page_id_ = directory_page_id; }
+
  private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                page_id_t directory_page_id);
 
  private:
+  /** metadata written before tables had a page directory */
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  /** metadata followed by the first page of the page directory */
+  static constexpr uint32_t TABLE_METADATA_DIRECTORY_MAGIC_NUM = 344529;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
   Schema *schema_;
+  page_id_t directory_page_id_;
 };
 
 /**
@@ -13,11 +13,27 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
-static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_PAGE_SIZE = 4096;          // page size of a database created without one, in byte
+static constexpr int MIN_PAGE_SIZE = 4096;              // page sizes are powers of two from MIN to MAX_PAGE_SIZE
+static constexpr int MAX_PAGE_SIZE = 32768;             // page layouts keep offsets in 16 bits
+static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool, in pages of DEFAULT_PAGE_SIZE
+
+static constexpr int BGWRITER_DELAY_MS = 200;            // the background writer cleans pages this often
+static constexpr size_t BGWRITER_MAX_PAGES = 64;         // dirty pages the background writer writes at a time
+static constexpr int CHECKPOINT_INTERVAL_SECONDS = 30;  // every dirty page is written at least this often
+
+static constexpr int PARALLEL_SCAN_MIN_PAGES = 64;     // smallest table a select scans with several threads
+static constexpr int PARALLEL_SCAN_MORSEL_PAGES = 16;  // pages a scan worker takes at a time
+static constexpr int MAX_PARALLEL_WORKERS = 16;        // largest degree of parallelism of a query
+
+static constexpr uint32_t AUTOVACUUM_MIN_DELETED_TUPLES = 1000;  // deletes that make autovacuum compact a table
+static constexpr int AUTOVACUUM_NAP_SECONDS = 5;                // autovacuum looks for such tables this often
+
+static constexpr int STATS_DUMP_INTERVAL_SECONDS = 10;  // the metrics file set by stats_file is rewritten this often
+static constexpr uint32_t DISK_LATENCY_SAMPLE_RATE = 8;  // one disk read or write in this many is timed
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = MIN_PAGE_SIZE / 2;  // max length of varchar
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
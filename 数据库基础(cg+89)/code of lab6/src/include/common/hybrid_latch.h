@@ -0,0 +1,186 @@
+#ifndef MINISQL_HYBRID_LATCH_H
+#define MINISQL_HYBRID_LATCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "macros.h"
+
+/**
+ * Reader-writer latch in a single atomic word, with optimistic reads.
+ *
+ * The word holds the number of shared holders, an exclusive bit, a bit telling that some thread is parked on the
+ * latch and a version which every exclusive unlock increments. Locking and unlocking without contention is one
+ * compare and swap. A thread that cannot get the latch spins for a while and then parks on a condition variable of
+ * a process wide parking lot, picked by the address of the latch, so the latch itself stays 8 bytes.
+ *
+ * Optimistic readers take no lock at all: they read the version with OptimisticRead, read the protected data and
+ * keep what they read only if Validate says no writer got in meanwhile. They must not follow pointers or sizes read
+ * before validating, the data may be torn.
+ *
+ * A writer that finds the latch shared sets the exclusive bit at once and waits for the readers to drain, so new
+ * readers queue behind it and a stream of readers cannot starve it.
+ */
+class HybridLatch {
+  static constexpr uint64_t SHARED_MASK = (1ULL << 16) - 1;
+  static constexpr uint64_t EXCLUSIVE_BIT = 1ULL << 16;
+  static constexpr uint64_t PARKED_BIT = 1ULL << 17;
+  static constexpr uint64_t VERSION_UNIT = 1ULL << 18;
+  static constexpr uint64_t VERSION_MASK = ~(VERSION_UNIT - 1);
+  static constexpr int SPIN_COUNT = 128;
+  static constexpr size_t PARKING_BUCKET_COUNT = 64;
+
+ public:
+  HybridLatch() = default;
+
+  DISALLOW_COPY(HybridLatch);
+
+  /**
+   * Acquire a write latch.
+   */
+  void WLock() {
+    uint64_t word = word_.load(std::memory_order_relaxed);
+    // fast path, the latch is free
+    if ((word & (EXCLUSIVE_BIT | SHARED_MASK)) == 0 &&
+        word_.compare_exchange_strong(word, word | EXCLUSIVE_BIT, std::memory_order_acquire)) {
+      return;
+    }
+    // first take the exclusive bit from the other writers, then wait for the readers to leave
+    Wait([](uint64_t w) { return (w & EXCLUSIVE_BIT) == 0; }, [](uint64_t w) { return w | EXCLUSIVE_BIT; });
+    Wait([](uint64_t w) { return (w & SHARED_MASK) == 0; }, [](uint64_t w) { return w; });
+  }
+
+  /**
+   * Release a write latch.
+   */
+  void WUnlock() {
+    uint64_t word = word_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+      ASSERT(word & EXCLUSIVE_BIT, "WUnlock failed.");
+      next = ((word & ~(EXCLUSIVE_BIT | PARKED_BIT)) + VERSION_UNIT);
+    } while (!word_.compare_exchange_weak(word, next, std::memory_order_release, std::memory_order_relaxed));
+    if (word & PARKED_BIT) {
+      Unpark();
+    }
+  }
+
+  /**
+   * Acquire a read latch.
+   */
+  void RLock() {
+    uint64_t word = word_.load(std::memory_order_relaxed);
+    if ((word & EXCLUSIVE_BIT) == 0 && (word & SHARED_MASK) < SHARED_MASK &&
+        word_.compare_exchange_strong(word, word + 1, std::memory_order_acquire)) {
+      return;
+    }
+    Wait([](uint64_t w) { return (w & EXCLUSIVE_BIT) == 0 && (w & SHARED_MASK) < SHARED_MASK; },
+         [](uint64_t w) { return w + 1; });
+  }
+
+  /**
+   * Release a read latch.
+   */
+  void RUnlock() {
+    uint64_t word = word_.fetch_sub(1, std::memory_order_release);
+    ASSERT((word & SHARED_MASK) != 0, "RUnlock failed.");
+    // the last reader lets in the writer waiting for it, or a reader waiting for a free shared slot
+    if ((word & PARKED_BIT) && ((word & SHARED_MASK) == 1 || (word & SHARED_MASK) == SHARED_MASK)) {
+      word_.fetch_and(~PARKED_BIT, std::memory_order_relaxed);
+      Unpark();
+    }
+  }
+
+  /**
+   * Start an optimistic read, waiting for a writer holding the latch to leave.
+   * @return the version to check with Validate at the end of the read
+   */
+  uint64_t OptimisticRead() const {
+    for (int spin = 0;; spin++) {
+      uint64_t word = word_.load(std::memory_order_acquire);
+      if ((word & EXCLUSIVE_BIT) == 0) {
+        return word & VERSION_MASK;
+      }
+      Pause(spin);
+    }
+  }
+
+  /**
+   * @return true if no writer took the latch since OptimisticRead returned version
+   */
+  bool Validate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (word_.load(std::memory_order_relaxed) & (VERSION_MASK | EXCLUSIVE_BIT)) == version;
+  }
+
+ private:
+  struct ParkingBucket {
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+
+  static ParkingBucket &BucketOf(const void *latch) {
+    static ParkingBucket buckets[PARKING_BUCKET_COUNT];
+    return buckets[(reinterpret_cast<uintptr_t>(latch) >> 3) % PARKING_BUCKET_COUNT];
+  }
+
+  static void Pause(int spin) {
+    if (spin < SPIN_COUNT) {
+#ifdef __SSE2__
+      _mm_pause();
+#endif
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Wait until can_enter(word) holds and then replace the word by enter(word), spinning first and parking when the
+   * latch stays taken.
+   */
+  template <typename CanEnter, typename Enter>
+  void Wait(CanEnter can_enter, Enter enter) {
+    for (int spin = 0;; spin++) {
+      uint64_t word = word_.load(std::memory_order_acquire);
+      if (can_enter(word)) {
+        uint64_t next = enter(word);
+        if (next == word || word_.compare_exchange_weak(word, next, std::memory_order_acquire)) {
+          return;
+        }
+        continue;
+      }
+      if (spin < SPIN_COUNT) {
+        Pause(spin);
+        continue;
+      }
+      // set the parked bit under the bucket mutex, an unlock seeing it takes the mutex before waking us
+      ParkingBucket &bucket = BucketOf(this);
+      std::unique_lock<std::mutex> lock(bucket.mutex);
+      word = word_.load(std::memory_order_acquire);
+      if (!can_enter(word) &&
+          ((word & PARKED_BIT) || word_.compare_exchange_strong(word, word | PARKED_BIT, std::memory_order_relaxed))) {
+        bucket.cv.wait(lock);
+      }
+      spin = 0;
+    }
+  }
+
+  void Unpark() {
+    ParkingBucket &bucket = BucketOf(this);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.cv.notify_all();
+  }
+
+  std::atomic<uint64_t> word_{0};
+};
+
+static_assert(sizeof(HybridLatch) == 8, "HybridLatch must stay one word");
+
+#endif  // MINISQL_HYBRID_LATCH_H
@@ -14,7 +14,12 @@
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  /**
+   * Open the database db_name, creating it with pages of page_size bytes if init is true. The pages go to buffer_pool,
+   * by default the pool of the process for the page size of the database.
+   */
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t page_size = DEFAULT_PAGE_SIZE,
+                           BufferPool *buffer_pool = nullptr);
 
   ~DBStorageEngine();
 
@@ -0,0 +1,172 @@
+#ifndef MINISQL_METRICS_H
+#define MINISQL_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * A count that only goes up. Adding is one relaxed atomic add, or a plain load and store for a counter only bumped
+ * under one latch, which costs a few times less.
+ */
+class Counter {
+ public:
+  inline void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** Add for a counter whose every Add happens under the same latch, readers may still read it at any time */
+  inline void AddLatched(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  inline uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * Distribution of durations in nanoseconds, HDR style: every power of two is cut into SUB_BUCKETS buckets, so a
+ * quantile read back is within 1 / SUB_BUCKETS of the recorded values whether they are nanoseconds or minutes.
+ * Recording is a few relaxed atomic adds, readers add the buckets up while values keep coming in.
+ */
+class Histogram {
+ public:
+  static constexpr int SUB_BUCKET_BITS = 4;
+  static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  void Record(uint64_t value) {
+    buckets_[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  /** @return the number of values recorded */
+  uint64_t Count() const;
+
+  inline uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  inline uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  /** @return the value a fraction q (0 to 1) of the recorded values are at most, rounded up to the end of its bucket */
+  uint64_t Quantile(double q) const;
+
+  /** @return the number of values recorded below bound, exact when bound is a power of two */
+  uint64_t CountBelow(uint64_t bound) const;
+
+  static inline size_t BucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return value;
+    }
+    int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+  }
+
+  /** @return the largest value counted in bucket */
+  static uint64_t BucketEnd(size_t bucket);
+
+ private:
+  std::atomic<uint64_t> buckets_[BUCKET_COUNT]{};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * The metrics of the process, by name and labels: counters and histograms bumped where the work happens, and gauges
+ * read by a callback when the metrics are shown. Metrics are registered once, usually when the instrumented object
+ * or file is set up, and keep their address for the life of the process.
+ *
+ * Names follow the Prometheus conventions, counters end in _total and histograms of durations in _seconds. Labels
+ * are given the way they are written out, like page_size="4096".
+ */
+class MetricsRegistry {
+ public:
+  MetricsRegistry() = default;
+
+  DISALLOW_COPY_AND_MOVE(MetricsRegistry);
+
+  /** @return the registry of the process, never destroyed so metrics can be bumped until the very end */
+  static MetricsRegistry *Instance();
+
+  /** @return the counter name{labels}, created on first use */
+  Counter *GetCounter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+  /** @return the histogram name{labels}, created on first use */
+  Histogram *GetHistogram(const std::string &name, const std::string &help, const std::string &labels = "");
+
+  /** Let the gauge name{labels} be read by read from now on, read must not use the registry */
+  void SetGauge(const std::string &name, const std::string &help, const std::string &labels,
+                std::function<double()> read);
+
+  void RemoveGauge(const std::string &name, const std::string &labels);
+
+  /** Write every metric in the Prometheus text exposition format */
+  void WriteText(std::ostream &out);
+
+  /**
+   * A line per metric for show stats, its name with labels and its value. Histograms give their count, mean,
+   * quantiles and max.
+   */
+  void Describe(std::vector<std::pair<std::string, std::string>> *lines);
+
+ private:
+  enum class Type { kCounter, kGauge, kHistogram };
+
+  struct Metric {
+    std::unique_ptr<Counter> counter_;
+    std::unique_ptr<Histogram> histogram_;
+    std::function<double()> gauge_;
+  };
+
+  struct Family {
+    std::string help_;
+    Type type_;
+    std::map<std::string, Metric> metrics_;  // by labels
+  };
+
+  /** @return the metric name{labels}, latch_ is held by the caller */
+  Metric &GetMetric(const std::string &name, const std::string &help, const std::string &labels, Type type);
+
+  std::mutex latch_;
+  std::map<std::string, Family> families_;
+};
+
+/**
+ * Records the nanoseconds from its construction to its destruction into a histogram, reading no clock when the
+ * histogram is nullptr (to time only a sample of cheap operations).
+ */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram *histogram) : histogram_(histogram) {
+    if (histogram_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedTimer() {
+    if (histogram_ != nullptr) {
+      histogram_->Record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(ScopedTimer);
+
+ private:
+  Histogram *histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#endif  // MINISQL_METRICS_H
@@ -0,0 +1,46 @@
+#ifndef MINISQL_QUERY_COUNTERS_H
+#define MINISQL_QUERY_COUNTERS_H
+
+#include <cstdint>
+
+/**
+ * Work done by a thread, counted where it happens: page lookups in the buffer pool, pages read and written by the
+ * disk managers and bytes handed out by the query arenas.
+ *
+ * Every thread has its own counters (see LocalQueryCounters), plain integers bumped without atomics, so counting
+ * stays compiled in. EXPLAIN ANALYZE takes the difference of the counters of the thread around each call into an
+ * executor.
+ */
+struct QueryCounters {
+  uint64_t buffer_hits_{0};
+  uint64_t buffer_misses_{0};
+  uint64_t pages_read_{0};
+  uint64_t pages_written_{0};
+  uint64_t bytes_allocated_{0};
+
+  QueryCounters &operator+=(const QueryCounters &other) {
+    buffer_hits_ += other.buffer_hits_;
+    buffer_misses_ += other.buffer_misses_;
+    pages_read_ += other.pages_read_;
+    pages_written_ += other.pages_written_;
+    bytes_allocated_ += other.bytes_allocated_;
+    return *this;
+  }
+
+  QueryCounters operator-(const QueryCounters &other) const {
+    QueryCounters result = *this;
+    result.buffer_hits_ -= other.buffer_hits_;
+    result.buffer_misses_ -= other.buffer_misses_;
+    result.pages_read_ -= other.pages_read_;
+    result.pages_written_ -= other.pages_written_;
+    result.bytes_allocated_ -= other.bytes_allocated_;
+    return result;
+  }
+};
+
+inline thread_local QueryCounters local_query_counters;
+
+/** @return the counters of the calling thread */
+inline QueryCounters &LocalQueryCounters() { return local_query_counters; }
+
+#endif  // MINISQL_QUERY_COUNTERS_H
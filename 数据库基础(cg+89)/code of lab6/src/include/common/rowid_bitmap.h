@@ -0,0 +1,48 @@
+#ifndef MINISQL_ROWID_BITMAP_H
+#define MINISQL_ROWID_BITMAP_H
+
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * Compressed set of RowIds, the result of one index scan in a bitmap index scan.
+ *
+ * Like a roaring bitmap the RowIds are split by their high part: every page with at least
+ * one RowId of the set gets a container, a bitset of its slots that ends with the last
+ * slot in the set. Containers are kept in page order, so sets are combined with a merge
+ * of their pages and handed out in the order the table heap lies on disk.
+ */
+class RowIdBitmap {
+ public:
+  RowIdBitmap() = default;
+
+  /** Build the set of rids, rids is sorted as a side effect */
+  explicit RowIdBitmap(std::vector<RowId> &rids);
+
+  inline bool IsEmpty() const { return pages_.empty(); }
+
+  size_t Cardinality() const;
+
+  /** the RowIds in both sets */
+  RowIdBitmap And(const RowIdBitmap &other) const;
+
+  /** the RowIds in either set */
+  RowIdBitmap Or(const RowIdBitmap &other) const;
+
+  /** Append the RowIds to result in page order, then slot order */
+  void ToRowIds(std::vector<RowId> &result) const;
+
+ private:
+  static constexpr uint32_t WORD_BITS = 64;
+
+  /** Append a container, nothing if all its words are 0 */
+  void AppendContainer(page_id_t page_id, const uint64_t *words, size_t count);
+
+  // the container of pages_[i] is words_[offsets_[i] .. offsets_[i + 1])
+  std::vector<page_id_t> pages_;
+  std::vector<uint32_t> offsets_{0};
+  std::vector<uint64_t> words_;
+};
+
+#endif  // MINISQL_ROWID_BITMAP_H
@@ -0,0 +1,62 @@
+#ifndef MINISQL_THREAD_POOL_H
+#define MINISQL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * Work-stealing thread pool running the morsels of parallel queries.
+ *
+ * Every worker owns a queue. A task submitted by a worker goes to its own queue, a task
+ * submitted from outside the pool to the queues in turn. A worker takes the oldest task of
+ * its own queue first, so the morsels of a query are started roughly in order, and an idle
+ * worker steals the newest task of another queue.
+ */
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(size_t thread_count);
+
+  ~ThreadPool();
+
+  DISALLOW_COPY_AND_MOVE(ThreadPool);
+
+  /** @return the pool shared by all queries, one thread per core */
+  static ThreadPool &Instance();
+
+  inline size_t GetThreadCount() const { return threads_.size(); }
+
+  void Submit(Task task);
+
+ private:
+  struct Queue {
+    std::mutex latch_;
+    std::deque<Task> tasks_;
+  };
+
+  /** Take a task from the queue of worker self, or steal one */
+  bool TryPop(size_t self, Task *task);
+
+  void Run(size_t self);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  /** queue the next task from outside the pool goes to */
+  std::atomic<size_t> next_queue_{0};
+  /** guards pending_ and stop_, idle workers sleep on cv_ */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  size_t pending_{0};
+  bool stop_{false};
+};
+
+#endif  // MINISQL_THREAD_POOL_H
@@ -0,0 +1,75 @@
+#ifndef MINISQL_EXCHANGE_H
+#define MINISQL_EXCHANGE_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/query_counters.h"
+#include "common/thread_pool.h"
+#include "record/row.h"
+
+/**
+ * Gather exchange, the top of a parallel pipeline.
+ *
+ * The input of the pipeline is cut into morsels numbered from 0. Every morsel is a task on the
+ * thread pool which runs the pipeline over it (scan, filter, projection, ...) into a batch of
+ * rows. At most dop morsels run at once, and no more than 2 * dop morsels are started ahead of
+ * the consumer, so a slow consumer holds the pipeline back instead of piling up batches.
+ * The consumer gets the batches in morsel order, that is the order a serial run produces.
+ *
+ * The query counters (see QueryCounters) of the morsels are added to those of the consumer thread when it takes a
+ * batch, so the work of the pool is counted for the query.
+ */
+class Gather {
+ public:
+  using Batch = std::vector<Row>;
+
+  /** Run the pipeline over a morsel, called on the threads of the pool */
+  using MorselFunc = std::function<void(size_t morsel, Batch *batch)>;
+
+  Gather(ThreadPool *pool, size_t morsel_count, size_t dop, MorselFunc morsel_func);
+
+  /** Morsels not started yet are dropped, the running ones are waited for */
+  ~Gather();
+
+  DISALLOW_COPY_AND_MOVE(Gather);
+
+  /**
+   * Take the batch of the next morsel, waiting for it if needed. An exception thrown by the
+   * pipeline is rethrown here.
+   * @return false after the last morsel
+   */
+  bool Next(Batch *batch);
+
+ private:
+  /** Start the morsels the limits allow, latch_ is held */
+  void Schedule();
+
+  void RunMorsel(size_t morsel);
+
+  ThreadPool *pool_;
+  size_t morsel_count_;
+  size_t dop_;
+  MorselFunc morsel_func_;
+  std::mutex latch_;
+  /** signalled when a morsel finishes */
+  std::condition_variable cv_;
+  /** batches of finished morsels not taken yet */
+  std::map<size_t, Batch> ready_;
+  /** morsel the consumer takes next */
+  size_t next_{0};
+  /** morsels started so far */
+  size_t started_{0};
+  size_t running_{0};
+  bool cancelled_{false};
+  std::exception_ptr error_;
+  /** counters of the morsels finished since the consumer last took a batch */
+  QueryCounters worker_counters_;
+};
+
+#endif  // MINISQL_EXCHANGE_H
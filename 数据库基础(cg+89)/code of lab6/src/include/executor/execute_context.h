@@ -5,10 +5,16 @@
 #ifndef MINISQL_EXECUTE_CONTEXT_H
 #define MINISQL_EXECUTE_CONTEXT_H
 
+#include <unordered_map>
+
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/macros.h"
+#include "executor/executor_stats.h"
 #include "transaction/transaction.h"
+#include "utils/mem_heap.h"
+
+class AbstractPlanNode;
 
 class ExecuteContext {
  public:
@@ -34,6 +40,26 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /**
+   * @return the per-query arena, rows and temporaries that must last for the whole query are
+   * allocated from it and released together when the context is destroyed at the end of the query.
+   * Rows and keys needed for a single row go to a scratch arena of the executor instead.
+   */
+  ArenaMemHeap *GetHeap() { return &heap_; }
+
+  /** @return the most threads a parallel pipeline of the query may use, 1 to run it serially */
+  uint32_t GetParallelWorkers() const { return parallel_workers_; }
+
+  void SetParallelWorkers(uint32_t parallel_workers) { parallel_workers_ = parallel_workers; }
+
+  /** Measure every executor of the query, for EXPLAIN ANALYZE */
+  void EnableAnalyze() { analyze_ = true; }
+
+  /** @return the figures of the executor running plan, nullptr unless the query is analyzed */
+  ExecutorStats *GetExecutorStats(const AbstractPlanNode *plan) {
+    return analyze_ ? &executor_stats_[plan] : nullptr;
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -41,6 +67,14 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** Per-query memory arena */
+  ArenaMemHeap heap_;
+  /** Degree of parallelism of the session running the query */
+  uint32_t parallel_workers_{1};
+  /** Whether the executors are measured */
+  bool analyze_{false};
+  /** Figures of the executors by plan node, when analyzed */
+  std::unordered_map<const AbstractPlanNode *, ExecutorStats> executor_stats_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
@@ -1,8 +1,12 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include "parser/syntax_tree_printer.h"
 #include "common/dberr.h"
@@ -10,6 +14,7 @@
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/abstract_plan.h"
+#include "planner/plan_cache.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
@@ -29,11 +34,33 @@ class ExecuteEngine {
   ExecuteEngine();
 
   ~ExecuteEngine() {
+    StopAutoVacuum();
+    StopStatsDump();
     for (auto it : dbs_) {
       delete it.second;
     }
   }
 
+  /**
+   * Execute one sql statement.
+   *
+   * Dml statements are looked up in the plan cache by their normalized text and skip parsing and
+   * planning on a hit. Also handles the statements the parser does not know about:
+   *   prepare <name> as <dml statement with ? placeholders>;
+   *   execute <name> [(<value>, ...)];
+   *   deallocate [prepare] <name>;
+   *   copy <table> from '<file>';
+   *   set parallel_workers = <n> | default;
+   *   set autovacuum = on | off;
+   *   set stats_file = '<file>' | off;  (the metrics are written to file every STATS_DUMP_INTERVAL_SECONDS)
+   *   vacuum [<table>];
+   *   create database <name> with page_size = <n>;  (n a power of two from MIN_PAGE_SIZE to MAX_PAGE_SIZE)
+   *   explain [analyze] <dml statement>;
+   *   show stats [<part of a metric name>];
+   * The time of every statement is recorded in the metrics registry by the kind of statement.
+   */
+  dberr_t ExecuteSql(const std::string &sql);
+
   /**
    * executor interface
    */
@@ -61,10 +88,84 @@ class ExecuteEngine {
   }
 
  private:
+  /** ExecuteSql without the timing */
+  dberr_t ExecuteStatement(const std::string &sql);
+
+  /** Parse and execute sql without going through the plan cache */
+  dberr_t ExecuteParsed(const std::string &sql);
+
+  /**
+   * @return the cached plan of tmpl, parsing and planning it on a miss. Returns nullptr on a syntax error
+   * (already reported by the parser), throws if the statement can not be planned. When a literal of tmpl
+   * does not become a parameter of the plan, returns nullptr and clears *parameterizable if it is given,
+   * throws otherwise.
+   */
+  PlanCache::Entry *GetCachedPlan(const SqlTemplate &tmpl, ExecuteContext *context, bool *parameterizable = nullptr);
+
+  /**
+   * Bind literals to the cached plan of tmpl and execute it. If sql is given (the statement tmpl was made from),
+   * a statement that can not be parameterized is run from sql without the plan cache.
+   */
+  dberr_t ExecuteTemplate(const SqlTemplate &tmpl, const std::vector<SqlLiteral> &literals,
+                          const std::string *sql = nullptr);
+
+  /** Run a planned dml statement and print its result */
+  dberr_t ExecuteQuery(const AbstractPlanNodeRef &plan, ExecuteContext *context,
+                       std::chrono::system_clock::time_point start_time);
+
+  dberr_t ExecutePrepare(const std::vector<SqlToken> &tokens);
+
+  dberr_t ExecuteExecute(const std::vector<SqlToken> &tokens);
+
+  dberr_t ExecuteDeallocate(const std::vector<SqlToken> &tokens);
+
+  /** Change a setting of the session: parallel_workers (the degree of parallelism), autovacuum or stats_file */
+  dberr_t ExecuteSet(const std::vector<SqlToken> &tokens);
+
+  /** Compact a table of the current database, or all of them, see CatalogManager::VacuumTable */
+  dberr_t ExecuteVacuum(const std::vector<SqlToken> &tokens);
+
+  /**
+   * Print the plan of a dml statement. With analyze the statement is executed and every executor reports the rows
+   * it returned, its Next calls, its time and the buffer pool, disk and memory work it did, its children included.
+   */
+  dberr_t ExecuteExplain(const std::vector<SqlToken> &tokens);
+
+  /** List the metrics of the process, those whose name contains the optional word only */
+  dberr_t ExecuteShowStats(const std::vector<SqlToken> &tokens);
+
+  /** Body of the autovacuum thread, vacuums the tables with many deletes while no statement runs */
+  void AutoVacuum();
+
+  void StopAutoVacuum();
+
+  /** Body of the stats thread, writes the metrics to file_name until stats_file is changed, and a last time then */
+  void DumpStats(const std::string &file_name);
+
+  void StopStatsDump();
+
+  /** @return a context on the current database carrying the settings of the session */
+  std::unique_ptr<ExecuteContext> MakeExecuteContext();
+
+  /**
+   * Bulk load a csv file (see CsvScanExecutor for the format) into a table.
+   * @param args the statement following the copy keyword
+   */
+  dberr_t ExecuteCopy(const std::string &args);
+
+  /** Build the executor tree of plan, wrapped for measuring when the context is analyzed */
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecuteContext *exec_ctx, const AbstractPlanNodeRef &plan);
 
+  static std::unique_ptr<AbstractExecutor> CreatePlanExecutor(ExecuteContext *exec_ctx,
+                                                              const AbstractPlanNodeRef &plan);
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
+  /** create database <name> with page_size = <n>, the page size is fixed for the life of the database */
+  dberr_t ExecuteCreateDatabase(const std::vector<SqlToken> &tokens);
+
+  dberr_t CreateDatabase(const std::string &db_name, uint32_t page_size);
+
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteShowDatabases(pSyntaxNode ast, ExecuteContext *context);
@@ -96,6 +197,21 @@ class ExecuteEngine {
  private:
   std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all opened databases */
   std::string current_db_;                                 /** current database */
+  PlanCache plan_cache_;                                   /** plans of dml statements, cleared by ddl */
+  std::unordered_map<std::string, SqlTemplate> prepared_;  /** prepared statements by name */
+  uint32_t parallel_workers_;                              /** degree of parallelism of the queries */
+  std::recursive_mutex latch_;                             /** held while a statement runs */
+  std::thread autovacuum_thread_;                          /** running while autovacuum is on */
+  std::mutex autovacuum_latch_;                            /** guards autovacuum_ */
+  std::condition_variable autovacuum_cv_;
+  bool autovacuum_{false};
+  std::thread stats_thread_;                               /** running while stats_file is set */
+  std::mutex stats_latch_;                                 /** guards stats_dump_ */
+  std::condition_variable stats_cv_;
+  bool stats_dump_{false};
+#ifdef ENABLE_PARSER_DEBUG
+  uint32_t syntax_tree_id_{0};
+#endif
 };
 
 #endif  // MINISQL_EXECUTE_ENGINE_H
@@ -0,0 +1,21 @@
+#ifndef MINISQL_EXECUTOR_STATS_H
+#define MINISQL_EXECUTOR_STATS_H
+
+#include <cstdint>
+
+#include "common/query_counters.h"
+
+/**
+ * What an executor did under EXPLAIN ANALYZE. The figures include the work of its children, the time of a delete
+ * contains the scan feeding it.
+ */
+struct ExecutorStats {
+  /** rows returned by Next */
+  uint64_t rows_{0};
+  uint64_t next_calls_{0};
+  /** wall time spent in Init and Next */
+  uint64_t time_ns_{0};
+  QueryCounters counters_;
+};
+
+#endif  // MINISQL_EXECUTOR_STATS_H
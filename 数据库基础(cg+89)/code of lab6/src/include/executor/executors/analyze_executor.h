@@ -0,0 +1,35 @@
+#ifndef MINISQL_ANALYZE_EXECUTOR_H
+#define MINISQL_ANALYZE_EXECUTOR_H
+
+#include <memory>
+
+#include "executor/execute_context.h"
+#include "executor/executor_stats.h"
+#include "executor/executors/abstract_executor.h"
+
+/**
+ * The AnalyzeExecutor wraps an executor of a query run by EXPLAIN ANALYZE. It passes Init and Next through and adds
+ * the rows, the calls, the time and the query counters of the thread they took to the ExecutorStats of the plan node.
+ */
+class AnalyzeExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new AnalyzeExecutor instance.
+   * @param exec_ctx The executor context
+   * @param child_executor The executor measured
+   * @param stats Where the figures of child_executor go
+   */
+  AnalyzeExecutor(ExecuteContext *exec_ctx, std::unique_ptr<AbstractExecutor> &&child_executor, ExecutorStats *stats);
+
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+  const Schema *GetOutputSchema() const override { return child_executor_->GetOutputSchema(); }
+
+ private:
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  ExecutorStats *stats_;
+};
+
+#endif  // MINISQL_ANALYZE_EXECUTOR_H
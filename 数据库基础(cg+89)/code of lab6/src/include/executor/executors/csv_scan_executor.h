@@ -0,0 +1,70 @@
+#ifndef MINISQL_CSV_SCAN_EXECUTOR_H
+#define MINISQL_CSV_SCAN_EXECUTOR_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/csv_scan_plan.h"
+
+/**
+ * The CsvScanExecutor streams rows out of a csv file.
+ *
+ * Records end with a newline (an optional \r before it is dropped), fields are separated by commas.
+ * A field may be quoted with double quotes, then it can contain commas and newlines and "" stands
+ * for a quote. An empty unquoted field is null, "" is an empty string.
+ */
+class CsvScanExecutor : public AbstractExecutor {
+ public:
+  CsvScanExecutor(ExecuteContext *exec_ctx, const CsvScanPlanNode *plan);
+
+  /** Open the file, throws if it can not be read */
+  void Init() override;
+
+  /**
+   * Yield the next record of the file.
+   * @param[out] row The next row, its fields are allocated from the row's heap
+   * @param[out] rid not used
+   * @return `true` if a row was produced, `false` at the end of the file
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+  /** @return next character of the file, EOF at the end */
+  inline int GetChar() {
+    if (pos_ == len_ && !FillBuffer()) {
+      return EOF;
+    }
+    return static_cast<unsigned char>(buffer_[pos_++]);
+  }
+
+  bool FillBuffer();
+
+  /**
+   * Read one field into field_.
+   * @return the character that ended the field: ',', '\n' or EOF
+   */
+  int ReadField(bool *quoted);
+
+  /** Convert field_ to a field of column idx and append it to row */
+  void AppendField(Row *row, uint32_t idx, bool quoted);
+
+  [[noreturn]] void Error(const std::string &msg) const;
+
+  const CsvScanPlanNode *plan_;
+  std::ifstream in_;
+  std::vector<char> buffer_;
+  size_t pos_{0};
+  size_t len_{0};
+  /** text of the field being read, reused across fields */
+  std::string field_;
+  uint32_t line_no_{0};
+};
+
+#endif  // MINISQL_CSV_SCAN_EXECUTOR_H
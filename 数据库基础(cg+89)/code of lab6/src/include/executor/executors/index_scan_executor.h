@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "common/rowid_bitmap.h"
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/index_scan_plan.h"
@@ -36,8 +37,17 @@ class IndexScanExecutor : public AbstractExecutor {
   bool is_Init;
  private:
 
+  /**
+   * Compute the RowIds matching expr with the indexes of the plan
+   * @return false if expr has no index to answer it
+   */
+  bool BuildBitmap(const AbstractExpressionRef &expr, RowIdBitmap &bitmap);
+
   /** The sequential scan plan node to be executed */
   const IndexScanPlanNode *plan_;
+  /** matching rows in page order */
   vector<RowId> result;
   uint32_t cursor{0};
+  /** search keys and the row being read, released after each row */
+  ArenaMemHeap row_heap_;
 };
\ No newline at end of file
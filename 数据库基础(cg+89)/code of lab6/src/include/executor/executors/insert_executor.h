@@ -12,7 +12,10 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. Rows are buffered and written in
+ * batches of BATCH_SIZE: the table heap is appended a page at a time and every index receives the
+ * batch sorted by key. A row that violates a unique index is taken back out of the table and the
+ * indexes that already hold it.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -42,9 +45,18 @@ class InsertExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  static constexpr size_t BATCH_SIZE = 1024;
+
+  /** Write the first count rows of batch_ to the table and its indexes */
+  void Flush(size_t count);
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
+  std::vector<IndexInfo *> indexes_;
+  /** fields of the buffered rows and their keys, released after each batch */
+  ArenaMemHeap batch_heap_;
+  std::vector<Row> batch_;
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -0,0 +1,63 @@
+#ifndef MINISQL_PARALLEL_SEQ_SCAN_EXECUTOR_H
+#define MINISQL_PARALLEL_SEQ_SCAN_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "executor/exchange.h"
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/parallel_seq_scan_plan.h"
+
+/**
+ * The ParallelSeqScanExecutor scans a table with several threads. The page directory of the
+ * table is cut into morsels of PARALLEL_SCAN_MORSEL_PAGES pages, a pipeline on the thread
+ * pool filters and projects the rows of each morsel and a Gather returns them in page order.
+ * A table smaller than PARALLEL_SCAN_MIN_PAGES when the scan starts is scanned by one serial
+ * SeqScanExecutor instead, the plan may be cached while the table grows or shrinks.
+ */
+class ParallelSeqScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new ParallelSeqScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The parallel sequential scan plan to be executed
+   */
+  ParallelSeqScanExecutor(ExecuteContext *exec_ctx, const ParallelSeqScanPlanNode *plan);
+
+  /** Start the pipeline */
+  void Init() override;
+
+  /**
+   * Yield the next row from the scan.
+   * @param[out] row The next row produced by the scan
+   * @param[out] rid The next row RID produced by the scan
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the scan */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+  /** @return whether a table of table_heap is large enough to be worth the threads */
+  static bool ScansInParallel(const TableHeap *table_heap);
+
+ private:
+  /** Filter and project the rows of a morsel, runs on the thread pool */
+  void ScanMorsel(size_t morsel, Gather::Batch *batch);
+
+  /** The parallel sequential scan plan node to be executed */
+  const ParallelSeqScanPlanNode *plan_;
+  /** pages of the table when the scan started */
+  std::vector<page_id_t> page_ids_;
+  ZoneMap::PageFilter page_filter_;
+  /** batch being returned by Next */
+  Gather::Batch batch_;
+  size_t cursor_{0};
+  /** the scan of a small table, nullptr when the pipeline runs */
+  std::unique_ptr<AbstractExecutor> serial_;
+  /** declared last, so the pipeline stops before the members it uses go away */
+  std::unique_ptr<Gather> gather_;
+};
+
+#endif  // MINISQL_PARALLEL_SEQ_SCAN_EXECUTOR_H
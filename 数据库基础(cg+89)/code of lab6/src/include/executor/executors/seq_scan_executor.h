@@ -37,6 +37,12 @@ class SeqScanExecutor : public AbstractExecutor {
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
+  /**
+   * @return a filter ruling out the pages of which no row can satisfy predicate, nullptr if the
+   * zone map can not tell anything about it
+   */
+  static ZoneMap::PageFilter MakePageFilter(const AbstractExpression *predicate, const ZoneMap &zone_map);
+
   bool is_Init;
 
  private:
@@ -5,6 +5,9 @@
 #ifndef MINISQL_UPDATE_EXECUTOR_H
 #define MINISQL_UPDATE_EXECUTOR_H
 
+#include <utility>
+#include <vector>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/update_plan.h"
@@ -51,12 +54,28 @@ class UpdateExecutor : public AbstractExecutor {
    */
   Row GenerateUpdatedTuple(const Row &src_row);
 
+  /**
+   * Move the entries of the row from the keys of old_row at its rid to the keys of new_row at its rid, in the indexes
+   * whose key columns are set or in every index when the row moved. On a unique conflict the indexes already changed
+   * are put back.
+   * @param[out] result why the new key could not be inserted, DB_INDEX_FULL when the index can not take it
+   * @return the index the new key conflicts in, nullptr when every index was updated
+   */
+  IndexInfo *UpdateIndexes(Row &old_row, Row &new_row, bool in_place, dberr_t *result);
+
+  /** Undo the delete marks of the rows from position from on, which were not moved yet */
+  void RollbackRelocations(const std::vector<std::pair<Row, Row>> &relocated, size_t from);
+
   /** The update plan node to be executed */
   const UpdatePlanNode *plan_;
-  /** Metadata identifying the table that should be updated */
+  /** The indexes of the table that should be updated */
   std::vector<IndexInfo *> index_info_;
+  /** Whether the update sets a key column of the index at the same position */
+  std::vector<bool> key_changed_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** fields of the row being updated and its keys, released after each row */
+  ArenaMemHeap row_heap_;
 };
 
 #endif  // MINISQL_UPDATE_EXECUTOR_H
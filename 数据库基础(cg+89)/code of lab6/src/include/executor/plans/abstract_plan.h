@@ -14,11 +14,13 @@
 /** PlanType represents the types of plans that we have in our system. */
 enum class PlanType {
   SeqScan,
+  ParallelSeqScan,
   IndexScan,
   Insert,
   Update,
   Delete,
   Values,
+  CsvScan,
   Aggregation,
   Limit,
   Distinct,
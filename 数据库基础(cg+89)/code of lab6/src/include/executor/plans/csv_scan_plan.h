@@ -0,0 +1,30 @@
+#ifndef MINISQL_CSV_SCAN_PLAN_H
+#define MINISQL_CSV_SCAN_PLAN_H
+
+#include <string>
+
+#include "abstract_plan.h"
+
+/**
+ * The CsvScanPlanNode reads rows from a csv file, it feeds the insert of `COPY table FROM 'file'`.
+ */
+class CsvScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new CsvScanPlanNode instance.
+   * @param output The schema of the rows in the file, one csv field per column
+   * @param file_name The file to read
+   */
+  CsvScanPlanNode(const Schema *output, std::string file_name)
+      : AbstractPlanNode(output, {}), file_name_(std::move(file_name)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::CsvScan; }
+
+  /** @return The file to read */
+  const std::string &GetFileName() const { return file_name_; }
+
+  std::string file_name_;
+};
+
+#endif  // MINISQL_CSV_SCAN_PLAN_H
@@ -6,9 +6,18 @@
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
 #include "planner/expressions/abstract_expression.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * The scan is a bitmap index scan: every comparison of the predicate answered by an index
+ * yields a RowIdBitmap, the bitmaps are combined along the AND/OR of the predicate and the
+ * table heap is visited in page order. An AND may leave out a side without index, an OR
+ * needs indexes on both sides.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -33,6 +42,55 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
 
+  /** @return The index answering `column op constant`, a hash index for "=" if there is one, nullptr if none */
+  IndexInfo *FindIndex(const AbstractExpressionRef &expr) const {
+    if (expr->GetType() != ExpressionType::ComparisonExpression ||
+        expr->GetChildAt(0)->GetType() != ExpressionType::ColumnExpression ||
+        expr->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression) {
+      return nullptr;
+    }
+    std::string op = std::dynamic_pointer_cast<ComparisonExpression>(expr)->GetComparisonType();
+    if (op != "=" && op != "<>" && op != "<" && op != "<=" && op != ">" && op != ">=") {
+      return nullptr;
+    }
+    uint32_t col_id = std::dynamic_pointer_cast<ColumnValueExpression>(expr->GetChildAt(0))->GetColIdx();
+    IndexInfo *found = nullptr;
+    for (auto index : indexes_) {
+      if (index->GetIndexKeySchema()->GetColumn(0)->GetTableInd() != col_id) {
+        continue;
+      }
+      // hash index only answers equality, and answers it with a single bucket read
+      if (index->GetIndexType() == "hash") {
+        if (op == "=") {
+          return index;
+        }
+      } else if (found == nullptr) {
+        found = index;
+      }
+    }
+    return found;
+  }
+
+  /**
+   * @return Whether the rows matching expr can be found with the indexes
+   * @param exact set to false if the rows found have to be checked against the predicate
+   */
+  bool CanUseIndexes(const AbstractExpressionRef &expr, bool &exact) const {
+    if (expr->GetType() == ExpressionType::LogicExpression) {
+      bool left_exact = true;
+      bool right_exact = true;
+      bool left = CanUseIndexes(expr->GetChildAt(0), left_exact);
+      bool right = CanUseIndexes(expr->GetChildAt(1), right_exact);
+      if (std::dynamic_pointer_cast<LogicExpression>(expr)->logic_type_ == LogicType::Or) {
+        exact = exact && left_exact && right_exact;
+        return left && right;
+      }
+      exact = exact && left && right && left_exact && right_exact;
+      return left || right;
+    }
+    return FindIndex(expr) != nullptr;
+  }
+
   /** The table name */
   std::string table_name_;
 
@@ -0,0 +1,28 @@
+#ifndef MINISQL_PARALLEL_SEQ_SCAN_PLAN_H
+#define MINISQL_PARALLEL_SEQ_SCAN_PLAN_H
+
+#include "executor/plans/seq_scan_plan.h"
+
+/**
+ * A sequential scan split over worker threads by the page directory of the table. The rows
+ * come out in the order of a plain SeqScanPlanNode.
+ */
+class ParallelSeqScanPlanNode : public SeqScanPlanNode {
+ public:
+  /**
+   * @param worker_count The number of threads scanning the table
+   */
+  ParallelSeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate,
+                          uint32_t worker_count)
+      : SeqScanPlanNode(output, std::move(table_name), std::move(filter_predicate)), worker_count_(worker_count) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::ParallelSeqScan; }
+
+  uint32_t GetWorkerCount() const { return worker_count_; }
+
+  /** The number of threads scanning the table */
+  uint32_t worker_count_;
+};
+
+#endif  // MINISQL_PARALLEL_SEQ_SCAN_PLAN_H
@@ -0,0 +1,162 @@
+#ifndef MINISQL_ADAPTIVE_RADIX_TREE_H
+#define MINISQL_ADAPTIVE_RADIX_TREE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+
+/**
+ * In-memory adaptive radix tree, the container of ArtIndex (CREATE INDEX ... USING art).
+ *
+ * Keys are the binary comparable bytes of GenericKey (see KeyManager), the tree
+ * orders them like memcmp. No key may be a prefix of another one, which the key
+ * encoding guarantees: every field is fixed length or terminated.
+ * (1) Inner nodes grow and shrink between 4, 16, 48 and 256 children, Node16 is
+ *     searched with SSE2 where it is available
+ * (2) A chain of nodes with a single child is compressed into the prefix of the
+ *     node below it. Only the first MAX_PREFIX_LENGTH bytes of a prefix are kept,
+ *     the rest is read from a leaf of the node when needed
+ * (3) Leaves hold the whole key and the RowId
+ */
+class AdaptiveRadixTree {
+ public:
+  AdaptiveRadixTree() = default;
+
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY(AdaptiveRadixTree)
+
+  inline bool IsEmpty() const { return root_ == nullptr; }
+
+  inline size_t GetSize() const { return size_; }
+
+  // Insert a key-value pair, false if the key exists.
+  bool Insert(const char *key, int length, const RowId &value);
+
+  // Remove a key and its value, false if the key does not exist.
+  bool Remove(const char *key, int length);
+
+  bool GetValue(const char *key, int length, RowId &value) const;
+
+  // Append the values of the keys between lower and upper to result in key order, nullptr for no bound.
+  void Scan(const char *lower, int lower_length, bool lower_inclusive, const char *upper, int upper_length,
+            bool upper_inclusive, std::vector<RowId> &result) const;
+
+  void Clear();
+
+ private:
+  static constexpr int MAX_PREFIX_LENGTH = 10;
+
+  enum class NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+  struct Node {
+    NodeType type;
+    uint16_t count{0};
+    uint32_t prefix_length{0};
+    uint8_t prefix[MAX_PREFIX_LENGTH];
+
+    explicit Node(NodeType node_type) : type(node_type) {}
+  };
+
+  struct Node4 : Node {
+    uint8_t keys[4];
+    Node *children[4];
+    Node4() : Node(NodeType::NODE4) {}
+  };
+
+  struct Node16 : Node {
+    uint8_t keys[16];
+    Node *children[16];
+    Node16() : Node(NodeType::NODE16) {}
+  };
+
+  // child_index[byte] is 1 + the slot of the child in children, 0 if there is none
+  struct Node48 : Node {
+    uint8_t child_index[256];
+    Node *children[48];
+    Node48() : Node(NodeType::NODE48) {
+      memset(child_index, 0, sizeof(child_index));
+      memset(children, 0, sizeof(children));
+    }
+  };
+
+  struct Node256 : Node {
+    Node *children[256];
+    Node256() : Node(NodeType::NODE256) { memset(children, 0, sizeof(children)); }
+  };
+
+  struct Leaf {
+    RowId value;
+    uint16_t length;
+    uint8_t key[0];
+  };
+
+  /** a child pointer with the lowest bit set is a leaf */
+  static inline bool IsLeaf(const Node *node) { return reinterpret_cast<uintptr_t>(node) & 1; }
+
+  static inline Leaf *AsLeaf(const Node *node) {
+    return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(node) & ~static_cast<uintptr_t>(1));
+  }
+
+  static inline Node *LeafNode(Leaf *leaf) {
+    return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(leaf) | 1);
+  }
+
+  static Leaf *NewLeaf(const uint8_t *key, int length, const RowId &value);
+
+  static bool LeafMatches(const Leaf *leaf, const uint8_t *key, int length);
+
+  // the leftmost leaf below node
+  static const Leaf *Minimum(const Node *node);
+
+  static Node *const *FindChild(const Node *node, uint8_t byte);
+
+  static inline Node **FindChild(Node *node, uint8_t byte) {
+    return const_cast<Node **>(FindChild(static_cast<const Node *>(node), byte));
+  }
+
+  // bytes of the prefix of node matching key from depth on, only the stored bytes are compared
+  static int CheckPrefix(const Node *node, const uint8_t *key, int length, int depth);
+
+  // bytes of the prefix of node matching key from depth on, the whole prefix is compared
+  static int PrefixMismatch(const Node *node, const uint8_t *key, int length, int depth);
+
+  // add a child to node, node is replaced by a larger node in *ref when it is full
+  static void AddChild(Node *node, Node **ref, uint8_t byte, Node *child);
+
+  // remove the child in slot of node, node is replaced by a smaller node in *ref when it gets sparse
+  static void RemoveChild(Node *node, Node **ref, uint8_t byte, Node **slot);
+
+  // copy the header and the prefix of from into to
+  static void CopyHeader(Node *to, const Node *from);
+
+  bool InsertAt(Node **ref, const uint8_t *key, int length, int depth, const RowId &value);
+
+  bool RemoveAt(Node **ref, const uint8_t *key, int length, int depth);
+
+  struct ScanBounds {
+    const uint8_t *lower;
+    int lower_length;
+    bool lower_inclusive;
+    const uint8_t *upper;
+    int upper_length;
+    bool upper_inclusive;
+  };
+
+  /**
+   * In order walk of the subtree of node, on_lower (on_upper) tells whether the path to node
+   * equals the lower (upper) bound so far, only then the bound has to be checked below.
+   */
+  static void ScanAt(const Node *node, int depth, bool on_lower, bool on_upper, const ScanBounds &bounds,
+                     std::vector<RowId> &result);
+
+  static void FreeNode(Node *node);
+
+  Node *root_{nullptr};
+  size_t size_{0};
+};
+
+#endif  // MINISQL_ADAPTIVE_RADIX_TREE_H
@@ -0,0 +1,44 @@
+#ifndef MINISQL_ART_INDEX_H
+#define MINISQL_ART_INDEX_H
+
+#include "index/adaptive_radix_tree.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index backed by an in-memory adaptive radix tree (CREATE INDEX ... USING art), for
+ * point and range lookups on tables that fit in memory. Supports the same operators
+ * as the B+ tree index. Nothing is written to disk, the catalog rebuilds the tree
+ * from the table every time the database is opened.
+ */
+class ArtIndex : public Index {
+ public:
+  /**
+   * @param unique false for a secondary index on columns with duplicates, the key size must
+   * then include room for the RowId appended to every key
+   */
+  ArtIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                  std::string compare_operator = "=") override;
+
+  dberr_t Destroy() override;
+
+ private:
+  /** Serialize key into key_buf_, with the RowId of a non-unique index */
+  GenericKey *MakeKey(const Row &key, const RowId &row_id);
+
+  void Scan(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive,
+            std::vector<RowId> &result) const;
+
+  KeyManager processor_;
+  std::vector<char> key_buf_;
+  std::vector<char> upper_buf_;
+  AdaptiveRadixTree container_;
+};
+
+#endif  // MINISQL_ART_INDEX_H
@@ -20,6 +20,12 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Keys are byte strings of variable length (see KeyManager). Pages hold as many
+ * of them as their bytes allow unless the max sizes given cap the number of
+ * pairs, a page is split before an insertion it has no room for and merged
+ * with a sibling when both fit into one page. Internal pages keep the shortest
+ * separator between two leaves instead of a full key.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -27,7 +33,7 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = 100, int internal_max_size = 100);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -35,6 +41,10 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
+  // Insert key-value pairs sorted by key, inserted[i] tells whether keys[i] was inserted.
+  void InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                   std::vector<bool> &inserted, Transaction *transaction = nullptr);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
@@ -56,13 +66,16 @@ class BPlusTree {
   // destroy the b plus tree
   void Destroy(page_id_t current_page_id = INVALID_PAGE_ID);
 
+  // destroy a b plus tree written with fixed size pairs before pages were slotted
+  void DestroyLegacy(page_id_t current_page_id = INVALID_PAGE_ID);
+
   void PrintTree(std::ofstream &out) {
     if (IsEmpty()) {
       return;
     }
     out << "digraph G {" << std::endl;
     Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-    auto *node = reinterpret_cast<BPlusTreePage *>(root_page);
+    auto *node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
     ToGraph(node, buffer_pool_manager_, out);
     out << "}" << std::endl;
   }
@@ -72,12 +85,16 @@ class BPlusTree {
 
   bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
+  bool LeafCovers(LeafPage *leaf, const GenericKey *key);
+
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
+  LeafPage *SplitForInsert(LeafPage *leaf, const GenericKey *key, Transaction *transaction);
+
   LeafPage *Split(LeafPage *node, Transaction *transaction);
 
-  InternalPage *Split(InternalPage *node, Transaction *transaction);
+  InternalPage *Split(InternalPage *node, GenericKey *middle_key, Transaction *transaction);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
@@ -101,6 +118,8 @@ class BPlusTree {
 
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
+  static std::string KeyToString(const GenericKey *key);
+
   // member variable
   index_id_t index_id_;
   page_id_t root_page_id_{INVALID_PAGE_ID};
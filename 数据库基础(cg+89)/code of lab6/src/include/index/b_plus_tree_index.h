@@ -7,22 +7,44 @@
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param unique false for a secondary index on columns with duplicates, the key size must
+   * then include room for the RowId appended to every key
+   */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  /**
+   * Sort the batch by key and insert it in order, consecutive keys mostly land in the leaf
+   * that is already pinned (see BPlusTree::InsertBatch)
+   */
+  void InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, std::vector<dberr_t> &results,
+                     Transaction *txn) override;
+
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
 
   dberr_t Destroy() override;
 
+  // free the pages of a tree written before pages were slotted, see BPlusTree::DestroyLegacy
+  dberr_t DestroyLegacy();
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
 
   IndexIterator GetEndIterator();
 
+ private:
+  // first entry whose key columns are not less than those of key
+  IndexIterator LowerBound(GenericKey *key);
+
+  // first entry whose key columns are greater than those of key
+  IndexIterator UpperBound(GenericKey *key);
+
  public:
   // comparator for key
   KeyManager processor_;
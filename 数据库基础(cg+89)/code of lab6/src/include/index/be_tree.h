@@ -0,0 +1,128 @@
+#ifndef MINISQL_BE_TREE_H
+#define MINISQL_BE_TREE_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/be_tree_internal_page.h"
+#include "page/be_tree_leaf_page.h"
+#include "transaction/transaction.h"
+
+/**
+ * Disk based Bε-tree, the container of BeTreeIndex (CREATE INDEX ... USING betree).
+ *
+ * Inserts and deletes are queued as messages in the buffer of the root. When a
+ * buffer is full the largest batch of messages for one child is moved down in
+ * one go, so a leaf is rewritten once per batch instead of once per key. Point
+ * and range queries merge the messages pending on their way down, a message
+ * always being newer than those below it.
+ * (1) Keys are unique, a non-unique index makes them so with a RowId suffix
+ * (2) Pages split when a flush overfills them; leaves left empty are dropped,
+ *     pages are never merged
+ * (3) No leaf chain, range queries walk the subtrees covering the range
+ */
+class BeTree {
+  using InternalPage = BeTreeInternalPage;
+  using LeafPage = BeTreeLeafPage;
+
+ public:
+  explicit BeTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator);
+
+  // Returns true if this tree has no root page yet.
+  inline bool IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+  // Insert a key-value pair, false if the key exists. Keys of a non-unique
+  // index carry their RowId and are inserted without looking them up.
+  bool Insert(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  // Queue the removal of a key, whether it exists or not.
+  void Remove(const GenericKey *key, Transaction *transaction = nullptr);
+
+  // Append the value of key to result, false if the key does not exist.
+  bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  // Append the values of the keys between lower and upper to result in key order, nullptr for no bound.
+  void GetRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive,
+                std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  // Release all pages of the tree.
+  void Destroy();
+
+ private:
+  /** key images (length and bytes of a GenericKey) ordered like the keys */
+  struct KeyLess {
+    bool operator()(const std::string &lhs, const std::string &rhs) const;
+  };
+
+  struct Message {
+    std::string key;
+    RowId value;
+    bool is_delete;
+  };
+
+  /** an internal page read into memory, so that it can overflow before it is written back */
+  struct Node {
+    page_id_t page_id;
+    std::vector<std::string> pivots;  // pivots[0] is unused
+    std::vector<page_id_t> children;
+    std::vector<Message> buffer;
+  };
+
+  /** right siblings created by a split, with the smallest key each of them holds */
+  using Siblings = std::vector<std::pair<std::string, page_id_t>>;
+
+  static inline std::string KeyImage(const GenericKey *key) {
+    return std::string(reinterpret_cast<const char *>(key), sizeof(uint16_t) + key->GetLength());
+  }
+
+  static inline const GenericKey *AsKey(const std::string &image) {
+    return reinterpret_cast<const GenericKey *>(image.data());
+  }
+
+  void Put(const GenericKey *key, const RowId &value, bool is_delete);
+
+  void StartNewTree();
+
+  // make a new root above the root and its siblings
+  void NewRoot(Siblings &siblings);
+
+  void UpdateRootPageId(bool insert_record);
+
+  void ReadNode(const InternalPage *page, Node &node) const;
+
+  // write node back to its page, splitting it into siblings when it has too many children
+  void WriteNode(Node &node, Siblings &siblings);
+
+  // move batches of messages down until at most target messages are left in the buffer of node
+  void FlushNode(Node &node, size_t target);
+
+  /**
+   * Apply a sorted batch of messages to the subtree at page_id.
+   * @return false if page_id is a leaf left empty
+   */
+  bool PushDown(page_id_t page_id, std::vector<Message> &batch, Siblings &siblings);
+
+  bool ApplyToLeaf(LeafPage *leaf, std::vector<Message> &batch, Siblings &siblings);
+
+  // merge the sorted messages of newer into older, a newer message replaces an older one of the same key
+  static void MergeMessages(std::vector<Message> &older, std::vector<Message> &newer);
+
+  void Collect(page_id_t page_id, const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+               bool upper_inclusive, std::map<std::string, RowId, KeyLess> &pairs);
+
+  void DestroyPage(page_id_t page_id);
+
+ private:
+  index_id_t index_id_;
+  page_id_t root_page_id_{INVALID_PAGE_ID};
+  BufferPoolManager *buffer_pool_manager_;
+  KeyManager processor_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  int buffer_max_size_;
+};
+
+#endif  // MINISQL_BE_TREE_H
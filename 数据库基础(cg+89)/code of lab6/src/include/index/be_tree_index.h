@@ -0,0 +1,39 @@
+#ifndef MINISQL_BE_TREE_INDEX_H
+#define MINISQL_BE_TREE_INDEX_H
+
+#include "index/be_tree.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index backed by a Bε-tree (CREATE INDEX ... USING betree), for tables that take
+ * many more inserts than queries. Supports the same operators as the B+ tree index.
+ */
+class BeTreeIndex : public Index {
+ public:
+  /**
+   * @param unique false for a secondary index on columns with duplicates, the key size must
+   * then include room for the RowId appended to every key
+   */
+  BeTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+              bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  dberr_t Destroy() override;
+
+ private:
+  /** Serialize key into key_buf_, with the RowId of a non-unique index */
+  GenericKey *MakeKey(const Row &key, const RowId &row_id);
+
+  KeyManager processor_;
+  std::vector<char> key_buf_;
+  std::vector<char> upper_buf_;
+  BeTree container_;
+};
+
+#endif  // MINISQL_BE_TREE_INDEX_H
@@ -0,0 +1,84 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/dberr.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "transaction/transaction.h"
+
+/**
+ * Disk based extendible hash table, the container of HashIndex.
+ *
+ * Keys are compared byte for byte, so they must be serialized into zeroed buffers of key_size bytes.
+ * The directory is kept in memory and written through to its pages whenever a bucket splits or merges,
+ * a point lookup only fetches the bucket page.
+ * (1) We only support unique key
+ * (2) A full bucket splits, doubling the directory when needed
+ * (3) An empty bucket merges with its split image, halving the directory when possible
+ */
+class ExtendibleHashTable {
+ public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager, int key_size);
+
+  // Returns true if this hash table has no directory yet.
+  inline bool IsEmpty() const { return directory_page_id_ == INVALID_PAGE_ID; }
+
+  // Insert a key-value pair. Returns DB_FAILED if the key exists, DB_INDEX_FULL if its bucket is full and
+  // can not be split any more.
+  dberr_t Insert(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  // Remove a key if it is stored with value, false if the key does not exist or has another value.
+  bool Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  // Append the value of key to result, false if the key does not exist.
+  bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  // Release all pages of the hash table.
+  void Destroy();
+
+  inline uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  static uint32_t Hash(const GenericKey *key, int key_size);
+
+ private:
+  void StartNewTable();
+
+  void LoadDirectory();
+
+  // Write the dirty directory slots and the directory page back to their pages.
+  void FlushDirectory();
+
+  inline void MarkSlotDirty(uint32_t slot) { dirty_blocks_[slot / HashTableDirectoryBlockPage::SLOTS_PER_BLOCK] = true; }
+
+  inline uint32_t SlotOf(uint32_t hash) const { return hash & ((1u << global_depth_) - 1); }
+
+  bool GrowDirectory();
+
+  void ShrinkDirectory();
+
+  // Split the full bucket of slot, the caller keeps bucket pinned.
+  bool SplitBucket(uint32_t slot, HashTableBucketPage *bucket);
+
+  // Merge the empty bucket of slot into its split image, repeatedly while the image is empty too.
+  void MergeBucket(uint32_t slot);
+
+  HashTableBucketPage *FetchBucket(page_id_t page_id);
+
+ private:
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  int key_size_;
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+  bool directory_dirty_{false};
+  uint32_t global_depth_{0};
+  /** in memory copy of the directory, indexed by slot */
+  std::vector<page_id_t> bucket_page_ids_;
+  std::vector<uint32_t> local_depths_;
+  std::vector<page_id_t> block_page_ids_;
+  std::vector<bool> dirty_blocks_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
@@ -1,13 +1,40 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
 #include <cstring>
 
 #include "record/field.h"
 #include "record/row.h"
 
+/**
+ * Index key, an order preserving encoding of the key row so that keys compare with memcmp
+ * and any prefix of a key is still a valid key (B+ tree pages elide common prefixes and
+ * keep truncated separators).
+ *
+ * Key format (size in byte):
+ *  --------------------------------------------------
+ * | Length (2) | Field(1) | ... | Field(n) | RowId |
+ *  --------------------------------------------------
+ * Each field starts with 0x00 if it is null, 0x01 otherwise, followed by
+ *  int:   big endian with the sign bit flipped
+ *  float: big endian, all bits flipped if negative, the sign bit flipped otherwise
+ *  char:  the data with 0x00 escaped as 0x00 0x01, terminated by 0x00 0x00
+ * Only keys of non-unique index end with the RowId, big endian with the sign bit of the page id flipped.
+ */
 class GenericKey {
   friend class KeyManager;
+
+ public:
+  inline uint16_t GetLength() const { return MACH_READ_FROM(uint16_t, data); }
+
+  inline void SetLength(uint16_t length) { MACH_WRITE_TO(uint16_t, data, length); }
+
+  inline const char *GetBytes() const { return data + sizeof(uint16_t); }
+
+  inline char *GetBytes() { return data + sizeof(uint16_t); }
+
+ private:
   char data[0];
 };
 
@@ -17,66 +44,86 @@ class KeyManager {
     return (GenericKey *)malloc(key_size_);  // remember delete
   }
 
-  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
-    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
-    //memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+  void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const;
+
+  void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const;
+
+  /**
+   * Keys of a non-unique index end with the RowId of their row, which makes every key unique
+   * and keeps duplicates ordered by RowId. SerializeFromKey leaves room for it.
+   */
+  void SetKeyRowId(GenericKey *key_buf, const RowId &rid) const;
+
+  RowId GetKeyRowId(const GenericKey *key_buf) const;
+
+  // compare, the RowId suffix breaks ties for non-unique index
+  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+    return CompareBytes(lhs->GetBytes(), lhs->GetLength(), rhs->GetBytes(), rhs->GetLength());
+  }
+
+  // compare the key columns only
+  [[nodiscard]] inline int CompareKeyFields(const GenericKey *lhs, const GenericKey *rhs) const {
+    int suffix = unique_ ? 0 : sizeof(RowId);
+    return CompareBytes(lhs->GetBytes(), lhs->GetLength() - suffix, rhs->GetBytes(), rhs->GetLength() - suffix);
   }
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  static inline int CompareBytes(const char *lhs, int lhs_len, const char *rhs, int rhs_len) {
+    int res = memcmp(lhs, rhs, std::min(lhs_len, rhs_len));
+    if (res != 0) {
+      return res;
+    }
+    return lhs_len - rhs_len;
   }
 
-  // compare
-  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-          delete lhs_value->GetData();
-          delete rhs_value->GetData();
-        }
-        return -1;
-      }
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-          delete lhs_value->GetData();
-          delete rhs_value->GetData();
-        }
-        return 1;
-      }
+  /**
+   * The first 4 bytes of an encoded key, or of its part after a page prefix, as a big endian
+   * integer padded with 0. Heads order like the bytes they come from: keys with different heads
+   * compare like their heads, only keys with the same head need to be compared in full.
+   */
+  static inline uint32_t KeyHead(const char *bytes, int length) {
+    uint32_t head = 0;
+    for (int i = 0; i < static_cast<int>(sizeof(uint32_t)); i++) {
+      head = (head << 8) | (i < length ? static_cast<uint8_t>(bytes[i]) : 0);
+    }
+    return head;
+  }
+
+  static inline int CommonPrefixLength(const char *lhs, int lhs_len, const char *rhs, int rhs_len) {
+    int len = std::min(lhs_len, rhs_len);
+    int i = 0;
+    while (i < len && lhs[i] == rhs[i]) {
+      i++;
     }
-    // equals
-    return 0;
+    return i;
   }
 
+  /**
+   * The shortest key s with lhs < s <= rhs, the prefix of rhs one byte past their common prefix.
+   * Used as separator in internal pages, it is not a key of any row.
+   */
+  static void ShortestSeparator(const GenericKey *lhs, const GenericKey *rhs, GenericKey *separator);
+
+  // bytes needed by the key of a row of key_schema in the worst case, the length included
+  static int GetMaxKeySize(Schema *key_schema, bool unique);
+
   inline int GetKeySize() const { return key_size_; }
 
+  inline bool IsUnique() const { return unique_; }
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->unique_ = other.unique_;
   }
 
   // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  KeyManager(Schema *key_schema, size_t key_size, bool unique = true)
+      : key_size_(key_size), key_schema_(key_schema), unique_(unique) {}
 
 public:
   int key_size_;
   Schema *key_schema_;
+  bool unique_;
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -0,0 +1,41 @@
+#ifndef MINISQL_HASH_INDEX_H
+#define MINISQL_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index backed by an extendible hash table, for equality lookups only (CREATE INDEX ... USING hash).
+ */
+class HashIndex : public Index {
+ public:
+  HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * @return DB_FAILED if the key exists, DB_INDEX_FULL if the hash table can not grow to take it
+   */
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  /**
+   * Remove key only if it is indexed at row_id
+   */
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  /**
+   * Only the "=" operator is supported, other operators return DB_FAILED and leave result untouched
+   */
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  dberr_t Destroy() override;
+
+ private:
+  /** Serialize key into key_buf_, zero padded so that equal keys are equal byte for byte */
+  GenericKey *MakeKey(const Row &key);
+
+  KeyManager processor_;
+  std::vector<char> key_buf_;
+  ExtendibleHashTable container_;
+};
+
+#endif  // MINISQL_HASH_INDEX_H
@@ -2,6 +2,7 @@
 #define MINISQL_INDEX_H
 
 #include <memory>
+#include <string>
 
 #include "common/dberr.h"
 #include "record/row.h"
@@ -15,10 +16,22 @@ class Index {
 
   virtual dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Insert a batch of entries, results[i] is set to the status of inserting keys[i].
+   * Indexes override this when inserting a whole batch is cheaper than one entry at a time.
+   */
+  virtual void InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                             std::vector<dberr_t> &results, Transaction *txn) {
+    results.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      results[i] = InsertEntry(keys[i], row_ids[i], txn);
+    }
+  }
+
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
-                          string compare_operator = "=") = 0;
+                          std::string compare_operator = "=") = 0;
 
   virtual dberr_t Destroy() = 0;
 
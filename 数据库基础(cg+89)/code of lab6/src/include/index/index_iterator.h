@@ -1,6 +1,8 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator {
@@ -12,9 +14,20 @@ class IndexIterator {
 
   explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
 
+  // the iterator owns a pin of its leaf page, so it can be moved but not copied
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
+  IndexIterator(const IndexIterator &other) = delete;
+
   ~IndexIterator();
 
-  /** Return the key/value pair this iterator is currently pointing at. */
+  /**
+   * Return the key/value pair this iterator is currently pointing at.
+   * Keys are stored compressed in the page, the key returned is a copy that
+   * stays valid until the next call.
+   */
   std::pair<GenericKey *, RowId> operator*();
 
   /** Move to the next key/value pair.*/
@@ -31,6 +44,7 @@ class IndexIterator {
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
+  std::vector<char> key_buf;
   // add your own private member variables here
 };
 
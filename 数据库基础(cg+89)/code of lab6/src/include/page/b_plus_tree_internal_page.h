@@ -4,12 +4,13 @@
 #include <string.h>
 
 #include <queue>
+#include <string>
+#include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(std::pair<GenericKey *, page_id_t>)) - 1)
+#define INTERNAL_PAGE_HEADER_SIZE 36
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -18,21 +19,40 @@
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
- * 
+ * Keys are separators of variable length, often shorter than the keys of the
+ * leaves (see KeyManager::ShortestSeparator). As in leaf pages the slots are
+ * stored at the front of the page, the key bytes in a heap growing down from
+ * the end of the page, and the prefix shared by all keys only once. The first
+ * slot has no key bytes. The slots are preceded by the dense array of key heads
+ * searched first, the head of the first slot is unused.
+ *
+ * Internal page format:
+ *  ------------------------------------------------------------------------------------------------------
+ * | HEADER | HEAD(0) ... HEAD(n) | SLOT(0) ... SLOT(n) | FREE SPACE | KEY(n) ... KEY(1) | PREFIX |
+ *  ------------------------------------------------------------------------------------------------------
+ *  Slot format (size in byte, 8 bytes in total):
+ *  --------------------------------------------------
+ * | KeyOffset (2) | KeyLength (2) | PAGE_ID (4) |
+ *  --------------------------------------------------
+ *  Header is the BPlusTreePage header followed by PrefixLength (2) and HeapTop (2),
+ *  36 bytes in total.
  */
 class BPlusTreeInternalPage : public BPlusTreePage {
+  struct Slot {
+    uint16_t key_offset_;
+    uint16_t key_length_;
+    page_id_t value_;
+  };
+
  public:
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-            int max_size = UNDEFINED_SIZE);
+            int max_size = UNDEFINED_SIZE, uint32_t page_size = DEFAULT_PAGE_SIZE);
 
-  GenericKey *KeyAt(int index);
+  // copy the whole key at index into key, which must hold GetKeySize() bytes
+  void KeyAt(int index, GenericKey *key) const;
 
-  void SetKeyAt(int index, GenericKey *key);
+  void SetKeyAt(int index, const GenericKey *key);
 
   int ValueIndex(const page_id_t &value) const;
 
@@ -40,41 +60,91 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void SetValueAt(int index, page_id_t value);
 
-  void *PairPtrAt(int index);
+  // whether key fits into the page, in place of the key at replace_index if it is not -1
+  bool HasRoomFor(const GenericKey *key, int replace_index = -1) const;
+
+  // bytes taken by the slots, the keys and the prefix
+  int GetUsedBytes() const;
+
+  // less than a quarter of the page is used, or less than min size children if the size is capped
+  bool IsUnderflow() const;
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
+  // whether all children of left and right fit into one page, with middle_key in between
+  static bool FitsMerged(const BPlusTreeInternalPage *left, const GenericKey *middle_key,
+                         const BPlusTreeInternalPage *right);
 
-  page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
+  page_id_t Lookup(const GenericKey *key, const KeyManager &KP) const;
 
-  void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  void PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
-  int InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  int InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
   void Remove(int index);
 
   page_id_t RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
+                 BufferPoolManager *buffer_pool_manager);
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  // the first key of the moved half goes up to the parent, it is copied into middle_key
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
 
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
                         BufferPoolManager *buffer_pool_manager);
 
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
+  inline uint32_t *Heads() { return reinterpret_cast<uint32_t *>(data_); }
+
+  inline const uint32_t *Heads() const { return reinterpret_cast<const uint32_t *>(data_); }
+
+  // the slots follow the heads, they move whenever the size changes
+  inline Slot *SlotAt(int index) { return reinterpret_cast<Slot *>(data_ + GetSize() * sizeof(uint32_t)) + index; }
+
+  inline const Slot *SlotAt(int index) const {
+    return reinterpret_cast<const Slot *>(data_ + GetSize() * sizeof(uint32_t)) + index;
+  }
+
+  // bytes taken by the heads and the slots of count children
+  static inline int SlotBytes(int count) { return count * (sizeof(uint32_t) + sizeof(Slot)); }
 
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+  // bytes behind the header, the page size comes from the header
+  inline int DataSize() const { return static_cast<int>(GetPageSize()) - INTERNAL_PAGE_HEADER_SIZE; }
 
-  void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
+  inline const char *PrefixPtr() const { return data_ + DataSize() - prefix_length_; }
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
+  // bytes a page takes to hold count children whose keys take key_bytes bytes and share a prefix
+  static int BytesFor(int count, int key_bytes, int prefix_length);
 
+  // total length of the keys, the prefix counted for each of them
+  int GetKeyBytes() const;
+
+  std::string CopyKey(int index) const;
+
+  // copy all pairs out of the page, the first key is empty
+  void CopyOut(std::vector<std::string> &keys, std::vector<page_id_t> &values) const;
+
+  // clear the page and store the pairs, with the longest common prefix of the keys
+  void Rebuild(const std::vector<std::string> &keys, const std::vector<page_id_t> &values);
+
+  // insert a keyed pair at index > 0
+  void InsertAt(int index, const GenericKey *key, page_id_t value);
+
+  // make room for a pair at index in the heads and the slots, the size grows by one
+  Slot *InsertSlotAt(int index);
+
+  // set the parent page id of the children in [begin, end) to this page
+  void AdoptChildren(int begin, int end, BufferPoolManager *buffer_pool_manager);
+
+  uint16_t prefix_length_;
+  uint16_t heap_top_;
+  char data_[0];
 };
 
 using InternalPage = BPlusTreeInternalPage;
+
+static_assert(sizeof(InternalPage) == INTERNAL_PAGE_HEADER_SIZE);
 #endif  // MINISQL_B_PLUS_TREE_INTERNAL_PAGE_H
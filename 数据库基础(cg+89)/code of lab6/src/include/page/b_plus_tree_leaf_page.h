@@ -6,64 +6,92 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
-
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * page. Keys are unique, a non-unique index makes them so with a RowId suffix.
+ *
+ * Keys have variable length. The slots are stored in order at the front of the
+ * page, the key bytes in a heap growing down from the end of the page. The
+ * prefix shared by all keys of the page is stored once, behind the heap, and
+ * only the rest of each key is kept in the heap.
+ *
+ * The slots are preceded by the heads of the keys, the first 4 bytes after
+ * the prefix as integers (see KeyManager::KeyHead). A search runs over this
+ * dense array and only reads the keys in the heap whose head equals the head
+ * of the key searched for.
  *
- *  Header format (size in byte, 24 bytes in total):
+ * Leaf page format:
+ *  ------------------------------------------------------------------------------------------------------
+ * | HEADER | HEAD(1) ... HEAD(n) | SLOT(1) ... SLOT(n) | FREE SPACE | KEY(n) ... KEY(1) | PREFIX |
+ *  ------------------------------------------------------------------------------------------------------
+ *  Slot format (size in byte, 12 bytes in total):
+ *  --------------------------------------------------------
+ * | KeyOffset (2) | KeyLength (2) | RID (8) |
+ *  --------------------------------------------------------
+ *
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  -------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | PageSize (4) | NextPageId (4) | PrefixLength (2) | HeapTop (2)
+ *  -------------------------------------------------------------------------------------------------
+ *  MaxSize caps the number of pairs when it is not UNDEFINED_SIZE, otherwise
+ *  the page holds as many pairs as its bytes allow.
  */
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey *, page_id_t>)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 40
 
 class BPlusTreeLeafPage : public BPlusTreePage {
+  struct Slot {
+    uint16_t key_offset_;
+    uint16_t key_length_;
+    RowId value_;
+  };
+
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-            int max_size = UNDEFINED_SIZE);
+            int max_size = UNDEFINED_SIZE, uint32_t page_size = DEFAULT_PAGE_SIZE);
 
   // helper methods
   page_id_t GetNextPageId() const;
 
   void SetNextPageId(page_id_t next_page_id);
 
-  GenericKey *KeyAt(int index);
-
-  void SetKeyAt(int index, GenericKey *key);
+  // copy the whole key at index into key, which must hold GetKeySize() bytes
+  void KeyAt(int index, GenericKey *key) const;
 
   RowId ValueAt(int index) const;
 
   void SetValueAt(int index, RowId value);
 
-  int KeyIndex(const GenericKey *key, const KeyManager &comparator);
+  int KeyIndex(const GenericKey *key, const KeyManager &comparator) const;
 
-  void *PairPtrAt(int index);
+  // compare key with the key at index without copying it out
+  int CompareWith(const GenericKey *key, int index) const;
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
+  // whether the pair of key fits into the page
+  bool HasRoomFor(const GenericKey *key) const;
 
-  std::pair<GenericKey *, RowId> GetItem(int index);
+  // bytes taken by the slots, the keys and the prefix
+  int GetUsedBytes() const;
+
+  // less than a quarter of the page is used, or less than min size pairs if the size is capped
+  bool IsUnderflow() const;
+
+  // whether all pairs of left and right fit into one page
+  static bool FitsMerged(const BPlusTreeLeafPage *left, const BPlusTreeLeafPage *right);
 
   // insert and delete methods
   int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
 
-  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
-
-  int  SearchKey(const GenericKey *key,const KeyManager &KM);
+  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator) const;
 
   int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
 
@@ -77,16 +105,52 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(void *src, int size);
+  inline uint32_t *Heads() { return reinterpret_cast<uint32_t *>(data_); }
 
-  void CopyLastFrom(GenericKey *key, const RowId value);
+  inline const uint32_t *Heads() const { return reinterpret_cast<const uint32_t *>(data_); }
 
-  void CopyFirstFrom(GenericKey *key, const RowId value);
+  // the slots follow the heads, they move whenever the size changes
+  inline Slot *SlotAt(int index) { return reinterpret_cast<Slot *>(data_ + GetSize() * sizeof(uint32_t)) + index; }
 
-  page_id_t next_page_id_{INVALID_PAGE_ID};
+  inline const Slot *SlotAt(int index) const {
+    return reinterpret_cast<const Slot *>(data_ + GetSize() * sizeof(uint32_t)) + index;
+  }
+
+  // bytes taken by the heads and the slots of count pairs
+  static inline int SlotBytes(int count) { return count * (sizeof(uint32_t) + sizeof(Slot)); }
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  // bytes behind the header, the page size comes from the header
+  inline int DataSize() const { return static_cast<int>(GetPageSize()) - LEAF_PAGE_HEADER_SIZE; }
+
+  inline const char *PrefixPtr() const { return data_ + DataSize() - prefix_length_; }
+
+  // bytes a page takes to hold count keys of key_bytes bytes in total sharing a prefix of prefix_length bytes
+  static int BytesFor(int count, int key_bytes, int prefix_length);
+
+  // total length of the keys, the prefix counted for each of them
+  int GetKeyBytes() const;
+
+  std::string CopyKey(int index) const;
+
+  // copy all pairs out of the page
+  void CopyOut(std::vector<std::string> &keys, std::vector<RowId> &values) const;
+
+  // clear the page and store the pairs, with the longest common prefix of the keys
+  void Rebuild(const std::vector<std::string> &keys, const std::vector<RowId> &values);
+
+  // make room for a pair at index in the heads and the slots, the size grows by one
+  Slot *InsertSlotAt(int index);
+
+  // remove the pair at index, its key bytes stay in the heap until the next rebuild
+  void RemoveAt(int index);
+
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  uint16_t prefix_length_;
+  uint16_t heap_top_;
+  char data_[0];
 };
 
 using LeafPage = BPlusTreeLeafPage;
+
+static_assert(sizeof(LeafPage) == LEAF_PAGE_HEADER_SIZE);
 #endif  // MINISQL_B_PLUS_TREE_LEAF_PAGE_H
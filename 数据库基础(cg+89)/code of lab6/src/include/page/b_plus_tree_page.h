@@ -18,12 +18,13 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 28 bytes in total):
+ * Header format (size in byte, 32 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | PageSize (4) |
  * ----------------------------------------------------------------------------
+ * PageSize is the page size of the database, the pages of an index have that many bytes.
  */
 class BPlusTreePage {
  public:
@@ -57,8 +58,50 @@ class BPlusTreePage {
 
   void SetPageId(page_id_t page_id);
 
+  uint32_t GetPageSize() const;
+
+  void SetPageSize(uint32_t page_size);
+
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+ protected:
+  /**
+   * Branch-free binary search over the sorted heads of the keys in [begin, end), see KeyManager::KeyHead.
+   * The comparison compiles to a conditional move, so the search has no mispredicted branches, and
+   * both heads the next step may read are prefetched while the current one is compared.
+   * @return the first index whose head is not less than head, end if there is none
+   */
+  static inline int LowerBoundHead(const uint32_t *heads, int begin, int end, uint32_t head) {
+    if (begin >= end) {
+      return begin;
+    }
+    const uint32_t *base = heads + begin;
+    for (int n = end - begin; n > 1;) {
+      int half = n >> 1;
+      __builtin_prefetch(base + (half >> 1));
+      __builtin_prefetch(base + half + (half >> 1));
+      base = (base[half] < head) ? base + half : base;
+      n -= half;
+    }
+    return (base - heads) + (*base < head);
+  }
+
+  // the first index whose head is greater than head, end if there is none
+  static inline int UpperBoundHead(const uint32_t *heads, int begin, int end, uint32_t head) {
+    if (begin >= end) {
+      return begin;
+    }
+    const uint32_t *base = heads + begin;
+    for (int n = end - begin; n > 1;) {
+      int half = n >> 1;
+      __builtin_prefetch(base + (half >> 1));
+      __builtin_prefetch(base + half + (half >> 1));
+      base = (base[half] <= head) ? base + half : base;
+      n -= half;
+    }
+    return (base - heads) + (*base <= head);
+  }
+
  private:
   // member variable, attributes that both internal and leaf page share
   [[maybe_unused]] IndexPageType page_type_;
@@ -68,6 +111,7 @@ class BPlusTreePage {
   [[maybe_unused]] int max_size_;
   [[maybe_unused]] page_id_t parent_page_id_;
   [[maybe_unused]] page_id_t page_id_;
+  [[maybe_unused]] uint32_t page_size_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_PAGE_H
@@ -0,0 +1,101 @@
+#ifndef MINISQL_BE_TREE_INTERNAL_PAGE_H
+#define MINISQL_BE_TREE_INTERNAL_PAGE_H
+
+/**
+ * be_tree_internal_page.h
+ *
+ * Internal page of the Bε-tree. Besides the children and the pivots between them
+ * it holds a buffer of pending insert and delete messages for its subtree, sorted
+ * by key with at most one message per key (a newer message replaces the older one).
+ * The pivots take about a sixteenth of the page and the buffer the rest.
+ *
+ * Child i holds the keys k with PIVOT(i) <= k < PIVOT(i+1), PIVOT(0) does not exist.
+ *
+ * Internal page format (size in byte):
+ *  ---------------------------------------------------------------------------------------------
+ * | HEADER | CHILD(0) ... CHILD(m-1) | PIVOT(1) ... PIVOT(m-1) | MESSAGE(1) ... MESSAGE(b) | FREE |
+ *  ---------------------------------------------------------------------------------------------
+ *  Message format (size in byte):
+ *  ------------------------------------------
+ * | Key (KeySize) | RID (8) | IsDelete (1) |
+ *  ------------------------------------------
+ *  Header format (size in byte, 28 bytes in total):
+ *  ---------------------------------------------------------------------------------
+ * | BeTreePage header (16) | MaxSize (4) | BufferSize (4) | BufferMaxSize (4) |
+ *  ---------------------------------------------------------------------------------
+ *  CurrentSize is the number of children, MaxSize the number of children the page holds.
+ */
+#include "page/be_tree_page.h"
+
+#define BE_TREE_INTERNAL_PAGE_HEADER_SIZE 28
+
+class BeTreeInternalPage : public BeTreePage {
+ public:
+  // After creating a new internal page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, int key_size, uint32_t page_size);
+
+  // children an internal page holds with keys of key_size bytes
+  static int MaxSizeFor(int key_size, uint32_t page_size);
+
+  // messages an internal page buffers with keys of key_size bytes
+  static int BufferMaxSizeFor(int key_size, uint32_t page_size);
+
+  inline int GetMaxSize() const { return max_size_; }
+
+  page_id_t ChildAt(int index) const;
+
+  void SetChildAt(int index, page_id_t child);
+
+  // index >= 1
+  const GenericKey *PivotAt(int index) const;
+
+  void SetPivotAt(int index, const GenericKey *pivot);
+
+  // index of the child whose range holds key
+  int ChildIndex(const GenericKey *key) const;
+
+  inline int GetBufferSize() const { return buffer_size_; }
+
+  inline void SetBufferSize(int size) { buffer_size_ = size; }
+
+  inline int GetBufferMaxSize() const { return buffer_max_size_; }
+
+  const GenericKey *MessageKeyAt(int index) const;
+
+  RowId MessageValueAt(int index) const;
+
+  bool IsDeleteAt(int index) const;
+
+  // index of the first message whose key is not less than key
+  int MessageIndex(const GenericKey *key) const;
+
+  // overwrite the message at index, the buffer size is left to the caller
+  void SetMessageAt(int index, const GenericKey *key, const RowId &value, bool is_delete);
+
+  /**
+   * Add a message to the buffer, replacing the message of the same key
+   * @return false if the buffer is full and holds no message of key
+   */
+  bool PutMessage(const GenericKey *key, const RowId &value, bool is_delete);
+
+ private:
+  inline int MessageSize() const { return GetKeySize() + sizeof(RowId) + 1; }
+
+  inline char *PivotPtrAt(int index) { return data_ + max_size_ * sizeof(page_id_t) + (index - 1) * GetKeySize(); }
+
+  inline const char *PivotPtrAt(int index) const {
+    return data_ + max_size_ * sizeof(page_id_t) + (index - 1) * GetKeySize();
+  }
+
+  inline char *MessagePtrAt(int index) { return PivotPtrAt(max_size_) + index * MessageSize(); }
+
+  inline const char *MessagePtrAt(int index) const { return PivotPtrAt(max_size_) + index * MessageSize(); }
+
+  int max_size_;
+  int buffer_size_;
+  int buffer_max_size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_BE_TREE_INTERNAL_PAGE_H
@@ -0,0 +1,49 @@
+#ifndef MINISQL_BE_TREE_LEAF_PAGE_H
+#define MINISQL_BE_TREE_LEAF_PAGE_H
+
+/**
+ * be_tree_leaf_page.h
+ *
+ * Leaf page of the Bε-tree, the pairs are sorted by key. Leaves are rewritten
+ * as a whole when a batch of messages is flushed into them, so they only offer
+ * lookups and positional writes.
+ *
+ * Leaf page format (size in byte):
+ *  ----------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ----------------------------------------------------------------
+ */
+#include "page/be_tree_page.h"
+
+class BeTreeLeafPage : public BeTreePage {
+ public:
+  // After creating a new leaf page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, int key_size);
+
+  // pairs a leaf of page_size bytes holds with keys of key_size bytes
+  static int MaxSizeFor(int key_size, uint32_t page_size);
+
+  const GenericKey *KeyAt(int index) const;
+
+  RowId ValueAt(int index) const;
+
+  // index of the first key not less than key
+  int KeyIndex(const GenericKey *key) const;
+
+  bool Lookup(const GenericKey *key, RowId &value) const;
+
+  // overwrite the pair at index, the size is left to the caller
+  void SetPairAt(int index, const GenericKey *key, const RowId &value);
+
+ private:
+  inline int PairSize() const { return GetKeySize() + sizeof(RowId); }
+
+  inline char *PairPtrAt(int index) { return data_ + index * PairSize(); }
+
+  inline const char *PairPtrAt(int index) const { return data_ + index * PairSize(); }
+
+  char data_[0];
+};
+
+#endif  // MINISQL_BE_TREE_LEAF_PAGE_H
@@ -0,0 +1,61 @@
+#ifndef MINISQL_BE_TREE_PAGE_H
+#define MINISQL_BE_TREE_PAGE_H
+
+/**
+ * be_tree_page.h
+ *
+ * Header shared by the leaf and internal pages of the Bε-tree (see index/be_tree.h).
+ * Keys are stored in slots of KeySize bytes, like the buckets of the hash index.
+ *
+ * Header format (size in byte, 16 bytes in total):
+ *  ------------------------------------------------------------
+ * | PageType (4) | KeySize (4) | CurrentSize (4) | PageId (4) |
+ *  ------------------------------------------------------------
+ */
+#include <cstring>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+#include "page/b_plus_tree_page.h"
+
+#define BE_TREE_PAGE_HEADER_SIZE 16
+
+class BeTreePage {
+ public:
+  inline bool IsLeafPage() const { return page_type_ == IndexPageType::LEAF_PAGE; }
+
+  inline int GetKeySize() const { return key_size_; }
+
+  inline int GetSize() const { return size_; }
+
+  inline void SetSize(int size) { size_ = size; }
+
+  inline page_id_t GetPageId() const { return page_id_; }
+
+ protected:
+  inline void InitHeader(IndexPageType page_type, page_id_t page_id, int key_size) {
+    page_type_ = page_type;
+    key_size_ = key_size;
+    size_ = 0;
+    page_id_ = page_id;
+  }
+
+  // copy the length and the bytes of key into a slot
+  static inline void CopyKey(char *slot, const GenericKey *key) {
+    memcpy(slot, key, sizeof(uint16_t) + key->GetLength());
+  }
+
+  static inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) {
+    return KeyManager::CompareBytes(lhs->GetBytes(), lhs->GetLength(), rhs->GetBytes(), rhs->GetLength());
+  }
+
+ private:
+  IndexPageType page_type_;
+  int key_size_;
+  int size_;
+  page_id_t page_id_;
+};
+
+#endif  // MINISQL_BE_TREE_PAGE_H
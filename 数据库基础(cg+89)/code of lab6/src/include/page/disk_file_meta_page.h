@@ -3,12 +3,32 @@
 
 #include <cstdint>
 
-#include "page/bitmap_page.h"
-
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
-
+#include "common/config.h"
+
+/**
+ * The first page of a database file. It starts with a magic number and the version of the file format, then records
+ * the page size the database was created with, the pages of the file have that size, this one included.
+ *
+ * Files of builds before the magic number have 4 KB pages and a meta page holding only the allocated pages, the
+ * extents and the used pages of each extent (LEGACY_HEADER_SIZE bytes of header). DiskManager rewrites such a meta
+ * page in this layout when it opens the file, the catalog then upgrades the rows and indexes.
+ */
 class DiskFileMetaPage {
  public:
+  static constexpr uint32_t MAGIC = 0x4c51534d;  // "MSQL"
+  // bumped when the layout of the file or of its pages changes, files of another version are not opened
+  static constexpr uint32_t FORMAT_VERSION = 1;
+  static constexpr uint32_t HEADER_SIZE = 20;
+  static constexpr uint32_t LEGACY_HEADER_SIZE = 8;
+
+  /** @return the number of extents a file of pages of page_size bytes can have */
+  static constexpr uint32_t GetMaxExtentNums(uint32_t page_size) { return (page_size - HEADER_SIZE) / 4; }
+
+  /** @return true if the page was written by a build of the current file format */
+  bool IsCurrentFormat() { return magic_ == MAGIC && format_version_ == FORMAT_VERSION; }
+
+  uint32_t GetPageSize() { return page_size_; }
+
   uint32_t GetExtentNums() { return num_extents_; }
 
   uint32_t GetAllocatedPages() { return num_allocated_pages_; }
@@ -21,8 +41,11 @@ class DiskFileMetaPage {
   }
 
  public:
+  uint32_t magic_{0};           // MAGIC, anything else is not a database file of this format
+  uint32_t format_version_{0};
   uint32_t num_allocated_pages_{0};//
   uint32_t num_extents_{0};  // each extent consists with a bit map and BIT_MAP_SIZE pages
+  uint32_t page_size_{0};    // 0 until the file is created
   uint32_t extent_used_page_[0];//这里的0是一个占位符，表示extent_used_page_是一个可变长数组
 };
 
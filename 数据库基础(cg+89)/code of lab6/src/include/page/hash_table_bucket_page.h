@@ -0,0 +1,78 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket page of the extendible hash index. Entries are unordered, each one
+ * carries the hash of its key so that lookups compare keys only on a hash match
+ * and splits never rehash. Only support unique key.
+ *
+ * Bucket page format (size in byte):
+ *  -----------------------------------------------------------------------
+ * | HEADER | HASH(1) + KEY(1) + RID(1) | ... | HASH(n) + KEY(n) + RID(n)
+ *  -----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 12 bytes in total):
+ *  -----------------------------------------------
+ * | CurrentSize (4) | KeySize (4) | MaxSize (4) |
+ *  -----------------------------------------------
+ *  MaxSize is the number of entries fitting the page size of the database.
+ */
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+#define HASH_BUCKET_PAGE_HEADER_SIZE 12
+
+class HashTableBucketPage {
+ public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values
+  void Init(int key_size, uint32_t page_size);
+
+  int GetSize() const { return size_; }
+
+  int GetKeySize() const { return key_size_; }
+
+  int GetMaxSize() const { return max_size_; }
+
+  uint32_t HashAt(int index) const;
+
+  const GenericKey *KeyAt(int index) const;
+
+  RowId ValueAt(int index) const;
+
+  /**
+   * @return index of the entry whose key equals key byte for byte, -1 if there is none
+   */
+  int Find(uint32_t hash, const GenericKey *key) const;
+
+  /**
+   * Append an entry
+   * @return false if the page is full
+   */
+  bool Insert(uint32_t hash, const GenericKey *key, const RowId &value);
+
+  void RemoveAt(int index);
+
+  /**
+   * Move the entries whose hash has mask_bit set to recipient, used when the bucket splits
+   */
+  void MoveSplitImageTo(HashTableBucketPage *recipient, uint32_t mask_bit);
+
+ private:
+  inline int PairSize() const { return sizeof(uint32_t) + key_size_ + sizeof(RowId); }
+
+  inline char *PairPtrAt(int index) { return data_ + index * PairSize(); }
+
+  inline const char *PairPtrAt(int index) const { return data_ + index * PairSize(); }
+
+  int size_;
+  int key_size_;
+  int max_size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
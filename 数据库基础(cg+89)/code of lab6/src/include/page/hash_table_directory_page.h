@@ -0,0 +1,72 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of the extendible hash index. Slot i of the directory points to the
+ * bucket holding the keys whose hash ends with the global depth low bits of i,
+ * the slots are stored in block pages listed by the directory page.
+ *
+ * Directory page format (size in byte):
+ *  ----------------------------------------------------------------------------
+ * | GlobalDepth (4) | BlockCount (4) | BlockPageId(1) (4) | ... | BlockPageId(n) (4)
+ *  ----------------------------------------------------------------------------
+ *
+ * Block page format (size in byte), SLOTS_PER_BLOCK slots:
+ *  --------------------------------------------------------------------------------
+ * | BucketPageId(1) (4) + LocalDepth(1) (4) | ... | BucketPageId(n) (4) + LocalDepth(n) (4)
+ *  --------------------------------------------------------------------------------
+ */
+#include "common/config.h"
+
+struct HashTableDirectorySlot {
+  page_id_t bucket_page_id_;
+  uint32_t local_depth_;
+};
+
+class HashTableDirectoryBlockPage {
+ public:
+  // sized for the smallest page size, the directory layout is the same in every database
+  static constexpr uint32_t SLOTS_PER_BLOCK = MIN_PAGE_SIZE / sizeof(HashTableDirectorySlot);
+
+  inline HashTableDirectorySlot &SlotAt(uint32_t index) { return slots_[index]; }
+
+ private:
+  HashTableDirectorySlot slots_[SLOTS_PER_BLOCK];
+};
+
+class HashTableDirectoryPage {
+ public:
+  /** block count must stay a power of two, the directory doubles */
+  static constexpr uint32_t MAX_BLOCK_COUNT = 512;
+  /** 2^MAX_GLOBAL_DEPTH slots fill MAX_BLOCK_COUNT blocks */
+  static constexpr uint32_t MAX_GLOBAL_DEPTH = 18;
+
+  static_assert((1u << MAX_GLOBAL_DEPTH) == MAX_BLOCK_COUNT * HashTableDirectoryBlockPage::SLOTS_PER_BLOCK);
+  static_assert(8 + MAX_BLOCK_COUNT * sizeof(page_id_t) <= MIN_PAGE_SIZE);
+
+  void Init() {
+    global_depth_ = 0;
+    block_count_ = 0;
+  }
+
+  inline uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  inline void SetGlobalDepth(uint32_t global_depth) { global_depth_ = global_depth; }
+
+  inline uint32_t GetBlockCount() const { return block_count_; }
+
+  inline void SetBlockCount(uint32_t block_count) { block_count_ = block_count; }
+
+  inline page_id_t GetBlockPageId(uint32_t index) const { return block_page_ids_[index]; }
+
+  inline void SetBlockPageId(uint32_t index, page_id_t page_id) { block_page_ids_[index] = page_id; }
+
+ private:
+  uint32_t global_depth_;
+  uint32_t block_count_;
+  page_id_t block_page_ids_[MAX_BLOCK_COUNT];
+};
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
@@ -30,7 +30,8 @@ class IndexRootsPage {
   int GetIndexCount() { return count_; }
 
  private:
-  static constexpr int MAX_INDEX_COUNT = (PAGE_SIZE - 4) / 8;
+  // fits the smallest page size, so the page reads the same in every database
+  static constexpr int MAX_INDEX_COUNT = (MIN_PAGE_SIZE - 4) / 8;
 
   int FindIndex(const index_id_t index_id);
 
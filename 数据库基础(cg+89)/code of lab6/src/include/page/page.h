@@ -1,27 +1,31 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
 
 #include "common/config.h"
-#include "common/rwlatch.h"
+#include "common/hybrid_latch.h"
 
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * A Page only holds that book-keeping, its data lives in the frame region of the buffer pool which the pool assigns
+ * to it with SetFrame. Code that reads or writes the page content must go through GetData().
  */
 class Page {
   // There is bookkeeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPool;
 
  public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page has no data until the buffer pool gives it a frame. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -33,10 +37,10 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return pin_count_.load(std::memory_order_relaxed); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
-  inline bool IsDirty() { return is_dirty_; }
+  inline bool IsDirty() { return is_dirty_.load(std::memory_order_relaxed); }
 
   /** Acquire the page write latch. */
   inline void WLatch() { rwlatch_.WLock(); }
@@ -50,6 +54,12 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Start reading the page without a latch. @return the version to pass to ValidateRead */
+  inline uint64_t OptimisticRLatch() { return rwlatch_.OptimisticRead(); }
+
+  /** @return true if nobody wrote the page since OptimisticRLatch returned version */
+  inline bool ValidateRead(uint64_t version) { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -65,19 +75,32 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Points the page at its frame. The frame is not touched: fresh anonymous memory is already zero, and writing
+   * it would commit the physical memory of frames that may never be used.
+   */
+  inline void SetFrame(char *data) { data_ = data; }
+
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
+  inline void ResetMemory(size_t page_size) { memset(data_, OFFSET_PAGE_START, page_size); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE];
+  /** The frame holding the actual data of the page, in the frame region of the buffer pool. */
+  char *data_ = nullptr;
+  /** The database of this page in the buffer pool. */
+  uint32_t db_id_ = 0;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /**
+   * The pin count of this page, -1 while the buffer pool claims the frame to change the page it holds. Pins are
+   * taken and dropped without the latch of the pool, so the frame must be claimed before page_id_ is written.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** True while the frame is in the replacer of the buffer pool, whether pinned or not. */
+  std::atomic<bool> in_replacer_{false};
   /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  HybridLatch rwlatch_;
 };
 
 #endif  // MINISQL_PAGE_H
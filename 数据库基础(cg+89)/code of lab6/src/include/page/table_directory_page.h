@@ -0,0 +1,44 @@
+#ifndef MINISQL_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_TABLE_DIRECTORY_PAGE_H
+
+#include "common/config.h"
+
+/**
+ * Page directory of a table heap: the ids of the pages of the table in the order of their
+ * list, so a scan can split the table without walking the list. A table with more pages
+ * than one directory page holds gets a list of directory pages.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------------
+ * | NextPageId (4) | PageCount (4) | PageId_1 (4) | ... | PageId_n (4) | FREE |
+ *  -------------------------------------------------------------------------
+ */
+class TableDirectoryPage {
+ public:
+  // a directory page uses MIN_PAGE_SIZE bytes whatever the page size of the database
+  static constexpr uint32_t MAX_PAGE_COUNT = (MIN_PAGE_SIZE - 8) / sizeof(page_id_t);
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    page_count_ = 0;
+  }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  inline uint32_t GetPageCount() const { return page_count_; }
+
+  inline void SetPageCount(uint32_t page_count) { page_count_ = page_count; }
+
+  inline page_id_t PageIdAt(uint32_t index) const { return page_ids_[index]; }
+
+  inline void SetPageIdAt(uint32_t index, page_id_t page_id) { page_ids_[index] = page_id; }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t page_count_;
+  page_id_t page_ids_[0];
+};
+
+#endif  // MINISQL_TABLE_DIRECTORY_PAGE_H
@@ -23,13 +23,15 @@
 #include "common/rowid.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
 
 class TablePage : public Page {
  public:
-  void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn);
+  // page_size is the page size of the database, the tuples are inserted from its end
+  void Init(page_id_t page_id, page_id_t prev_id, uint32_t page_size, LogManager *log_mgr, Transaction *txn);
 
   page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
 
@@ -58,6 +60,11 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Bind view to the tuple at rid without deserializing it, the page must stay pinned while the view is used
+   */
+  bool GetTupleView(const RowId &rid, RowView *view, Schema *schema, Transaction *txn, LockManager *lock_manager);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
@@ -112,7 +119,8 @@ class TablePage : public Page {
   static constexpr size_t OFFSET_TUPLE_SIZE = 28;
 
  public:
-  static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  // the largest row a page of page_size bytes holds
+  static constexpr size_t MaxRowSize(uint32_t page_size) { return page_size - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE; }
 };
 
 #endif
@@ -5,8 +5,13 @@
   extern char *yytext;
   extern int yylex(void);
   int yyerror(char* error);
+
+  /* multi-row inserts are right recursive, allow long value lists */
+  #define YYMAXDEPTH 1000000
 %}
 
+%define api.header.include {"parser/minisql_yacc.h"}
+
 %union {
 	pSyntaxNode syntax_node;
 }
@@ -26,7 +31,7 @@
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
-%type <syntax_node> sql_insert sql_delete sql_update update_values update_value
+%type <syntax_node> sql_insert insert_rows insert_row sql_delete sql_update update_values update_value
 %type <syntax_node> sql_quit sql_exec_file
 
 %%
@@ -289,12 +294,27 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES insert_rows {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
-    pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    SyntaxNodeAddChildren($$, $5);
+  }
+  ;
+
+insert_rows:
+  insert_row ',' insert_rows {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | insert_row {
+    $$ = $1;
+  }
+  ;
+
+insert_row:
+  '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
   }
   ;
 
@@ -5,10 +5,12 @@
 #ifndef MINISQL_ABSTRACT_EXPRESSION_H
 #define MINISQL_ABSTRACT_EXPRESSION_H
 
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -36,6 +38,9 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /** @return The field obtained by evaluating a tuple in place, without materializing it */
+  virtual Field Evaluate(const RowView *row) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
@@ -54,7 +59,10 @@ class AbstractExpression {
   virtual TypeId GetReturnType() { return ret_type_; }
 
   /** @return the type of this expression */
-  virtual ExpressionType GetType() { return type_; }
+  virtual ExpressionType GetType() const { return type_; }
+
+  /** @return the expression as sql text, with the column names of schema, for EXPLAIN */
+  virtual std::string ToString(const Schema *schema) const = 0;
 
  private:
   /** The return type of this expression. */
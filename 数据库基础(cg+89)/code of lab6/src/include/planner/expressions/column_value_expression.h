@@ -27,6 +27,8 @@ class ColumnValueExpression : public AbstractExpression {
 
   Field Evaluate(const Row *row) const override { return Field(*row->GetField(col_idx_)); }
 
+  Field Evaluate(const RowView *row) const override { return row->GetField(col_idx_); }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     return row_idx_ == 0 ? Field(*left_row->GetField(col_idx_)) : Field(*right_row->GetField(col_idx_));
   }
@@ -34,6 +36,13 @@ class ColumnValueExpression : public AbstractExpression {
   uint32_t GetRowIdx() const { return row_idx_; }
   uint32_t GetColIdx() const { return col_idx_; }
 
+  std::string ToString(const Schema *schema) const override {
+    if (schema != nullptr && col_idx_ < schema->GetColumnCount()) {
+      return schema->GetColumn(col_idx_)->GetName();
+    }
+    return "#" + std::to_string(col_idx_);
+  }
+
  private:
   /** Row index 0 = left side of join, row index 1 = right side of join */
   uint32_t row_idx_;
@@ -27,13 +27,30 @@ class ComparisonExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
+  Field Evaluate(const RowView *row) const override {
+    Field lhs = GetChildAt(0)->Evaluate(row);
+    Field rhs = GetChildAt(1)->Evaluate(row);
+    return Field(kTypeInt, PerformComparison(lhs, rhs));
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     Field lhs = GetChildAt(0)->EvaluateJoin(left_row, right_row);
     Field rhs = GetChildAt(1)->EvaluateJoin(left_row, right_row);
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
-  std::string GetComparisonType() { return comp_type_; }
+  std::string GetComparisonType() const { return comp_type_; }
+
+  std::string ToString(const Schema *schema) const override {
+    std::string lhs = GetChildAt(0)->ToString(schema);
+    if (comp_type_ == "is") {
+      return lhs + " is null";
+    }
+    if (comp_type_ == "not") {
+      return lhs + " is not null";
+    }
+    return lhs + " " + comp_type_ + " " + GetChildAt(1)->ToString(schema);
+  }
 
  private:
   CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
@@ -5,6 +5,8 @@
 #ifndef MINISQL_CONSTANT_VALUE_EXPRESSION_H
 #define MINISQL_CONSTANT_VALUE_EXPRESSION_H
 
+#include <string>
+
 #include "abstract_expression.h"
 
 /**
@@ -14,13 +16,48 @@ class ConstantValueExpression : public AbstractExpression {
  public:
   /** Creates a new constant value expression wrapping the given value. */
   explicit ConstantValueExpression(const Field &val)
-      : AbstractExpression({}, val.GetTypeId(), ExpressionType::ConstantExpression), val_(val) {}
+      : AbstractExpression({}, val.GetTypeId(), ExpressionType::ConstantExpression), val_(val.GetTypeId()) {
+    Bind(val);
+  }
+
+  /**
+   * Replace the constant, used to bind the parameters of a cached plan before each execution.
+   * Char data is copied into the expression, so val may be released afterwards.
+   */
+  void Bind(const Field &val) {
+    ASSERT(val.GetTypeId() == GetReturnType(), "Parameter type does not match the constant.");
+    if (val.GetTypeId() == kTypeChar && !val.IsNull()) {
+      chars_.assign(val.GetData(), val.GetLength());
+      Field f(kTypeChar, &chars_[0], val.GetLength(), false);
+      val_ = f;
+    } else {
+      Field f(val);
+      val_ = f;
+    }
+  }
 
   Field Evaluate(const Row *row) const override { return Field(val_); }
 
+  /** Per-row evaluation in scans, hand out the constant without copying its char data */
+  Field Evaluate(const RowView *row) const override {
+    if (val_.GetTypeId() == kTypeChar && !val_.IsNull()) {
+      return Field(kTypeChar, const_cast<char *>(val_.GetData()), val_.GetLength(), false);
+    }
+    return Field(val_);
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override { return Field(val_); }
 
-  const Field val_;
+  std::string ToString(const Schema *schema) const override {
+    std::string text = Field(val_).toString();
+    return val_.GetTypeId() == kTypeChar && !val_.IsNull() ? "\"" + text + "\"" : text;
+  }
+
+  Field val_;
+
+ private:
+  /** storage of val_'s char data */
+  std::string chars_;
 };
 
 #endif  // MINISQL_CONSTANT_VALUE_EXPRESSION_H
@@ -0,0 +1,122 @@
+#ifndef MINISQL_PLAN_CACHE_H
+#define MINISQL_PLAN_CACHE_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "executor/plans/abstract_plan.h"
+#include "planner/expressions/constant_value_expression.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+};
+
+/**
+ * A token of a sql statement, split with the same rules as the lexer (see parser/minisql.l).
+ */
+struct SqlToken {
+  enum Type { kWord, kNumber, kString, kSymbol, kParam };
+
+  Type type_;
+  /** text of the token, strings without the quotes */
+  std::string val_;
+};
+
+/**
+ * A literal of a statement, or the value bound to a parameter.
+ */
+struct SqlLiteral {
+  /** kNodeNumber, kNodeString or kNodeNull */
+  SyntaxNodeType type_;
+  std::string val_;
+};
+
+/**
+ * A dml statement with its literals taken out.
+ *
+ * "select * from t where id = 1 and name = "a";" becomes the key
+ * "select * from t where id = ? and name = ? ;" and the literals {1, "a"}, so that statements
+ * differing only in their constants share one cached plan.
+ */
+struct SqlTemplate {
+  /** normalized text, used as the plan cache key */
+  std::string key_;
+  /** text handed to the parser, the i-th literal is replaced by the placeholder string "?i" */
+  std::string text_;
+  /** literals in the order they appear */
+  std::vector<SqlLiteral> literals_;
+  /** indexes of the literals written as ? in the statement, they are supplied by EXECUTE */
+  std::vector<uint32_t> params_;
+};
+
+/**
+ * Split sql into tokens. A string may be quoted with ' as well as with ".
+ * @return false if sql contains anything the lexer would reject
+ */
+bool TokenizeSql(const std::string &sql, std::vector<SqlToken> *tokens);
+
+/**
+ * Join tokens back into a statement the lexer accepts, every string quoted with ".
+ * @return false if a string contains ", which can only be written quoted with '
+ */
+bool RenderSql(const std::vector<SqlToken> &tokens, std::string *sql);
+
+/**
+ * Build the template of the statement made of tokens[begin, end)
+ */
+void MakeSqlTemplate(const std::vector<SqlToken> &tokens, size_t begin, size_t end, SqlTemplate *tmpl);
+
+/**
+ * LRU cache of plans keyed by normalized sql text.
+ *
+ * Plans reference tables and indexes by pointer, so the cache must be cleared by any ddl.
+ * Only one statement executes at a time, the cache is not thread safe.
+ */
+class PlanCache {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 128;
+  /** statements with more literals than this, i.e. large multi-row inserts, are not cached */
+  static constexpr size_t MAX_CACHED_LITERALS = 1024;
+
+  struct Entry {
+    AbstractPlanNodeRef plan_;
+    /** constants of the plan indexed by literal, rebound before each execution */
+    std::vector<std::shared_ptr<ConstantValueExpression>> params_;
+
+    /**
+     * Bind the literals of a statement to the parameters of the plan.
+     * Throws if a literal does not match the type of its column.
+     */
+    void Bind(const std::vector<SqlLiteral> &literals);
+  };
+
+  explicit PlanCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+  /**
+   * @return the cached entry of key, which becomes the most recently used, or nullptr
+   */
+  Entry *Get(const std::string &key);
+
+  /**
+   * Cache a plan, evicting the least recently used entry when the cache is full
+   * @return the cached entry
+   */
+  Entry *Put(const std::string &key, Entry entry);
+
+  void Clear();
+
+  inline size_t Size() const { return entries_.size(); }
+
+ private:
+  using EntryList = std::list<std::pair<std::string, Entry>>;
+
+  size_t capacity_;
+  /** most recently used first */
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+};
+
+#endif  // MINISQL_PLAN_CACHE_H
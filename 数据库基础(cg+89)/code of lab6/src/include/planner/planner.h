@@ -10,6 +10,7 @@
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
+#include "executor/plans/parallel_seq_scan_plan.h"
 #include "executor/plans/seq_scan_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
@@ -25,7 +26,8 @@
  */
 class Planner {
  public:
-  explicit Planner(ExecuteContext *context) : context_(context) {}
+  explicit Planner(ExecuteContext *context, std::vector<std::shared_ptr<ConstantValueExpression>> *params = nullptr)
+      : context_(context), params_(params) {}
 
   // The following parts are undocumented. One `PlanXXX` functions simply corresponds to a
   // bound thing in the binder.
@@ -34,6 +36,9 @@ class Planner {
 
   AbstractPlanNodeRef PlanSelect(std::shared_ptr<SelectStatement> statement);
 
+  /** A full scan for a select, run by several threads if the table is large enough and the session allows it */
+  AbstractPlanNodeRef PlanSeqScan(const Schema *out_schema, std::shared_ptr<SelectStatement> statement);
+
   AbstractPlanNodeRef PlanInsert(std::shared_ptr<InsertStatement> statement);
 
   AbstractPlanNodeRef PlanDelete(std::shared_ptr<DeleteStatement> statement);
@@ -50,6 +55,9 @@ class Planner {
    */
   ExecuteContext *context_;
 
+  /** If not null the statement is planned with placeholders, see AbstractStatement::MakeConstantValueExpression */
+  std::vector<std::shared_ptr<ConstantValueExpression>> *params_;
+
   /** The maximum size allowed for VARCHAR columns */
   static constexpr const uint32_t MAX_VARCHAR_SIZE = 128;
 };
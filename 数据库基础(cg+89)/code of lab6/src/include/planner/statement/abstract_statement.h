@@ -29,6 +29,9 @@ class AbstractStatement {
 
   ExecuteContext *context_;
 
+  /** parameters of the statement indexed by placeholder, nullptr if the statement is not parameterized */
+  std::vector<std::shared_ptr<ConstantValueExpression>> *params_{nullptr};
+
  public:
   /** Render this statement as a string. */
   virtual std::string ToString() const {
@@ -52,43 +55,59 @@ class AbstractStatement {
     return std::make_shared<ColumnValueExpression>(0, index, col_type);
   }
 
+  /**
+   * Convert a literal to a field of the column type.
+   * @param col_type The type of the column the literal is compared with or assigned to
+   * @param value_type kNodeNumber, kNodeString or kNodeNull
+   * @param val The text of the literal, char fields point to it without copying
+   * @return The field, throws if the literal does not match the column type
+   */
+  static Field MakeConstantField(TypeId col_type, SyntaxNodeType value_type, const char *val) {
+    if (value_type == kNodeNull) {
+      return Field(col_type);
+    }
+    switch (col_type) {
+      case kTypeInt: {
+        if (value_type != kNodeNumber)
+          throw std::logic_error("The value of the predicate does not match the type of column");
+        return Field(kTypeInt, stoi(val));
+      }
+      case kTypeFloat: {
+        if (value_type != kNodeNumber)
+          throw std::logic_error("The value of the predicate does not match the type of column");
+        return Field(kTypeFloat, stof(val));
+      }
+      case kTypeChar: {
+        if (value_type != kNodeString)
+          throw std::logic_error("The value of the predicate does not match the type of column");
+        return Field(kTypeChar, const_cast<char *>(val), strlen(val), false);
+      }
+      default:
+        throw std::logic_error("The type of the column is kTypeInvalid");
+    }
+  }
+
   /**
    * Allocate a constant value expression and return it to the caller.
+   * When planning a parameterized statement every string literal is a placeholder "?<index>",
+   * the expression is then typed by the column, registered in params_ and bound later.
    * @param col_type The type of the constant value
    * @param value The ptr to the SyntaxNode of the constant value
    * @return An owning pointer to the ConstantValueExpression
    */
   AbstractExpressionRef MakeConstantValueExpression(TypeId col_type, pSyntaxNode value) {
-    Field *f = nullptr;
-    if (value->type_ == kNodeNull) {
-      f = new Field(col_type);
-    } else {
-      switch (col_type) {
-        case kTypeInt: {
-          if (value->type_ != kNodeNumber)
-            throw std::logic_error("The value of the predicate does not match the type of column");
-          f = new Field(kTypeInt, stoi(value->val_));
-          break;
-        }
-        case kTypeFloat: {
-          if (value->type_ != kNodeNumber)
-            throw std::logic_error("The value of the predicate does not match the type of column");
-          f = new Field(kTypeFloat, stof(value->val_));
-          break;
-        }
-        case kTypeChar: {
-          if (value->type_ != kNodeString)
-            throw std::logic_error("The value of the predicate does not match the type of column");
-          f = new Field(kTypeChar, value->val_, strlen(value->val_), true);
-          break;
-        }
-        default:
-          throw std::logic_error("The type of the column is kTypeInvalid");
+    if (params_ != nullptr && value->type_ == kNodeString) {
+      if (value->val_[0] != '?')
+        throw std::logic_error("Invalid parameter placeholder");
+      uint32_t idx = stoul(value->val_ + 1);
+      auto param = std::make_shared<ConstantValueExpression>(Field(col_type));
+      if (params_->size() <= idx) {
+        params_->resize(idx + 1);
       }
+      (*params_)[idx] = param;
+      return param;
     }
-    auto const_expr = std::make_shared<ConstantValueExpression>(*f);
-    delete f;
-    return const_expr;
+    return std::make_shared<ConstantValueExpression>(MakeConstantField(col_type, value->type_, value->val_));
   }
 
   /**
@@ -8,6 +8,7 @@
 #include "common/macros.h"
 #include "record/type_id.h"
 #include "record/types.h"
+#include "utils/mem_heap.h"
 
 class Field {
   friend class Type;
@@ -61,6 +62,15 @@ class Field {
     }
   }
 
+  // char, data copied into heap which owns it from then on
+  explicit Field(TypeId type, const char *data, uint32_t len, MemHeap *heap)
+      : type_id_(type), len_(len), manage_data_(false) {
+    ASSERT(type == TypeId::kTypeChar && data != nullptr && heap != nullptr, "Invalid heap char field.");
+    ASSERT(len < VARCHAR_MAX_LEN, "Field length exceeds max varchar length");
+    value_.chars_ = static_cast<char *>(heap->Allocate(len));
+    memcpy(value_.chars_, data, len);
+  }
+
   // copy constructor
   explicit Field(const Field &other) {
     type_id_ = other.type_id_;
@@ -10,34 +10,58 @@
 #include "record/schema.h"
 
 /**
- *  Row format:
- * -------------------------------------------
- * | Header | Field-1 | ... | Field-N |
- * -------------------------------------------
+ *  Row format (compact):
+ * ---------------------------------------------------------------------------------
+ * | Header | Fixed-width fields | Varchar end offsets | Varchar data |
+ * ---------------------------------------------------------------------------------
  *  Header format:
- * --------------------------------------------
- * | Field Nums | Null bitmap |
- * -------------------------------------------
+ * ---------------------------------------------------
+ * | ROW_COMPACT_FLAG | Field Nums (4) | Null bitmap |
+ * ---------------------------------------------------
  *
+ *  The null bitmap takes one bit per field. Fixed-width fields keep their slot even when null,
+ *  so their offsets only depend on the schema (Schema::GetRowOffset). Each char field stores the
+ *  end offset of its data (relative to the row) as a var_offset_t, its data starts where the
+ *  previous char field ends, or at Schema::GetRowDataOffset() for the first one.
  *
+ *  Legacy format, still readable, rewritten by TableHeap::UpgradeRowFormat:
+ * ---------------------------------------------------------------
+ * | Field Nums (4) | Null flags (1 per field) | Field-1 | ... | Field-N |
+ * ---------------------------------------------------------------
+ *  where null fields take no space and char fields are | Length (4) | Data |.
  */
 class Row {
  public:
+  /** Set in the header word of compact rows, legacy rows start with a plain field count */
+  static constexpr uint32_t ROW_COMPACT_FLAG = 0x80000000;
+
+  using var_offset_t = uint16_t;
+
+  static inline uint32_t GetCompactHeaderSize(uint32_t field_count) {
+    return sizeof(uint32_t) + (field_count + 7) / 8;
+  }
+
+  static inline bool IsCompact(const char *buf) { return (MACH_READ_UINT32(buf) & ROW_COMPACT_FLAG) != 0; }
+
+  static inline bool IsNullInBitmap(const char *buf, uint32_t idx) {
+    return (buf[sizeof(uint32_t) + idx / 8] >> (idx % 8)) & 1;
+  }
+
   /**
    * Row used for insert
    * Field integrity should check by upper level
    */
-  Row(std::vector<Field> &fields) {
+  Row(std::vector<Field> &fields, MemHeap *heap = nullptr) : heap_(heap) {
     // deep copy
     for (auto &field : fields) {
-      fields_.push_back(new Field(field));
+      fields_.push_back(CopyField(field));
     }
   }
 
   void destroy() {
     if (!fields_.empty()) {
       for (auto field : fields_) {
-        delete field;
+        DeleteField(field);
       }
       fields_.clear();
     }
@@ -56,33 +80,85 @@ class Row {
   Row(RowId rid) : rid_(rid) {}
 
   /**
-   * Row copy function, deep copy
+   * Row whose fields (and their char data) are allocated from heap, typically the per-query
+   * arena of ExecuteContext. The heap must outlive the row.
    */
-  Row(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
+  explicit Row(MemHeap *heap) : heap_(heap) {}
+
+  Row(RowId rid, MemHeap *heap) : rid_(rid), heap_(heap) {}
+
+  /**
+   * Row copy function, deep copy into the heap of other
+   */
+  Row(const Row &other) : rid_(other.rid_), heap_(other.heap_) {
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(CopyField(*field));
     }
   }
 
   /**
-   * Assign operator, deep copy
+   * Move constructor, takes over the fields of other together with their heap
+   */
+  Row(Row &&other) noexcept : rid_(other.rid_), fields_(std::move(other.fields_)), heap_(other.heap_) {
+    other.fields_.clear();
+  }
+
+  /**
+   * Assign operator, deep copy, the row keeps its own heap
    */
   Row &operator=(const Row &other) {
+    if (this == &other) {
+      return *this;
+    }
     destroy();
     rid_ = other.rid_;
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(CopyField(*field));
     }
     return *this;
   }
 
+  inline MemHeap *GetHeap() const { return heap_; }
+
+  /**
+   * Construct a field owned by this row, from its heap if it has one.
+   * Char fields must be built with CopyField or the (data, len, heap) constructor so that
+   * their data ends up in the same place.
+   */
+  template <typename... Args>
+  Field *NewField(Args &&...args) const {
+    if (heap_ == nullptr) {
+      return new Field(std::forward<Args>(args)...);
+    }
+    return ALLOC_P(heap_, Field)(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Deep copy a field (char data included) into storage owned by this row
+   */
+  Field *CopyField(const Field &field) const {
+    if (field.GetTypeId() != kTypeChar || field.IsNull()) {
+      return NewField(field);
+    }
+    return NewCharField(field.GetData(), field.GetLength());
+  }
+
+  Field *NewCharField(const char *data, uint32_t len) const {
+    if (heap_ == nullptr) {
+      return new Field(kTypeChar, const_cast<char *>(data), len, true);
+    }
+    return ALLOC_P(heap_, Field)(kTypeChar, data, len, heap_);
+  }
+
   /**
    * Note: Make sure that bytes write to buf is equal to GetSerializedSize()
    */
   uint32_t SerializeTo(char *buf, Schema *schema) const;
 
+  /**
+   * Accepts both the compact and the legacy format
+   * @return bytes read, i.e. the size of the tuple as stored
+   */
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
   /**
@@ -105,15 +181,31 @@ class Row {
     return fields_[idx];
   }
 
-    void SetFieldAt(uint32_t idx,Field newfield){
-    fields_[idx]=new Field(newfield);
-    }
+  void SetFieldAt(uint32_t idx, const Field &newfield) {
+    Field *old_field = fields_[idx];
+    fields_[idx] = CopyField(newfield);
+    DeleteField(old_field);
+  }
   inline size_t GetFieldCount() const { return fields_.size(); }
 
  private:
+  uint32_t DeserializeLegacyFrom(char *buf, Schema *schema);
+
+  /** Decode one non-char field (or a null field of any type) at buf */
+  Field *NewFieldFrom(const char *buf, TypeId type_id, bool is_null) const;
+
+  void DeleteField(Field *field) const {
+    if (heap_ == nullptr) {
+      delete field;
+    } else {
+      field->~Field();
+      heap_->Free(field);
+    }
+  }
 
   RowId rid_{};
   std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  MemHeap *heap_{nullptr};      /** if not null, fields are placed in (and never deleted from) this heap */
 };
 
 #endif  // MINISQL_ROW_H
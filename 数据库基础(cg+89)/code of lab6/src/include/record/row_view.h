@@ -0,0 +1,98 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * RowView is a read-only, non-owning view over a serialized tuple (see Row for the format).
+ *
+ * The view points straight into the buffer it was reset on, normally the data of a pinned TablePage,
+ * and decodes fields lazily on access. Fields of compact rows are located in O(1) from the schema
+ * layout, legacy rows are walked once and their field offsets cached.
+ *
+ * Fields returned by GetField() do not own their char data, so they (and the view) are only valid
+ * while the underlying page stays pinned and unmodified.
+ *
+ * Use Materialize()/Project() to build an owning Row for rows that escape the page.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  /**
+   * Point the view at a new tuple. Offsets decoded for the previous tuple are discarded,
+   * the offset buffer itself is kept so that re-binding a view does not allocate.
+   */
+  void Reset(const char *buf, const Schema *schema, RowId rid);
+
+  /** Detach the view from any tuple */
+  void Clear();
+
+  inline bool IsValid() const { return buf_ != nullptr; }
+
+  /** @return false if the tuple is still stored in the legacy row format */
+  inline bool IsCompact() const { return compact_; }
+
+  inline const RowId GetRowId() const { return rid_; }
+
+  inline const Schema *GetSchema() const { return schema_; }
+
+  inline uint32_t GetFieldCount() const { return field_count_; }
+
+  inline bool IsNull(uint32_t idx) const {
+    ASSERT(idx < field_count_, "Failed to access field");
+    if (compact_) {
+      return Row::IsNullInBitmap(buf_, idx);
+    }
+    return MACH_READ_FROM(bool, buf_ + sizeof(uint32_t) + idx * sizeof(bool));
+  }
+
+  /**
+   * Decode the idx-th field without copying, char fields reference the page memory directly
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * @return size of the serialized tuple in bytes, equal to Row::GetSerializedSize()
+   */
+  uint32_t GetSerializedSize() const;
+
+  /**
+   * Deep copy all fields of the viewed tuple into row, allocating from the row's heap if it has one
+   */
+  void Materialize(Row *row) const;
+
+  /**
+   * Deep copy the columns of key_schema (looked up by name in the view's schema) into row,
+   * same semantics as Row::GetKeyFromRow
+   */
+  void Project(const Schema *key_schema, Row *row) const;
+
+ private:
+  /**
+   * @return offset of the idx-th field's value, for char fields also its length
+   */
+  uint32_t FieldOffset(uint32_t idx, uint32_t *len) const;
+
+  /** Legacy rows only: make sure offsets_[0..idx] are decoded and return the offset of the idx-th field */
+  uint32_t LegacyFieldOffset(uint32_t idx) const;
+
+  /** Deep copy the idx-th field into storage owned by row (its heap, if any) */
+  Field *NewField(uint32_t idx, const Row *row) const;
+
+  const char *buf_{nullptr};
+  const Schema *schema_{nullptr};
+  RowId rid_{};
+  uint32_t field_count_{0};
+  bool compact_{false};
+  /** legacy rows only, offsets of the fields decoded so far, relative to buf_ */
+  mutable std::vector<uint32_t> offsets_;
+};
+
+#endif  // MINISQL_ROW_VIEW_H
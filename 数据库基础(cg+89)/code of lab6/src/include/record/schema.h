@@ -13,7 +13,9 @@
 class Schema {
  public:
   explicit Schema(const std::vector<Column *> columns, bool is_manage_ = true)
-      : columns_(std::move(columns)), is_manage_(is_manage_) {}
+      : columns_(std::move(columns)), is_manage_(is_manage_) {
+    ComputeRowLayout();
+  }
 
   ~Schema() {
     if (is_manage_) {
@@ -41,6 +43,19 @@ class Schema {
 
   inline bool GetIsManage() const{return is_manage_;}
 
+  /**
+   * Compact row layout (see Row), computed once from the column types.
+   * For a fixed-width column this is the byte offset of its value in the row,
+   * for a char column the byte offset of its entry in the varchar offset array.
+   */
+  inline uint32_t GetRowOffset(const uint32_t column_index) const { return row_offsets_[column_index]; }
+
+  /** Byte offset of the varchar offset array, i.e. the entry of the first char column */
+  inline uint32_t GetRowVarArrayOffset() const { return row_var_array_offset_; }
+
+  /** Byte offset where varchar data starts, also the size of a compact row without varchar data */
+  inline uint32_t GetRowDataOffset() const { return row_data_offset_; }
+
   /**
    * Shallow copy schema, only used in index
    *
@@ -83,9 +98,14 @@ class Schema {
   static uint32_t DeserializeFrom(char *buf, Schema *&schema);
 
  private:
+  void ComputeRowLayout();
+
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;
   bool is_manage_ = false; /** if false, don't need to delete pointer to column */
+  std::vector<uint32_t> row_offsets_;
+  uint32_t row_var_array_offset_{0};
+  uint32_t row_data_offset_{0};
 };
 
 using IndexSchema = Schema;
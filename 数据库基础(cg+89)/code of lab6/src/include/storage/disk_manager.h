@@ -16,13 +16,19 @@
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
  *
- * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
+ * Disk page storage format: (Free Page BitMap Size = page size * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * Every page of the file, the meta page included, has the page size chosen when the file was created.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);//explicit 防止隐式类型转换
+  /**
+   * Open db_file, creating it with pages of page_size bytes if it does not exist. An existing file keeps the page
+   * size it was created with.
+   */
+  explicit DiskManager(const std::string &db_file, uint32_t page_size = DEFAULT_PAGE_SIZE);//explicit 防止隐式类型转换
 
   ~DiskManager() {
     if (!closed) {
@@ -42,6 +48,12 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Write count pages, sorted by page_id, from consecutive blocks of page_data of the page size.
+   * Pages that are adjacent on disk are written with a single write and the file is flushed once.
+   */
+  void WritePages(const page_id_t *logical_page_ids, const char *page_data, size_t count);
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
@@ -69,9 +81,21 @@ class DiskManager {
    */
   char *GetMetaData() { return meta_data_; }
 
-  static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  /** @return the size of the pages of the file in byte */
+  inline uint32_t GetPageSize() const { return page_size_; }
+
+  /** @return true if databases can be created with pages of page_size bytes */
+  static inline bool IsValidPageSize(uint32_t page_size) {
+    return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+  }
 
  private:
+  /**
+   * Rewrite the meta page of a file of the legacy format (no magic number, 4 KB pages) read into meta_data_ in the
+   * current layout, throw std::runtime_error if it is not a legacy meta page either
+   */
+  void UpgradeLegacyMetaPage();
+
   /**
    * Helper function to get disk file size
    */
@@ -92,6 +116,23 @@ class DiskManager {
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Call fn with the bitmap page in page_data, typed for the page size of the file
+   */
+  template <typename Fn>
+  auto WithBitmap(char *page_data, Fn fn) {
+    switch (page_size_) {
+      case 8192:
+        return fn(reinterpret_cast<BitmapPage<8192> *>(page_data));
+      case 16384:
+        return fn(reinterpret_cast<BitmapPage<16384> *>(page_data));
+      case 32768:
+        return fn(reinterpret_cast<BitmapPage<32768> *>(page_data));
+      default:
+        return fn(reinterpret_cast<BitmapPage<4096> *>(page_data));
+    }
+  }
+
  private:
   // stream to write db file
   std::fstream db_io_;
@@ -99,7 +140,9 @@ class DiskManager {
   // with multiple buffer pool instances, need to protect file access
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];//page_size is the count of bytes. meta_data 转换成disk_file_meta_page
+  uint32_t page_size_;
+  size_t bitmap_size_;  // pages in an extent
+  char meta_data_[MAX_PAGE_SIZE]{};//page_size is the count of bytes. meta_data 转换成disk_file_meta_page
 };
 
 #endif
\ No newline at end of file
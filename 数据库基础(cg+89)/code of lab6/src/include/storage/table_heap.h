@@ -1,10 +1,16 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <mutex>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
+#include "page/table_directory_page.h"
 #include "page/table_page.h"
 #include "storage/table_iterator.h"
+#include "storage/zone_map.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 
@@ -17,9 +23,14 @@ class TableHeap {
     return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
+  /**
+   * Open an existing table heap. A heap without a page directory (directory_page_id is
+   * INVALID_PAGE_ID) gets one, GetDirectoryPageId() tells where it was written.
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager,
+                           page_id_t directory_page_id = INVALID_PAGE_ID) {
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, directory_page_id);
   }
 
   ~TableHeap() {}
@@ -32,6 +43,17 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples. Tuples are appended to the last page of the table, which stays pinned
+   * while it is being filled, so the heap is written a page at a time. Space freed by deletes in
+   * earlier pages is not reused by inserts.
+   * @param[in/out] rows Tuples to insert, rows that can not be inserted get INVALID_ROWID as rid
+   * @param[in] count Number of tuples
+   * @param[in] txn The transaction performing the insert
+   * @return number of inserted tuples
+   */
+  size_t InsertTuples(Row *const *rows, size_t count, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -41,6 +63,7 @@ class TableHeap {
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
+   * Update the tuple in place, other tuples of the page are shifted if its size changes.
    * if the new tuple is too large to fit in the old page, return false (will delete and insert)
    * @param[in] row Tuple of new row
    * @param[in] rid Rid of the old tuple
@@ -71,7 +94,32 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Rewrite tuples stored in the legacy row format into the compact one, in place so that
+   * row ids (and the indexes pointing at them) stay valid.
+   * @return number of tuples left in the legacy format because their page had no room to grow them
+   */
+  uint32_t UpgradeRowFormat(Transaction *txn);
+
+  /**
+   * Move the tuples of the last pages into the free space of the first ones and release the
+   * pages left empty at the end of the table, see VACUUM. Moved rows get new row ids. The
+   * table must not be used by anyone else meanwhile.
+   * @param on_move called with every moved row, which carries its new row id, and its old row id. When it returns
+   * false the row is put back at its old row id and the vacuum stops.
+   * @param[out] released_pages number of released pages
+   * @return false if the vacuum was stopped by on_move
+   */
+  bool Vacuum(const std::function<bool(Row &, const RowId &)> &on_move, uint32_t &released_pages, Transaction *txn);
+
+  /**
+   * @return tuples deleted since the table was opened or vacuumed
+   */
+  inline uint32_t GetDeletedTuples() const { return deleted_tuples_; }
+
   void FreeTableHeap() {
+    zone_map_.Clear();
+    FreeDirectory();
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
       auto old_page_id = next_page_id;
@@ -90,8 +138,9 @@ class TableHeap {
 
   /**
    * @return the begin iterator of this table
+   * @param page_filter pages whose zone it rules out are skipped, see ZoneMap
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, ZoneMap::PageFilter page_filter = nullptr);
 
   /**
    * @return the end iterator of this table
@@ -103,6 +152,28 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline const ZoneMap &GetZoneMap() const { return zone_map_; }
+
+  /**
+   * @return the first page of the page directory of this table
+   */
+  inline page_id_t GetDirectoryPageId() const { return directory_page_id_; }
+
+  /**
+   * @return the pages of this table in the order of the page list
+   */
+  inline const std::vector<page_id_t> &GetPageIds() const { return page_ids_; }
+
+  /**
+   * Visit the tuples of a page of this table. Pages may be scanned from several threads at
+   * once as long as nothing modifies the table meanwhile.
+   * @param page_filter the page is not visited if it rules out the zone of the page, see ZoneMap
+   * @param visitor called with every tuple of the page, the view is valid during the call only
+   * @return false if the page was skipped
+   */
+  bool ScanPage(page_id_t page_id, const ZoneMap::PageFilter &page_filter,
+                const std::function<void(const RowView &)> &visitor, Transaction *txn);
+
 private:
   /**
    * create table heap and initialize first page
@@ -112,30 +183,76 @@ private:
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
           log_manager_(log_manager),
-          lock_manager_(lock_manager) {
+          lock_manager_(lock_manager),
+          zone_map_(schema) {
 //    ASSERT(false, "Not implemented yet.");
     TablePage* true_page = reinterpret_cast<TablePage*>(buffer_pool_manager->NewPage(first_page_id_));//初始化新获得数据页
-    true_page->Init(first_page_id_ ,INVALID_PAGE_ID,log_manager_, nullptr);
+    true_page->Init(first_page_id_ ,INVALID_PAGE_ID,buffer_pool_manager->GetPageSize(),log_manager_, nullptr);
     buffer_pool_manager->UnpinPage(first_page_id_,true);
+    zone_map_.AddEmpty(first_page_id_, INVALID_PAGE_ID);
+    AppendToDirectory(first_page_id_);
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t directory_page_id)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {
+        lock_manager_(lock_manager),
+        zone_map_(schema) {
+    if (directory_page_id != INVALID_PAGE_ID) {
+      LoadDirectory(directory_page_id);
+    } else {
+      BuildDirectory();
+    }
+  }
 
+  /**
+   * @return the last page of the table, pinned
+   */
+  TablePage *FetchLastPage();
 
-  }
+  /** Read the page directory starting at directory_page_id */
+  void LoadDirectory(page_id_t directory_page_id);
+
+  /** Walk the page list of a heap written before it had a page directory and write one */
+  void BuildDirectory();
+
+  /** Record a page just linked to the end of the page list, the directory grows by a page when it is full */
+  void AppendToDirectory(page_id_t page_id);
+
+  /** Shrink the directory to the pages left in page_ids_ after pages were released from the end */
+  void TruncateDirectory();
+
+  void FreeDirectory();
+
+  /**
+   * @return the first page from page_id on that the filter does not rule out by its known zone
+   */
+  page_id_t SkipPages(page_id_t page_id, const ZoneMap::PageFilter &page_filter) const;
+
+  /**
+   * @return whether the rows of page may pass the filter, the zone of page is built if unknown
+   * and the page must be latched
+   */
+  bool PageMayMatch(TablePage *page, const ZoneMap::PageFilter &page_filter, Transaction *txn);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  /** pages of the table in list order, the last one is where new tuples go */
+  std::vector<page_id_t> page_ids_;
+  /** pages the directory is stored in, the first one is kept in the table metadata */
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+  std::vector<page_id_t> directory_page_ids_;
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  ZoneMap zone_map_;
+  uint32_t deleted_tuples_{0};
+  /** guards zone_map_ while pages are scanned in parallel */
+  std::mutex zone_latch_;
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
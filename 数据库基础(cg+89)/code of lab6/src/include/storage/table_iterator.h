@@ -2,18 +2,24 @@
 #define MINISQL_TABLE_ITERATOR_H
 
 #include "common/rowid.h"
+#include "storage/zone_map.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/transaction.h"
 
 class TableHeap;
+class TablePage;
 
+/**
+ * The iterator keeps the page of the current tuple pinned, so the tuple can be read through
+ * GetView() without copying. operator* / operator-> materialize a Row only when asked for it.
+ */
 class TableIterator {
 public:
   // you may define your own constructor based on your member variables
-  explicit TableIterator(TableHeap* new_tableheap, RowId rid);
-  TableIterator() {
+  explicit TableIterator(TableHeap* new_tableheap, RowId rid, ZoneMap::PageFilter page_filter = nullptr);
+  TableIterator() = default;
 
-  }
   explicit TableIterator(const TableIterator &other);
 
   virtual ~TableIterator();
@@ -26,6 +32,13 @@ public:
 
   Row *operator->();
 
+  /**
+   * Zero-copy access to the current tuple, valid until the iterator moves or the page is modified
+   */
+  const RowView &GetView();
+
+  inline RowId GetRowId() const { return it_rid; }
+
   TableIterator &operator=(const TableIterator &itr) noexcept;
 
   TableIterator &operator++();
@@ -33,9 +46,23 @@ public:
   TableIterator operator++(int);
 
 private:
+  /** pin the page of it_rid (if any) and forget the cached tuple */
+  void Pin();
+
+  void Unpin();
+
   // add your own private member variables here
- TableHeap* it_tableheap;
- Row* it_row;
+ TableHeap* it_tableheap{nullptr};
+ RowId it_rid{INVALID_ROWID};
+ /** page of it_rid, pinned as long as the iterator points to it */
+ TablePage* it_page{nullptr};
+ RowView it_view;
+ bool it_view_bound{false};
+ /** materialized copy of the current tuple, built on demand */
+ Row* it_row{nullptr};
+ bool it_row_valid{false};
+ /** pages ruled out by the filter are skipped, see TableHeap::Begin */
+ ZoneMap::PageFilter it_page_filter;
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
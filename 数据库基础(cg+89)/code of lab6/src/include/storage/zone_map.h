@@ -0,0 +1,66 @@
+#ifndef MINISQL_ZONE_MAP_H
+#define MINISQL_ZONE_MAP_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "page/table_page.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Zone map of a table heap: per page the smallest and the largest value of every int and
+ * float column, so that a scan can pass over pages none of whose rows match its predicate
+ * without fetching them.
+ *
+ * The map lives in memory only. A page gets its zone when it is created or the first time a
+ * filtered scan reads it, inserts and in place updates widen the zone. Deletes leave it as it
+ * is, a zone only has to be a bound of the values in the page.
+ */
+class ZoneMap {
+ public:
+  struct Zone {
+    /** next page of the table, a skipped page is not fetched to follow the list */
+    page_id_t next_page_id{INVALID_PAGE_ID};
+    /** bounds of the non-null values per column, min > max if there is none */
+    std::vector<double> min;
+    std::vector<double> max;
+  };
+
+  /** @return false if no row of a page with the zone can match */
+  using PageFilter = std::function<bool(const Zone &)>;
+
+  explicit ZoneMap(Schema *schema);
+
+  /** @return whether zones hold the bounds of the column */
+  inline bool IsTracked(uint32_t column) const { return tracked_[column]; }
+
+  /** @return the value of an int or float field as it is kept in a zone */
+  static double ValueOf(const Field &field);
+
+  /** @return the zone of page, nullptr if it is unknown */
+  const Zone *Find(page_id_t page_id) const;
+
+  /** Summarize the tuples of page, which must be latched */
+  const Zone &Build(TablePage *page, Transaction *txn, LockManager *lock_manager);
+
+  /** Add the zone of a new and empty page */
+  void AddEmpty(page_id_t page_id, page_id_t next_page_id);
+
+  /** Widen the zone of page, if it is known, to hold row */
+  void Widen(page_id_t page_id, const Row &row);
+
+  void SetNextPageId(page_id_t page_id, page_id_t next_page_id);
+
+  inline void Clear() { zones_.clear(); }
+
+ private:
+  Zone NewZone(page_id_t next_page_id) const;
+
+  Schema *schema_;
+  std::vector<bool> tracked_;
+  std::unordered_map<page_id_t, Zone> zones_;
+};
+
+#endif  // MINISQL_ZONE_MAP_H
@@ -0,0 +1,120 @@
+#ifndef MINISQL_MEM_HEAP_H
+#define MINISQL_MEM_HEAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/query_counters.h"
+
+/**
+ * Allocator interface used by the ALLOC / ALLOC_P macros.
+ */
+class MemHeap {
+ public:
+  virtual ~MemHeap() = default;
+
+  /**
+   * @return pointer to at least size bytes, aligned for any fundamental type
+   */
+  virtual void *Allocate(size_t size) = 0;
+
+  /**
+   * Give back memory returned by Allocate()
+   */
+  virtual void Free(void *ptr) = 0;
+};
+
+/**
+ * Bump allocator handing out memory from large blocks. Free() is a no-op, everything is released
+ * at once by Reset() or the destructor, which makes it suited for per-query temporaries.
+ * Objects placed in the arena must either be trivially destructible or be destroyed explicitly
+ * (Row does this for its fields) before the arena goes away.
+ */
+class ArenaMemHeap : public MemHeap {
+ public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  explicit ArenaMemHeap(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~ArenaMemHeap() override {
+    for (auto block : blocks_) {
+      free(block);
+    }
+    for (auto block : large_blocks_) {
+      free(block);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(ArenaMemHeap);
+
+  void *Allocate(size_t size) override {
+    size = (std::max<size_t>(size, 1) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    allocated_size_ += size;
+    LocalQueryCounters().bytes_allocated_ += size;
+    if (size > remaining_) {
+      // large requests get a block of their own, so the current block is not wasted
+      if (size > block_size_ / 4) {
+        large_blocks_.push_back(NewBlock(size));
+        return large_blocks_.back();
+      }
+      blocks_.push_back(NewBlock(block_size_));
+      cur_ = blocks_.back();
+      remaining_ = block_size_;
+    }
+    void *ptr = cur_;
+    cur_ += size;
+    remaining_ -= size;
+    return ptr;
+  }
+
+  void Free(void *ptr) override {}
+
+  /**
+   * Release everything allocated so far, the first block is kept for reuse
+   */
+  void Reset() {
+    for (auto block : large_blocks_) {
+      free(block);
+    }
+    large_blocks_.clear();
+    for (size_t i = 1; i < blocks_.size(); i++) {
+      free(blocks_[i]);
+    }
+    blocks_.resize(std::min<size_t>(blocks_.size(), 1));
+    reserved_size_ = blocks_.size() * block_size_;
+    cur_ = blocks_.empty() ? nullptr : blocks_[0];
+    remaining_ = blocks_.empty() ? 0 : block_size_;
+    allocated_size_ = 0;
+  }
+
+  /** @return bytes handed out since construction or the last Reset() */
+  inline size_t GetAllocatedSize() const { return allocated_size_; }
+
+  /** @return bytes held in blocks */
+  inline size_t GetReservedSize() const { return reserved_size_; }
+
+ private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  char *NewBlock(size_t size) {
+    char *block = static_cast<char *>(malloc(size));
+    ASSERT(block != nullptr, "Out of memory.");
+    reserved_size_ += size;
+    return block;
+  }
+
+  size_t block_size_;
+  /** blocks of block_size_ bytes, the last one is being bumped */
+  std::vector<char *> blocks_;
+  /** blocks holding a single large allocation */
+  std::vector<char *> large_blocks_;
+  char *cur_{nullptr};
+  size_t remaining_{0};
+  size_t allocated_size_{0};
+  size_t reserved_size_{0};
+};
+
+#endif  // MINISQL_MEM_HEAP_H
@@ -0,0 +1,644 @@
+#include "index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static int CompareBytes(const uint8_t *lhs, int lhs_length, const uint8_t *rhs, int rhs_length) {
+  int res = memcmp(lhs, rhs, std::min(lhs_length, rhs_length));
+  if (res != 0) {
+    return res;
+  }
+  return lhs_length - rhs_length;
+}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() { Clear(); }
+
+void AdaptiveRadixTree::Clear() {
+  if (root_ != nullptr) {
+    FreeNode(root_);
+  }
+  root_ = nullptr;
+  size_ = 0;
+}
+
+void AdaptiveRadixTree::FreeNode(Node *node) {
+  if (IsLeaf(node)) {
+    free(AsLeaf(node));
+    return;
+  }
+  switch (node->type) {
+    case NodeType::NODE4: {
+      auto n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->count; i++) {
+        FreeNode(n->children[i]);
+      }
+      delete n;
+      break;
+    }
+    case NodeType::NODE16: {
+      auto n = static_cast<Node16 *>(node);
+      for (int i = 0; i < n->count; i++) {
+        FreeNode(n->children[i]);
+      }
+      delete n;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto n = static_cast<Node48 *>(node);
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index[i] != 0) {
+          FreeNode(n->children[n->child_index[i] - 1]);
+        }
+      }
+      delete n;
+      break;
+    }
+    case NodeType::NODE256: {
+      auto n = static_cast<Node256 *>(node);
+      for (int i = 0; i < 256; i++) {
+        if (n->children[i] != nullptr) {
+          FreeNode(n->children[i]);
+        }
+      }
+      delete n;
+      break;
+    }
+  }
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+AdaptiveRadixTree::Leaf *AdaptiveRadixTree::NewLeaf(const uint8_t *key, int length, const RowId &value) {
+  auto leaf = static_cast<Leaf *>(malloc(sizeof(Leaf) + length));
+  leaf->value = value;
+  leaf->length = length;
+  memcpy(leaf->key, key, length);
+  return leaf;
+}
+
+bool AdaptiveRadixTree::LeafMatches(const Leaf *leaf, const uint8_t *key, int length) {
+  return leaf->length == length && memcmp(leaf->key, key, length) == 0;
+}
+
+const AdaptiveRadixTree::Leaf *AdaptiveRadixTree::Minimum(const Node *node) {
+  while (!IsLeaf(node)) {
+    switch (node->type) {
+      case NodeType::NODE4:
+        node = static_cast<const Node4 *>(node)->children[0];
+        break;
+      case NodeType::NODE16:
+        node = static_cast<const Node16 *>(node)->children[0];
+        break;
+      case NodeType::NODE48: {
+        auto n = static_cast<const Node48 *>(node);
+        int i = 0;
+        while (n->child_index[i] == 0) {
+          i++;
+        }
+        node = n->children[n->child_index[i] - 1];
+        break;
+      }
+      case NodeType::NODE256: {
+        auto n = static_cast<const Node256 *>(node);
+        int i = 0;
+        while (n->children[i] == nullptr) {
+          i++;
+        }
+        node = n->children[i];
+        break;
+      }
+    }
+  }
+  return AsLeaf(node);
+}
+
+AdaptiveRadixTree::Node *const *AdaptiveRadixTree::FindChild(const Node *node, uint8_t byte) {
+  switch (node->type) {
+    case NodeType::NODE4: {
+      auto n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < n->count; i++) {
+        if (n->keys[i] == byte) {
+          return &n->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE16: {
+      auto n = static_cast<const Node16 *>(node);
+#ifdef __SSE2__
+      // compare the byte with all 16 keys at once, the mask drops the unused keys
+      __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(n->keys)));
+      int mask = _mm_movemask_epi8(cmp) & ((1 << n->count) - 1);
+      return mask != 0 ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+      for (int i = 0; i < n->count; i++) {
+        if (n->keys[i] == byte) {
+          return &n->children[i];
+        }
+      }
+      return nullptr;
+#endif
+    }
+    case NodeType::NODE48: {
+      auto n = static_cast<const Node48 *>(node);
+      return n->child_index[byte] != 0 ? &n->children[n->child_index[byte] - 1] : nullptr;
+    }
+    case NodeType::NODE256: {
+      auto n = static_cast<const Node256 *>(node);
+      return n->children[byte] != nullptr ? &n->children[byte] : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+int AdaptiveRadixTree::CheckPrefix(const Node *node, const uint8_t *key, int length, int depth) {
+  int max_cmp = std::min(std::min(static_cast<int>(node->prefix_length), MAX_PREFIX_LENGTH), length - depth);
+  int i = 0;
+  while (i < max_cmp && node->prefix[i] == key[depth + i]) {
+    i++;
+  }
+  return i;
+}
+
+int AdaptiveRadixTree::PrefixMismatch(const Node *node, const uint8_t *key, int length, int depth) {
+  int i = CheckPrefix(node, key, length, depth);
+  if (i < MAX_PREFIX_LENGTH || static_cast<int>(node->prefix_length) <= MAX_PREFIX_LENGTH) {
+    return i;
+  }
+  // the rest of the prefix is only kept in the leaves
+  const Leaf *leaf = Minimum(node);
+  int max_cmp = std::min(static_cast<int>(leaf->length), length) - depth;
+  max_cmp = std::min(max_cmp, static_cast<int>(node->prefix_length));
+  while (i < max_cmp && leaf->key[depth + i] == key[depth + i]) {
+    i++;
+  }
+  return i;
+}
+
+void AdaptiveRadixTree::CopyHeader(Node *to, const Node *from) {
+  to->count = from->count;
+  to->prefix_length = from->prefix_length;
+  memcpy(to->prefix, from->prefix, std::min(static_cast<int>(from->prefix_length), MAX_PREFIX_LENGTH));
+}
+
+void AdaptiveRadixTree::AddChild(Node *node, Node **ref, uint8_t byte, Node *child) {
+  switch (node->type) {
+    case NodeType::NODE4: {
+      auto n = static_cast<Node4 *>(node);
+      if (n->count < 4) {
+        int pos = 0;
+        while (pos < n->count && n->keys[pos] < byte) {
+          pos++;
+        }
+        memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+        memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(Node *));
+        n->keys[pos] = byte;
+        n->children[pos] = child;
+        n->count++;
+        return;
+      }
+      auto grown = new Node16();
+      CopyHeader(grown, n);
+      memcpy(grown->keys, n->keys, n->count);
+      memcpy(grown->children, n->children, n->count * sizeof(Node *));
+      *ref = grown;
+      delete n;
+      AddChild(grown, ref, byte, child);
+      return;
+    }
+    case NodeType::NODE16: {
+      auto n = static_cast<Node16 *>(node);
+      if (n->count < 16) {
+        int pos = 0;
+        while (pos < n->count && n->keys[pos] < byte) {
+          pos++;
+        }
+        memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+        memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(Node *));
+        n->keys[pos] = byte;
+        n->children[pos] = child;
+        n->count++;
+        return;
+      }
+      auto grown = new Node48();
+      CopyHeader(grown, n);
+      for (int i = 0; i < n->count; i++) {
+        grown->child_index[n->keys[i]] = i + 1;
+        grown->children[i] = n->children[i];
+      }
+      *ref = grown;
+      delete n;
+      AddChild(grown, ref, byte, child);
+      return;
+    }
+    case NodeType::NODE48: {
+      auto n = static_cast<Node48 *>(node);
+      if (n->count < 48) {
+        // removals leave holes in children, take the first one
+        int pos = 0;
+        while (n->children[pos] != nullptr) {
+          pos++;
+        }
+        n->children[pos] = child;
+        n->child_index[byte] = pos + 1;
+        n->count++;
+        return;
+      }
+      auto grown = new Node256();
+      CopyHeader(grown, n);
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index[i] != 0) {
+          grown->children[i] = n->children[n->child_index[i] - 1];
+        }
+      }
+      *ref = grown;
+      delete n;
+      AddChild(grown, ref, byte, child);
+      return;
+    }
+    case NodeType::NODE256: {
+      auto n = static_cast<Node256 *>(node);
+      n->children[byte] = child;
+      n->count++;
+      return;
+    }
+  }
+}
+
+void AdaptiveRadixTree::RemoveChild(Node *node, Node **ref, uint8_t byte, Node **slot) {
+  switch (node->type) {
+    case NodeType::NODE4: {
+      auto n = static_cast<Node4 *>(node);
+      int pos = slot - n->children;
+      memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+      memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(Node *));
+      n->count--;
+      if (n->count > 1) {
+        return;
+      }
+      // a single child is merged with this node, the key byte between them joins the prefix
+      Node *child = n->children[0];
+      if (!IsLeaf(child)) {
+        int prefix = n->prefix_length;
+        if (prefix < MAX_PREFIX_LENGTH) {
+          n->prefix[prefix++] = n->keys[0];
+        }
+        if (prefix < MAX_PREFIX_LENGTH) {
+          int sub_prefix = std::min(static_cast<int>(child->prefix_length), MAX_PREFIX_LENGTH - prefix);
+          memcpy(n->prefix + prefix, child->prefix, sub_prefix);
+          prefix += sub_prefix;
+        }
+        memcpy(child->prefix, n->prefix, std::min(prefix, MAX_PREFIX_LENGTH));
+        child->prefix_length += n->prefix_length + 1;
+      }
+      *ref = child;
+      delete n;
+      return;
+    }
+    case NodeType::NODE16: {
+      auto n = static_cast<Node16 *>(node);
+      int pos = slot - n->children;
+      memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+      memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(Node *));
+      n->count--;
+      if (n->count > 3) {
+        return;
+      }
+      auto shrunk = new Node4();
+      CopyHeader(shrunk, n);
+      memcpy(shrunk->keys, n->keys, n->count);
+      memcpy(shrunk->children, n->children, n->count * sizeof(Node *));
+      *ref = shrunk;
+      delete n;
+      return;
+    }
+    case NodeType::NODE48: {
+      auto n = static_cast<Node48 *>(node);
+      n->children[n->child_index[byte] - 1] = nullptr;
+      n->child_index[byte] = 0;
+      n->count--;
+      if (n->count > 12) {
+        return;
+      }
+      auto shrunk = new Node16();
+      CopyHeader(shrunk, n);
+      int pos = 0;
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index[i] != 0) {
+          shrunk->keys[pos] = i;
+          shrunk->children[pos++] = n->children[n->child_index[i] - 1];
+        }
+      }
+      *ref = shrunk;
+      delete n;
+      return;
+    }
+    case NodeType::NODE256: {
+      auto n = static_cast<Node256 *>(node);
+      n->children[byte] = nullptr;
+      n->count--;
+      if (n->count > 37) {
+        return;
+      }
+      auto shrunk = new Node48();
+      CopyHeader(shrunk, n);
+      int pos = 0;
+      for (int i = 0; i < 256; i++) {
+        if (n->children[i] != nullptr) {
+          shrunk->children[pos] = n->children[i];
+          shrunk->child_index[i] = ++pos;
+        }
+      }
+      *ref = shrunk;
+      delete n;
+      return;
+    }
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+bool AdaptiveRadixTree::Insert(const char *key, int length, const RowId &value) {
+  if (!InsertAt(&root_, reinterpret_cast<const uint8_t *>(key), length, 0, value)) {
+    return false;
+  }
+  size_++;
+  return true;
+}
+
+bool AdaptiveRadixTree::InsertAt(Node **ref, const uint8_t *key, int length, int depth, const RowId &value) {
+  Node *node = *ref;
+  if (node == nullptr) {
+    *ref = LeafNode(NewLeaf(key, length, value));
+    return true;
+  }
+
+  if (IsLeaf(node)) {
+    // replace the leaf by a node holding both keys below their common prefix
+    Leaf *leaf = AsLeaf(node);
+    if (LeafMatches(leaf, key, length)) {
+      return false;
+    }
+    int max_cmp = std::min(static_cast<int>(leaf->length), length) - depth;
+    int common = 0;
+    while (common < max_cmp && leaf->key[depth + common] == key[depth + common]) {
+      common++;
+    }
+    ASSERT(common < max_cmp, "A key of the radix tree is a prefix of another one.");
+    auto parent = new Node4();
+    parent->prefix_length = common;
+    memcpy(parent->prefix, key + depth, std::min(common, MAX_PREFIX_LENGTH));
+    Node *unused = parent;
+    AddChild(parent, &unused, leaf->key[depth + common], node);
+    AddChild(parent, &unused, key[depth + common], LeafNode(NewLeaf(key, length, value)));
+    *ref = parent;
+    return true;
+  }
+
+  if (node->prefix_length > 0) {
+    int diff = PrefixMismatch(node, key, length, depth);
+    if (diff < static_cast<int>(node->prefix_length)) {
+      // the key leaves the prefix at diff, split the prefix there
+      auto parent = new Node4();
+      parent->prefix_length = diff;
+      memcpy(parent->prefix, node->prefix, std::min(diff, MAX_PREFIX_LENGTH));
+      Node *unused = parent;
+      if (node->prefix_length <= MAX_PREFIX_LENGTH) {
+        AddChild(parent, &unused, node->prefix[diff], node);
+        node->prefix_length -= diff + 1;
+        memmove(node->prefix, node->prefix + diff + 1, std::min(static_cast<int>(node->prefix_length), MAX_PREFIX_LENGTH));
+      } else {
+        node->prefix_length -= diff + 1;
+        const Leaf *leaf = Minimum(node);
+        AddChild(parent, &unused, leaf->key[depth + diff], node);
+        memcpy(node->prefix, leaf->key + depth + diff + 1,
+               std::min(static_cast<int>(node->prefix_length), MAX_PREFIX_LENGTH));
+      }
+      AddChild(parent, &unused, key[depth + diff], LeafNode(NewLeaf(key, length, value)));
+      *ref = parent;
+      return true;
+    }
+    depth += node->prefix_length;
+  }
+
+  ASSERT(depth < length, "A key of the radix tree is a prefix of another one.");
+  Node **child = FindChild(node, key[depth]);
+  if (child != nullptr) {
+    return InsertAt(child, key, length, depth + 1, value);
+  }
+  AddChild(node, ref, key[depth], LeafNode(NewLeaf(key, length, value)));
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+bool AdaptiveRadixTree::Remove(const char *key, int length) {
+  if (!RemoveAt(&root_, reinterpret_cast<const uint8_t *>(key), length, 0)) {
+    return false;
+  }
+  size_--;
+  return true;
+}
+
+bool AdaptiveRadixTree::RemoveAt(Node **ref, const uint8_t *key, int length, int depth) {
+  Node *node = *ref;
+  if (node == nullptr) {
+    return false;
+  }
+  if (IsLeaf(node)) {
+    // only the root is reached here, other leaves are removed by their parent
+    if (!LeafMatches(AsLeaf(node), key, length)) {
+      return false;
+    }
+    free(AsLeaf(node));
+    *ref = nullptr;
+    return true;
+  }
+  if (node->prefix_length > 0) {
+    if (CheckPrefix(node, key, length, depth) != std::min(static_cast<int>(node->prefix_length), MAX_PREFIX_LENGTH)) {
+      return false;
+    }
+    depth += node->prefix_length;
+  }
+  if (depth >= length) {
+    return false;
+  }
+  Node **child = FindChild(node, key[depth]);
+  if (child == nullptr) {
+    return false;
+  }
+  if (IsLeaf(*child)) {
+    if (!LeafMatches(AsLeaf(*child), key, length)) {
+      return false;
+    }
+    free(AsLeaf(*child));
+    RemoveChild(node, ref, key[depth], child);
+    return true;
+  }
+  return RemoveAt(child, key, length, depth + 1);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool AdaptiveRadixTree::GetValue(const char *key, int length, RowId &value) const {
+  auto bytes = reinterpret_cast<const uint8_t *>(key);
+  const Node *node = root_;
+  int depth = 0;
+  while (node != nullptr) {
+    if (IsLeaf(node)) {
+      // the prefixes skipped on the way are checked here
+      const Leaf *leaf = AsLeaf(node);
+      if (!LeafMatches(leaf, bytes, length)) {
+        return false;
+      }
+      value = leaf->value;
+      return true;
+    }
+    if (node->prefix_length > 0) {
+      if (CheckPrefix(node, bytes, length, depth) !=
+          std::min(static_cast<int>(node->prefix_length), MAX_PREFIX_LENGTH)) {
+        return false;
+      }
+      depth += node->prefix_length;
+    }
+    if (depth >= length) {
+      return false;
+    }
+    Node *const *child = FindChild(node, bytes[depth]);
+    node = child != nullptr ? *child : nullptr;
+    depth++;
+  }
+  return false;
+}
+
+void AdaptiveRadixTree::Scan(const char *lower, int lower_length, bool lower_inclusive, const char *upper,
+                             int upper_length, bool upper_inclusive, std::vector<RowId> &result) const {
+  if (root_ == nullptr) {
+    return;
+  }
+  ScanBounds bounds{reinterpret_cast<const uint8_t *>(lower), lower_length, lower_inclusive,
+                    reinterpret_cast<const uint8_t *>(upper), upper_length, upper_inclusive};
+  ScanAt(root_, 0, lower != nullptr, upper != nullptr, bounds, result);
+}
+
+/*
+ * Compare the prefix of a node at depth with the same bytes of a bound. A bound
+ * ending inside the prefix is smaller than every key below the node.
+ */
+static int ComparePrefix(const uint8_t *prefix, int prefix_length, const uint8_t *bound, int bound_length,
+                         int depth) {
+  int length = std::max(0, std::min(prefix_length, bound_length - depth));
+  int res = memcmp(prefix, bound + depth, length);
+  if (res != 0) {
+    return res;
+  }
+  return length < prefix_length ? 1 : 0;
+}
+
+void AdaptiveRadixTree::ScanAt(const Node *node, int depth, bool on_lower, bool on_upper, const ScanBounds &bounds,
+                               std::vector<RowId> &result) {
+  if (IsLeaf(node)) {
+    const Leaf *leaf = AsLeaf(node);
+    if (on_lower) {
+      int cmp = CompareBytes(leaf->key, leaf->length, bounds.lower, bounds.lower_length);
+      if (cmp < 0 || (cmp == 0 && !bounds.lower_inclusive)) {
+        return;
+      }
+    }
+    if (on_upper) {
+      int cmp = CompareBytes(leaf->key, leaf->length, bounds.upper, bounds.upper_length);
+      if (cmp > 0 || (cmp == 0 && !bounds.upper_inclusive)) {
+        return;
+      }
+    }
+    result.push_back(leaf->value);
+    return;
+  }
+
+  if (node->prefix_length > 0 && (on_lower || on_upper)) {
+    // the whole prefix is in every leaf below
+    const uint8_t *prefix = Minimum(node)->key + depth;
+    if (on_lower) {
+      int cmp = ComparePrefix(prefix, node->prefix_length, bounds.lower, bounds.lower_length, depth);
+      if (cmp < 0) {
+        return;
+      }
+      on_lower = cmp == 0;
+    }
+    if (on_upper) {
+      int cmp = ComparePrefix(prefix, node->prefix_length, bounds.upper, bounds.upper_length, depth);
+      if (cmp > 0) {
+        return;
+      }
+      on_upper = cmp == 0;
+    }
+  }
+  depth += node->prefix_length;
+  if (on_lower && depth >= bounds.lower_length) {
+    on_lower = false;
+  }
+  if (on_upper && depth >= bounds.upper_length) {
+    return;
+  }
+
+  // visit a child in key order, false once the children are past the upper bound
+  auto visit = [&](uint8_t byte, const Node *child) {
+    bool child_on_lower = on_lower;
+    bool child_on_upper = on_upper;
+    if (on_lower) {
+      if (byte < bounds.lower[depth]) {
+        return true;
+      }
+      child_on_lower = byte == bounds.lower[depth];
+    }
+    if (on_upper) {
+      if (byte > bounds.upper[depth]) {
+        return false;
+      }
+      child_on_upper = byte == bounds.upper[depth];
+    }
+    ScanAt(child, depth + 1, child_on_lower, child_on_upper, bounds, result);
+    return true;
+  };
+  switch (node->type) {
+    case NodeType::NODE4: {
+      auto n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < n->count && visit(n->keys[i], n->children[i]); i++) {
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto n = static_cast<const Node16 *>(node);
+      for (int i = 0; i < n->count && visit(n->keys[i], n->children[i]); i++) {
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      auto n = static_cast<const Node48 *>(node);
+      for (int i = 0; i < 256; i++) {
+        if (n->child_index[i] != 0 && !visit(i, n->children[n->child_index[i] - 1])) {
+          break;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE256: {
+      auto n = static_cast<const Node256 *>(node);
+      for (int i = 0; i < 256; i++) {
+        if (n->children[i] != nullptr && !visit(i, n->children[i])) {
+          break;
+        }
+      }
+      break;
+    }
+  }
+}
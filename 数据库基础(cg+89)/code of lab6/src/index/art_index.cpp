@@ -0,0 +1,80 @@
+#include "index/art_index.h"
+
+#include <limits>
+
+ArtIndex::ArtIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, bool unique)
+    : Index(index_id, key_schema), processor_(key_schema_, key_size, unique), key_buf_(key_size), upper_buf_(key_size) {}
+
+GenericKey *ArtIndex::MakeKey(const Row &key, const RowId &row_id) {
+  auto index_key = reinterpret_cast<GenericKey *>(key_buf_.data());
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!processor_.IsUnique()) {
+    processor_.SetKeyRowId(index_key, row_id);
+  }
+  return index_key;
+}
+
+void ArtIndex::Scan(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive,
+                    std::vector<RowId> &result) const {
+  container_.Scan(lower == nullptr ? nullptr : lower->GetBytes(), lower == nullptr ? 0 : lower->GetLength(),
+                  lower_inclusive, upper == nullptr ? nullptr : upper->GetBytes(),
+                  upper == nullptr ? 0 : upper->GetLength(), upper_inclusive, result);
+}
+
+dberr_t ArtIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  GenericKey *index_key = MakeKey(key, row_id);
+  if (!container_.Insert(index_key->GetBytes(), index_key->GetLength(), row_id)) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *index_key = MakeKey(key, row_id);
+  container_.Remove(index_key->GetBytes(), index_key->GetLength());
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                          std::string compare_operator) {
+  // duplicates of a non-unique index lie between the key with the smallest and the greatest RowId
+  GenericKey *lower = MakeKey(key, RowId(std::numeric_limits<page_id_t>::min(), 0));
+  GenericKey *upper = lower;
+  if (!processor_.IsUnique()) {
+    upper = reinterpret_cast<GenericKey *>(upper_buf_.data());
+    memcpy(upper, lower, upper_buf_.size());
+    processor_.SetKeyRowId(upper,
+                           RowId(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  }
+  if (compare_operator == "=") {
+    if (processor_.IsUnique()) {
+      RowId value;
+      if (container_.GetValue(lower->GetBytes(), lower->GetLength(), value)) {
+        result.push_back(value);
+      }
+    } else {
+      Scan(lower, true, upper, true, result);
+    }
+  } else if (compare_operator == ">") {
+    Scan(upper, false, nullptr, false, result);
+  } else if (compare_operator == ">=") {
+    Scan(lower, true, nullptr, false, result);
+  } else if (compare_operator == "<") {
+    Scan(nullptr, false, lower, false, result);
+  } else if (compare_operator == "<=") {
+    Scan(nullptr, false, upper, true, result);
+  } else if (compare_operator == "<>") {
+    Scan(nullptr, false, lower, false, result);
+    Scan(upper, false, nullptr, false, result);
+  }
+  if (!result.empty()) {
+    return DB_SUCCESS;
+  }
+  return DB_KEY_NOT_FOUND;
+}
+
+dberr_t ArtIndex::Destroy() {
+  container_.Clear();
+  return DB_SUCCESS;
+}
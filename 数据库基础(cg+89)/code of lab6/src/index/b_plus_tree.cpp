@@ -1,12 +1,32 @@
 #include "index/b_plus_tree.h"
 
+#include <iomanip>
+#include <sstream>
 #include <string>
 
+#include "common/metrics.h"
 #include "glog/logging.h"
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 #include "page/index_roots_page.h"
 
+// 所有b+树索引共用的结构变化计数，按叶子页和内部页分开
+static const char *SPLITS_METRIC = "minisql_bptree_splits_total";
+static const char *MERGES_METRIC = "minisql_bptree_merges_total";
+static const char *REDISTRIBUTIONS_METRIC = "minisql_bptree_redistributions_total";
+static Counter *const leaf_splits =
+    MetricsRegistry::Instance()->GetCounter(SPLITS_METRIC, "B+ tree pages split", "node=\"leaf\"");
+static Counter *const internal_splits =
+    MetricsRegistry::Instance()->GetCounter(SPLITS_METRIC, "B+ tree pages split", "node=\"internal\"");
+static Counter *const leaf_merges =
+    MetricsRegistry::Instance()->GetCounter(MERGES_METRIC, "B+ tree pages merged into a sibling", "node=\"leaf\"");
+static Counter *const internal_merges = MetricsRegistry::Instance()->GetCounter(
+    MERGES_METRIC, "B+ tree pages merged into a sibling", "node=\"internal\"");
+static Counter *const leaf_redistributions = MetricsRegistry::Instance()->GetCounter(
+    REDISTRIBUTIONS_METRIC, "B+ tree entries moved from a sibling to an underfull page", "node=\"leaf\"");
+static Counter *const internal_redistributions = MetricsRegistry::Instance()->GetCounter(
+    REDISTRIBUTIONS_METRIC, "B+ tree entries moved from a sibling to an underfull page", "node=\"internal\"");
+
 /**
  * TODO: Student Implement
  */
@@ -19,7 +39,7 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       internal_max_size_(internal_max_size) {
   page_id_t page_id;
   IndexRootsPage *indexRootsPage = reinterpret_cast<IndexRootsPage *>(
-      buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+      buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
   if(indexRootsPage->GetRootId(index_id,&page_id)){
    root_page_id_=page_id;
   }
@@ -31,17 +51,27 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
 }
 
 void BPlusTree::Destroy(page_id_t current_page_id) {
+  if (current_page_id == INVALID_PAGE_ID) {
+    // 从根开始释放整棵树
+    if (IsEmpty()) {
+      return;
+    }
+    Destroy(root_page_id_);
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return;
+  }
   Page *page = buffer_pool_manager_->FetchPage(current_page_id);
   if (page == nullptr) {
     return;
   }
-  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page);
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
   if (node->IsLeafPage()) {
-    LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
     buffer_pool_manager_->DeletePage(leaf->GetPageId());
   } else {
-    InternalPage *internal = reinterpret_cast<InternalPage *>(page);
+    InternalPage *internal = reinterpret_cast<InternalPage *>(page->GetData());
     for (int i = 0; i < internal->GetSize(); i++) {
       Destroy(internal->ValueAt(i));
     }
@@ -50,6 +80,38 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
   }
 }
 
+/*
+ * Release the pages of a tree written in the fixed slot layout used before
+ * slotted pages. Only the child page ids of its internal pages are read: the
+ * pairs of KeySize + 4 bytes started after the page header, repeated once more.
+ */
+void BPlusTree::DestroyLegacy(page_id_t current_page_id) {
+  if (current_page_id == INVALID_PAGE_ID) {
+    if (IsEmpty()) {
+      return;
+    }
+    DestroyLegacy(root_page_id_);
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return;
+  }
+  static constexpr int LEGACY_INTERNAL_PAIRS_OFFSET = 2 * 28;
+  Page *page = buffer_pool_manager_->FetchPage(current_page_id);
+  if (page == nullptr) {
+    return;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (!node->IsLeafPage()) {
+    int pair_size = node->GetKeySize() + sizeof(page_id_t);
+    const char *pairs = page->GetData() + LEGACY_INTERNAL_PAIRS_OFFSET;
+    for (int i = 0; i < node->GetSize(); i++) {
+      DestroyLegacy(MACH_READ_FROM(page_id_t, pairs + i * pair_size + node->GetKeySize()));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(current_page_id, false);
+  buffer_pool_manager_->DeletePage(current_page_id);
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
@@ -68,7 +130,7 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
     return false;
   }
   Page *page = FindLeafPage(key, root_page_id_, false);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
   RowId id = INVALID_ROWID;
   bool res = leaf->Lookup(key, id, processor_);
   if (res) {
@@ -108,8 +170,9 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   if (page == nullptr) {
     ASSERT(false, "all page are pinned while StartNewTree");
   }
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
-  leaf->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_,
+             buffer_pool_manager_->GetPageSize());
   leaf->Insert(key, value, processor_);
   UpdateRootPageId(1);
   buffer_pool_manager_->UnpinPage(root_page_id_, true);
@@ -125,22 +188,106 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
  */
 bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
   Page *page = FindLeafPage(key, root_page_id_, false);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
   RowId lookup_res = INVALID_ROWID;
   if (leaf->Lookup(key, lookup_res, processor_)) {
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
     return false;
   }
-  if (leaf->Insert(key, value, processor_)) {
-    if (leaf->GetSize() > leaf->GetMaxSize()) {
-      LeafPage *new_leaf = Split(leaf, transaction);
-      InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+  leaf = SplitForInsert(leaf, key, transaction);
+  leaf->Insert(key, value, processor_);
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  return true;
+}
+
+/*
+ * Insert key & value pairs sorted by key
+ * The leaf found for a key stays pinned and is reused for the following keys
+ * as long as they fall into its key range, so a sorted batch descends the tree
+ * about once per leaf instead of once per key. After a split the next key
+ * descends from the root again.
+ * inserted[i] is false if keys[i] already exists in the tree.
+ */
+void BPlusTree::InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                            std::vector<bool> &inserted, Transaction *transaction) {
+  inserted.assign(keys.size(), false);
+  LeafPage *leaf = nullptr;
+  bool dirty = false;
+  for (size_t i = 0; i < keys.size(); i++) {
+    GenericKey *key = keys[i];
+    if (IsEmpty()) {
+      StartNewTree(key, values[i]);
+      inserted[i] = true;
+      continue;
     }
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-    return true;
+    if (leaf != nullptr && !LeafCovers(leaf, key)) {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), dirty);
+      leaf = nullptr;
+    }
+    if (leaf == nullptr) {
+      leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_, false)->GetData());
+      dirty = false;
+    }
+    RowId lookup_res = INVALID_ROWID;
+    if (leaf->Lookup(key, lookup_res, processor_)) {
+      continue;
+    }
+    inserted[i] = true;
+    if (!leaf->HasRoomFor(key)) {
+      leaf = SplitForInsert(leaf, key, transaction);
+      leaf->Insert(key, values[i], processor_);
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+      leaf = nullptr;
+      continue;
+    }
+    leaf->Insert(key, values[i], processor_);
+    dirty = true;
+  }
+  if (leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), dirty);
   }
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-  return false;
+}
+
+/*
+ * Whether key belongs to leaf: it lies between the first and the last key of
+ * the leaf, or leaf is the right most leaf and key is not below its first key.
+ */
+bool BPlusTree::LeafCovers(LeafPage *leaf, const GenericKey *key) {
+  if (leaf->GetSize() == 0 || leaf->CompareWith(key, 0) < 0) {
+    return false;
+  }
+  return leaf->GetNextPageId() == INVALID_PAGE_ID || leaf->CompareWith(key, leaf->GetSize() - 1) <= 0;
+}
+
+/*
+ * Split leaf until the half key belongs to has room for it. Keys have variable
+ * length, so a page is split before the insertion that would overflow it, and
+ * one split may not be enough when the key does not share the prefix of the
+ * page. The separator pushed up is the shortest key between the two halves.
+ * @return: the leaf to insert key into, still pinned, the other halves are unpinned
+ */
+BPlusTreeLeafPage *BPlusTree::SplitForInsert(LeafPage *leaf, const GenericKey *key, Transaction *transaction) {
+  if (leaf->HasRoomFor(key)) {
+    return leaf;
+  }
+  std::vector<char> buf(3 * processor_.GetKeySize());
+  auto *last_key = reinterpret_cast<GenericKey *>(buf.data());
+  auto *first_key = reinterpret_cast<GenericKey *>(buf.data() + processor_.GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(buf.data() + 2 * processor_.GetKeySize());
+  while (!leaf->HasRoomFor(key)) {
+    LeafPage *new_leaf = Split(leaf, transaction);
+    leaf->KeyAt(leaf->GetSize() - 1, last_key);
+    new_leaf->KeyAt(0, first_key);
+    KeyManager::ShortestSeparator(last_key, first_key, separator);
+    InsertIntoParent(leaf, separator, new_leaf, transaction);
+    if (processor_.CompareKeys(key, separator) >= 0) {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+      leaf = new_leaf;
+    } else {
+      buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+    }
+  }
+  return leaf;
 }
 
 /*
@@ -149,17 +296,20 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is returned pinned, for internal page the key moved up to the
+ * parent is copied into middle_key.
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction) {
+BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, GenericKey *middle_key, Transaction *transaction) {
   page_id_t new_page_id;
   Page *page = buffer_pool_manager_->NewPage(new_page_id);
   if (page == nullptr) {
     ASSERT(false, "all page are pinned while Split");
   }
-  InternalPage *new_page = reinterpret_cast<InternalPage *>(page);
-  new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
-  node->MoveHalfTo(new_page, buffer_pool_manager_);
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  InternalPage *new_page = reinterpret_cast<InternalPage *>(page->GetData());
+  new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_,
+                 buffer_pool_manager_->GetPageSize());
+  node->MoveHalfTo(new_page, middle_key, buffer_pool_manager_);
+  internal_splits->Add();
   return new_page;
 }
 
@@ -169,10 +319,11 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
   if (page == nullptr) {
     ASSERT(false, "all page are pinned while Split");
   }
-  LeafPage *new_page = reinterpret_cast<LeafPage *>(page);
-  new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
+  LeafPage *new_page = reinterpret_cast<LeafPage *>(page->GetData());
+  new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_,
+                 buffer_pool_manager_->GetPageSize());
   node->MoveHalfTo(new_page);
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  leaf_splits->Add();
   return new_page;
 }
 
@@ -184,6 +335,8 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is split before the insertion when the key does not fit, new_node
+ * then goes to the half old_node ended up in.
  */
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                                  Transaction *transaction) {
@@ -193,8 +346,9 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     if (page == nullptr) {
       ASSERT(false, "all page are pinned while InsertIntoParent");
     }
-    InternalPage *new_page = reinterpret_cast<InternalPage *>(page);
-    new_page->Init(new_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+    InternalPage *new_page = reinterpret_cast<InternalPage *>(page->GetData());
+    new_page->Init(new_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_,
+                   buffer_pool_manager_->GetPageSize());
     new_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
     old_node->SetParentPageId(new_page_id);
     new_node->SetParentPageId(new_page_id);
@@ -208,17 +362,23 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
   if (page == nullptr) {
     ASSERT(false, "all page are pinned while InsertIntoParent");
   }
-  InternalPage *parent_page = reinterpret_cast<InternalPage *>(page);
-  if (parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId())) {
-    if (parent_page->GetSize() > parent_page->GetMaxSize()) {
-      InternalPage *new_parent_page = Split(parent_page, transaction);
-      InsertIntoParent(parent_page, new_parent_page->KeyAt(0), new_parent_page, transaction);
+  InternalPage *parent_page = reinterpret_cast<InternalPage *>(page->GetData());
+  std::vector<char> middle_buf(processor_.GetKeySize());
+  auto *middle_key = reinterpret_cast<GenericKey *>(middle_buf.data());
+  while (!parent_page->HasRoomFor(key)) {
+    InternalPage *new_parent_page = Split(parent_page, middle_key, transaction);
+    InsertIntoParent(parent_page, middle_key, new_parent_page, transaction);
+    // old_node可能随一半的子节点移到了新页
+    if (old_node->GetParentPageId() == new_parent_page->GetPageId()) {
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      parent_page = new_parent_page;
+    } else {
+      buffer_pool_manager_->UnpinPage(new_parent_page->GetPageId(), true);
     }
-    buffer_pool_manager_->UnpinPage(parent_page_id, true);
-    return;
   }
-  buffer_pool_manager_->UnpinPage(parent_page_id, false);
-  return;
+  parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent_page->GetPageId());
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -236,39 +396,27 @@ void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
     return;
   }
   Page *page = FindLeafPage(key, root_page_id_, false);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
-  if (leaf->RemoveAndDeleteRecord(key, processor_)) {
-    page_id_t now = leaf->GetPageId();
-    GenericKey *new_key = leaf->KeyAt(0);
-    if (!leaf->IsRootPage()) {
-      int i = 0;
-      InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(leaf->GetParentPageId()));
-      while (1) {
-        i = parent->ValueIndex(now);
-        if (i > 0) {
-          parent->SetKeyAt(i, new_key);
-          break;
-        }
-        if (parent->IsRootPage()) break;
-        now = parent->GetPageId();
-        parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent->GetParentPageId()));
-      }
-    }
-
-    if (leaf->GetSize() < leaf->GetMinSize()) {
-      bool t = CoalesceOrRedistribute(leaf, transaction);
-      t||buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-      return;
-    }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int old_size = leaf->GetSize();
+  // 分隔键只要求不小于左侧、不大于右侧的所有键，删除后仍然有效，无需更新父节点
+  if (leaf->RemoveAndDeleteRecord(key, processor_) == old_size) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    return;
   }
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-  return;
+  if (leaf->IsUnderflow() && CoalesceOrRedistribute(leaf, transaction)) {
+    page_id_t leaf_id = leaf->GetPageId();
+    buffer_pool_manager_->UnpinPage(leaf_id, true);
+    buffer_pool_manager_->DeletePage(leaf_id);
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
 }
 
-/* todo
- * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+/*
+ * User needs to first find the sibling of input page. If the pairs of sibling
+ * and input page fit into one page, merge. Otherwise, redistribute.
  * Using template N to represent either internal page or leaf page.
+ * The sibling and the parent are unpinned here, node stays pinned.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
@@ -277,71 +425,72 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
   if (node->IsRootPage()) {
     return AdjustRoot(node);
   }
-  InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId()));
+  InternalPage *parent =
+      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
   int index = parent->ValueIndex(node->GetPageId());
   int sibling_index = (index == 0) ? 1 : index - 1;
-  N *sibling = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index)));
-  if(node->GetSize() >= node->GetMinSize()){
-    return false;
-  }
-  if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
-    Redistribute(sibling, node, parent, index);
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    return false;
-  } else {
-    Coalesce(sibling, node, parent, index, transaction);
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), false);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    return true;
+  N *sibling = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index))->GetData());
+  bool node_deleted = false;
+  if (Coalesce(sibling, node, parent, index, transaction)) {
+    // 总是把右侧页合并进左侧页，index为0时被删除的是兄弟页
+    page_id_t sibling_id = sibling->GetPageId();
+    buffer_pool_manager_->UnpinPage(sibling_id, true);
+    if (index == 0) {
+      buffer_pool_manager_->DeletePage(sibling_id);
+    } else {
+      node_deleted = true;
+    }
+    page_id_t parent_id = parent->GetPageId();
+    bool parent_deleted = parent->IsUnderflow() && CoalesceOrRedistribute(parent, transaction);
+    buffer_pool_manager_->UnpinPage(parent_id, true);
+    if (parent_deleted) {
+      buffer_pool_manager_->DeletePage(parent_id);
+    }
+    return node_deleted;
   }
+  Redistribute(sibling, node, parent, index);
+  buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+  return false;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
- * Using template N to represent either internal page or leaf page.
+ * Move all the key & value pairs from the right one of node and its sibling to
+ * the left one if they fit into one page, the parent drops the right one.
+ * The caller deletes the emptied page and handles the parent recursively.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @return  true means the pages are merged, false means nothing happened
  */
 bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
                          Transaction *transaction) {
-  if (index == 0) {
-    neighbor_node->MoveAllTo(node);
-    parent->Remove(1);
-    buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());
-  } else {
-    node->MoveAllTo(neighbor_node);
-    parent->Remove(index);
-    buffer_pool_manager_->DeletePage(node->GetPageId());
+  LeafPage *left = (index == 0) ? node : neighbor_node;
+  LeafPage *right = (index == 0) ? neighbor_node : node;
+  if (!LeafPage::FitsMerged(left, right)) {
+    return false;
   }
-  bool t = CoalesceOrRedistribute(parent, transaction);
-  t||buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-  return 1;
+  right->MoveAllTo(left);
+  parent->Remove(index == 0 ? 1 : index);
+  leaf_merges->Add();
+  return true;
 }
 
 bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
                          Transaction *transaction) {
-  if(index == 0) {
-    neighbor_node->MoveAllTo(node, parent->KeyAt(1), buffer_pool_manager_);
-    parent->Remove(1);
-    buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());
-  } else {
-    node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
-    parent->Remove(index);
-    buffer_pool_manager_->DeletePage(node->GetPageId());
-  }
-  bool t = CoalesceOrRedistribute(parent, transaction);
-  if (t) {
-    buffer_pool_manager_->DeletePage(parent->GetPageId());
-  } else {
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+  InternalPage *left = (index == 0) ? node : neighbor_node;
+  InternalPage *right = (index == 0) ? neighbor_node : node;
+  int middle_index = (index == 0) ? 1 : index;
+  std::vector<char> middle_buf(processor_.GetKeySize());
+  auto *middle_key = reinterpret_cast<GenericKey *>(middle_buf.data());
+  parent->KeyAt(middle_index, middle_key);
+  if (!InternalPage::FitsMerged(left, middle_key, right)) {
+    return false;
   }
-  return 1;
+  right->MoveAllTo(left, middle_key, buffer_pool_manager_);
+  parent->Remove(middle_index);
+  internal_merges->Add();
+  return true;
 }
 
 /*
@@ -349,28 +498,64 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
  * "node".
- * Using template N to represent either internal page or leaf page.
+ * Keys have variable length, so nothing moves if the pair or the new separator
+ * does not fit, the node then simply stays underfull.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *&parent, int index) {
+  if (neighbor_node->GetSize() < 2) {
+    return;
+  }
+  std::vector<char> buf(3 * processor_.GetKeySize());
+  auto *moved_key = reinterpret_cast<GenericKey *>(buf.data());
+  auto *next_key = reinterpret_cast<GenericKey *>(buf.data() + processor_.GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(buf.data() + 2 * processor_.GetKeySize());
+  int separator_index = (index == 0) ? 1 : index;
+  if (index == 0) {
+    neighbor_node->KeyAt(0, moved_key);
+    neighbor_node->KeyAt(1, next_key);
+    KeyManager::ShortestSeparator(moved_key, next_key, separator);
+  } else {
+    neighbor_node->KeyAt(neighbor_node->GetSize() - 1, moved_key);
+    neighbor_node->KeyAt(neighbor_node->GetSize() - 2, next_key);
+    KeyManager::ShortestSeparator(next_key, moved_key, separator);
+  }
+  if (!node->HasRoomFor(moved_key) || !parent->HasRoomFor(separator, separator_index)) {
+    return;
+  }
   if (index == 0) {
     neighbor_node->MoveFirstToEndOf(node);
-    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
   } else {
     neighbor_node->MoveLastToFrontOf(node);
-    parent->SetKeyAt(index, node->KeyAt(0));
   }
+  parent->SetKeyAt(separator_index, separator);
+  leaf_redistributions->Add();
 }
+
 void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *&parent, int index) {
+  if (neighbor_node->GetSize() < 2) {
+    return;
+  }
+  std::vector<char> buf(2 * processor_.GetKeySize());
+  auto *middle_key = reinterpret_cast<GenericKey *>(buf.data());
+  auto *up_key = reinterpret_cast<GenericKey *>(buf.data() + processor_.GetKeySize());
+  int middle_index = (index == 0) ? 1 : index;
+  parent->KeyAt(middle_index, middle_key);
+  // 父节点的键下移到node，兄弟页的一个键上移到父节点
+  neighbor_node->KeyAt(index == 0 ? 1 : neighbor_node->GetSize() - 1, up_key);
+  if (!node->HasRoomFor(middle_key) || !parent->HasRoomFor(up_key, middle_index)) {
+    return;
+  }
   if (index == 0) {
-    neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
-    parent->SetKeyAt(1, neighbor_node->KeyAt(0)); 
+    neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
   } else {
-    neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
-    parent->SetKeyAt(index, neighbor_node->KeyAt(neighbor_node->GetSize()));
+    neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
   }
+  parent->SetKeyAt(middle_index, up_key);
+  internal_redistributions->Add();
 }
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -397,7 +582,7 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     // root_node->SetPageId(INVALID_PAGE_ID);
     // root_node->SetParentPageId(INVALID_PAGE_ID);
     root_page_id_ = new_root_id;
-    BPlusTreePage *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(new_root_id));
+    BPlusTreePage *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(new_root_id)->GetData());
     page->SetParentPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPage(new_root_id, true);
     UpdateRootPageId(0);
@@ -423,6 +608,8 @@ IndexIterator BPlusTree::Begin() {
   LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
   page_id_t leaf_id = leaf->GetPageId();
   IndexIterator iterator(leaf_id, buffer_pool_manager_, 0);
+  // the iterator holds its own pin
+  buffer_pool_manager_->UnpinPage(leaf_id, false);
   return iterator;
 }
 
@@ -439,7 +626,14 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
   Page *page = FindLeafPage(key, page_id, false);
   LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
   int index = leaf->KeyIndex(key, processor_);
-  IndexIterator iterator(leaf->GetPageId(), buffer_pool_manager_, index);
+  page_id_t leaf_id = leaf->GetPageId();
+  if (index >= leaf->GetSize()) {
+    // key is greater than every key of this leaf, the first greater one starts the next leaf
+    leaf_id = leaf->GetNextPageId();
+    index = 0;
+  }
+  IndexIterator iterator(leaf_id, buffer_pool_manager_, index);
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
   return iterator;
 }
 
@@ -463,11 +657,11 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
     return nullptr;
   }
   Page *page = buffer_pool_manager_->FetchPage(page_id);
-  BPlusTreePage *tree_page = reinterpret_cast<BPlusTreePage *>(page);
+  BPlusTreePage *tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
   if (tree_page->IsLeafPage()) {
     return page;
   }
-  InternalPage *internal_page = reinterpret_cast<InternalPage *>(page);
+  InternalPage *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
   if (leftMost) {
     page_id_t leftMostPageId = internal_page->ValueAt(0);
     buffer_pool_manager_->UnpinPage(page_id, false);
@@ -488,15 +682,26 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
   IndexRootsPage *indexRootsPage =
-      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-  if (insert_record) {
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  // the record may be missing after the tree was emptied, or present when it is reused
+  if (!indexRootsPage->Update(index_id_, root_page_id_)) {
     indexRootsPage->Insert(index_id_, root_page_id_);
-  } else {
-    indexRootsPage->Update(index_id_, root_page_id_);
   }
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
+/*
+ * Keys are byte strings after encoding, they are printed in hex
+ */
+std::string BPlusTree::KeyToString(const GenericKey *key) {
+  std::ostringstream out;
+  out << std::hex << std::setfill('0');
+  for (int i = 0; i < key->GetLength(); i++) {
+    out << std::setw(2) << static_cast<int>(static_cast<uint8_t>(key->GetBytes()[i]));
+  }
+  return out.str();
+}
+
 /**
  * This method is used for debug only, You don't need to modify
  */
@@ -518,18 +723,11 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << leaf->GetMaxSize() << ",min_size=" << leaf->GetMinSize() << ",size=" << leaf->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    std::vector<char> key_buf(processor_.GetKeySize());
+    auto *key = reinterpret_cast<GenericKey *>(key_buf.data());
     for (int i = 0; i < leaf->GetSize(); i++) {
-      Row keyrow(INVALID_ROWID);
-      Schema *schema = nullptr;
-      std::vector<Column *> columns = {
-          new Column("int", TypeId::kTypeInt, 0, false, false),
-      };
-      Schema *table_schema = new Schema(columns);
-      KeyManager KP(table_schema, 16);
-      KP.DeserializeToKey(leaf->KeyAt(i), keyrow, table_schema);
-      Field *row_value = keyrow.GetField(0);
-      auto x = row_value->toString();
-      out << "<TD>" << x << "</TD>\n";
+      leaf->KeyAt(i, key);
+      out << "<TD>" << KeyToString(key) << "</TD>\n";
     }
     out << "</TR>";
     // Print table end
@@ -560,19 +758,13 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << inner->GetMaxSize() << ",min_size=" << inner->GetMinSize() << ",size=" << inner->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    std::vector<char> key_buf(processor_.GetKeySize());
+    auto *key = reinterpret_cast<GenericKey *>(key_buf.data());
     for (int i = 0; i < inner->GetSize(); i++) {
       out << "<TD PORT=\"p" << inner->ValueAt(i) << "\">";
       if (i > 0) {
-        std::vector<Column *> columns = {
-            new Column("int", TypeId::kTypeInt, 0, false, false),
-        };
-        Row keyrow(INVALID_ROWID);
-        Schema *table_schema = new Schema(columns);
-        KeyManager KP(table_schema, 16);
-        KP.DeserializeToKey(inner->KeyAt(i), keyrow, table_schema);
-        Field *row_value = keyrow.GetField(0);
-        auto x = row_value->toString();
-        out << x;
+        inner->KeyAt(i, key);
+        out << KeyToString(key);
       } else {
         out << " ";
       }
@@ -607,12 +799,15 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
  * This function is for debug only, you don't need to modify
  */
 void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
+  std::vector<char> key_buf(processor_.GetKeySize());
+  auto *key = reinterpret_cast<GenericKey *>(key_buf.data());
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
               << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
-      std::cout << leaf->KeyAt(i) << ",";
+      leaf->KeyAt(i, key);
+      std::cout << KeyToString(key) << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
@@ -620,7 +815,8 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
     auto *internal = reinterpret_cast<InternalPage *>(page);
     std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
-      std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
+      internal->KeyAt(i, key);
+      std::cout << KeyToString(key) << ": " << internal->ValueAt(i) << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
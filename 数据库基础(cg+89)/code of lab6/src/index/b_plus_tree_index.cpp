@@ -1,12 +1,14 @@
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include "index/b_plus_tree_index.h"
 
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique)
     : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
+      processor_(key_schema_, key_size, unique),
       container_(index_id, buffer_pool_manager, processor_) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
@@ -14,6 +16,9 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
 
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!processor_.IsUnique()) {
+    processor_.SetKeyRowId(index_key, row_id);
+  }
    //cout<<"123"<<endl;
   bool status = container_.Insert(index_key, row_id, txn);
   delete index_key;
@@ -28,9 +33,56 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
   return DB_SUCCESS;
 }
 
+void BPlusTreeIndex::InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                                   std::vector<dberr_t> &results, Transaction *txn) {
+  size_t count = keys.size();
+  results.assign(count, DB_SUCCESS);
+  // sort on the key fields directly, comparing serialized keys would deserialize them on every comparison
+  std::vector<uint32_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  uint32_t column_count = key_schema_->GetColumnCount();
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    for (uint32_t i = 0; i < column_count; i++) {
+      const Field *lhs = keys[a].GetField(i);
+      const Field *rhs = keys[b].GetField(i);
+      if (lhs->CompareLessThan(*rhs) == CmpBool::kTrue) {
+        return true;
+      }
+      if (lhs->CompareGreaterThan(*rhs) == CmpBool::kTrue) {
+        return false;
+      }
+    }
+    // duplicates of a non-unique index are ordered by RowId inside the tree
+    return !processor_.IsUnique() && row_ids[a] < row_ids[b];
+  });
+  size_t key_size = processor_.GetKeySize();
+  std::vector<char> key_buf(count * key_size);
+  std::vector<GenericKey *> sorted_keys(count);
+  std::vector<RowId> sorted_values(count);
+  for (size_t i = 0; i < count; i++) {
+    ASSERT(row_ids[order[i]].Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+    sorted_keys[i] = reinterpret_cast<GenericKey *>(key_buf.data() + i * key_size);
+    processor_.SerializeFromKey(sorted_keys[i], keys[order[i]], key_schema_);
+    if (!processor_.IsUnique()) {
+      processor_.SetKeyRowId(sorted_keys[i], row_ids[order[i]]);
+    }
+    sorted_values[i] = row_ids[order[i]];
+  }
+  std::vector<bool> inserted;
+  container_.InsertBatch(sorted_keys, sorted_values, inserted, txn);
+  for (size_t i = 0; i < count; i++) {
+    if (!inserted[i]) {
+      results[order[i]] = DB_FAILED;
+    }
+  }
+}
+
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!processor_.IsUnique()) {
+    processor_.SetKeyRowId(index_key, row_id);
+  }
 
   container_.Remove(index_key, txn);
   delete index_key;
@@ -40,36 +92,43 @@ dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *t
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  auto end = GetEndIterator();
   if (compare_operator == "=") {
-    container_.GetValue(index_key, result, txn);
+    if (processor_.IsUnique()) {
+      container_.GetValue(index_key, result, txn);
+    } else {
+      // duplicates are adjacent, one descent then walk the leaf chain
+      for (auto iter = LowerBound(index_key); iter != end && processor_.CompareKeyFields((*iter).first, index_key) == 0;
+           ++iter) {
+        result.emplace_back((*iter).second);
+      }
+    }
   } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
-      ++iter;
-    result.clear();
-    for (; iter != GetEndIterator(); ++iter) {
+    for (auto iter = UpperBound(index_key); iter != end; ++iter) {
       result.emplace_back((*iter).second);
     }
   } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
+    for (auto iter = LowerBound(index_key); iter != end; ++iter) {
       result.emplace_back((*iter).second);
     }
   } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
+    auto bound = LowerBound(index_key);
+    for (auto iter = GetBeginIterator(); iter != bound; ++iter) {
       result.emplace_back((*iter).second);
     }
   } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
+    auto bound = UpperBound(index_key);
+    for (auto iter = GetBeginIterator(); iter != bound; ++iter) {
       result.emplace_back((*iter).second);
     }
-    container_.GetValue(index_key, result, txn);
   } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
+    auto bound = LowerBound(index_key);
+    for (auto iter = GetBeginIterator(); iter != bound; ++iter) {
+      result.emplace_back((*iter).second);
+    }
+    for (auto iter = UpperBound(index_key); iter != end; ++iter) {
       result.emplace_back((*iter).second);
     }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
   }
   delete index_key;
   if (!result.empty())
@@ -83,6 +142,11 @@ dberr_t BPlusTreeIndex::Destroy() {
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::DestroyLegacy() {
+  container_.DestroyLegacy();
+  return DB_SUCCESS;
+}
+
 IndexIterator BPlusTreeIndex::GetBeginIterator() {
   return container_.Begin();
 }
@@ -94,3 +158,24 @@ IndexIterator BPlusTreeIndex::GetBeginIterator(GenericKey *key) {
 IndexIterator BPlusTreeIndex::GetEndIterator() {
   return container_.End();
 }
+
+IndexIterator BPlusTreeIndex::LowerBound(GenericKey *key) {
+  if (!processor_.IsUnique()) {
+    // smaller than the RowId of any row
+    processor_.SetKeyRowId(key, RowId(std::numeric_limits<page_id_t>::min(), 0));
+  }
+  return container_.Begin(key);
+}
+
+IndexIterator BPlusTreeIndex::UpperBound(GenericKey *key) {
+  if (!processor_.IsUnique()) {
+    // greater than the RowId of any row
+    processor_.SetKeyRowId(key, RowId(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+    return container_.Begin(key);
+  }
+  auto iter = container_.Begin(key);
+  if (iter != GetEndIterator() && processor_.CompareKeys((*iter).first, key) == 0) {
+    ++iter;
+  }
+  return iter;
+}
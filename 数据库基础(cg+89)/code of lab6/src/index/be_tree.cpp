@@ -0,0 +1,489 @@
+#include "index/be_tree.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "glog/logging.h"
+#include "page/index_roots_page.h"
+
+static int CompareImages(const std::string &lhs, const std::string &rhs) {
+  return KeyManager::CompareBytes(lhs.data() + sizeof(uint16_t), lhs.size() - sizeof(uint16_t),
+                                  rhs.data() + sizeof(uint16_t), rhs.size() - sizeof(uint16_t));
+}
+
+bool BeTree::KeyLess::operator()(const std::string &lhs, const std::string &rhs) const {
+  return CompareImages(lhs, rhs) < 0;
+}
+
+BeTree::BeTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator)
+    : index_id_(index_id),
+      buffer_pool_manager_(buffer_pool_manager),
+      processor_(comparator),
+      leaf_max_size_(LeafPage::MaxSizeFor(comparator.GetKeySize(), buffer_pool_manager->GetPageSize())),
+      internal_max_size_(InternalPage::MaxSizeFor(comparator.GetKeySize(), buffer_pool_manager->GetPageSize())),
+      buffer_max_size_(InternalPage::BufferMaxSizeFor(comparator.GetKeySize(), buffer_pool_manager->GetPageSize())) {
+  auto roots_page =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  page_id_t page_id;
+  if (roots_page->GetRootId(index_id, &page_id)) {
+    root_page_id_ = page_id;
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+/*****************************************************************************
+ * UPDATE
+ *****************************************************************************/
+bool BeTree::Insert(const GenericKey *key, const RowId &value, Transaction *transaction) {
+  if (processor_.IsUnique()) {
+    // the key may sit in a leaf or in any buffer on the way, it has to be looked up
+    std::vector<RowId> result;
+    if (GetValue(key, result, transaction)) {
+      return false;
+    }
+  }
+  Put(key, value, false);
+  return true;
+}
+
+void BeTree::Remove(const GenericKey *key, Transaction *transaction) {
+  if (IsEmpty()) {
+    return;
+  }
+  Put(key, INVALID_ROWID, true);
+}
+
+/*
+ * Queue a message in the buffer of the root. Only a full buffer, or a root that
+ * is still a leaf, touches the pages below.
+ */
+void BeTree::Put(const GenericKey *key, const RowId &value, bool is_delete) {
+  if (IsEmpty()) {
+    StartNewTree();
+  }
+  auto node = reinterpret_cast<BeTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+  std::vector<Message> batch{{KeyImage(key), value, is_delete}};
+  Siblings siblings;
+  if (node->IsLeafPage()) {
+    ApplyToLeaf(reinterpret_cast<LeafPage *>(node), batch, siblings);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    NewRoot(siblings);
+    return;
+  }
+  auto internal = reinterpret_cast<InternalPage *>(node);
+  if (internal->PutMessage(key, value, is_delete)) {
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    return;
+  }
+  Node root;
+  ReadNode(internal, root);
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  FlushNode(root, buffer_max_size_ - 1);
+  MergeMessages(root.buffer, batch);
+  if (root.children.size() > 1) {
+    WriteNode(root, siblings);
+    NewRoot(siblings);
+    return;
+  }
+  // the flush dropped all children but one, hand the messages to it and make it the root
+  PushDown(root.children[0], root.buffer, siblings);
+  root_page_id_ = root.children[0];
+  UpdateRootPageId(false);
+  buffer_pool_manager_->DeletePage(root.page_id);
+  NewRoot(siblings);
+}
+
+void BeTree::StartNewTree() {
+  Page *page = buffer_pool_manager_->NewPage(root_page_id_);
+  ASSERT(page != nullptr, "out of memory");
+  reinterpret_cast<LeafPage *>(page->GetData())->Init(root_page_id_, processor_.GetKeySize());
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  UpdateRootPageId(true);
+}
+
+void BeTree::NewRoot(Siblings &siblings) {
+  // the new root splits too if the old one left more siblings than it holds
+  while (!siblings.empty()) {
+    Node root;
+    Page *page = buffer_pool_manager_->NewPage(root.page_id);
+    ASSERT(page != nullptr, "out of memory");
+    buffer_pool_manager_->UnpinPage(root.page_id, false);
+    root.children.push_back(root_page_id_);
+    root.pivots.emplace_back();
+    for (auto &sibling : siblings) {
+      root.pivots.push_back(std::move(sibling.first));
+      root.children.push_back(sibling.second);
+    }
+    siblings.clear();
+    WriteNode(root, siblings);
+    root_page_id_ = root.page_id;
+    UpdateRootPageId(false);
+  }
+}
+
+void BeTree::UpdateRootPageId(bool insert_record) {
+  auto roots_page =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  if (insert_record) {
+    roots_page->Insert(index_id_, root_page_id_);
+  } else {
+    roots_page->Update(index_id_, root_page_id_);
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+/*****************************************************************************
+ * FLUSH
+ *****************************************************************************/
+void BeTree::ReadNode(const InternalPage *page, Node &node) const {
+  node.page_id = page->GetPageId();
+  node.children.resize(page->GetSize());
+  node.pivots.resize(page->GetSize());
+  for (int i = 0; i < page->GetSize(); i++) {
+    node.children[i] = page->ChildAt(i);
+    if (i > 0) {
+      node.pivots[i] = KeyImage(page->PivotAt(i));
+    }
+  }
+  node.buffer.reserve(page->GetBufferSize());
+  for (int i = 0; i < page->GetBufferSize(); i++) {
+    node.buffer.push_back({KeyImage(page->MessageKeyAt(i)), page->MessageValueAt(i), page->IsDeleteAt(i)});
+  }
+}
+
+/*
+ * A node with more children than a page holds is split evenly, the messages
+ * go with the children they are meant for.
+ */
+void BeTree::WriteNode(Node &node, Siblings &siblings) {
+  auto message_less = [](const Message &message, const std::string &pivot) {
+    return CompareImages(message.key, pivot) < 0;
+  };
+  int count = node.children.size();
+  int pages = (count + internal_max_size_ - 1) / internal_max_size_;
+  int begin = 0;
+  size_t message_begin = 0;
+  for (int p = 0; p < pages; p++) {
+    int end = count * (p + 1) / pages;
+    size_t message_end = node.buffer.size();
+    if (end < count) {
+      message_end = std::lower_bound(node.buffer.begin() + message_begin, node.buffer.end(), node.pivots[end],
+                                     message_less) -
+                    node.buffer.begin();
+    }
+    page_id_t page_id = node.page_id;
+    Page *page = p == 0 ? buffer_pool_manager_->FetchPage(page_id) : buffer_pool_manager_->NewPage(page_id);
+    ASSERT(page != nullptr, "out of memory");
+    auto internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, processor_.GetKeySize(), buffer_pool_manager_->GetPageSize());
+    for (int i = begin; i < end; i++) {
+      internal->SetChildAt(i - begin, node.children[i]);
+      if (i > begin) {
+        internal->SetPivotAt(i - begin, AsKey(node.pivots[i]));
+      }
+    }
+    internal->SetSize(end - begin);
+    for (size_t i = message_begin; i < message_end; i++) {
+      const Message &message = node.buffer[i];
+      internal->SetMessageAt(i - message_begin, AsKey(message.key), message.value, message.is_delete);
+    }
+    internal->SetBufferSize(message_end - message_begin);
+    if (p > 0) {
+      siblings.emplace_back(node.pivots[begin], page_id);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    begin = end;
+    message_begin = message_end;
+  }
+}
+
+/*
+ * Move the messages of the child with the most pending messages down, until
+ * the buffer has at most target messages left.
+ */
+void BeTree::FlushNode(Node &node, size_t target) {
+  auto message_less = [](const Message &message, const std::string &pivot) {
+    return CompareImages(message.key, pivot) < 0;
+  };
+  while (node.buffer.size() > target) {
+    size_t child = 0;
+    size_t batch_begin = 0;
+    size_t batch_end = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i < node.children.size(); i++) {
+      size_t end = node.buffer.size();
+      if (i + 1 < node.children.size()) {
+        end = std::lower_bound(node.buffer.begin() + begin, node.buffer.end(), node.pivots[i + 1], message_less) -
+              node.buffer.begin();
+      }
+      if (end - begin > batch_end - batch_begin) {
+        child = i;
+        batch_begin = begin;
+        batch_end = end;
+      }
+      begin = end;
+    }
+    std::vector<Message> batch(std::make_move_iterator(node.buffer.begin() + batch_begin),
+                               std::make_move_iterator(node.buffer.begin() + batch_end));
+    node.buffer.erase(node.buffer.begin() + batch_begin, node.buffer.begin() + batch_end);
+
+    Siblings siblings;
+    bool alive = PushDown(node.children[child], batch, siblings);
+    for (size_t i = 0; i < siblings.size(); i++) {
+      node.children.insert(node.children.begin() + child + 1 + i, siblings[i].second);
+      node.pivots.insert(node.pivots.begin() + child + 1 + i, std::move(siblings[i].first));
+    }
+    if (!alive && node.children.size() > 1) {
+      // the keys of an emptied leaf now belong to its left neighbour, or to its right one for the first child
+      buffer_pool_manager_->DeletePage(node.children[child]);
+      node.pivots.erase(node.pivots.begin() + std::max<size_t>(child, 1));
+      node.children.erase(node.children.begin() + child);
+    }
+  }
+}
+
+bool BeTree::PushDown(page_id_t page_id, std::vector<Message> &batch, Siblings &siblings) {
+  auto node = reinterpret_cast<BeTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  if (node->IsLeafPage()) {
+    bool alive = ApplyToLeaf(reinterpret_cast<LeafPage *>(node), batch, siblings);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return alive;
+  }
+  auto internal = reinterpret_cast<InternalPage *>(node);
+  if (internal->GetBufferSize() + batch.size() <= static_cast<size_t>(buffer_max_size_)) {
+    for (auto &message : batch) {
+      internal->PutMessage(AsKey(message.key), message.value, message.is_delete);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+  }
+  Node child;
+  ReadNode(internal, child);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  MergeMessages(child.buffer, batch);
+  FlushNode(child, buffer_max_size_);
+  WriteNode(child, siblings);
+  return true;
+}
+
+/*
+ * Rewrite the leaf with its pairs and the batch merged, spread over as few
+ * pages as hold them. The leaf is left pinned.
+ */
+bool BeTree::ApplyToLeaf(LeafPage *leaf, std::vector<Message> &batch, Siblings &siblings) {
+  std::vector<std::pair<std::string, RowId>> pairs;
+  pairs.reserve(leaf->GetSize() + batch.size());
+  int i = 0;
+  size_t j = 0;
+  while (i < leaf->GetSize() || j < batch.size()) {
+    int cmp;
+    if (i == leaf->GetSize()) {
+      cmp = 1;
+    } else if (j == batch.size()) {
+      cmp = -1;
+    } else {
+      cmp = processor_.CompareKeys(leaf->KeyAt(i), AsKey(batch[j].key));
+    }
+    if (cmp < 0) {
+      pairs.emplace_back(KeyImage(leaf->KeyAt(i)), leaf->ValueAt(i));
+      i++;
+      continue;
+    }
+    if (cmp == 0) {
+      i++;
+    }
+    if (!batch[j].is_delete) {
+      pairs.emplace_back(std::move(batch[j].key), batch[j].value);
+    }
+    j++;
+  }
+
+  int count = pairs.size();
+  int pages = std::max(1, (count + leaf_max_size_ - 1) / leaf_max_size_);
+  int begin = 0;
+  for (int p = 0; p < pages; p++) {
+    int end = count * (p + 1) / pages;
+    LeafPage *target = leaf;
+    page_id_t page_id = leaf->GetPageId();
+    if (p > 0) {
+      Page *page = buffer_pool_manager_->NewPage(page_id);
+      ASSERT(page != nullptr, "out of memory");
+      target = reinterpret_cast<LeafPage *>(page->GetData());
+      target->Init(page_id, processor_.GetKeySize());
+      siblings.emplace_back(pairs[begin].first, page_id);
+    }
+    for (int k = begin; k < end; k++) {
+      target->SetPairAt(k - begin, AsKey(pairs[k].first), pairs[k].second);
+    }
+    target->SetSize(end - begin);
+    if (p > 0) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    begin = end;
+  }
+  return count > 0;
+}
+
+void BeTree::MergeMessages(std::vector<Message> &older, std::vector<Message> &newer) {
+  std::vector<Message> merged;
+  merged.reserve(older.size() + newer.size());
+  size_t i = 0;
+  size_t j = 0;
+  while (i < older.size() || j < newer.size()) {
+    int cmp;
+    if (i == older.size()) {
+      cmp = 1;
+    } else if (j == newer.size()) {
+      cmp = -1;
+    } else {
+      cmp = CompareImages(older[i].key, newer[j].key);
+    }
+    if (cmp < 0) {
+      merged.push_back(std::move(older[i++]));
+    } else {
+      if (cmp == 0) {
+        i++;
+      }
+      merged.push_back(std::move(newer[j++]));
+    }
+  }
+  older.swap(merged);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool BeTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
+  if (IsEmpty()) {
+    return false;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    auto node = reinterpret_cast<BeTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    if (node->IsLeafPage()) {
+      RowId value;
+      bool found = reinterpret_cast<LeafPage *>(node)->Lookup(key, value);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      if (found) {
+        result.push_back(value);
+      }
+      return found;
+    }
+    // a message on the way is newer than anything below it
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    int index = internal->MessageIndex(key);
+    if (index < internal->GetBufferSize() && processor_.CompareKeys(internal->MessageKeyAt(index), key) == 0) {
+      bool found = !internal->IsDeleteAt(index);
+      if (found) {
+        result.push_back(internal->MessageValueAt(index));
+      }
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return found;
+    }
+    page_id_t child = internal->ChildAt(internal->ChildIndex(key));
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child;
+  }
+}
+
+void BeTree::GetRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive,
+                      std::vector<RowId> &result, Transaction *transaction) {
+  if (IsEmpty()) {
+    return;
+  }
+  std::map<std::string, RowId, KeyLess> pairs;
+  Collect(root_page_id_, lower, lower_inclusive, upper, upper_inclusive, pairs);
+  for (auto &pair : pairs) {
+    result.push_back(pair.second);
+  }
+}
+
+/*
+ * Collect the pairs of the subtrees first, then apply the messages of this
+ * page over them, they are newer.
+ */
+void BeTree::Collect(page_id_t page_id, const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                     bool upper_inclusive, std::map<std::string, RowId, KeyLess> &pairs) {
+  auto below_upper = [&](const GenericKey *key) {
+    if (upper == nullptr) {
+      return true;
+    }
+    int cmp = processor_.CompareKeys(key, upper);
+    return cmp < 0 || (cmp == 0 && upper_inclusive);
+  };
+  auto above_lower = [&](const GenericKey *key) {
+    if (lower == nullptr) {
+      return true;
+    }
+    int cmp = processor_.CompareKeys(key, lower);
+    return cmp > 0 || (cmp == 0 && lower_inclusive);
+  };
+  auto node = reinterpret_cast<BeTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  if (node->IsLeafPage()) {
+    auto leaf = reinterpret_cast<LeafPage *>(node);
+    for (int i = lower == nullptr ? 0 : leaf->KeyIndex(lower); i < leaf->GetSize() && below_upper(leaf->KeyAt(i));
+         i++) {
+      if (above_lower(leaf->KeyAt(i))) {
+        pairs[KeyImage(leaf->KeyAt(i))] = leaf->ValueAt(i);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return;
+  }
+  auto internal = reinterpret_cast<InternalPage *>(node);
+  int first = lower == nullptr ? 0 : internal->ChildIndex(lower);
+  int last = upper == nullptr ? internal->GetSize() - 1 : internal->ChildIndex(upper);
+  std::vector<page_id_t> children;
+  for (int i = first; i <= last; i++) {
+    children.push_back(internal->ChildAt(i));
+  }
+  std::vector<Message> messages;
+  for (int i = lower == nullptr ? 0 : internal->MessageIndex(lower);
+       i < internal->GetBufferSize() && below_upper(internal->MessageKeyAt(i)); i++) {
+    if (above_lower(internal->MessageKeyAt(i))) {
+      messages.push_back({KeyImage(internal->MessageKeyAt(i)), internal->MessageValueAt(i), internal->IsDeleteAt(i)});
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (auto child : children) {
+    Collect(child, lower, lower_inclusive, upper, upper_inclusive, pairs);
+  }
+  for (auto &message : messages) {
+    if (message.is_delete) {
+      pairs.erase(message.key);
+    } else {
+      pairs[message.key] = message.value;
+    }
+  }
+}
+
+/*****************************************************************************
+ * DESTROY
+ *****************************************************************************/
+void BeTree::Destroy() {
+  if (IsEmpty()) {
+    return;
+  }
+  DestroyPage(root_page_id_);
+  root_page_id_ = INVALID_PAGE_ID;
+  auto roots_page =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  roots_page->Delete(index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+void BeTree::DestroyPage(page_id_t page_id) {
+  auto node = reinterpret_cast<BeTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  std::vector<page_id_t> children;
+  if (!node->IsLeafPage()) {
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      children.push_back(internal->ChildAt(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (auto child : children) {
+    DestroyPage(child);
+  }
+  buffer_pool_manager_->DeletePage(page_id);
+}
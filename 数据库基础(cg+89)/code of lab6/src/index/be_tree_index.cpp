@@ -0,0 +1,72 @@
+#include "index/be_tree_index.h"
+
+#include <limits>
+
+BeTreeIndex::BeTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                         BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size, unique),
+      key_buf_(key_size),
+      upper_buf_(key_size),
+      container_(index_id, buffer_pool_manager, processor_) {}
+
+GenericKey *BeTreeIndex::MakeKey(const Row &key, const RowId &row_id) {
+  auto index_key = reinterpret_cast<GenericKey *>(key_buf_.data());
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!processor_.IsUnique()) {
+    processor_.SetKeyRowId(index_key, row_id);
+  }
+  return index_key;
+}
+
+dberr_t BeTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  if (!container_.Insert(MakeKey(key, row_id), row_id, txn)) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t BeTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  container_.Remove(MakeKey(key, row_id), txn);
+  return DB_SUCCESS;
+}
+
+dberr_t BeTreeIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator) {
+  // duplicates of a non-unique index lie between the key with the smallest and the greatest RowId
+  GenericKey *lower = MakeKey(key, RowId(std::numeric_limits<page_id_t>::min(), 0));
+  GenericKey *upper = lower;
+  if (!processor_.IsUnique()) {
+    upper = reinterpret_cast<GenericKey *>(upper_buf_.data());
+    memcpy(upper, lower, upper_buf_.size());
+    processor_.SetKeyRowId(upper,
+                           RowId(std::numeric_limits<page_id_t>::max(), std::numeric_limits<uint32_t>::max()));
+  }
+  if (compare_operator == "=") {
+    if (processor_.IsUnique()) {
+      container_.GetValue(lower, result, txn);
+    } else {
+      container_.GetRange(lower, true, upper, true, result, txn);
+    }
+  } else if (compare_operator == ">") {
+    container_.GetRange(upper, false, nullptr, false, result, txn);
+  } else if (compare_operator == ">=") {
+    container_.GetRange(lower, true, nullptr, false, result, txn);
+  } else if (compare_operator == "<") {
+    container_.GetRange(nullptr, false, lower, false, result, txn);
+  } else if (compare_operator == "<=") {
+    container_.GetRange(nullptr, false, upper, true, result, txn);
+  } else if (compare_operator == "<>") {
+    container_.GetRange(nullptr, false, lower, false, result, txn);
+    container_.GetRange(upper, false, nullptr, false, result, txn);
+  }
+  if (!result.empty()) {
+    return DB_SUCCESS;
+  }
+  return DB_KEY_NOT_FOUND;
+}
+
+dberr_t BeTreeIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
@@ -0,0 +1,358 @@
+#include "index/extendible_hash_table.h"
+
+#include <unordered_set>
+
+#include "glog/logging.h"
+#include "page/index_roots_page.h"
+
+ExtendibleHashTable::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager, int key_size)
+    : index_id_(index_id), buffer_pool_manager_(buffer_pool_manager), key_size_(key_size) {
+  auto roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  page_id_t page_id;
+  if (roots_page->GetRootId(index_id, &page_id)) {
+    directory_page_id_ = page_id;
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  if (!IsEmpty()) {
+    LoadDirectory();
+  }
+}
+
+/*
+ * 64 bit FNV-1a folded with the murmur finalizer, so that the low bits used by
+ * the directory depend on every byte of the key.
+ */
+uint32_t ExtendibleHashTable::Hash(const GenericKey *key, int key_size) {
+  auto bytes = reinterpret_cast<const unsigned char *>(key);
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < key_size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+/*****************************************************************************
+ * DIRECTORY
+ *****************************************************************************/
+/*
+ * Create the directory with global depth 0 and a single empty bucket, and
+ * record the directory page in the index roots page.
+ */
+void ExtendibleHashTable::StartNewTable() {
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+  page_id_t block_page_id;
+  Page *block = buffer_pool_manager_->NewPage(block_page_id);
+  Page *directory_page = buffer_pool_manager_->NewPage(directory_page_id_);
+  ASSERT(bucket_page != nullptr && block != nullptr && directory_page != nullptr,
+         "all page are pinned while StartNewTable");
+  auto bucket = reinterpret_cast<HashTableBucketPage *>(bucket_page->GetData());
+  auto directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  bucket->Init(key_size_, buffer_pool_manager_->GetPageSize());
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(block_page_id, true);
+  directory->Init();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+
+  global_depth_ = 0;
+  bucket_page_ids_.assign(1, bucket_page_id);
+  local_depths_.assign(1, 0);
+  block_page_ids_.assign(1, block_page_id);
+  dirty_blocks_.assign(1, true);
+  directory_dirty_ = true;
+  FlushDirectory();
+
+  auto roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  roots_page->Insert(index_id_, directory_page_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+void ExtendibleHashTable::LoadDirectory() {
+  auto directory =
+      reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+  global_depth_ = directory->GetGlobalDepth();
+  block_page_ids_.resize(directory->GetBlockCount());
+  for (uint32_t i = 0; i < block_page_ids_.size(); i++) {
+    block_page_ids_[i] = directory->GetBlockPageId(i);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  dirty_blocks_.assign(block_page_ids_.size(), false);
+
+  uint32_t slot_count = 1u << global_depth_;
+  bucket_page_ids_.resize(slot_count);
+  local_depths_.resize(slot_count);
+  for (uint32_t b = 0; b * HashTableDirectoryBlockPage::SLOTS_PER_BLOCK < slot_count; b++) {
+    auto block =
+        reinterpret_cast<HashTableDirectoryBlockPage *>(buffer_pool_manager_->FetchPage(block_page_ids_[b])->GetData());
+    for (uint32_t i = 0; i < HashTableDirectoryBlockPage::SLOTS_PER_BLOCK; i++) {
+      uint32_t slot = b * HashTableDirectoryBlockPage::SLOTS_PER_BLOCK + i;
+      if (slot >= slot_count) {
+        break;
+      }
+      bucket_page_ids_[slot] = block->SlotAt(i).bucket_page_id_;
+      local_depths_[slot] = block->SlotAt(i).local_depth_;
+    }
+    buffer_pool_manager_->UnpinPage(block_page_ids_[b], false);
+  }
+}
+
+void ExtendibleHashTable::FlushDirectory() {
+  uint32_t slot_count = bucket_page_ids_.size();
+  for (uint32_t b = 0; b < block_page_ids_.size(); b++) {
+    if (!dirty_blocks_[b]) {
+      continue;
+    }
+    auto block =
+        reinterpret_cast<HashTableDirectoryBlockPage *>(buffer_pool_manager_->FetchPage(block_page_ids_[b])->GetData());
+    for (uint32_t i = 0; i < HashTableDirectoryBlockPage::SLOTS_PER_BLOCK; i++) {
+      uint32_t slot = b * HashTableDirectoryBlockPage::SLOTS_PER_BLOCK + i;
+      if (slot >= slot_count) {
+        break;
+      }
+      block->SlotAt(i) = {bucket_page_ids_[slot], local_depths_[slot]};
+    }
+    buffer_pool_manager_->UnpinPage(block_page_ids_[b], true);
+    dirty_blocks_[b] = false;
+  }
+  if (directory_dirty_) {
+    auto directory =
+        reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+    directory->SetGlobalDepth(global_depth_);
+    directory->SetBlockCount(block_page_ids_.size());
+    for (uint32_t i = 0; i < block_page_ids_.size(); i++) {
+      directory->SetBlockPageId(i, block_page_ids_[i]);
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    directory_dirty_ = false;
+  }
+}
+
+/*
+ * Double the directory, slot i + 2^global_depth points to the same bucket as slot i.
+ * @return false if the directory already has MAX_GLOBAL_DEPTH or the pages of its new blocks
+ * can not be allocated, the blocks allocated before the failure are freed again
+ */
+bool ExtendibleHashTable::GrowDirectory() {
+  if (global_depth_ >= HashTableDirectoryPage::MAX_GLOBAL_DEPTH) {
+    return false;
+  }
+  uint32_t old_count = bucket_page_ids_.size();
+  uint32_t old_block_count = block_page_ids_.size();
+  uint32_t block_count =
+      (2 * old_count + HashTableDirectoryBlockPage::SLOTS_PER_BLOCK - 1) / HashTableDirectoryBlockPage::SLOTS_PER_BLOCK;
+  while (block_page_ids_.size() < block_count) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(block_page_id) == nullptr) {
+      while (block_page_ids_.size() > old_block_count) {
+        buffer_pool_manager_->DeletePage(block_page_ids_.back());
+        block_page_ids_.pop_back();
+        dirty_blocks_.pop_back();
+      }
+      return false;
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    block_page_ids_.push_back(block_page_id);
+    dirty_blocks_.push_back(false);
+  }
+  bucket_page_ids_.resize(2 * old_count);
+  local_depths_.resize(2 * old_count);
+  for (uint32_t i = 0; i < old_count; i++) {
+    bucket_page_ids_[old_count + i] = bucket_page_ids_[i];
+    local_depths_[old_count + i] = local_depths_[i];
+    MarkSlotDirty(old_count + i);
+  }
+  global_depth_++;
+  directory_dirty_ = true;
+  return true;
+}
+
+/*
+ * Halve the directory while no bucket uses the highest bit of the slots.
+ */
+void ExtendibleHashTable::ShrinkDirectory() {
+  while (global_depth_ > 0) {
+    for (auto local_depth : local_depths_) {
+      if (local_depth >= global_depth_) {
+        return;
+      }
+    }
+    global_depth_--;
+    uint32_t slot_count = 1u << global_depth_;
+    bucket_page_ids_.resize(slot_count);
+    local_depths_.resize(slot_count);
+    uint32_t block_count =
+        (slot_count + HashTableDirectoryBlockPage::SLOTS_PER_BLOCK - 1) / HashTableDirectoryBlockPage::SLOTS_PER_BLOCK;
+    while (block_page_ids_.size() > block_count) {
+      buffer_pool_manager_->DeletePage(block_page_ids_.back());
+      block_page_ids_.pop_back();
+      dirty_blocks_.pop_back();
+    }
+    directory_dirty_ = true;
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool ExtendibleHashTable::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
+  if (IsEmpty()) {
+    return false;
+  }
+  uint32_t hash = Hash(key, key_size_);
+  page_id_t bucket_page_id = bucket_page_ids_[SlotOf(hash)];
+  auto bucket = FetchBucket(bucket_page_id);
+  int index = bucket->Find(hash, key);
+  if (index != -1) {
+    result.push_back(bucket->ValueAt(index));
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  return index != -1;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+dberr_t ExtendibleHashTable::Insert(const GenericKey *key, const RowId &value, Transaction *transaction) {
+  if (IsEmpty()) {
+    StartNewTable();
+  }
+  uint32_t hash = Hash(key, key_size_);
+  while (true) {
+    uint32_t slot = SlotOf(hash);
+    page_id_t bucket_page_id = bucket_page_ids_[slot];
+    auto bucket = FetchBucket(bucket_page_id);
+    if (bucket->Find(hash, key) != -1) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      return DB_FAILED;
+    }
+    if (bucket->Insert(hash, key, value)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      return DB_SUCCESS;
+    }
+    // the entries may all stay on one side, then the next round splits again
+    bool split = SplitBucket(slot, bucket);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, split);
+    if (!split) {
+      LOG(WARNING) << "Hash index " << index_id_ << " can not split a full bucket any further." << std::endl;
+      return DB_INDEX_FULL;
+    }
+  }
+}
+
+bool ExtendibleHashTable::SplitBucket(uint32_t slot, HashTableBucketPage *bucket) {
+  uint32_t local_depth = local_depths_[slot];
+  if (local_depth == global_depth_ && !GrowDirectory()) {
+    return false;
+  }
+  page_id_t image_page_id;
+  Page *image_page = buffer_pool_manager_->NewPage(image_page_id);
+  if (image_page == nullptr) {
+    return false;
+  }
+  auto image = reinterpret_cast<HashTableBucketPage *>(image_page->GetData());
+  image->Init(key_size_, buffer_pool_manager_->GetPageSize());
+  uint32_t mask_bit = 1u << local_depth;
+  bucket->MoveSplitImageTo(image, mask_bit);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  // the slots of the bucket are those agreeing with slot on the low local_depth bits
+  for (uint32_t i = slot & (mask_bit - 1); i < bucket_page_ids_.size(); i += mask_bit) {
+    if ((i & mask_bit) != 0) {
+      bucket_page_ids_[i] = image_page_id;
+    }
+    local_depths_[i] = local_depth + 1;
+    MarkSlotDirty(i);
+  }
+  FlushDirectory();
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+bool ExtendibleHashTable::Remove(const GenericKey *key, const RowId &value, Transaction *transaction) {
+  if (IsEmpty()) {
+    return false;
+  }
+  uint32_t hash = Hash(key, key_size_);
+  uint32_t slot = SlotOf(hash);
+  page_id_t bucket_page_id = bucket_page_ids_[slot];
+  auto bucket = FetchBucket(bucket_page_id);
+  int index = bucket->Find(hash, key);
+  // the key may have been taken over by another row since value was indexed
+  if (index == -1 || !(bucket->ValueAt(index) == value)) {
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    return false;
+  }
+  bucket->RemoveAt(index);
+  bool empty = bucket->GetSize() == 0;
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  if (empty) {
+    MergeBucket(slot);
+  }
+  return true;
+}
+
+void ExtendibleHashTable::MergeBucket(uint32_t slot) {
+  bool merged = false;
+  while (local_depths_[slot] > 0) {
+    uint32_t local_depth = local_depths_[slot];
+    uint32_t mask_bit = 1u << (local_depth - 1);
+    uint32_t image_slot = slot ^ mask_bit;
+    if (local_depths_[image_slot] != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = bucket_page_ids_[slot];
+    page_id_t image_page_id = bucket_page_ids_[image_slot];
+    auto bucket = FetchBucket(bucket_page_id);
+    bool empty = bucket->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+    for (uint32_t i = slot & (mask_bit - 1); i < bucket_page_ids_.size(); i += mask_bit) {
+      bucket_page_ids_[i] = image_page_id;
+      local_depths_[i] = local_depth - 1;
+      MarkSlotDirty(i);
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    merged = true;
+    // the image may be empty as well, keep merging from its side
+    slot = image_slot & ((1u << (local_depth - 1)) - 1);
+  }
+  if (merged) {
+    ShrinkDirectory();
+    FlushDirectory();
+  }
+}
+
+HashTableBucketPage *ExtendibleHashTable::FetchBucket(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "all page are pinned while FetchBucket");
+  return reinterpret_cast<HashTableBucketPage *>(page->GetData());
+}
+
+void ExtendibleHashTable::Destroy() {
+  if (IsEmpty()) {
+    return;
+  }
+  std::unordered_set<page_id_t> buckets(bucket_page_ids_.begin(), bucket_page_ids_.end());
+  for (auto page_id : buckets) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  for (auto page_id : block_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  buffer_pool_manager_->DeletePage(directory_page_id_);
+  auto roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  roots_page->Delete(index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  directory_page_id_ = INVALID_PAGE_ID;
+  global_depth_ = 0;
+  bucket_page_ids_.clear();
+  local_depths_.clear();
+  block_page_ids_.clear();
+  dirty_blocks_.clear();
+}
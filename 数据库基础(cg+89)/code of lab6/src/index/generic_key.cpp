@@ -0,0 +1,164 @@
+#include "index/generic_key.h"
+
+#include <string>
+#include <vector>
+
+static inline void WriteBigEndian(char *buf, uint32_t value) {
+  for (int i = 3; i >= 0; i--) {
+    buf[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+static inline uint32_t ReadBigEndian(const char *buf) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value = (value << 8) | static_cast<uint8_t>(buf[i]);
+  }
+  return value;
+}
+
+void KeyManager::SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
+  ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
+  char *begin = key_buf->GetBytes();
+  [[maybe_unused]] char *end = key_buf->data + key_size_ - (unique_ ? 0 : sizeof(RowId));
+  char *buf = begin;
+  char value[sizeof(uint32_t)];
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Field *field = key.GetField(i);
+    ASSERT(buf < end, "Index key size exceed max key size.");
+    if (field->IsNull()) {
+      *buf++ = 0;
+      continue;
+    }
+    *buf++ = 1;
+    switch (field->GetTypeId()) {
+      case kTypeInt: {
+        ASSERT(buf + sizeof(uint32_t) <= end, "Index key size exceed max key size.");
+        field->SerializeTo(value);
+        WriteBigEndian(buf, MACH_READ_UINT32(value) ^ 0x80000000u);
+        buf += sizeof(uint32_t);
+        break;
+      }
+      case kTypeFloat: {
+        ASSERT(buf + sizeof(uint32_t) <= end, "Index key size exceed max key size.");
+        field->SerializeTo(value);
+        float f = MACH_READ_FROM(float, value);
+        // -0.0 equals 0.0
+        if (f == 0) {
+          f = 0;
+        }
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        WriteBigEndian(buf, (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u);
+        buf += sizeof(uint32_t);
+        break;
+      }
+      case kTypeChar: {
+        const char *data = field->GetData();
+        uint32_t len = field->GetLength();
+        for (uint32_t j = 0; j < len; j++) {
+          ASSERT(buf + 2 <= end, "Index key size exceed max key size.");
+          *buf++ = data[j];
+          if (data[j] == 0) {
+            *buf++ = 1;
+          }
+        }
+        ASSERT(buf + 2 <= end, "Index key size exceed max key size.");
+        *buf++ = 0;
+        *buf++ = 0;
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+  if (!unique_) {
+    // filled by SetKeyRowId
+    memset(buf, 0, sizeof(RowId));
+    buf += sizeof(RowId);
+  }
+  key_buf->SetLength(buf - begin);
+}
+
+void KeyManager::DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+  const char *buf = key_buf->GetBytes();
+  uint32_t column_count = schema->GetColumnCount();
+  std::vector<Field> fields;
+  std::vector<std::string> chars(column_count);
+  fields.reserve(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (*buf++ == 0) {
+      fields.emplace_back(type);
+      continue;
+    }
+    switch (type) {
+      case kTypeInt:
+        fields.emplace_back(type, static_cast<int32_t>(ReadBigEndian(buf) ^ 0x80000000u));
+        buf += sizeof(uint32_t);
+        break;
+      case kTypeFloat: {
+        uint32_t bits = ReadBigEndian(buf);
+        bits = (bits & 0x80000000u) ? bits ^ 0x80000000u : ~bits;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        fields.emplace_back(type, f);
+        buf += sizeof(uint32_t);
+        break;
+      }
+      case kTypeChar:
+        while (buf[0] != 0 || buf[1] != 0) {
+          chars[i].push_back(buf[0]);
+          // skip the escape of 0x00
+          buf += buf[0] == 0 ? 2 : 1;
+        }
+        buf += 2;
+        fields.emplace_back(type, chars[i].data(), chars[i].size(), false);
+        break;
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+  ASSERT(buf - key_buf->GetBytes() <= key_buf->GetLength(), "Index key size exceed max key size.");
+  Row row(fields);
+  key = row;
+}
+
+void KeyManager::SetKeyRowId(GenericKey *key_buf, const RowId &rid) const {
+  char *buf = key_buf->GetBytes() + key_buf->GetLength() - sizeof(RowId);
+  WriteBigEndian(buf, static_cast<uint32_t>(rid.GetPageId()) ^ 0x80000000u);
+  WriteBigEndian(buf + sizeof(uint32_t), rid.GetSlotNum());
+}
+
+RowId KeyManager::GetKeyRowId(const GenericKey *key_buf) const {
+  const char *buf = key_buf->GetBytes() + key_buf->GetLength() - sizeof(RowId);
+  return RowId(static_cast<page_id_t>(ReadBigEndian(buf) ^ 0x80000000u), ReadBigEndian(buf + sizeof(uint32_t)));
+}
+
+void KeyManager::ShortestSeparator(const GenericKey *lhs, const GenericKey *rhs, GenericKey *separator) {
+  ASSERT(CompareBytes(lhs->GetBytes(), lhs->GetLength(), rhs->GetBytes(), rhs->GetLength()) < 0,
+         "Separator needs ordered keys.");
+  int len = CommonPrefixLength(lhs->GetBytes(), lhs->GetLength(), rhs->GetBytes(), rhs->GetLength()) + 1;
+  len = std::min(len, static_cast<int>(rhs->GetLength()));
+  memmove(separator->GetBytes(), rhs->GetBytes(), len);
+  separator->SetLength(len);
+}
+
+int KeyManager::GetMaxKeySize(Schema *key_schema, bool unique) {
+  int size = sizeof(uint16_t);
+  for (auto column : key_schema->GetColumns()) {
+    // null flag
+    size += 1;
+    if (column->GetType() == kTypeChar) {
+      // every byte escaped in the worst case, and the terminator
+      size += 2 * column->GetLength() + 2;
+    } else {
+      size += sizeof(uint32_t);
+    }
+  }
+  if (!unique) {
+    size += sizeof(RowId);
+  }
+  return size;
+}
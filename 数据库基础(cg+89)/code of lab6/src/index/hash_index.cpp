@@ -0,0 +1,40 @@
+#include "index/hash_index.h"
+
+HashIndex::HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                     BufferPoolManager *buffer_pool_manager)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size),
+      key_buf_(key_size),
+      container_(index_id, buffer_pool_manager, key_size) {}
+
+GenericKey *HashIndex::MakeKey(const Row &key) {
+  auto index_key = reinterpret_cast<GenericKey *>(key_buf_.data());
+  memset(index_key, 0, key_buf_.size());
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  return index_key;
+}
+
+dberr_t HashIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  return container_.Insert(MakeKey(key), row_id, txn);
+}
+
+dberr_t HashIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  container_.Remove(MakeKey(key), row_id, txn);
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator) {
+  if (compare_operator != "=") {
+    return DB_FAILED;
+  }
+  if (!container_.GetValue(MakeKey(key), result, txn)) {
+    return DB_KEY_NOT_FOUND;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
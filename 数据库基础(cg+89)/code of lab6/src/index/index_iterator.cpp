@@ -8,7 +8,32 @@ IndexIterator::IndexIterator() = default;
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
   if(current_page_id!=INVALID_PAGE_ID)
-  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
+  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+}
+
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : current_page_id(other.current_page_id),
+      page(other.page),
+      item_index(other.item_index),
+      buffer_pool_manager(other.buffer_pool_manager),
+      key_buf(std::move(other.key_buf)) {
+  other.current_page_id = INVALID_PAGE_ID;
+  other.page = nullptr;
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    if (current_page_id != INVALID_PAGE_ID)
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    current_page_id = other.current_page_id;
+    page = other.page;
+    item_index = other.item_index;
+    buffer_pool_manager = other.buffer_pool_manager;
+    key_buf = std::move(other.key_buf);
+    other.current_page_id = INVALID_PAGE_ID;
+    other.page = nullptr;
+  }
+  return *this;
 }
 
 IndexIterator::~IndexIterator() {
@@ -20,7 +45,10 @@ std::pair<GenericKey *, RowId> IndexIterator::operator*() {
   if (page == nullptr) {
     return {nullptr, INVALID_ROWID};
   }
-  return std::make_pair(page->KeyAt(item_index), page->ValueAt(item_index));
+  key_buf.resize(page->GetKeySize());
+  auto *key = reinterpret_cast<GenericKey *>(key_buf.data());
+  page->KeyAt(item_index, key);
+  return std::make_pair(key, page->ValueAt(item_index));
 }
 
 IndexIterator &IndexIterator::operator++() {
@@ -31,14 +59,16 @@ IndexIterator &IndexIterator::operator++() {
     if (next_page_id != INVALID_PAGE_ID) {
       buffer_pool_manager->UnpinPage(current_page_id, false);
       current_page_id = next_page_id;
-      page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
+      page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
       item_index = 0;
     } else {
+      buffer_pool_manager->UnpinPage(current_page_id, false);
       current_page_id = INVALID_PAGE_ID;
+      page = nullptr;
       item_index = 0;
     }
   }
-
+  return *this;
 }
 
 bool IndexIterator::operator==(const IndexIterator &itr) const {
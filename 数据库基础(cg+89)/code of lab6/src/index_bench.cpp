@@ -0,0 +1,98 @@
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "glog/logging.h"
+
+/**
+ * Inserts and point lookups per second on b+ tree and be-tree indexes, one index
+ * on an int column and one on a char(32) column whose values share a long prefix.
+ *
+ * usage: index_bench [keys] [lookups]
+ * The database file is created under ./databases and removed afterwards.
+ */
+static const char *BENCH_DB_NAME = "index_bench.db";
+
+static std::string CharKey(int value) {
+  char buf[33];
+  snprintf(buf, sizeof(buf), "customer-account-%010d", value);
+  return buf;
+}
+
+static Row MakeKey(TypeId type, int value, std::string &char_buf) {
+  std::vector<Field> fields;
+  if (type == kTypeInt) {
+    fields.emplace_back(kTypeInt, value);
+  } else {
+    char_buf = CharKey(value);
+    fields.emplace_back(kTypeChar, &char_buf[0], char_buf.size(), false);
+  }
+  return Row(fields);
+}
+
+static void RunBench(CatalogManager *catalog, const std::string &index_type, const std::string &column, TypeId type,
+                     const std::vector<int> &values, int lookups) {
+  IndexInfo *index_info = nullptr;
+  std::string index_name = index_type + "_" + column;
+  catalog->CreateIndex("bench", index_name, {column}, nullptr, index_info, index_type);
+  Index *index = index_info->GetIndex();
+  std::string char_buf;
+  auto insert_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < values.size(); i++) {
+    index->InsertEntry(MakeKey(type, values[i], char_buf), RowId(values[i] / 64 + 2, values[i] % 64), nullptr);
+  }
+  double insert_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - insert_start).count();
+  std::mt19937 rng(7);
+  std::vector<Row> keys;
+  keys.reserve(lookups);
+  std::vector<std::string> char_bufs(lookups);
+  for (int i = 0; i < lookups; i++) {
+    keys.push_back(MakeKey(type, values[rng() % values.size()], char_bufs[i]));
+  }
+  int found = 0;
+  std::vector<RowId> result;
+  auto start = std::chrono::steady_clock::now();
+  for (auto &key : keys) {
+    result.clear();
+    found += index->ScanKey(key, result, nullptr, "=") == DB_SUCCESS;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%-12s %zu keys, %.0f inserts/s, %d lookups, %d found, %.0f lookups/s\n", index_name.c_str(), values.size(),
+         values.size() / insert_seconds, lookups, found, lookups / seconds);
+}
+
+int main(int argc, char **argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+  int key_count = argc > 1 ? atoi(argv[1]) : 200000;
+  int lookups = argc > 2 ? atoi(argv[2]) : 1000000;
+
+  mkdir("./databases", 0777);
+  {
+    DBStorageEngine engine(BENCH_DB_NAME, true);
+    std::vector<Column *> columns = {new Column("id", kTypeInt, 0, false, true),
+                                     new Column("name", kTypeChar, 32, 1, false, true)};
+    TableInfo *table_info = nullptr;
+    engine.catalog_mgr_->CreateTable("bench", new Schema(columns), nullptr, table_info);
+
+    std::vector<int> values(key_count);
+    std::mt19937 rng(42);
+    for (int i = 0; i < key_count; i++) {
+      values[i] = i * 3;
+    }
+    // insert in random order, pages end up as full as under a normal workload
+    std::shuffle(values.begin(), values.end(), rng);
+    for (const char *index_type : {"bptree", "betree", "art"}) {
+      RunBench(engine.catalog_mgr_, index_type, "id", kTypeInt, values, lookups);
+      RunBench(engine.catalog_mgr_, index_type, "name", kTypeChar, values, lookups);
+    }
+  }
+  remove((std::string("./databases/") + BENCH_DB_NAME).c_str());
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+#include "common/hybrid_latch.h"
+#include "common/rwlatch.h"
+
+/**
+ * Latch and unlatch pairs per second of the page latch, HybridLatch, against the mutex and condition variable based
+ * ReaderWriterLatch: without contention, and with 1 to 32 threads going over a few latches with read_percent of
+ * reads. Optimistic reads of HybridLatch are counted when they validate, the torn ones are retried.
+ *
+ * usage: latch_bench [operations] [read_percent] [latches]
+ */
+struct Protected {
+  uint64_t a{0};
+  uint64_t b{0};
+};
+
+template <typename Latch>
+struct Guarded {
+  Latch latch;
+  Protected data;
+};
+
+template <typename Latch>
+static double Uncontended(size_t operations, bool write) {
+  Guarded<Latch> guarded;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < operations; i++) {
+    if (write) {
+      guarded.latch.WLock();
+      guarded.data.a++;
+      guarded.latch.WUnlock();
+    } else {
+      guarded.latch.RLock();
+      guarded.data.b += guarded.data.a;
+      guarded.latch.RUnlock();
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return operations / seconds;
+}
+
+static double UncontendedOptimistic(size_t operations) {
+  Guarded<HybridLatch> guarded;
+  uint64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < operations; i++) {
+    uint64_t version = guarded.latch.OptimisticRead();
+    uint64_t a = guarded.data.a;
+    if (guarded.latch.Validate(version)) {
+      sum += a;
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  guarded.data.b = sum;
+  return operations / seconds;
+}
+
+// the writers keep a == b, a read seeing them differ means the latch let a reader in during a write
+template <typename Latch>
+static double Contended(size_t operations, int read_percent, size_t latch_count, int thread_count, bool optimistic,
+                        size_t *broken) {
+  std::vector<Guarded<Latch>> guarded(latch_count);
+  size_t per_thread = operations / thread_count;
+  std::vector<size_t> broken_reads(thread_count, 0);
+  auto worker = [&](int t) {
+    std::mt19937 rng(t + 1);
+    for (size_t i = 0; i < per_thread; i++) {
+      auto &g = guarded[rng() % latch_count];
+      if (static_cast<int>(rng() % 100) >= read_percent) {
+        g.latch.WLock();
+        g.data.a++;
+        g.data.b++;
+        g.latch.WUnlock();
+      } else if (optimistic) {
+        if constexpr (std::is_same_v<Latch, HybridLatch>) {
+          while (true) {
+            uint64_t version = g.latch.OptimisticRead();
+            uint64_t a = reinterpret_cast<volatile uint64_t &>(g.data.a);
+            uint64_t b = reinterpret_cast<volatile uint64_t &>(g.data.b);
+            if (g.latch.Validate(version)) {
+              broken_reads[t] += a != b;
+              break;
+            }
+          }
+        }
+      } else {
+        g.latch.RLock();
+        broken_reads[t] += g.data.a != g.data.b;
+        g.latch.RUnlock();
+      }
+    }
+  };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back(worker, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (auto count : broken_reads) {
+    *broken += count;
+  }
+  return per_thread * thread_count / seconds;
+}
+
+int main(int argc, char **argv) {
+  size_t operations = argc > 1 ? atoi(argv[1]) : 4000000;
+  int read_percent = argc > 2 ? atoi(argv[2]) : 90;
+  size_t latch_count = argc > 3 ? atoi(argv[3]) : 16;
+  // glibc locks mutexes without atomics until a second thread exists, the engine always runs the background writer
+  std::thread([] {}).join();
+  printf("sizeof HybridLatch %zu, sizeof ReaderWriterLatch %zu, %u hardware threads\n", sizeof(HybridLatch),
+         sizeof(ReaderWriterLatch), std::thread::hardware_concurrency());
+  printf("uncontended ops/s      %16s %16s\n", "HybridLatch", "RWLatch");
+  printf("  read                 %16.0f %16.0f\n", Uncontended<HybridLatch>(operations, false),
+         Uncontended<ReaderWriterLatch>(operations, false));
+  printf("  write                %16.0f %16.0f\n", Uncontended<HybridLatch>(operations, true),
+         Uncontended<ReaderWriterLatch>(operations, true));
+  printf("  optimistic read      %16.0f\n", UncontendedOptimistic(operations));
+  printf("%zu latches, %d%% reads, ops/s\n", latch_count, read_percent);
+  printf("threads %16s %16s %16s\n", "HybridLatch", "optimistic", "RWLatch");
+  size_t broken = 0;
+  for (int thread_count : {1, 2, 4, 8, 16, 32}) {
+    double hybrid = Contended<HybridLatch>(operations, read_percent, latch_count, thread_count, false, &broken);
+    double optimistic = Contended<HybridLatch>(operations, read_percent, latch_count, thread_count, true, &broken);
+    double rwlatch = Contended<ReaderWriterLatch>(operations, read_percent, latch_count, thread_count, false, &broken);
+    printf("%-7d %16.0f %16.0f %16.0f\n", thread_count, hybrid, optimistic, rwlatch);
+  }
+  printf("broken reads: %zu\n", broken);
+  return broken == 0 ? 0 : 1;
+}
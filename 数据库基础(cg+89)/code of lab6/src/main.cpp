@@ -1,9 +1,8 @@
 #include <cstdio>
+#include <string>
 
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
-#include "parser/syntax_tree_printer.h"
-#include "utils/tree_file_mgr.h"
 /*extern "C" {
 int yyparse(void);
 FILE *yyin;
@@ -18,65 +17,37 @@ void InitGoogleLog(char *argv) {
   // LOG(INFO) << "glog started!";
 }
 
-void InputCommand(char *input, const int len) {
-  memset(input, 0, len);
+// 读入一条以 ; 结尾的语句, 多行 INSERT 可以很长, 所以不限长度; 输入结束时返回 false
+bool InputCommand(std::string *input) {
+  input->clear();
   printf("minisql > ");
-  int i = 0;
-  char ch;
+  int ch;
   while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+    if (ch == EOF) {
+      return false;
+    }
+    input->push_back(static_cast<char>(ch));
   }
-  input[i] = ch;  // ;
-  getchar();      // remove enter
+  input->push_back(';');
+  getchar();  // remove enter
+  return true;
 }
 
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  std::string cmd;
 
   // executor engine
   ExecuteEngine engine;
 
-  // for print syntax tree
-  TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
-  uint32_t syntax_tree_id = 0;
-
   while (1) {
-    // read from buffer
-    InputCommand(cmd, buf_size);
-    // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
-    }
-    yy_switch_to_buffer(bp);
-
-    // init parser module
-    MinisqlParserInit();
-
-    // parse
-    yyparse();
-
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-      // Comment them out if you don't need to debug the syntax tree
-      printf("[INFO] Sql syntax parse ok!\n");
-      SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
+    // read from buffer, end of input quits like quit;
+    if (!InputCommand(&cmd)) {
+      break;
     }
-
-    auto result = engine.Execute(MinisqlGetParserRootNode());
-
-    // clean memory after parse
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
+    // parse and execute, the syntax tree is dumped to syntax_tree_* files with ENABLE_PARSER_DEBUG
+    auto result = engine.ExecuteSql(cmd);
 
     // quit condition
     engine.ExecuteInformation(result);
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/metrics.h"
+#include "glog/logging.h"
+
+/**
+ * Cost of the metrics against the work they are attached to: a counter add, latched or not, a histogram record and
+ * a timed region (a record and two clock reads) in nanoseconds, next to a buffer pool hit (FetchPage and UnpinPage,
+ * which count a hit with a latched add) and a page read from the disk manager (which counts the page and times one
+ * read in DISK_LATENCY_SAMPLE_RATE). The overhead printed is the share of the instrumented operation taken by its
+ * metrics. Counters are also added from 1 to 16 threads at once.
+ *
+ * usage: metrics_bench [operations]
+ * The database file is created under ./databases and removed afterwards.
+ */
+static const char *BENCH_DB_FILE = "./databases/metrics_bench.db";
+static const int BENCH_PAGES = 256;
+
+template <typename F>
+static double NanosPerOp(size_t operations, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < operations; i++) {
+    f(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / operations;
+}
+
+static double ContendedAdds(size_t operations, int thread_count) {
+  Counter counter;
+  size_t per_thread = operations / thread_count;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < per_thread; i++) {
+        counter.Add();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / per_thread;
+}
+
+int main(int argc, char **argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+  size_t operations = argc > 1 ? atoi(argv[1]) : 10000000;
+
+  Counter counter;
+  Histogram histogram;
+  double add = NanosPerOp(operations, [&](size_t) { counter.Add(); });
+  double latched_add = NanosPerOp(operations, [&](size_t) { counter.AddLatched(); });
+  double record = NanosPerOp(operations, [&](size_t i) { histogram.Record(i & 0xffff); });
+  double timed = NanosPerOp(operations, [&](size_t) { ScopedTimer timer(&histogram); });
+
+  remove(BENCH_DB_FILE);
+  double hit, read;
+  {
+    DiskManager disk_manager(BENCH_DB_FILE);
+    BufferPoolManager bpm(BENCH_PAGES, &disk_manager);
+    std::vector<page_id_t> page_ids(BENCH_PAGES);
+    for (auto &page_id : page_ids) {
+      bpm.NewPage(page_id);
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+    hit = NanosPerOp(operations, [&](size_t i) {
+      page_id_t page_id = page_ids[i % BENCH_PAGES];
+      bpm.FetchPage(page_id);
+      bpm.UnpinPage(page_id, false);
+    });
+    std::vector<char> data(disk_manager.GetPageSize());
+    read = NanosPerOp(operations / 100,
+                      [&](size_t i) { disk_manager.ReadPage(page_ids[i % BENCH_PAGES], data.data()); });
+    disk_manager.Close();
+  }
+  remove(BENCH_DB_FILE);
+
+  printf("%zu operations, %u hardware threads\n", operations, std::thread::hardware_concurrency());
+  printf("counter add          %8.2f ns\n", add);
+  printf("latched counter add  %8.2f ns\n", latched_add);
+  printf("histogram record     %8.2f ns\n", record);
+  printf("timed region         %8.2f ns\n", timed);
+  printf("buffer pool hit      %8.2f ns, metrics overhead %.2f%%\n", hit, 100 * latched_add / hit);
+  printf("disk page read       %8.2f ns, metrics overhead %.2f%%\n", read,
+         100 * (add + timed / DISK_LATENCY_SAMPLE_RATE) / read);
+  printf("counter adds from several threads at once, ns per add\n");
+  for (int thread_count : {1, 2, 4, 8, 16}) {
+    printf("  %-2d threads %8.2f ns\n", thread_count, ContendedAdds(operations, thread_count));
+  }
+  return 0;
+}
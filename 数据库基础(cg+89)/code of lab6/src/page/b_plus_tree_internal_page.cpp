@@ -1,11 +1,8 @@
 #include "page/b_plus_tree_internal_page.h"
 
-#include "index/generic_key.h"
+#include <algorithm>
 
-#define pairs_off (data_ + INTERNAL_PAGE_HEADER_SIZE)
-#define pair_size (GetKeySize() + sizeof(page_id_t))
-#define key_off 0
-#define val_off GetKeySize()
+#include "index/generic_key.h"
 
 /**
  * TODO: Student Implement
@@ -18,32 +15,128 @@
  * Including set page type, set current size, set page id, set parent id and set
  * max page size
  */
-void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
+void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size, uint32_t page_size) {
   SetPageId(page_id);
   SetParentPageId(parent_id);
   SetKeySize(key_size);
   SetMaxSize(max_size);
   SetSize(0);
   SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetPageSize(page_size);
+  prefix_length_ = 0;
+  heap_top_ = DataSize();
+}
+
+int InternalPage::BytesFor(int count, int key_bytes, int prefix_length) {
+  // 第一个槽没有key
+  int key_count = std::max(count - 1, 0);
+  return SlotBytes(count) + key_bytes - key_count * prefix_length + prefix_length;
+}
+
+int InternalPage::GetKeyBytes() const {
+  int key_bytes = 0;
+  for (int i = 1; i < GetSize(); i++) {
+    key_bytes += prefix_length_ + SlotAt(i)->key_length_;
+  }
+  return key_bytes;
+}
+
+int InternalPage::GetUsedBytes() const {
+  return BytesFor(GetSize(), GetKeyBytes(), prefix_length_);
+}
+
+bool InternalPage::HasRoomFor(const GenericKey *key, int replace_index) const {
+  int count = GetSize();
+  int key_bytes = GetKeyBytes() + key->GetLength();
+  if (replace_index < 0) {
+    if (GetMaxSize() != UNDEFINED_SIZE && count >= GetMaxSize()) {
+      return false;
+    }
+    count++;
+  } else {
+    key_bytes -= prefix_length_ + SlotAt(replace_index)->key_length_;
+  }
+  int prefix_length = KeyManager::CommonPrefixLength(key->GetBytes(), key->GetLength(), PrefixPtr(), prefix_length_);
+  return BytesFor(count, key_bytes, prefix_length) <= DataSize();
+}
+
+bool InternalPage::IsUnderflow() const {
+  if (GetMaxSize() != UNDEFINED_SIZE) {
+    return GetSize() < GetMinSize();
+  }
+  return GetUsedBytes() < DataSize() / 4;
 }
+
+bool InternalPage::FitsMerged(const InternalPage *left, const GenericKey *middle_key, const InternalPage *right) {
+  int count = left->GetSize() + right->GetSize();
+  if (left->GetMaxSize() != UNDEFINED_SIZE && count > left->GetMaxSize()) {
+    return false;
+  }
+  std::string middle(middle_key->GetBytes(), middle_key->GetLength());
+  // key有序，所有key的公共前缀即最小与最大key的公共前缀
+  std::string first_key = left->GetSize() > 1 ? left->CopyKey(1) : middle;
+  std::string last_key = right->GetSize() > 1 ? right->CopyKey(right->GetSize() - 1) : middle;
+  int prefix_length =
+      KeyManager::CommonPrefixLength(first_key.data(), first_key.size(), last_key.data(), last_key.size());
+  int key_bytes = left->GetKeyBytes() + middle.size() + right->GetKeyBytes();
+  return BytesFor(count, key_bytes, prefix_length) <= left->DataSize();
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *InternalPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+void InternalPage::KeyAt(int index, GenericKey *key) const {
+  if (index == 0) {
+    key->SetLength(0);
+    return;
+  }
+  const Slot *slot = SlotAt(index);
+  memcpy(key->GetBytes(), PrefixPtr(), prefix_length_);
+  memcpy(key->GetBytes() + prefix_length_, data_ + slot->key_offset_, slot->key_length_);
+  key->SetLength(prefix_length_ + slot->key_length_);
 }
 
-void InternalPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+std::string InternalPage::CopyKey(int index) const {
+  if (index == 0) {
+    return std::string();
+  }
+  const Slot *slot = SlotAt(index);
+  std::string key(PrefixPtr(), prefix_length_);
+  key.append(data_ + slot->key_offset_, slot->key_length_);
+  return key;
+}
+
+/*
+ * The caller makes sure the key fits with HasRoomFor(key, index)
+ */
+void InternalPage::SetKeyAt(int index, const GenericKey *key) {
+  ASSERT(index > 0 && HasRoomFor(key, index), "No room for the key in internal page.");
+  int length = key->GetLength();
+  int suffix_length = length - prefix_length_;
+  bool shares_prefix = length >= prefix_length_ && memcmp(key->GetBytes(), PrefixPtr(), prefix_length_) == 0;
+  if (shares_prefix && heap_top_ - SlotBytes(GetSize()) >= suffix_length) {
+    heap_top_ -= suffix_length;
+    memcpy(data_ + heap_top_, key->GetBytes() + prefix_length_, suffix_length);
+    Heads()[index] = KeyManager::KeyHead(data_ + heap_top_, suffix_length);
+    SlotAt(index)->key_offset_ = heap_top_;
+    SlotAt(index)->key_length_ = suffix_length;
+    return;
+  }
+  // 公共前缀变短，或者连续空间不足，整页重建
+  std::vector<std::string> keys;
+  std::vector<page_id_t> values;
+  CopyOut(keys, values);
+  keys[index].assign(key->GetBytes(), length);
+  Rebuild(keys, values);
 }
 
 page_id_t InternalPage::ValueAt(int index) const {
-  return *reinterpret_cast<const page_id_t *>(pairs_off + index * pair_size + val_off);
+  return SlotAt(index)->value_;
 }
 
 void InternalPage::SetValueAt(int index, page_id_t value) {
-  *reinterpret_cast<page_id_t *>(pairs_off + index * pair_size + val_off) = value;
+  SlotAt(index)->value_ = value;
 }
 
 int InternalPage::ValueIndex(const page_id_t &value) const {
@@ -53,11 +146,97 @@ int InternalPage::ValueIndex(const page_id_t &value) const {
   return -1;
 }
 
-void *InternalPage::PairPtrAt(int index) { return KeyAt(index); }
+void InternalPage::CopyOut(std::vector<std::string> &keys, std::vector<page_id_t> &values) const {
+  for (int i = 0; i < GetSize(); i++) {
+    keys.push_back(CopyKey(i));
+    values.push_back(ValueAt(i));
+  }
+}
 
-void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
+/*
+ * 整页重建：重新计算公共前缀，并整理堆中被删除key留下的空洞，第一个key被忽略
+ */
+void InternalPage::Rebuild(const std::vector<std::string> &keys, const std::vector<page_id_t> &values) {
+  int count = keys.size();
+  int prefix_length = 0;
+  if (count > 1) {
+    prefix_length = KeyManager::CommonPrefixLength(keys[1].data(), keys[1].size(), keys.back().data(),
+                                                   keys.back().size());
+  }
+  prefix_length_ = prefix_length;
+  heap_top_ = DataSize() - prefix_length;
+  if (count > 1) {
+    memcpy(data_ + heap_top_, keys[1].data(), prefix_length);
+  }
+  // 先设置大小，槽数组的位置取决于首部数组的长度
+  SetSize(count);
+  for (int i = 0; i < count; i++) {
+    Slot *slot = SlotAt(i);
+    slot->value_ = values[i];
+    if (i == 0) {
+      Heads()[i] = 0;
+      slot->key_offset_ = heap_top_;
+      slot->key_length_ = 0;
+      continue;
+    }
+    int suffix_length = keys[i].size() - prefix_length;
+    heap_top_ -= suffix_length;
+    memcpy(data_ + heap_top_, keys[i].data() + prefix_length, suffix_length);
+    Heads()[i] = KeyManager::KeyHead(data_ + heap_top_, suffix_length);
+    slot->key_offset_ = heap_top_;
+    slot->key_length_ = suffix_length;
+  }
+  ASSERT(SlotBytes(count) <= heap_top_, "Internal page overflow.");
+}
+
+InternalPage::Slot *InternalPage::InsertSlotAt(int index) {
+  int size = GetSize();
+  char *slots = reinterpret_cast<char *>(SlotAt(0));
+  char *new_slots = slots + sizeof(uint32_t);
+  // 从高地址往低地址依次移动：index之后的槽、index之前的槽、index之后的首部
+  memmove(new_slots + (index + 1) * sizeof(Slot), slots + index * sizeof(Slot), (size - index) * sizeof(Slot));
+  memmove(new_slots, slots, index * sizeof(Slot));
+  memmove(Heads() + index + 1, Heads() + index, (size - index) * sizeof(uint32_t));
+  IncreaseSize(1);
+  return SlotAt(index);
+}
+
+void InternalPage::InsertAt(int index, const GenericKey *key, page_id_t value) {
+  ASSERT(index > 0 && HasRoomFor(key), "No room for the key in internal page.");
+  int length = key->GetLength();
+  int suffix_length = length - prefix_length_;
+  bool shares_prefix = length >= prefix_length_ && memcmp(key->GetBytes(), PrefixPtr(), prefix_length_) == 0;
+  if (GetSize() > 1 && shares_prefix &&
+      heap_top_ - SlotBytes(GetSize() + 1) >= suffix_length) {
+    Slot *slot = InsertSlotAt(index);
+    heap_top_ -= suffix_length;
+    memcpy(data_ + heap_top_, key->GetBytes() + prefix_length_, suffix_length);
+    Heads()[index] = KeyManager::KeyHead(data_ + heap_top_, suffix_length);
+    slot->key_offset_ = heap_top_;
+    slot->key_length_ = suffix_length;
+    slot->value_ = value;
+    return;
+  }
+  // 公共前缀变短，或者连续空间不足，整页重建
+  std::vector<std::string> keys;
+  std::vector<page_id_t> values;
+  CopyOut(keys, values);
+  keys.emplace(keys.begin() + index, key->GetBytes(), length);
+  values.insert(values.begin() + index, value);
+  Rebuild(keys, values);
+}
+
+void InternalPage::AdoptChildren(int begin, int end, BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; ++i) {
+    page_id_t child_page_id = ValueAt(i);
+    Page *child_page = buffer_pool_manager->FetchPage(child_page_id);
+    ASSERT(child_page != nullptr, "can't fetch child page");
+    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    child_node->SetParentPageId(GetPageId());
+    buffer_pool_manager->UnpinPage(child_page_id, true);
+  }
 }
+
 /*****************************************************************************
  * LOOKUP
  *****************************************************************************/
@@ -65,19 +244,36 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * Find and return the child pointer(page_id) which points to the child page
  * that contains input "key"
  * Start the search from the second key(the first key should always be invalid)
- * 用了二分查找
+ * 先和公共前缀比较一次，再在首部数组上无分支二分查找，首部相同时才比较完整的剩余部分
  */
-page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
-  int l = 1, r = GetSize();
+page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) const {
+  if (GetSize() <= 1) {
+    return ValueAt(0);
+  }
+  int length = key->GetLength();
+  int cmp = memcmp(key->GetBytes(), PrefixPtr(), std::min(length, static_cast<int>(prefix_length_)));
+  if (cmp < 0 || (cmp == 0 && length < prefix_length_)) {
+    return ValueAt(0);
+  }
+  if (cmp > 0) {
+    return ValueAt(GetSize() - 1);
+  }
+  const char *suffix = key->GetBytes() + prefix_length_;
+  int suffix_length = length - prefix_length_;
+  uint32_t head = KeyManager::KeyHead(suffix, suffix_length);
+  int size = GetSize();
+  int l = LowerBoundHead(Heads(), 1, size, head);
+  int r = UpperBoundHead(Heads(), l, size, head);
+  const Slot *slots = SlotAt(0);
   for (; l < r;) {
     int mid = (l + r) >> 1;
-    if (KM.CompareKeys(key, KeyAt(mid)) < 0)
+    const Slot *slot = slots + mid;
+    if (KeyManager::CompareBytes(suffix, suffix_length, data_ + slot->key_offset_, slot->key_length_) < 0)
       r = mid;
     else
       l = mid + 1;
   }
   return ValueAt(l - 1);
-  // return INVALID_PAGE_ID;
 }
 
 /*****************************************************************************
@@ -89,24 +285,21 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
  * page, you should create a new root page and populate its elements.
  * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
-void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  SetSize(2);
-  SetValueAt(0, old_value);
-  SetKeyAt(1, new_key);
-  SetValueAt(1, new_value);
+void InternalPage::PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key,
+                                   const page_id_t &new_value) {
+  std::vector<std::string> keys{std::string(), std::string(new_key->GetBytes(), new_key->GetLength())};
+  Rebuild(keys, {old_value, new_value});
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
+ * The caller makes sure the key fits with HasRoomFor()
  * @return:  new size after insertion
  */
-int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  int i = ValueIndex(old_value);
-  PairCopy(KeyAt(i + 2), KeyAt(i + 1), GetSize() - i - 1);
-  SetSize(GetSize() + 1);
-  SetKeyAt(i + 1, new_key);
-  SetValueAt(i + 1, new_value);
+int InternalPage::InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key,
+                                  const page_id_t &new_value) {
+  InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
   return GetSize();
 }
 
@@ -115,32 +308,36 @@ int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_ke
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
- * buffer_pool_manager 是干嘛的？传给CopyNFrom()用于Fetch数据页
- */
-void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  int mid = size / 2;
-  recipient->CopyNFrom(PairPtrAt(mid), size - mid, buffer_pool_manager);
-  SetSize(mid);
-}
-
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- *
+ * buffer_pool_manager 是干嘛的？传给AdoptChildren()用于Fetch数据页
+ * 按字节数平分，被移走一半的第一个key上移到父节点
  */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager) {
-  int old_size = GetSize();
-  SetSize(old_size + size);
-  PairCopy(KeyAt(old_size), src, size);
-  for (int i = old_size; i < GetSize(); ++i) {
-    page_id_t child_page_id = ValueAt(i);
-    Page *child_page = buffer_pool_manager->FetchPage(child_page_id);
-    ASSERT(child_page != nullptr, "can't fetch child page");
-    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-    child_node->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(child_page_id, true);
+void InternalPage::MoveHalfTo(InternalPage *recipient, GenericKey *middle_key,
+                              BufferPoolManager *buffer_pool_manager) {
+  std::vector<std::string> keys;
+  std::vector<page_id_t> values;
+  CopyOut(keys, values);
+  int count = keys.size();
+  int total = 0;
+  for (auto &key : keys) {
+    total += SlotBytes(1) + key.size();
+  }
+  int mid = 0;
+  for (int bytes = 0; mid < count && bytes * 2 < total; mid++) {
+    bytes += SlotBytes(1) + keys[mid].size();
   }
+  if (GetMaxSize() != UNDEFINED_SIZE) {
+    mid = count / 2;
+  }
+  // 两页都至少保留两个子节点
+  mid = std::max(2, std::min(mid, count - 2));
+  memcpy(middle_key->GetBytes(), keys[mid].data(), keys[mid].size());
+  middle_key->SetLength(keys[mid].size());
+  recipient->Rebuild(std::vector<std::string>(keys.begin() + mid, keys.end()),
+                     std::vector<page_id_t>(values.begin() + mid, values.end()));
+  recipient->AdoptChildren(0, recipient->GetSize(), buffer_pool_manager);
+  keys.resize(mid);
+  values.resize(mid);
+  Rebuild(keys, values);
 }
 
 /*****************************************************************************
@@ -152,8 +349,30 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
  * NOTE: store key&value pair continuously after deletion
  */
 void InternalPage::Remove(int index) {
-  PairCopy(KeyAt(index), KeyAt(index + 1), GetSize() - index - 1);
-  SetSize(GetSize() - 1);
+  const Slot *slot = SlotAt(index);
+  if (slot->key_offset_ == heap_top_) {
+    // 最后写入的key紧贴堆顶，可以直接收回
+    heap_top_ += slot->key_length_;
+  }
+  int size = GetSize();
+  char *slots = reinterpret_cast<char *>(SlotAt(0));
+  char *new_slots = slots - sizeof(uint32_t);
+  // 从低地址往高地址依次移动：index之后的首部、index之前的槽、index之后的槽
+  memmove(Heads() + index, Heads() + index + 1, (size - index - 1) * sizeof(uint32_t));
+  memmove(new_slots, slots, index * sizeof(Slot));
+  memmove(new_slots + index * sizeof(Slot), slots + (index + 1) * sizeof(Slot), (size - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+  if (GetSize() <= 1) {
+    // 没有key了，公共前缀随之清空
+    prefix_length_ = 0;
+    heap_top_ = DataSize();
+  }
+  if (GetSize() > 0) {
+    // 第一个槽没有key
+    Heads()[0] = 0;
+    SlotAt(0)->key_offset_ = heap_top_;
+    SlotAt(0)->key_length_ = 0;
+  }
 }
 
 /*
@@ -161,8 +380,9 @@ void InternalPage::Remove(int index) {
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 page_id_t InternalPage::RemoveAndReturnOnlyChild() {
+  page_id_t child = ValueAt(0);
   SetSize(0);
-  return ValueAt(0);
+  return child;
 }
 
 /*****************************************************************************
@@ -175,19 +395,17 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
  */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  int old_size = recipient->GetSize();
-  recipient->CopyNFrom(PairPtrAt(0), size, buffer_pool_manager);
-  recipient->SetKeyAt(old_size, middle_key);
-  for (int i = 0; i < size; ++i) {
-    page_id_t child_page_id = ValueAt(i);
-    Page *child_page = buffer_pool_manager->FetchPage(child_page_id);
-    ASSERT(child_page != nullptr, "can't fetch child page");
-    auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-    child_node->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(child_page_id, true);
-  }
+void InternalPage::MoveAllTo(InternalPage *recipient, const GenericKey *middle_key,
+                             BufferPoolManager *buffer_pool_manager) {
+  std::vector<std::string> keys;
+  std::vector<page_id_t> values;
+  recipient->CopyOut(keys, values);
+  int old_size = keys.size();
+  CopyOut(keys, values);
+  keys[old_size].assign(middle_key->GetBytes(), middle_key->GetLength());
+  recipient->Rebuild(keys, values);
+  recipient->AdoptChildren(old_size, recipient->GetSize(), buffer_pool_manager);
+  SetSize(0);
 }
 
 /*****************************************************************************
@@ -201,28 +419,14 @@ void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, Bu
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
  */
-void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
+void InternalPage::MoveFirstToEndOf(InternalPage *recipient, const GenericKey *middle_key,
                                     BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom(middle_key, ValueAt(0), buffer_pool_manager);
+  int size = recipient->GetSize();
+  recipient->InsertAt(size, middle_key, ValueAt(0));
+  recipient->AdoptChildren(size, size + 1, buffer_pool_manager);
   Remove(0);
 }
 
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  SetSize(size + 1);
-  SetKeyAt(size, key);
-  SetValueAt(size, value);
-  Page *child_page = buffer_pool_manager->FetchPage(value);
-  ASSERT(child_page != nullptr, "can't fetch child page");
-  auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-  child_node->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);
-}
-
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
  * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
@@ -230,26 +434,14 @@ void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPo
  * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
  * moved to the recipient
  */
-void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
+void InternalPage::MoveLastToFrontOf(InternalPage *recipient, const GenericKey *middle_key,
                                      BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  SetSize(size - 1);
-  recipient->CopyFirstFrom(ValueAt(size - 1), buffer_pool_manager);
-  recipient->SetKeyAt(1, middle_key);
+  int last = GetSize() - 1;
+  std::vector<std::string> keys{std::string()};
+  std::vector<page_id_t> values{ValueAt(last)};
+  recipient->CopyOut(keys, values);
+  keys[1].assign(middle_key->GetBytes(), middle_key->GetLength());
+  recipient->Rebuild(keys, values);
+  recipient->AdoptChildren(0, 1, buffer_pool_manager);
+  Remove(last);
 }
-
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  SetSize(size + 1);
-  PairCopy(KeyAt(1), KeyAt(0), size);
-  SetValueAt(0, value);
-  Page *child_page = buffer_pool_manager->FetchPage(value);
-  ASSERT(child_page != nullptr, "can't fetch child page");
-  auto *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-  child_node->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);
-}
\ No newline at end of file
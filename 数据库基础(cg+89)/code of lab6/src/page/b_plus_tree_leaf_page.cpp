@@ -4,10 +4,6 @@
 
 #include "index/generic_key.h"
 
-#define pairs_off (data_ + LEAF_PAGE_HEADER_SIZE)
-#define pair_size (GetKeySize() + sizeof(RowId))
-#define key_off 0
-#define val_off GetKeySize()
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -21,7 +17,7 @@
  * next page id and set max size
  * 未初始化next_page_id
  */
-void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
+void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size, uint32_t page_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   // 设置当前大小为 0
   SetSize(0);
@@ -34,8 +30,11 @@ void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int ma
     SetMaxSize(max_size);
   // 设置 key 大小
     SetKeySize(key_size);
-
-
+  // 页大小随数据库而定，要在算DataSize之前设置
+  SetPageSize(page_size);
+  // 空页没有公共前缀，堆从页尾开始
+  prefix_length_ = 0;
+  heap_top_ = DataSize();
 }
 
 /**
@@ -58,68 +57,198 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
 /**
  * Helper method to find the first index i so that pairs_[i].first >= key
  * NOTE: This method is only used when generating index iterator
- * 二分查找
+ * 先和页内公共前缀比较一次，再在首部数组上无分支二分查找，首部相同时才比较完整的剩余部分
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  int left = 0, right = GetSize()-1 ;  // 第一个Key是Invalid_Page_Id，所以从1开始
-  while (left <= right) {
+int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) const {
+  int length = key->GetLength();
+  int cmp = memcmp(key->GetBytes(), PrefixPtr(), std::min(length, static_cast<int>(prefix_length_)));
+  if (cmp < 0 || (cmp == 0 && length < prefix_length_)) {
+    return 0;
+  }
+  if (cmp > 0) {
+    return GetSize();
+  }
+  const char *suffix = key->GetBytes() + prefix_length_;
+  int suffix_length = length - prefix_length_;
+  uint32_t head = KeyManager::KeyHead(suffix, suffix_length);
+  int size = GetSize();
+  int left = LowerBoundHead(Heads(), 0, size, head);
+  int right = UpperBoundHead(Heads(), left, size, head);
+  const Slot *slots = SlotAt(0);
+  while (left < right) {
     int mid = (left + right) >> 1;
-    auto cur = KeyAt(mid);
-    //ASSERT(false,"fail");
-    std::vector<Column *> columns = {
-        new Column("int", TypeId::kTypeInt, 0, false, false),
-    };
-   // Row keyrow(INVALID_ROWID);
-    //Schema *table_schema = new Schema(columns);
-    //KeyManager KP(table_schema, 16);
-
-    //KP.DeserializeToKey(key,keyrow,table_schema );
-   // Field *row_value =keyrow.GetField(0);
-   // auto x=row_value ->toString();
-    if (KM.CompareKeys(key, cur) >0)
-      left = mid +1;
+    const Slot *slot = slots + mid;
+    if (KeyManager::CompareBytes(suffix, suffix_length, data_ + slot->key_offset_, slot->key_length_) > 0)
+      left = mid + 1;
     else
-      right = mid -1;
+      right = mid;
+  }
+  return left;
+}
+
+int LeafPage::CompareWith(const GenericKey *key, int index) const {
+  int length = key->GetLength();
+  int cmp = memcmp(key->GetBytes(), PrefixPtr(), std::min(length, static_cast<int>(prefix_length_)));
+  if (cmp != 0) {
+    return cmp;
+  }
+  if (length < prefix_length_) {
+    return -1;
   }
-  return right+1 ;
-  return 0;
+  const Slot *slot = SlotAt(index);
+  return KeyManager::CompareBytes(key->GetBytes() + prefix_length_, length - prefix_length_,
+                                  data_ + slot->key_offset_, slot->key_length_);
+}
+
+int LeafPage::BytesFor(int count, int key_bytes, int prefix_length) {
+  return SlotBytes(count) + key_bytes - count * prefix_length + prefix_length;
+}
+
+int LeafPage::GetKeyBytes() const {
+  int key_bytes = GetSize() * prefix_length_;
+  for (int i = 0; i < GetSize(); i++) {
+    key_bytes += SlotAt(i)->key_length_;
+  }
+  return key_bytes;
+}
+
+int LeafPage::GetUsedBytes() const {
+  return BytesFor(GetSize(), GetKeyBytes(), prefix_length_);
+}
+
+bool LeafPage::HasRoomFor(const GenericKey *key) const {
+  if (GetMaxSize() != UNDEFINED_SIZE && GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  int length = key->GetLength();
+  int prefix_length = KeyManager::CommonPrefixLength(key->GetBytes(), length, PrefixPtr(), prefix_length_);
+  // 共享前缀且连续空间足够时不必统计整页
+  if (prefix_length == prefix_length_ &&
+      heap_top_ - SlotBytes(GetSize() + 1) >= length - prefix_length) {
+    return true;
+  }
+  return BytesFor(GetSize() + 1, GetKeyBytes() + length, prefix_length) <= DataSize();
+}
+
+bool LeafPage::IsUnderflow() const {
+  if (GetMaxSize() != UNDEFINED_SIZE) {
+    return GetSize() < GetMinSize();
+  }
+  return GetUsedBytes() < DataSize() / 4;
+}
+
+bool LeafPage::FitsMerged(const LeafPage *left, const LeafPage *right) {
+  int count = left->GetSize() + right->GetSize();
+  if (left->GetMaxSize() != UNDEFINED_SIZE && count > left->GetMaxSize()) {
+    return false;
+  }
+  if (left->GetSize() == 0 || right->GetSize() == 0) {
+    // 一侧为空，合并后与另一侧相同
+    return true;
+  }
+  // key有序，所有key的公共前缀即最小与最大key的公共前缀
+  std::string first_key = left->CopyKey(0);
+  std::string last_key = right->CopyKey(right->GetSize() - 1);
+  int prefix_length =
+      KeyManager::CommonPrefixLength(first_key.data(), first_key.size(), last_key.data(), last_key.size());
+  return BytesFor(count, left->GetKeyBytes() + right->GetKeyBytes(), prefix_length) <=
+         left->DataSize();
 }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *LeafPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
-}
-
-void LeafPage::SetKeyAt(int index, GenericKey *key) {
-  memmove(pairs_off + index * pair_size + key_off, key, GetKeySize());
+void LeafPage::KeyAt(int index, GenericKey *key) const {
+  const Slot *slot = SlotAt(index);
+  memcpy(key->GetBytes(), PrefixPtr(), prefix_length_);
+  memcpy(key->GetBytes() + prefix_length_, data_ + slot->key_offset_, slot->key_length_);
+  key->SetLength(prefix_length_ + slot->key_length_);
 }
 
 RowId LeafPage::ValueAt(int index) const {
-  return *reinterpret_cast<const RowId *>(pairs_off + index * pair_size + val_off);
+  return SlotAt(index)->value_;
 }
 
 void LeafPage::SetValueAt(int index, RowId value) {
-  *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+  SlotAt(index)->value_ = value;
 }
 
-void *LeafPage::PairPtrAt(int index) {
-  return KeyAt(index);
+std::string LeafPage::CopyKey(int index) const {
+  const Slot *slot = SlotAt(index);
+  std::string key(PrefixPtr(), prefix_length_);
+  key.append(data_ + slot->key_offset_, slot->key_length_);
+  return key;
 }
 
-void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memmove(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+void LeafPage::CopyOut(std::vector<std::string> &keys, std::vector<RowId> &values) const {
+  for (int i = 0; i < GetSize(); i++) {
+    keys.push_back(CopyKey(i));
+    values.push_back(ValueAt(i));
+  }
 }
 
 /*
- * Helper method to find and return the key & value pair associated with input
- * "index"(a.k.a. array offset)
+ * 整页重建：重新计算公共前缀，并整理堆中被删除key留下的空洞
  */
-std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) {
-    // replace with your own code
-  return std::make_pair(KeyAt(index), ValueAt(index));
+void LeafPage::Rebuild(const std::vector<std::string> &keys, const std::vector<RowId> &values) {
+  int count = keys.size();
+  int prefix_length = 0;
+  if (count > 0) {
+    prefix_length = KeyManager::CommonPrefixLength(keys.front().data(), keys.front().size(), keys.back().data(),
+                                                   keys.back().size());
+  }
+  ASSERT(BytesFor(count, 0, 0) <= DataSize(), "Leaf page overflow.");
+  prefix_length_ = prefix_length;
+  heap_top_ = DataSize() - prefix_length;
+  if (count > 0) {
+    memcpy(data_ + heap_top_, keys.front().data(), prefix_length);
+  }
+  // 先设置大小，槽数组的位置取决于首部数组的长度
+  SetSize(count);
+  for (int i = 0; i < count; i++) {
+    int suffix_length = keys[i].size() - prefix_length;
+    heap_top_ -= suffix_length;
+    memcpy(data_ + heap_top_, keys[i].data() + prefix_length, suffix_length);
+    Heads()[i] = KeyManager::KeyHead(data_ + heap_top_, suffix_length);
+    Slot *slot = SlotAt(i);
+    slot->key_offset_ = heap_top_;
+    slot->key_length_ = suffix_length;
+    slot->value_ = values[i];
+  }
+  ASSERT(SlotBytes(count) <= heap_top_, "Leaf page overflow.");
+}
+
+LeafPage::Slot *LeafPage::InsertSlotAt(int index) {
+  int size = GetSize();
+  char *slots = reinterpret_cast<char *>(SlotAt(0));
+  char *new_slots = slots + sizeof(uint32_t);
+  // 从高地址往低地址依次移动：index之后的槽、index之前的槽、index之后的首部
+  memmove(new_slots + (index + 1) * sizeof(Slot), slots + index * sizeof(Slot), (size - index) * sizeof(Slot));
+  memmove(new_slots, slots, index * sizeof(Slot));
+  memmove(Heads() + index + 1, Heads() + index, (size - index) * sizeof(uint32_t));
+  IncreaseSize(1);
+  return SlotAt(index);
+}
+
+void LeafPage::RemoveAt(int index) {
+  const Slot *slot = SlotAt(index);
+  if (slot->key_offset_ == heap_top_) {
+    // 最后写入的key紧贴堆顶，可以直接收回
+    heap_top_ += slot->key_length_;
+  }
+  int size = GetSize();
+  char *slots = reinterpret_cast<char *>(SlotAt(0));
+  char *new_slots = slots - sizeof(uint32_t);
+  // 从低地址往高地址依次移动：index之后的首部、index之前的槽、index之后的槽
+  memmove(Heads() + index, Heads() + index + 1, (size - index - 1) * sizeof(uint32_t));
+  memmove(new_slots, slots, index * sizeof(Slot));
+  memmove(new_slots + index * sizeof(Slot), slots + (index + 1) * sizeof(Slot), (size - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+  if (GetSize() == 0) {
+    prefix_length_ = 0;
+    heap_top_ = DataSize();
+  }
 }
 
 /*****************************************************************************
@@ -127,22 +256,34 @@ std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * The caller makes sure the pair fits with HasRoomFor()
  * @return page size after insertion
  */
 int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
+  ASSERT(HasRoomFor(key), "No room for the key in leaf page.");
   // 查找插入位置
   int idx = KeyIndex(key, KM);
-
-  // 将该位置之后的元素全部向后移动一位
-  for (int i = GetSize() - 1; i >= idx; --i) {
-    memmove(KeyAt(i + 1), KeyAt(i), GetKeySize());
-    SetValueAt(i + 1, ValueAt(i));
+  int length = key->GetLength();
+  int suffix_length = length - prefix_length_;
+  bool shares_prefix = length >= prefix_length_ && memcmp(key->GetBytes(), PrefixPtr(), prefix_length_) == 0;
+  if (!shares_prefix || heap_top_ - SlotBytes(GetSize() + 1) < suffix_length) {
+    // 公共前缀变短，或者连续空间不足，整页重建
+    std::vector<std::string> keys;
+    std::vector<RowId> values;
+    CopyOut(keys, values);
+    keys.emplace(keys.begin() + idx, key->GetBytes(), length);
+    values.insert(values.begin() + idx, value);
+    Rebuild(keys, values);
+    return GetSize();
   }
-  // 插入 key 和 value
-  SetKeyAt(idx, key);
-  SetValueAt(idx, value);
-  // 更新 current size
-  IncreaseSize(1);
+  // 将该位置之后的槽全部向后移动一位，key的剩余部分写入堆
+  Slot *slot = InsertSlotAt(idx);
+  heap_top_ -= suffix_length;
+  memcpy(data_ + heap_top_, key->GetBytes() + prefix_length_, suffix_length);
+  Heads()[idx] = KeyManager::KeyHead(data_ + heap_top_, suffix_length);
+  slot->key_offset_ = heap_top_;
+  slot->key_length_ = suffix_length;
+  slot->value_ = value;
   return GetSize();
 }
 
@@ -151,24 +292,34 @@ int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM)
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * 按字节数而非个数平分，两页各自重新计算公共前缀
  */
 void LeafPage::MoveHalfTo(LeafPage *recipient) {
-  int mid = GetSize() / 2;
-  int count = GetSize() - mid;
-  recipient->CopyNFrom(PairPtrAt(mid), count);
- // memset(PairPtrAt(mid),0,count* pair_size);
-  SetSize(mid);
-  //recipient->IncreaseSize(count);
+  std::vector<std::string> keys;
+  std::vector<RowId> values;
+  CopyOut(keys, values);
+  int count = keys.size();
+  int total = 0;
+  for (auto &key : keys) {
+    total += SlotBytes(1) + key.size();
+  }
+  int mid = 0;
+  for (int bytes = 0; mid < count && bytes * 2 < total; mid++) {
+    bytes += SlotBytes(1) + keys[mid].size();
+  }
+  if (GetMaxSize() != UNDEFINED_SIZE) {
+    mid = count / 2;
+  }
+  mid = std::max(1, std::min(mid, count - 1));
+  recipient->Rebuild(std::vector<std::string>(keys.begin() + mid, keys.end()),
+                     std::vector<RowId>(values.begin() + mid, values.end()));
+  keys.resize(mid);
+  values.resize(mid);
+  Rebuild(keys, values);
 
   recipient->SetNextPageId(GetNextPageId());
-}
-
-/*
- * Copy starting from items, and copy {size} number of elements into me.
- */
-void LeafPage::CopyNFrom(void *src, int size) {
-  memmove(pairs_off + GetSize() * pair_size, src, size * pair_size);
-  SetSize(GetSize() + size);
+  //新页接在当前页之后，维持叶子链表
+  SetNextPageId(recipient->GetPageId());
 }
 
 /*****************************************************************************
@@ -179,34 +330,15 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * does, then store its corresponding value in input "value" and return true.
  * If the key does not exist, then return false
  */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
+bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) const {
   int idx = KeyIndex(key, KM);
-  if (idx < GetSize() && KM.CompareKeys(key, KeyAt(idx)) == 0) {
+  if (idx < GetSize() && CompareWith(key, idx) == 0) {
     value = ValueAt(idx);
     return true;
   }
   return false;
 }
 
-int  LeafPage ::SearchKey(const GenericKey *key,const KeyManager &KM) {
-  int low = 0;
-  int high = GetSize() - 1;
-
-  while (low < high) {
-    int mid = (low + high) / 2;
-    int cmp = KM.CompareKeys(key, KeyAt(mid));
-    if (cmp <=0) {
-      high = mid;
-    } else {
-      low = mid +1;
-    }
-  }
-
-  if( KM.CompareKeys(key, KeyAt(low))==0)
-    return low;
-  return -1;
-}
-
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -217,30 +349,11 @@ int  LeafPage ::SearchKey(const GenericKey *key,const KeyManager &KM) {
  * @return  page size after deletion
  */
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
- /* for (int i = 0; i < GetSize(); ++i) {
-    if (KM.CompareKeys(KeyAt(i), key) == 0) {
-      int pos = i;
-      cout<<pos<<"here"<<endl;
-      break;
-    }}*/
-  int idx = SearchKey(key, KM);
- /* cout<<idx<<endl;*/
-  if (idx <0) {
-    // 如果未找到，返回-1
-
-
-    return -1;
+  int idx = KeyIndex(key, KM);
+  if (idx < GetSize() && CompareWith(key, idx) == 0) {
+    RemoveAt(idx);
   }
-  // 将该位置之后的元素全部向前移动一位
- /* for (int i = idx + 1; i < GetSize(); ++i) {
-    memmove(KeyAt(i - 1), KeyAt(i), GetKeySize());
-    SetValueAt(i - 1, ValueAt(i));
-  }*/
-  memmove(KeyAt(idx), KeyAt(idx + 1), (GetSize() - idx - 1) * pair_size);
-  //memset(KeyAt(GetSize()-1),0,pair_size);
-  // 更新 current size
-  IncreaseSize(-1);
-  return 1;
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -249,11 +362,14 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
 /*
  * Remove all key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
+ * recipient是左侧的兄弟页
  */
 void LeafPage::MoveAllTo(LeafPage *recipient) {
-
-  recipient->CopyNFrom(pairs_off, GetSize());
-  //memset(pairs_off,0,GetSize()*pair_size);
+  std::vector<std::string> keys;
+  std::vector<RowId> values;
+  recipient->CopyOut(keys, values);
+  CopyOut(keys, values);
+  recipient->Rebuild(keys, values);
   recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
 }
@@ -266,48 +382,23 @@ void LeafPage::MoveAllTo(LeafPage *recipient) {
  *
  */
 void LeafPage::MoveFirstToEndOf(LeafPage *recipient) {
-  recipient->CopyLastFrom(KeyAt(0), ValueAt(0));
-  int newsize = GetSize() - 1;
-  for (int i = 0; i < newsize; ++i) {
-    memmove(KeyAt(i), KeyAt(i + 1), GetKeySize());
-    SetValueAt(i, ValueAt(i + 1));
-  }
-  memset(KeyAt(GetSize() - 1),0,pair_size);
-  SetSize(newsize);
-}
-
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-void LeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
-  SetKeyAt(GetSize(), key);
-  SetValueAt(GetSize(), value);
-  IncreaseSize(1);
+  std::vector<std::string> keys;
+  std::vector<RowId> values;
+  recipient->CopyOut(keys, values);
+  keys.push_back(CopyKey(0));
+  values.push_back(ValueAt(0));
+  recipient->Rebuild(keys, values);
+  RemoveAt(0);
 }
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 void LeafPage::MoveLastToFrontOf(LeafPage *recipient) {
-  auto last_key = KeyAt(GetSize() - 1);
-  auto last_val = ValueAt(GetSize() - 1);
-  recipient->CopyFirstFrom(last_key, last_val);
-  memset(KeyAt(GetSize() - 1),0,pair_size);
-  SetSize(GetSize() - 1);
-}
-
-/*
- * Insert item at the front of my items. Move items accordingly.
- *
- */
-void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
-  int count = GetSize();
-  for (int i = count - 1; i >= 0; --i) {
-    memmove(KeyAt(i + 1), KeyAt(i), GetKeySize());
-    SetValueAt(i + 1, ValueAt(i));
-  }
-  memmove(KeyAt(0), key, GetKeySize());
-  SetValueAt(0, value);
-  SetSize(count + 1);
-
+  int last = GetSize() - 1;
+  std::vector<std::string> keys{CopyKey(last)};
+  std::vector<RowId> values{ValueAt(last)};
+  recipient->CopyOut(keys, values);
+  recipient->Rebuild(keys, values);
+  RemoveAt(last);
 }
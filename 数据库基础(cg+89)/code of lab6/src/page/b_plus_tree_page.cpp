@@ -103,6 +103,14 @@ void BPlusTreePage::SetPageId(page_id_t page_id) {
   page_id_ = page_id;
 }
 
+uint32_t BPlusTreePage::GetPageSize() const {
+  return page_size_;
+}
+
+void BPlusTreePage::SetPageSize(uint32_t page_size) {
+  page_size_ = page_size;
+}
+
 /*
  * Helper methods to set lsn
  */
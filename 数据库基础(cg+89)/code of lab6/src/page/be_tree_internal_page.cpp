@@ -0,0 +1,100 @@
+#include "page/be_tree_internal_page.h"
+
+#include <algorithm>
+
+void BeTreeInternalPage::Init(page_id_t page_id, int key_size, uint32_t page_size) {
+  InitHeader(IndexPageType::INTERNAL_PAGE, page_id, key_size);
+  max_size_ = MaxSizeFor(key_size, page_size);
+  buffer_size_ = 0;
+  buffer_max_size_ = BufferMaxSizeFor(key_size, page_size);
+  ASSERT(buffer_max_size_ >= 2, "Key is too large for the buffer of a be-tree page.");
+}
+
+int BeTreeInternalPage::MaxSizeFor(int key_size, uint32_t page_size) {
+  // the pivots take about a sixteenth of the page, a smaller fanout leaves room for larger batches per child
+  int size = (page_size - BE_TREE_INTERNAL_PAGE_HEADER_SIZE) / 16 / (key_size + sizeof(page_id_t));
+  return std::max(size, 4);
+}
+
+int BeTreeInternalPage::BufferMaxSizeFor(int key_size, uint32_t page_size) {
+  int max_size = MaxSizeFor(key_size, page_size);
+  int pivot_bytes = max_size * sizeof(page_id_t) + (max_size - 1) * key_size;
+  return (page_size - BE_TREE_INTERNAL_PAGE_HEADER_SIZE - pivot_bytes) / (key_size + sizeof(RowId) + 1);
+}
+
+page_id_t BeTreeInternalPage::ChildAt(int index) const {
+  return MACH_READ_FROM(page_id_t, data_ + index * sizeof(page_id_t));
+}
+
+void BeTreeInternalPage::SetChildAt(int index, page_id_t child) {
+  MACH_WRITE_TO(page_id_t, data_ + index * sizeof(page_id_t), child);
+}
+
+const GenericKey *BeTreeInternalPage::PivotAt(int index) const {
+  return reinterpret_cast<const GenericKey *>(PivotPtrAt(index));
+}
+
+void BeTreeInternalPage::SetPivotAt(int index, const GenericKey *pivot) {
+  CopyKey(PivotPtrAt(index), pivot);
+}
+
+int BeTreeInternalPage::ChildIndex(const GenericKey *key) const {
+  // the last child whose pivot is not greater than key
+  int left = 1;
+  int right = GetSize();
+  while (left < right) {
+    int mid = (left + right) >> 1;
+    if (CompareKeys(PivotAt(mid), key) <= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left - 1;
+}
+
+const GenericKey *BeTreeInternalPage::MessageKeyAt(int index) const {
+  return reinterpret_cast<const GenericKey *>(MessagePtrAt(index));
+}
+
+RowId BeTreeInternalPage::MessageValueAt(int index) const {
+  return MACH_READ_FROM(RowId, MessagePtrAt(index) + GetKeySize());
+}
+
+bool BeTreeInternalPage::IsDeleteAt(int index) const {
+  return MessagePtrAt(index)[GetKeySize() + sizeof(RowId)] != 0;
+}
+
+int BeTreeInternalPage::MessageIndex(const GenericKey *key) const {
+  int left = 0;
+  int right = buffer_size_;
+  while (left < right) {
+    int mid = (left + right) >> 1;
+    if (CompareKeys(MessageKeyAt(mid), key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+void BeTreeInternalPage::SetMessageAt(int index, const GenericKey *key, const RowId &value, bool is_delete) {
+  char *message = MessagePtrAt(index);
+  CopyKey(message, key);
+  MACH_WRITE_TO(RowId, message + GetKeySize(), value);
+  message[GetKeySize() + sizeof(RowId)] = is_delete ? 1 : 0;
+}
+
+bool BeTreeInternalPage::PutMessage(const GenericKey *key, const RowId &value, bool is_delete) {
+  int index = MessageIndex(key);
+  if (index == buffer_size_ || CompareKeys(MessageKeyAt(index), key) != 0) {
+    if (buffer_size_ == buffer_max_size_) {
+      return false;
+    }
+    memmove(MessagePtrAt(index + 1), MessagePtrAt(index), (buffer_size_ - index) * MessageSize());
+    buffer_size_++;
+  }
+  SetMessageAt(index, key, value, is_delete);
+  return true;
+}
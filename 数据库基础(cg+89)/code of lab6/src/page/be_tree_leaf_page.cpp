@@ -0,0 +1,46 @@
+#include "page/be_tree_leaf_page.h"
+
+void BeTreeLeafPage::Init(page_id_t page_id, int key_size) {
+  InitHeader(IndexPageType::LEAF_PAGE, page_id, key_size);
+}
+
+int BeTreeLeafPage::MaxSizeFor(int key_size, uint32_t page_size) {
+  return (page_size - BE_TREE_PAGE_HEADER_SIZE) / (key_size + sizeof(RowId));
+}
+
+const GenericKey *BeTreeLeafPage::KeyAt(int index) const {
+  return reinterpret_cast<const GenericKey *>(PairPtrAt(index));
+}
+
+RowId BeTreeLeafPage::ValueAt(int index) const {
+  return MACH_READ_FROM(RowId, PairPtrAt(index) + GetKeySize());
+}
+
+int BeTreeLeafPage::KeyIndex(const GenericKey *key) const {
+  int left = 0;
+  int right = GetSize();
+  while (left < right) {
+    int mid = (left + right) >> 1;
+    if (CompareKeys(KeyAt(mid), key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+bool BeTreeLeafPage::Lookup(const GenericKey *key, RowId &value) const {
+  int index = KeyIndex(key);
+  if (index == GetSize() || CompareKeys(KeyAt(index), key) != 0) {
+    return false;
+  }
+  value = ValueAt(index);
+  return true;
+}
+
+void BeTreeLeafPage::SetPairAt(int index, const GenericKey *key, const RowId &value) {
+  char *pair = PairPtrAt(index);
+  CopyKey(pair, key);
+  MACH_WRITE_TO(RowId, pair + GetKeySize(), value);
+}
@@ -65,3 +65,9 @@ template class BitmapPage<1024>;
 template class BitmapPage<2048>;
 
 template class BitmapPage<4096>;
+
+template class BitmapPage<8192>;
+
+template class BitmapPage<16384>;
+
+template class BitmapPage<32768>;
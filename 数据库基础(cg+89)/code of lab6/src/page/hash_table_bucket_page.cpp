@@ -0,0 +1,64 @@
+#include "page/hash_table_bucket_page.h"
+
+#include <cstring>
+
+void HashTableBucketPage::Init(int key_size, uint32_t page_size) {
+  size_ = 0;
+  key_size_ = key_size;
+  max_size_ = (page_size - HASH_BUCKET_PAGE_HEADER_SIZE) / PairSize();
+}
+
+uint32_t HashTableBucketPage::HashAt(int index) const {
+  return MACH_READ_UINT32(PairPtrAt(index));
+}
+
+const GenericKey *HashTableBucketPage::KeyAt(int index) const {
+  return reinterpret_cast<const GenericKey *>(PairPtrAt(index) + sizeof(uint32_t));
+}
+
+RowId HashTableBucketPage::ValueAt(int index) const {
+  return MACH_READ_FROM(RowId, PairPtrAt(index) + sizeof(uint32_t) + key_size_);
+}
+
+int HashTableBucketPage::Find(uint32_t hash, const GenericKey *key) const {
+  for (int i = 0; i < size_; i++) {
+    if (HashAt(i) == hash && memcmp(KeyAt(i), key, key_size_) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool HashTableBucketPage::Insert(uint32_t hash, const GenericKey *key, const RowId &value) {
+  if (size_ >= GetMaxSize()) {
+    return false;
+  }
+  char *pair = PairPtrAt(size_);
+  MACH_WRITE_UINT32(pair, hash);
+  memcpy(pair + sizeof(uint32_t), key, key_size_);
+  MACH_WRITE_TO(RowId, pair + sizeof(uint32_t) + key_size_, value);
+  size_++;
+  return true;
+}
+
+void HashTableBucketPage::RemoveAt(int index) {
+  // entries are unordered, fill the hole with the last one
+  size_--;
+  if (index != size_) {
+    memcpy(PairPtrAt(index), PairPtrAt(size_), PairSize());
+  }
+}
+
+void HashTableBucketPage::MoveSplitImageTo(HashTableBucketPage *recipient, uint32_t mask_bit) {
+  int kept = 0;
+  for (int i = 0; i < size_; i++) {
+    if ((HashAt(i) & mask_bit) != 0) {
+      memcpy(recipient->PairPtrAt(recipient->size_++), PairPtrAt(i), PairSize());
+    } else if (kept != i) {
+      memcpy(PairPtrAt(kept++), PairPtrAt(i), PairSize());
+    } else {
+      kept++;
+    }
+  }
+  size_ = kept;
+}
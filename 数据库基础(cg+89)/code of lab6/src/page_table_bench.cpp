@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+
+/**
+ * Operations per second on the page table of the buffer pool against an unordered_map behind a mutex, at 1 to 32
+ * threads. Every thread looks up random pages and, for update_percent of its operations, evicts one of its pages
+ * and loads another, like FetchPage does on a miss. The tables hold frames pages at any time.
+ *
+ * usage: page_table_bench [frames] [operations] [update_percent]
+ */
+class LockedMap {
+ public:
+  explicit LockedMap(size_t frames) { map_.reserve(frames); }
+
+  bool Find(uint64_t key, frame_id_t *frame_id) {
+    std::lock_guard<std::mutex> lock(latch_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return false;
+    }
+    *frame_id = it->second;
+    return true;
+  }
+
+  bool Insert(uint64_t key, frame_id_t frame_id) {
+    std::lock_guard<std::mutex> lock(latch_);
+    return map_.emplace(key, frame_id).second;
+  }
+
+  bool Erase(uint64_t key) {
+    std::lock_guard<std::mutex> lock(latch_);
+    return map_.erase(key) > 0;
+  }
+
+ private:
+  std::mutex latch_;
+  std::unordered_map<uint64_t, frame_id_t> map_;
+};
+
+static inline uint64_t PageKey(page_id_t page_id) { return (static_cast<uint64_t>(1) << 32) | page_id; }
+
+template <typename Table>
+static double RunBench(size_t frames, size_t operations, int update_percent, int thread_count) {
+  Table table(frames);
+  // thread t owns the pages t, t + thread_count, ..., a quarter of them are loaded at a time
+  std::vector<std::vector<page_id_t>> loaded(thread_count), unloaded(thread_count);
+  for (size_t i = 0; i < 4 * frames; i++) {
+    int owner = static_cast<int>(i % thread_count);
+    if (i < frames) {
+      table.Insert(PageKey(static_cast<page_id_t>(i)), static_cast<frame_id_t>(i));
+      loaded[owner].push_back(static_cast<page_id_t>(i));
+    } else {
+      unloaded[owner].push_back(static_cast<page_id_t>(i));
+    }
+  }
+  size_t per_thread = operations / thread_count;
+  std::vector<size_t> found(thread_count, 0);
+  auto worker = [&](int t) {
+    std::mt19937 rng(t + 1);
+    auto &mine = loaded[t];
+    auto &others = unloaded[t];
+    for (size_t i = 0; i < per_thread; i++) {
+      if (static_cast<int>(rng() % 100) < update_percent && !mine.empty() && !others.empty()) {
+        size_t victim = rng() % mine.size();
+        size_t next = rng() % others.size();
+        frame_id_t frame_id = 0;
+        table.Find(PageKey(mine[victim]), &frame_id);
+        table.Erase(PageKey(mine[victim]));
+        table.Insert(PageKey(others[next]), frame_id);
+        std::swap(mine[victim], others[next]);
+      } else {
+        frame_id_t frame_id;
+        found[t] += table.Find(PageKey(static_cast<page_id_t>(rng() % (4 * frames))), &frame_id);
+      }
+    }
+  };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++) {
+    threads.emplace_back(worker, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return per_thread * thread_count / seconds;
+}
+
+int main(int argc, char **argv) {
+  size_t frames = argc > 1 ? atoi(argv[1]) : DEFAULT_BUFFER_POOL_SIZE;
+  size_t operations = argc > 2 ? atoi(argv[2]) : 4000000;
+  int update_percent = argc > 3 ? atoi(argv[3]) : 10;
+  printf("%zu frames, %zu operations, %d%% updates, %u hardware threads\n", frames, operations, update_percent,
+         std::thread::hardware_concurrency());
+  printf("%-8s %16s %16s\n", "threads", "PageTable ops/s", "mutex map ops/s");
+  for (int thread_count : {1, 2, 4, 8, 16, 32}) {
+    double page_table = RunBench<PageTable>(frames, operations, update_percent, thread_count);
+    double locked_map = RunBench<LockedMap>(frames, operations, update_percent, thread_count);
+    printf("%-8d %16.0f %16.0f\n", thread_count, page_table, locked_map);
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include "planner/plan_cache.h"
+
+#include <cctype>
+
+#include "planner/planner.h"
+
+bool TokenizeSql(const std::string &sql, std::vector<SqlToken> *tokens) {
+  tokens->clear();
+  size_t i = 0, n = sql.size();
+  while (i < n) {
+    char c = sql[i];
+    if (c == ' ' || c == '\t' || c == '\v' || c == '\n' || c == '\f') {
+      i++;
+    } else if (c == '"' || c == '\'') {
+      // strings may be quoted either way, as the file names of copy
+      size_t begin = ++i;
+      while (i < n && sql[i] != c) {
+        i += sql[i] == '\\' ? 2 : 1;
+      }
+      if (i >= n) {
+        return false;
+      }
+      tokens->push_back({SqlToken::kString, sql.substr(begin, i - begin)});
+      i++;
+    } else if (isalpha(c) || c == '_') {
+      size_t begin = i;
+      while (i < n && (isalnum(sql[i]) || sql[i] == '_')) {
+        i++;
+      }
+      tokens->push_back({SqlToken::kWord, sql.substr(begin, i - begin)});
+    } else if (isdigit(c) || c == '-' || c == '.') {
+      // [-]?{D}*\.{D}+ | [-]?{D}*
+      size_t begin = i;
+      if (sql[i] == '-') {
+        i++;
+      }
+      while (i < n && isdigit(sql[i])) {
+        i++;
+      }
+      if (i + 1 < n && sql[i] == '.' && isdigit(sql[i + 1])) {
+        i++;
+        while (i < n && isdigit(sql[i])) {
+          i++;
+        }
+      }
+      if (i == begin) {
+        return false;
+      }
+      tokens->push_back({SqlToken::kNumber, sql.substr(begin, i - begin)});
+    } else if ((c == '<' || c == '>') && i + 1 < n && (sql[i + 1] == '=' || (c == '<' && sql[i + 1] == '>'))) {
+      tokens->push_back({SqlToken::kSymbol, sql.substr(i, 2)});
+      i += 2;
+    } else if (strchr("=,*;<>()", c) != nullptr) {
+      tokens->push_back({SqlToken::kSymbol, std::string(1, c)});
+      i++;
+    } else if (c == '?') {
+      tokens->push_back({SqlToken::kParam, "?"});
+      i++;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RenderSql(const std::vector<SqlToken> &tokens, std::string *sql) {
+  sql->clear();
+  for (auto &token : tokens) {
+    if (!sql->empty()) {
+      *sql += ' ';
+    }
+    if (token.type_ != SqlToken::kString) {
+      *sql += token.val_;
+      continue;
+    }
+    if (token.val_.find('"') != std::string::npos) {
+      return false;
+    }
+    *sql += '"' + token.val_ + '"';
+  }
+  return true;
+}
+
+void MakeSqlTemplate(const std::vector<SqlToken> &tokens, size_t begin, size_t end, SqlTemplate *tmpl) {
+  tmpl->key_.clear();
+  tmpl->text_.clear();
+  tmpl->literals_.clear();
+  tmpl->params_.clear();
+  for (size_t i = begin; i < end; i++) {
+    auto &token = tokens[i];
+    if (i != begin) {
+      tmpl->key_ += ' ';
+      tmpl->text_ += ' ';
+    }
+    switch (token.type_) {
+      case SqlToken::kNumber:
+      case SqlToken::kString:
+      case SqlToken::kParam: {
+        if (token.type_ == SqlToken::kParam) {
+          tmpl->params_.push_back(tmpl->literals_.size());
+          tmpl->literals_.push_back({kNodeNull, ""});
+        } else {
+          tmpl->literals_.push_back({token.type_ == SqlToken::kNumber ? kNodeNumber : kNodeString, token.val_});
+        }
+        tmpl->key_ += '?';
+        tmpl->text_ += "\"?" + std::to_string(tmpl->literals_.size() - 1) + "\"";
+        break;
+      }
+      default:
+        tmpl->key_ += token.val_;
+        tmpl->text_ += token.val_;
+        break;
+    }
+  }
+}
+
+void PlanCache::Entry::Bind(const std::vector<SqlLiteral> &literals) {
+  ASSERT(literals.size() == params_.size(), "Literals do not match the parameters of the plan.");
+  for (size_t i = 0; i < params_.size(); i++) {
+    auto &param = params_[i];
+    Field val = AbstractStatement::MakeConstantField(param->GetReturnType(), literals[i].type_, literals[i].val_.c_str());
+    param->Bind(val);
+  }
+}
+
+PlanCache::Entry *PlanCache::Get(const std::string &key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+PlanCache::Entry *PlanCache::Put(const std::string &key, Entry entry) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  while (!entries_.empty() && entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, std::move(entry));
+  index_[key] = entries_.begin();
+  return &entries_.front().second;
+}
+
+void PlanCache::Clear() {
+  index_.clear();
+  entries_.clear();
+}
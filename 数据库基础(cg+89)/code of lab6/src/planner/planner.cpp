@@ -1,31 +1,34 @@
 //
 // Created by njz on 2023/2/2.
 //
-#include <algorithm>
 #include "planner/planner.h"
 
 void Planner::PlanQuery(pSyntaxNode ast) {
   switch (ast->type_) {
     case kNodeSelect: {
       auto statement = make_shared<SelectStatement>(ast, context_);
+      statement->params_ = params_;
       statement->SyntaxTree2Statement(ast->child_);
       plan_ = PlanSelect(statement);
       return;
     }
     case kNodeInsert: {
       auto statement = make_shared<InsertStatement>(ast, context_);
+      statement->params_ = params_;
       statement->SyntaxTree2Statement(ast->child_);
       plan_ = PlanInsert(statement);
       return;
     }
     case kNodeDelete: {
       auto statement = make_shared<DeleteStatement>(ast, context_);
+      statement->params_ = params_;
       statement->SyntaxTree2Statement(ast->child_);
       plan_ = PlanDelete(statement);
       return;
     }
     case kNodeUpdate: {
       auto statement = make_shared<UpdateStatement>(ast, context_);
+      statement->params_ = params_;
       statement->SyntaxTree2Statement(ast->child_);
       plan_ = PlanUpdate(statement);
       return;
@@ -41,19 +44,30 @@ AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> stateme
   context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
   for (auto index : indexes) {
     if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
-      }
+      available_index.push_back(index);
     }
   }
-  if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+  if (available_index.empty() || statement->where_ == nullptr) {
+    return PlanSeqScan(out_schema, statement);
   }
-  return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
+  // a bitmap index scan answers a predicate with an index under every OR, see IndexScanPlanNode
+  auto plan = make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index, true,
+                                             statement->where_);
+  bool exact = true;
+  if (!plan->CanUseIndexes(statement->where_, exact)) {
+    return PlanSeqScan(out_schema, statement);
+  }
+  plan->need_filter_ = !exact;
+  return plan;
+}
+
+AbstractPlanNodeRef Planner::PlanSeqScan(const Schema *out_schema, std::shared_ptr<SelectStatement> statement) {
+  // the executor scans small tables serially, the plan outlives the size of the table in the plan cache
+  uint32_t worker_count = context_->GetParallelWorkers();
+  if (worker_count > 1) {
+    return make_shared<ParallelSeqScanPlanNode>(out_schema, statement->table_name_, statement->where_, worker_count);
+  }
+  return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
 }
 
 AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> statement) {
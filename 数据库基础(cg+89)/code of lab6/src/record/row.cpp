@@ -4,107 +4,136 @@
  * TODO: Student Implement
  */
 uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
-
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
-
-  uint32_t ofs = 0;
- // return GetSerializedSize(schema);
-  // Serialize header
   uint32_t field_count = fields_.size();
+  uint32_t header_size = GetCompactHeaderSize(field_count);
 
-  MACH_WRITE_UINT32(buf , field_count);
-  ofs += sizeof(uint32_t);
-
-  //return ofs;
-  // Serialize null bitmap
-  for(auto field : fields_) {
-    MACH_WRITE_TO(bool, buf+ofs, field->IsNull());
-    ofs += sizeof(bool);
+  // Serialize header and null bitmap
+  MACH_WRITE_UINT32(buf, ROW_COMPACT_FLAG | field_count);
+  memset(buf + sizeof(uint32_t), 0, header_size - sizeof(uint32_t));
+  for (uint32_t i = 0; i < field_count; i++) {
+    if (fields_[i]->IsNull()) {
+      buf[sizeof(uint32_t) + i / 8] |= static_cast<char>(1 << (i % 8));
+    }
   }
 
-  // Serialize fields
+  // Serialize fields, fixed-width ones in place, char ones appended to the varchar data
+  uint32_t data_ofs = schema->GetRowDataOffset();
   for (uint32_t i = 0; i < field_count; ++i) {
     Field *field = fields_[i];
-    if(!field->IsNull()) {
-      field->SerializeTo(buf+ofs);
-      ofs += field->GetSerializedSize();
+    uint32_t ofs = schema->GetRowOffset(i);
+    if (schema->GetColumn(i)->GetType() == kTypeChar) {
+      if (!field->IsNull()) {
+        memcpy(buf + data_ofs, field->GetData(), field->GetLength());
+        data_ofs += field->GetLength();
+      }
+      ASSERT(data_ofs <= UINT16_MAX, "Row too large for compact format.");
+      MACH_WRITE_TO(var_offset_t, buf + ofs, static_cast<var_offset_t>(data_ofs));
+    } else if (field->IsNull()) {
+      memset(buf + ofs, 0, Type::GetTypeSize(field->GetTypeId()));
+    } else {
+      field->SerializeTo(buf + ofs);
     }
   }
-  buf += ofs;
-  return ofs;
-
+  return data_ofs;
 }
 
 uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(fields_.empty(), "Non empty field in row.");
-  // replace with your code here
+  if (!IsCompact(buf)) {
+    return DeserializeLegacyFrom(buf, schema);
+  }
+  uint32_t field_count = MACH_READ_UINT32(buf) & ~ROW_COMPACT_FLAG;
+  ASSERT(field_count == schema->GetColumnCount(), "Fields size do not match schema's column size.");
+  fields_.resize(field_count, nullptr);
+
+  uint32_t data_ofs = schema->GetRowDataOffset();
+  for (uint32_t i = 0; i < field_count; ++i) {
+    bool is_null = IsNullInBitmap(buf, i);
+    uint32_t ofs = schema->GetRowOffset(i);
+    TypeId type_id = schema->GetColumn(i)->GetType();
+    if (type_id == kTypeChar && !is_null) {
+      uint32_t end = MACH_READ_FROM(var_offset_t, buf + ofs);
+      fields_[i] = NewCharField(buf + data_ofs, end - data_ofs);
+      data_ofs = end;
+    } else {
+      if (type_id == kTypeChar) {
+        data_ofs = MACH_READ_FROM(var_offset_t, buf + ofs);
+      }
+      fields_[i] = NewFieldFrom(buf + ofs, type_id, is_null);
+    }
+  }
+  return data_ofs;
+}
+
+uint32_t Row::DeserializeLegacyFrom(char *buf, Schema *schema) {
   uint32_t ofs = 0;
 
   // Deserialize header
   uint32_t field_count = MACH_READ_UINT32(buf + ofs);
   ofs += sizeof(uint32_t);
 
-  // Deserialize null bitmap
+  // Deserialize null flags
   bool null_bitmap[field_count];
   for (uint32_t i = 0; i < field_count; i++) {
-    null_bitmap[i] = MACH_READ_FROM(bool, buf+ofs);
+    null_bitmap[i] = MACH_READ_FROM(bool, buf + ofs);
     ofs += sizeof(bool);
   }
-  /*uint32_t null_bitmap_size = (field_count + 7) / 8; // Calculate size of null bitmap in bytes
-  const char *null_bitmap = buf + ofs;
-  ofs += null_bitmap_size;*/
-
-  // Deserialize fields
-  fields_.resize(field_count, nullptr); // Resize fields vector to match the field count
 
+  // Deserialize fields, null fields take no space but still get a null Field
+  fields_.resize(field_count, nullptr);
   for (uint32_t i = 0; i < field_count; ++i) {
-    bool is_null = (null_bitmap[i / 8] & (1 << (i % 8))) != 0;
-
-    // Deserialize field if it's not null
-    if (is_null) {
-      fields_[i] = nullptr; // Set field to null
+    TypeId type_id = schema->GetColumn(i)->GetType();
+    if (type_id == kTypeChar && !null_bitmap[i]) {
+      uint32_t len = MACH_READ_UINT32(buf + ofs);
+      fields_[i] = NewCharField(buf + ofs + sizeof(uint32_t), len);
+      ofs += sizeof(uint32_t) + len;
     } else {
-      // Deserialize non-null field
-      TypeId type_id = schema->GetColumn(i)->GetType();
-      uint32_t field_size = Type::GetInstance(type_id)->DeserializeFrom(buf + ofs, &fields_[i], is_null);
-      ofs += field_size;
-      }
+      fields_[i] = NewFieldFrom(buf + ofs, type_id, null_bitmap[i]);
+      ofs += null_bitmap[i] ? 0 : Type::GetTypeSize(type_id);
+    }
   }
-  buf += ofs;
-  return GetSerializedSize(schema);;
+  return ofs;
+}
+
+Field *Row::NewFieldFrom(const char *buf, TypeId type_id, bool is_null) const {
+  if (is_null) {
+    return NewField(type_id);
+  }
+  switch (type_id) {
+    case kTypeInt:
+      return NewField(type_id, MACH_READ_FROM(int32_t, buf));
+    case kTypeFloat:
+      return NewField(type_id, MACH_READ_FROM(float, buf));
+    default:
+      break;
+  }
+  throw "Unknown field type.";
 }
 
 uint32_t Row::GetSerializedSize(Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
- // std::cout<<schema->GetColumnCount();
-  //std::cout<<fields_.size();
- // EXPECT_EQ(schema->GetColumnCount(),fields_.size());
-  //ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
-  // replace with your code here
-  uint32_t ofs = sizeof(uint32_t); // Size for field count in header
-
-  uint32_t field_count = fields_.size();
-
-  uint32_t null_bitmap_size = fields_.size() * sizeof(bool); // Calculate size of null bitmap in bytes
-  ofs += null_bitmap_size; // Size for null bitmap
+  uint32_t ofs = schema->GetRowDataOffset();
   for (uint32_t i = 0; i < fields_.size(); ++i) {
-      bool is_null = (fields_[i] == nullptr);
-      TypeId type_id = schema->GetColumn(i)->GetType();
-      ofs += Type::GetInstance(type_id)->GetSerializedSize(*fields_[i], is_null);
+    if (fields_[i]->GetTypeId() == kTypeChar && !fields_[i]->IsNull()) {
+      ofs += fields_[i]->GetLength();
+    }
   }
   return ofs;
 }
 
 void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) {
-  auto columns = key_schema->GetColumns();
-  std::vector<Field> fields;
-  uint32_t idx;
-  for (auto column : columns) {
-    schema->GetColumnIndex(column->GetName(), idx);
-    fields.emplace_back(*this->GetField(idx));
+  // copy straight into key_row, so keys built in an arena row stay in the arena
+  key_row.destroy();
+  uint32_t idx = 0;
+  for (auto column : key_schema->GetColumns()) {
+    if (schema->GetColumnIndex(column->GetName(), idx) != DB_SUCCESS) {
+      ASSERT(false, "Key column not in the row schema.");
+      key_row.destroy();
+      return;
+    }
+    key_row.fields_.push_back(key_row.CopyField(*GetField(idx)));
   }
-  key_row = Row(fields);
 }
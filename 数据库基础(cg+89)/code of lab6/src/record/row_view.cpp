@@ -0,0 +1,152 @@
+#include "record/row_view.h"
+
+void RowView::Reset(const char *buf, const Schema *schema, RowId rid) {
+  ASSERT(buf != nullptr && schema != nullptr, "Invalid tuple for row view.");
+  buf_ = buf;
+  schema_ = schema;
+  rid_ = rid;
+  compact_ = Row::IsCompact(buf);
+  field_count_ = MACH_READ_UINT32(buf) & ~Row::ROW_COMPACT_FLAG;
+  ASSERT(field_count_ == schema->GetColumnCount(), "Fields size do not match schema's column size.");
+  offsets_.clear();
+  if (!compact_) {
+    // the first field starts right after the header, the remaining offsets are decoded on demand
+    offsets_.push_back(sizeof(uint32_t) + field_count_ * sizeof(bool));
+  }
+}
+
+void RowView::Clear() {
+  buf_ = nullptr;
+  schema_ = nullptr;
+  rid_ = INVALID_ROWID;
+  field_count_ = 0;
+  compact_ = false;
+  offsets_.clear();
+}
+
+uint32_t RowView::FieldOffset(uint32_t idx, uint32_t *len) const {
+  ASSERT(idx < field_count_, "Failed to access field");
+  bool is_char = schema_->GetColumn(idx)->GetType() == kTypeChar;
+  if (!compact_) {
+    uint32_t ofs = LegacyFieldOffset(idx);
+    if (is_char) {
+      *len = MACH_READ_UINT32(buf_ + ofs);
+      ofs += sizeof(uint32_t);
+    }
+    return ofs;
+  }
+  uint32_t ofs = schema_->GetRowOffset(idx);
+  if (!is_char) {
+    return ofs;
+  }
+  uint32_t end = MACH_READ_FROM(Row::var_offset_t, buf_ + ofs);
+  uint32_t begin = ofs == schema_->GetRowVarArrayOffset()
+                       ? schema_->GetRowDataOffset()
+                       : MACH_READ_FROM(Row::var_offset_t, buf_ + ofs - sizeof(Row::var_offset_t));
+  *len = end - begin;
+  return begin;
+}
+
+uint32_t RowView::LegacyFieldOffset(uint32_t idx) const {
+  while (offsets_.size() <= idx) {
+    uint32_t i = offsets_.size() - 1;
+    uint32_t ofs = offsets_.back();
+    if (!IsNull(i)) {
+      TypeId type_id = schema_->GetColumn(i)->GetType();
+      if (type_id == kTypeChar) {
+        ofs += sizeof(uint32_t) + MACH_READ_UINT32(buf_ + ofs);
+      } else {
+        ofs += Type::GetTypeSize(type_id);
+      }
+    }
+    offsets_.push_back(ofs);
+  }
+  return offsets_[idx];
+}
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type_id = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type_id);
+  }
+  uint32_t len = 0;
+  const char *data = buf_ + FieldOffset(idx, &len);
+  switch (type_id) {
+    case kTypeInt:
+      return Field(type_id, MACH_READ_FROM(int32_t, data));
+    case kTypeFloat:
+      return Field(type_id, MACH_READ_FROM(float, data));
+    case kTypeChar:
+      return Field(type_id, const_cast<char *>(data), len, false);
+    default:
+      break;
+  }
+  throw "Unknown field type.";
+}
+
+uint32_t RowView::GetSerializedSize() const {
+  if (compact_) {
+    uint32_t var_end = schema_->GetRowDataOffset();
+    if (schema_->GetRowVarArrayOffset() != var_end) {
+      // the last varchar end offset is the end of the row
+      var_end = MACH_READ_FROM(Row::var_offset_t, buf_ + var_end - sizeof(Row::var_offset_t));
+    }
+    return var_end;
+  }
+  if (field_count_ == 0) {
+    return sizeof(uint32_t);
+  }
+  uint32_t last = field_count_ - 1;
+  uint32_t ofs = LegacyFieldOffset(last);
+  if (!IsNull(last)) {
+    TypeId type_id = schema_->GetColumn(last)->GetType();
+    ofs += type_id == kTypeChar ? sizeof(uint32_t) + MACH_READ_UINT32(buf_ + ofs) : Type::GetTypeSize(type_id);
+  }
+  return ofs;
+}
+
+Field *RowView::NewField(uint32_t idx, const Row *row) const {
+  TypeId type_id = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return row->NewField(type_id);
+  }
+  uint32_t len = 0;
+  const char *data = buf_ + FieldOffset(idx, &len);
+  switch (type_id) {
+    case kTypeInt:
+      return row->NewField(type_id, MACH_READ_FROM(int32_t, data));
+    case kTypeFloat:
+      return row->NewField(type_id, MACH_READ_FROM(float, data));
+    case kTypeChar:
+      return row->NewCharField(data, len);
+    default:
+      break;
+  }
+  throw "Unknown field type.";
+}
+
+void RowView::Materialize(Row *row) const {
+  ASSERT(IsValid(), "Materialize an unbound row view.");
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  for (uint32_t i = 0; i < field_count_; i++) {
+    fields.push_back(NewField(i, row));
+  }
+}
+
+void RowView::Project(const Schema *key_schema, Row *row) const {
+  ASSERT(IsValid(), "Project an unbound row view.");
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  uint32_t idx = 0;
+  for (auto column : key_schema->GetColumns()) {
+    if (schema_->GetColumnIndex(column->GetName(), idx) != DB_SUCCESS) {
+      ASSERT(false, "Key column not in the row schema.");
+      row->destroy();
+      return;
+    }
+    fields.push_back(NewField(idx, row));
+  }
+}
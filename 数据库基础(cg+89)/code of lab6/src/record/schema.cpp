@@ -1,5 +1,7 @@
 #include "record/schema.h"
 
+#include "record/row.h"
+
 /**
  * TODO: Student Implement
  */
@@ -75,3 +77,26 @@ uint32_t Schema::DeserializeFrom(char *buf, Schema *&schema) {
   buf += ofs;
   return ofs;
 }
+
+void Schema::ComputeRowLayout() {
+  uint32_t column_count = columns_.size();
+  uint32_t ofs = Row::GetCompactHeaderSize(column_count);
+  row_offsets_.resize(column_count);
+  // fixed-width values first, at offsets that do not depend on the row
+  for (uint32_t i = 0; i < column_count; i++) {
+    TypeId type_id = columns_[i]->GetType();
+    if (type_id != kTypeChar) {
+      row_offsets_[i] = ofs;
+      ofs += Type::GetTypeSize(type_id);
+    }
+  }
+  // then one end offset per char column, in column order
+  row_var_array_offset_ = ofs;
+  for (uint32_t i = 0; i < column_count; i++) {
+    if (columns_[i]->GetType() == kTypeChar) {
+      row_offsets_[i] = ofs;
+      ofs += sizeof(Row::var_offset_t);
+    }
+  }
+  row_data_offset_ = ofs;
+}
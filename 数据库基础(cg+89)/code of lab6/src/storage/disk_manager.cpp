@@ -3,11 +3,31 @@
 #include <sys/stat.h>
 #include <filesystem>
 #include <stdexcept>
+#include <type_traits>
 
+#include "common/metrics.h"
+#include "common/query_counters.h"
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+//所有数据库文件共用一组读写指标
+static Histogram *const read_latency = MetricsRegistry::Instance()->GetHistogram(
+    "minisql_disk_read_seconds", "Time to read a page from a database file, sampled");
+static Histogram *const write_latency = MetricsRegistry::Instance()->GetHistogram(
+    "minisql_disk_write_seconds", "Time to write and flush a page or a batch of pages, sampled");
+static Counter *const pages_read =
+    MetricsRegistry::Instance()->GetCounter("minisql_disk_pages_read_total", "Pages read from database files");
+static Counter *const pages_written =
+    MetricsRegistry::Instance()->GetCounter("minisql_disk_pages_written_total", "Pages written to database files");
+
+//页缓存命中时读一页只要一两微秒，读两次时钟就占了不少，只给其中一部分读写计时
+static inline Histogram *Sampled(Histogram *histogram) {
+  thread_local uint32_t io_count = 0;
+  return io_count++ % DISK_LATENCY_SAMPLE_RATE == 0 ? histogram : nullptr;
+}
+
+DiskManager::DiskManager(const std::string &db_file, uint32_t page_size)
+    : file_name_(db_file), page_size_(MIN_PAGE_SIZE) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -24,7 +44,76 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw std::exception();
     }
   }
-  ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  //页大小记录在元数据页开头，先按最小页大小读出
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (GetFileSize(file_name_) == 0) {
+    //新建的文件，写下格式和建库时给定的页大小
+    if (!IsValidPageSize(page_size)) {
+      throw std::invalid_argument("Invalid page size " + std::to_string(page_size) + ".");
+    }
+    page_size_ = page_size;
+    meta_page->magic_ = DiskFileMetaPage::MAGIC;
+    meta_page->format_version_ = DiskFileMetaPage::FORMAT_VERSION;
+    meta_page->page_size_ = page_size_;
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+  } else {
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    //没有magic的是加magic之前的旧版本文件，先把元数据页改成新格式，行和索引由catalog打开时升级
+    if (meta_page->magic_ != DiskFileMetaPage::MAGIC) {
+      UpgradeLegacyMetaPage();
+    }
+    if (!meta_page->IsCurrentFormat()) {
+      db_io_.close();
+      throw std::runtime_error(file_name_ + " has format version " + std::to_string(meta_page->format_version_) +
+                               ", this build reads version " + std::to_string(DiskFileMetaPage::FORMAT_VERSION) +
+                               ".");
+    }
+    if (!IsValidPageSize(meta_page->page_size_)) {
+      db_io_.close();
+      throw std::runtime_error(file_name_ + " has an invalid page size.");
+    }
+    page_size_ = meta_page->page_size_;
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  }
+  bitmap_size_ = WithBitmap(meta_data_, [](auto *bitmap_page) {
+    return std::remove_pointer_t<decltype(bitmap_page)>::GetMaxSupportedSize();
+  });
+}
+
+void DiskManager::UpgradeLegacyMetaPage() {
+  //旧格式：已分配页数、extent数、各extent已用页数，页大小固定为4KB
+  uint32_t legacy[MIN_PAGE_SIZE / sizeof(uint32_t)];
+  memcpy(legacy, meta_data_, MIN_PAGE_SIZE);
+  uint32_t num_allocated_pages = legacy[0];
+  uint32_t num_extents = legacy[1];
+  const uint32_t *extent_used_page = legacy + DiskFileMetaPage::LEGACY_HEADER_SIZE / sizeof(uint32_t);
+  //各extent已用页数之和必须等于已分配页数，否则不是旧版本的库文件
+  bool valid = num_extents <= (MIN_PAGE_SIZE - DiskFileMetaPage::LEGACY_HEADER_SIZE) / sizeof(uint32_t);
+  uint64_t used_pages = 0;
+  for (uint32_t i = 0; valid && i < num_extents; i++) {
+    valid = extent_used_page[i] <= BitmapPage<MIN_PAGE_SIZE>::GetMaxSupportedSize();
+    used_pages += extent_used_page[i];
+  }
+  if (!valid || used_pages != num_allocated_pages) {
+    db_io_.close();
+    throw std::runtime_error(file_name_ + " is not a database file.");
+  }
+  //新格式的头部多出12字节，最后几个extent放不下
+  if (num_extents > DiskFileMetaPage::GetMaxExtentNums(MIN_PAGE_SIZE)) {
+    db_io_.close();
+    throw std::runtime_error(file_name_ + " has too many extents to be upgraded.");
+  }
+  memset(meta_data_, 0, sizeof(meta_data_));
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  meta_page->magic_ = DiskFileMetaPage::MAGIC;
+  meta_page->format_version_ = DiskFileMetaPage::FORMAT_VERSION;
+  meta_page->num_allocated_pages_ = num_allocated_pages;
+  meta_page->num_extents_ = num_extents;
+  meta_page->page_size_ = MIN_PAGE_SIZE;
+  memcpy(meta_page->extent_used_page_, extent_used_page, num_extents * sizeof(uint32_t));
+  page_size_ = MIN_PAGE_SIZE;
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  LOG(WARNING) << file_name_ << " upgraded from the legacy file format";
 }
 
 void DiskManager::Close() {
@@ -37,12 +126,45 @@ void DiskManager::Close() {
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  {
+    ScopedTimer timer(Sampled(read_latency));
+    ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  }
+  LocalQueryCounters().pages_read_++;
+  pages_read->Add();
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  {
+    ScopedTimer timer(Sampled(write_latency));
+    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  }
+  LocalQueryCounters().pages_written_++;
+  pages_written->Add();
+}
+
+void DiskManager::WritePages(const page_id_t *logical_page_ids, const char *page_data, size_t count) {
+  LocalQueryCounters().pages_written_ += count;
+  pages_written->Add(count);
+  ScopedTimer timer(Sampled(write_latency));
+  size_t i = 0;
+  while (i < count) {
+    //物理页号连续的一段页合并成一次写
+    page_id_t first = MapPageId(logical_page_ids[i]);
+    size_t run = 1;
+    while (i + run < count && MapPageId(logical_page_ids[i + run]) == first + static_cast<page_id_t>(run)) {
+      run++;
+    }
+    db_io_.seekp(static_cast<size_t>(first) * page_size_);
+    db_io_.write(page_data + i * page_size_, run * page_size_);
+    if (db_io_.bad()) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    i += run;
+  }
+  db_io_.flush();
 }
 
 /**
@@ -54,7 +176,7 @@ page_id_t DiskManager::AllocatePage() {
  // int num_extent=meta->GetExtentNums();
  // int i;
  // for(i=0;i<num_extent;i++){//detect if has available position
- //   if(meta->GetExtentUsedPage(i) <BitmapPage<PAGE_SIZE>::GetMaxSupportedSize()){
+ //   if(meta->GetExtentUsedPage(i) <BITMAP_SIZE){
     //    meta->extent_used_page_[i]+=1;//increase the page in this extent
       //  break;
  // }
@@ -70,23 +192,22 @@ page_id_t DiskManager::AllocatePage() {
   //分区序号
   uint32_t first_free_bitmap = 0;
   DiskFileMetaPage *meta_page =reinterpret_cast<DiskFileMetaPage *>(meta_data_);
-  while(meta_page->extent_used_page_[first_free_bitmap] == BITMAP_SIZE)
+  while(meta_page->extent_used_page_[first_free_bitmap] == bitmap_size_)
   {
     first_free_bitmap++;
-    ASSERT(first_free_bitmap < MAX_VALID_PAGE_ID,"exceed maxinum allocate quantity");
+    ASSERT(first_free_bitmap < DiskFileMetaPage::GetMaxExtentNums(page_size_),"exceed maxinum allocate quantity");
   }
   //找到目标bitmap区域后
-  page_id_t bitmap_physical_page_id = first_free_bitmap * (1 + BITMAP_SIZE) + 1;
-  char page_data[PAGE_SIZE];
+  page_id_t bitmap_physical_page_id = first_free_bitmap * (1 + bitmap_size_) + 1;
+  char page_data[MAX_PAGE_SIZE];
   //读取数据并转换类型
   ReadPhysicalPage(bitmap_physical_page_id,page_data);
-  BitmapPage<PAGE_SIZE> *bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(page_data);
   //offset
   uint32_t next_fre_page;
-  bitmap_page->AllocatePage(next_fre_page);
+  WithBitmap(page_data, [&](auto *bitmap_page) { return bitmap_page->AllocatePage(next_fre_page); });
 
   //计算逻辑页数(均从0开始记录，不用offset)
-  next_free_page_id = first_free_bitmap  * BITMAP_SIZE + next_fre_page;
+  next_free_page_id = first_free_bitmap  * bitmap_size_ + next_fre_page;
 
   //修改记录参数
   //修改已分配页数
@@ -128,19 +249,20 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   //}
   //通过逻辑页id计算对映bitmap页物理id
   page_id_t physical_page_id = MapPageId(logical_page_id);
-  page_id_t bitmap_physical_page_id = 1 + (physical_page_id - 1) / (1 + BITMAP_SIZE) * (1 + BITMAP_SIZE);
+  page_id_t bitmap_physical_page_id = 1 + (physical_page_id - 1) / (1 + bitmap_size_) * (1 + bitmap_size_);
   //从disk读出数据并进行相应转化
-  char page_data[PAGE_SIZE];
+  char page_data[MAX_PAGE_SIZE];
   ReadPhysicalPage(bitmap_physical_page_id,page_data);
-  BitmapPage<PAGE_SIZE> *bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(page_data);
   //通过bitmap类型free page
-  bitmap_page->DeAllocatePage(physical_page_id - bitmap_physical_page_id - 1);
+  WithBitmap(page_data, [&](auto *bitmap_page) {
+    return bitmap_page->DeAllocatePage(physical_page_id - bitmap_physical_page_id - 1);
+  });
   //修改元数据信息
   DiskFileMetaPage *meta_page =reinterpret_cast<DiskFileMetaPage *>(meta_data_);
   //减去相应的分配总页数
   meta_page->num_allocated_pages_--;
   //减少相应分区的分配总页数
-  uint32_t modify_page = (physical_page_id - 1) / (1 + BITMAP_SIZE);
+  uint32_t modify_page = (physical_page_id - 1) / (1 + bitmap_size_);
   meta_page->extent_used_page_[modify_page]--;
   //根据当前分区的实际分配量修改分配分区数量
   if(meta_page->extent_used_page_[modify_page] == 0)
@@ -160,19 +282,19 @@ bool DiskManager::IsPageFree(page_id_t logical_page_id) {
    // return true;
   //return false;
 
-  page_id_t physical_page_id = logical_page_id + logical_page_id/(BITMAP_SIZE) + 2;//通过逻辑页号计算物理页号，语雀可以看对应关系
+  page_id_t physical_page_id = logical_page_id + logical_page_id/(bitmap_size_) + 2;//通过逻辑页号计算物理页号，语雀可以看对应关系
   //通过bitmap去判断page是否free
   //通过数据页计算相应的bitmap页
-  page_id_t bitmap_physical_page_id = 1 + (physical_page_id - 1)/(1 + BITMAP_SIZE) * (1 + BITMAP_SIZE);
+  page_id_t bitmap_physical_page_id = 1 + (physical_page_id - 1)/(1 + bitmap_size_) * (1 + bitmap_size_);
   //从disk读取数据
-  char page_data[PAGE_SIZE];
+  char page_data[MAX_PAGE_SIZE];
   ReadPhysicalPage(bitmap_physical_page_id,page_data);
-  //类型转换
-  BitmapPage<PAGE_SIZE> *bitmap_page = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(page_data);
   //注意bitmap_page下标从0开始
   bool result;
   //result = bitmap_page->IsPageFree(0);
-  result = bitmap_page->IsPageFree(physical_page_id - bitmap_physical_page_id - 1);
+  result = WithBitmap(page_data, [&](auto *bitmap_page) {
+    return bitmap_page->IsPageFree(physical_page_id - bitmap_physical_page_id - 1);
+  });
   if (result)
     return true;
   else
@@ -185,7 +307,7 @@ bool DiskManager::IsPageFree(page_id_t logical_page_id) {
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {//它框架这个函数是转物理页ID，不是转位图页ID
   //计算式应该为logical_page_id/physical_page_id*(1+physical_page_id)+1，可以去语雀那里看物理页和逻辑页的对应关系
   //physical_page_id从1开始,logical_page_id从0开始
-  page_id_t result =  logical_page_id + logical_page_id/BITMAP_SIZE + 2;
+  page_id_t result =  logical_page_id + logical_page_id/bitmap_size_ + 2;
   return result;
 }
 
@@ -196,33 +318,33 @@ int DiskManager::GetFileSize(const std::string &file_name) {
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (static_cast<int64_t>(offset) >= GetFileSize(file_name_)) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-    memset(page_data, 0, PAGE_SIZE);
+    memset(page_data, 0, page_size_);
   } else {
     // set read cursor to offset
     db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
+    db_io_.read(page_data, page_size_);
+    // if file ends before reading a whole page
     int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    if (read_count < static_cast<int>(page_size_)) {
 #ifdef ENABLE_BPM_DEBUG
       LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      memset(page_data + read_count, 0, page_size_ - read_count);
     }
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
   // set write cursor to offset
   db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  db_io_.write(page_data, page_size_);
   // check for I/O error
   if (db_io_.bad()) {
     LOG(ERROR) << "I/O error while writing";
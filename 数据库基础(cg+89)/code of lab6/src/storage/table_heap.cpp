@@ -1,70 +1,146 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+
 /**
  * TODO: Student Implement
  */
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
- //获得row对映的tablepage最大支持size
-  size_t max_size_row = TablePage::SIZE_MAX_ROW;
-  //如果单行数据超过此大小，返回false
+  Row *rows[] = {&row};
+  return InsertTuples(rows, 1, txn) == 1;
+}
 
-  if(row.GetSerializedSize(schema_) > max_size_row)
-    return false;
-  //从table中第一逻辑页开始遍历获得free page用于填入该row
-  //第一页的page_id不会为INVALID_PAGE_ID，与初始化实现相关
-  page_id_t next_page_id = GetFirstPageId();
- int x= reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(next_page_id))->GetFreeSpacePointer();
-  //next_page_id为无效值时返回nullptr
-  TablePage* true_page;
-
-  while(1)
-  {
-    //firstpageid不可能为无效值
-    if(next_page_id == INVALID_PAGE_ID)
-    {
-      //没有有效页，则尝试分配新页
-      TablePage* new_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->NewPage(next_page_id));
-      //若分配失败，则返回false
-      if(new_page == nullptr)
-        return false;
-      //对成功分配页面初始化
-      new_page->Init(next_page_id,true_page->GetPageId(),log_manager_,txn);
-     // new_page->WLatch();
-      //向其中插入元素
-      new_page->InsertTuple(row,schema_ ,txn,lock_manager_,log_manager_);
-     // new_page->WUnlatch();
-      //newpage函数默认pin页，此处unpin
-      buffer_pool_manager_->UnpinPage(next_page_id,true);
-      //修改原数据页的nextpageid记录并unpin写回
-      true_page->SetNextPageId(next_page_id);
-      buffer_pool_manager_->UnpinPage(true_page->GetPageId(),true);
-      return true;
+size_t TableHeap::InsertTuples(Row *const *rows, size_t count, Transaction *txn) {
+  //新元组总是追加到最后一页，避免每次插入都从第一页开始遍历链表
+  TablePage *page = FetchLastPage();
+  if (page == nullptr) {
+    return 0;
+  }
+  bool dirty = false;
+  size_t inserted = 0;
+  page->WLatch();
+  for (size_t i = 0; i < count; i++) {
+    Row &row = *rows[i];
+    //单行数据超过页面能容纳的大小，无法插入
+    if (row.GetSerializedSize(schema_) > TablePage::MaxRowSize(buffer_pool_manager_->GetPageSize())) {
+      row.SetRowId(INVALID_ROWID);
+      continue;
+    }
+    if (!page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+      //最后一页已满，分配新页接到链表末尾，旧页写完后才unpin
+      page_id_t new_page_id;
+      auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+      if (new_page == nullptr) {
+        //缓冲池分配不出新页，本行及之后的行都没有插入，rid全部置为无效
+        for (size_t j = i; j < count; j++) {
+          rows[j]->SetRowId(INVALID_ROWID);
+        }
+        break;
+      }
+      new_page->Init(new_page_id, page->GetTablePageId(), buffer_pool_manager_->GetPageSize(), log_manager_, txn);
+      page->SetNextPageId(new_page_id);
+      zone_map_.SetNextPageId(page->GetTablePageId(), new_page_id);
+      zone_map_.AddEmpty(new_page_id, INVALID_PAGE_ID);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+      page = new_page;
+      page->WLatch();
+      AppendToDirectory(new_page_id);
+      page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
     }
-    else//函数从这里开始执行，因为firstpageid不可能为无效值
-         {
+    zone_map_.Widen(page->GetTablePageId(), row);
+    dirty = true;
+    inserted++;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), dirty);
+  return inserted;
+}
 
-      true_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(next_page_id));
-    //可能存在分配错误的情况
-    if(true_page == nullptr)
-      return false;
-    //进行写入操作
-    //上锁
-   // true_page->WLatch();
-    //尝试在当前true_page插入row
-    //return true;
-    if(true_page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_))
-    {
-      buffer_pool_manager_->UnpinPage(next_page_id,true);
-      //true_page->WUnlatch();
-      return true;
+TablePage *TableHeap::FetchLastPage() {
+  //页目录中的最后一页即链表末尾，新元组写入该页
+  return reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids_.back()));
+}
+
+void TableHeap::LoadDirectory(page_id_t directory_page_id) {
+  directory_page_id_ = directory_page_id;
+  page_id_t page_id = directory_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto directory = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    directory_page_ids_.push_back(page_id);
+    for (uint32_t i = 0; i < directory->GetPageCount(); i++) {
+      page_ids_.push_back(directory->PageIdAt(i));
     }
-    //true_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(next_page_id,false);
-    //next_page_id/true_page的遍历
-    next_page_id = true_page->GetNextPageId();
+    page_id_t next_page_id = directory->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
 
-  }}
-  return true;
+void TableHeap::BuildDirectory() {
+  //旧版本的表没有页目录，沿链表走一遍记下所有页
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Page not exist!");
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    AppendToDirectory(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::AppendToDirectory(page_id_t page_id) {
+  uint32_t index = page_ids_.size() % TableDirectoryPage::MAX_PAGE_COUNT;
+  page_ids_.push_back(page_id);
+  TableDirectoryPage *directory;
+  page_id_t directory_page_id;
+  if (index == 0) {
+    //目录页已满（或还没有目录页），新开一页接到目录链表末尾
+    Page *page = buffer_pool_manager_->NewPage(directory_page_id);
+    ASSERT(page != nullptr, "Not able to allocate page");
+    directory = reinterpret_cast<TableDirectoryPage *>(page->GetData());
+    directory->Init();
+    if (directory_page_ids_.empty()) {
+      directory_page_id_ = directory_page_id;
+    } else {
+      page_id_t prev_page_id = directory_page_ids_.back();
+      auto prev = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(prev_page_id)->GetData());
+      prev->SetNextPageId(directory_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    directory_page_ids_.push_back(directory_page_id);
+  } else {
+    directory_page_id = directory_page_ids_.back();
+    directory = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+  }
+  directory->SetPageIdAt(index, page_id);
+  directory->SetPageCount(index + 1);
+  buffer_pool_manager_->UnpinPage(directory_page_id, true);
+}
+
+void TableHeap::TruncateDirectory() {
+  size_t directory_count = std::max<size_t>(
+      (page_ids_.size() + TableDirectoryPage::MAX_PAGE_COUNT - 1) / TableDirectoryPage::MAX_PAGE_COUNT, 1);
+  while (directory_page_ids_.size() > directory_count) {
+    buffer_pool_manager_->DeletePage(directory_page_ids_.back());
+    directory_page_ids_.pop_back();
+  }
+  //页号只从末尾删除，只需改写最后一个目录页的页数和后继
+  page_id_t last_page_id = directory_page_ids_.back();
+  auto directory = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(last_page_id)->GetData());
+  directory->SetPageCount(page_ids_.size() - (directory_count - 1) * TableDirectoryPage::MAX_PAGE_COUNT);
+  directory->SetNextPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+}
+
+void TableHeap::FreeDirectory() {
+  for (page_id_t page_id : directory_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  directory_page_ids_.clear();
+  directory_page_id_ = INVALID_PAGE_ID;
+  page_ids_.clear();
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
@@ -93,41 +169,20 @@ bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn)
   TablePage* true_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if(true_page == nullptr)
     return false;
-  //通过rowid唯一标识建立row对象
+  //TablePage::UpdateTuple自己会读出旧元组，无需先GetTuple再取一次页
   Row ori_row = Row(rid);
-  //gettuple函数本身已上锁
-  //true_page->RLatch();
-  bool get_tuple_result = GetTuple(&ori_row,txn);
-  //true_page->RUnlatch();
-  if(get_tuple_result == false)
-    return false;
-  //注意TablePage::UpdateTuple返回值已修改，因而定义int类型接受结果
-  int update_tuple_result;
   true_page->WLatch();
-  //尝试更新对映的数据页
-  update_tuple_result = true_page->UpdateTuple(row,&ori_row,schema_,txn,lock_manager_,log_manager_);
+  //新元组放得下时原地更新（变长时页内其余元组随之移动），否则返回false
+  bool update_tuple_result = true_page->UpdateTuple(row,&ori_row,schema_,txn,lock_manager_,log_manager_);
   true_page->WUnlatch();
-  //若返回值为1，表示更新成功，可以返回true
-  if(update_tuple_result == 0)
+  if(update_tuple_result)
   {
-    buffer_pool_manager_->UnpinPage(true_page->GetTablePageId(),true);
-    return true;
+    //新值可能超出该页原有的最值范围
+    zone_map_.Widen(rid.GetPageId(), row);
   }
-  //若tuple已被删除或slot_num越界，直接返回false
-  else if(update_tuple_result == -1 || update_tuple_result == 1)
-  {
-    buffer_pool_manager_->UnpinPage(true_page->GetTablePageId(),false);
-    return false;
-  }
-  //特殊情况，因为位置不足而发生false的返回，本函数应该如何处理
-  else if(update_tuple_result == 2)
-  {
-    buffer_pool_manager_->UnpinPage(true_page->GetTablePageId(),false);
-
-    return false;
-  }
-  //以防奇怪的返回值
-  return false;
+  //tuple已被删除、slot_num越界或本页空间不足时由调用者删除后重新插入
+  buffer_pool_manager_->UnpinPage(true_page->GetTablePageId(),update_tuple_result);
+  return update_tuple_result;
 }
 
 /**
@@ -144,6 +199,7 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   true_page->ApplyDelete(rid,txn,log_manager_);
   true_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(true_page->GetTablePageId(),true);
+  deleted_tuples_++;
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -180,7 +236,121 @@ bool TableHeap::GetTuple(Row *row, Transaction *txn) {
     return false;
 }
 
+uint32_t TableHeap::UpgradeRowFormat(Transaction *txn) {
+  uint32_t legacy_rows = 0;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Page not exist!");
+    bool is_dirty = false;
+    RowView view;
+    RowId rid;
+    page->WLatch();
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      if (!page->GetTupleView(rid, &view, schema_, txn, lock_manager_) || view.IsCompact()) {
+        continue;
+      }
+      Row row(rid);
+      view.Materialize(&row);
+      // UpdateTuple re-reads the old tuple into old_row, which must be empty
+      Row old_row(rid);
+      if (page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_)) {
+        is_dirty = true;
+      } else {
+        legacy_rows++;
+      }
+    }
+    page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_dirty);
+  }
+  return legacy_rows;
+}
+
+bool TableHeap::Vacuum(const std::function<bool(Row &, const RowId &)> &on_move, uint32_t &released_pages,
+                       Transaction *txn) {
+  deleted_tuples_ = 0;
+  released_pages = 0;
+  //没有页的表无可压紧，也不能算表尾下标
+  if (page_ids_.empty()) {
+    return true;
+  }
+  //从表尾的页取出元组，按顺序填入表头各页的空闲空间，表尾空出的页从链表中摘除并释放
+  //删除时ApplyDelete已在页内压紧元组，这里只需在页之间搬移
+  uint32_t released = 0;
+  bool moved = false;
+  bool stopped = false;
+  size_t dest = 0;
+  size_t src = page_ids_.size() - 1;
+  TablePage *dest_page = nullptr;
+  bool dest_dirty = false;
+  while (dest < src) {
+    auto src_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids_[src]));
+    ASSERT(src_page != nullptr, "Page not exist!");
+    bool src_dirty = false;
+    RowId rid;
+    while (dest < src && src_page->GetFirstTupleRid(&rid)) {
+      Row row(rid);
+      src_page->GetTuple(&row, schema_, txn, lock_manager_);
+      //放不下时换下一页，直到追上正在清空的页
+      while (dest < src) {
+        if (dest_page == nullptr) {
+          dest_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids_[dest]));
+          dest_dirty = false;
+        }
+        if (dest_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+          break;
+        }
+        buffer_pool_manager_->UnpinPage(page_ids_[dest], dest_dirty);
+        dest_page = nullptr;
+        dest++;
+      }
+      if (dest == src) {
+        break;
+      }
+      dest_dirty = true;
+      //调用方不接受这次搬移时删掉刚插入的元组，原元组留在原处，停止整理
+      if (!on_move(row, rid)) {
+        dest_page->ApplyDelete(row.GetRowId(), txn, log_manager_);
+        stopped = true;
+        break;
+      }
+      src_page->ApplyDelete(rid, txn, log_manager_);
+      src_dirty = true;
+      moved = true;
+    }
+    bool is_empty = !src_page->GetFirstTupleRid(&rid);
+    buffer_pool_manager_->UnpinPage(page_ids_[src], src_dirty);
+    if (stopped || !is_empty) {
+      break;
+    }
+    //表尾的页已空，前一页成为新的表尾
+    page_id_t prev_page_id = page_ids_[src - 1];
+    auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+    prev_page->SetNextPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    buffer_pool_manager_->DeletePage(page_ids_[src]);
+    page_ids_.pop_back();
+    src--;
+    released++;
+  }
+  if (dest_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_ids_[dest], dest_dirty);
+  }
+  if (released > 0) {
+    TruncateDirectory();
+  }
+  //zone只是值的上下界，搬移之后全部作废，由之后的扫描按实际数据重建
+  if (moved || released > 0) {
+    zone_map_.Clear();
+  }
+  released_pages = released;
+  return !stopped;
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
+  zone_map_.Clear();
+  FreeDirectory();
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
     if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
@@ -195,24 +365,82 @@ void TableHeap::DeleteTable(page_id_t page_id) {
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, ZoneMap::PageFilter page_filter) {
   //注意fetch已pin页面
   RowId now_rowid;
   //根据第一逻辑页获得对映的具体数据页
 
-  TablePage* true_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(first_page_id_));
-  //cout<<first_page_id_<<endl;
-  //添加锁
-  //true_page->WLatch();
-  //从数据页中获得对映的row对象，用于迭代器的构建
-  true_page->GetFirstTupleRid(&now_rowid);
-  //cout<<"25"<<endl;
-  //打开锁
- // true_page->WUnlatch();
-  //unpin使用的页，未改变页面内容
-  buffer_pool_manager_->UnpinPage(first_page_id_,false);
-  //cout<<"26"<<endl;
-  return TableIterator(this,now_rowid);
+  //前面的页可能已被删空，沿链表找到第一个含有元组的页
+  //zone map排除的页不必读取
+  page_id_t page_id = SkipPages(first_page_id_, page_filter);
+  while (page_id != INVALID_PAGE_ID) {
+    TablePage* true_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
+    //从数据页中获得对映的row对象，用于迭代器的构建
+    true_page->RLatch();
+    bool found = PageMayMatch(true_page, page_filter, txn) && true_page->GetFirstTupleRid(&now_rowid);
+    page_id_t next_page_id = true_page->GetNextPageId();
+    true_page->RUnlatch();
+    //unpin使用的页，未改变页面内容
+    buffer_pool_manager_->UnpinPage(page_id,false);
+    if (found) {
+      return TableIterator(this,now_rowid,std::move(page_filter));
+    }
+    page_id = SkipPages(next_page_id, page_filter);
+  }
+  return End();
+}
+
+page_id_t TableHeap::SkipPages(page_id_t page_id, const ZoneMap::PageFilter &page_filter) const {
+  if (!page_filter) {
+    return page_id;
+  }
+  //zone已知且被排除的页直接沿zone中记录的后继跳过，不必取页
+  const ZoneMap::Zone *zone;
+  while (page_id != INVALID_PAGE_ID && (zone = zone_map_.Find(page_id)) != nullptr && !page_filter(*zone)) {
+    page_id = zone->next_page_id;
+  }
+  return page_id;
+}
+
+bool TableHeap::PageMayMatch(TablePage *page, const ZoneMap::PageFilter &page_filter, Transaction *txn) {
+  if (!page_filter) {
+    return true;
+  }
+  const ZoneMap::Zone *zone = zone_map_.Find(page->GetTablePageId());
+  //第一次读到的页顺便建立zone
+  return page_filter(zone != nullptr ? *zone : zone_map_.Build(page, txn, lock_manager_));
+}
+
+bool TableHeap::ScanPage(page_id_t page_id, const ZoneMap::PageFilter &page_filter,
+                         const std::function<void(const RowView &)> &visitor, Transaction *txn) {
+  //zone已知且被排除的页不必取页
+  if (page_filter) {
+    std::lock_guard<std::mutex> guard(zone_latch_);
+    const ZoneMap::Zone *zone = zone_map_.Find(page_id);
+    if (zone != nullptr && !page_filter(*zone)) {
+      return false;
+    }
+  }
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  ASSERT(page != nullptr, "Page not exist!");
+  page->RLatch();
+  bool may_match = true;
+  if (page_filter) {
+    std::lock_guard<std::mutex> guard(zone_latch_);
+    may_match = PageMayMatch(page, page_filter, txn);
+  }
+  if (may_match) {
+    RowView view;
+    RowId rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      if (page->GetTupleView(rid, &view, schema_, txn, lock_manager_)) {
+        visitor(view);
+      }
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return may_match;
 }
 
 /**
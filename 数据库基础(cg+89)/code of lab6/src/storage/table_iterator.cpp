@@ -3,149 +3,139 @@
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
-/**
- * TODO: Student Implement
- */
-
-TableIterator::TableIterator(TableHeap* new_tableheap, RowId rid) {
+TableIterator::TableIterator(TableHeap* new_tableheap, RowId rid, ZoneMap::PageFilter page_filter)
+    : it_tableheap(new_tableheap), it_rid(rid), it_page_filter(std::move(page_filter)) {
   ASSERT(new_tableheap != nullptr,"Empty pointer does not have an iterator!");
-  //若new_tableheap不为nullptr时，直接赋值即可
-  //因为不会去改变，所以即使是指针也可以直接复制
-  it_tableheap = new_tableheap;
-  //cout<<"300"<<endl;
-  //无论rid数值如何，均可以直接构建Row对象
-  it_row = new Row(rid);
-//  it_row->GetRowId();
-  //若rid不为无效对象，需要给it_row分配对象数据
-  //注意rowid只重载了==，没有重载!=
-  if(rid == INVALID_ROWID);
-  //cout<<"500"<<endl;
-  else {
-  // tranction参数好像无所谓，class都没有定义
-  it_tableheap->GetTuple(it_row, nullptr);
-  // it_row->GetFieldCount();
-  }
+  Pin();
 }
 
-TableIterator::TableIterator(const TableIterator &other) {
-  it_tableheap = other.it_tableheap;
+TableIterator::TableIterator(const TableIterator &other)
+    : it_tableheap(other.it_tableheap), it_rid(other.it_rid), it_page_filter(other.it_page_filter) {
+  //只复制位置，元组在需要时才重新读取
+  Pin();
+}
 
-  it_row = new Row(other.it_row->GetRowId());
-  it_tableheap->GetTuple(it_row,nullptr);
+TableIterator::~TableIterator() {
+  Unpin();
+  delete it_row;
+}
 
+void TableIterator::Pin() {
+  it_view_bound = false;
+  it_row_valid = false;
+  if (it_tableheap == nullptr || it_rid.GetPageId() == INVALID_PAGE_ID) {
+    it_page = nullptr;
+    return;
+  }
+  it_page = reinterpret_cast<TablePage *>(it_tableheap->buffer_pool_manager_->FetchPage(it_rid.GetPageId()));
+  ASSERT(it_page != nullptr, "Page not exist!");
 }
 
-TableIterator::~TableIterator() {
-  //delete it_row;
+void TableIterator::Unpin() {
+  if (it_page != nullptr) {
+    it_tableheap->buffer_pool_manager_->UnpinPage(it_page->GetTablePageId(), false);
+    it_page = nullptr;
+  }
+  it_view_bound = false;
+  it_row_valid = false;
+  it_view.Clear();
 }
 
 bool TableIterator::operator==(const TableIterator &itr) const {
-  if(it_row->GetRowId() == itr.it_row->GetRowId())
-    return true;
-  else
-    return false;
+  return it_rid == itr.it_rid;
 }
 
 bool TableIterator::operator!=(const TableIterator &itr) const {
-  if(*this == itr)
-    return false;
-  else
-    return true;
+  return !(*this == itr);
+}
+
+const RowView &TableIterator::GetView() {
+  ASSERT(it_page != nullptr, "Dereference an end iterator!");
+  //延迟到访问时绑定，避免上层在两次访问之间修改页面导致偏移失效
+  if (!it_view_bound) {
+    it_page->RLatch();
+    it_view_bound = it_page->GetTupleView(it_rid, &it_view, it_tableheap->schema_, nullptr, it_tableheap->lock_manager_);
+    it_page->RUnlatch();
+    ASSERT(it_view_bound, "Tuple is no longer in the page!");
+  }
+  return it_view;
 }
 
 const Row &TableIterator::operator*() {
-  return *it_row;
+  return *operator->();
 }
 
 Row *TableIterator::operator->() {
-    return it_row;
+  if (it_row == nullptr) {
+    it_row = new Row(it_rid);
+  }
+  if (!it_row_valid) {
+    if (it_page == nullptr) {
+      it_row->destroy();
+      it_row->SetRowId(it_rid);
+    } else {
+      GetView().Materialize(it_row);
+    }
+    it_row_valid = true;
+  }
+  return it_row;
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
-    //delete it_row;
-    it_row = new Row(itr.it_row->GetRowId());
-    it_tableheap = itr.it_tableheap;
-    if(itr.it_row->GetRowId()== INVALID_ROWID);
-    else
-    it_tableheap->GetTuple(it_row,nullptr);
+  if (this == &itr) {
     return *this;
-
+  }
+  Unpin();
+  it_tableheap = itr.it_tableheap;
+  it_rid = itr.it_rid;
+  it_page_filter = itr.it_page_filter;
+  Pin();
+  return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
-    //需要先判断it_row的合法性
-    //特别注意，rowid没有重载!=运算符
-    ASSERT(!(it_row->GetRowId() == INVALID_ROWID),"RowId is illegal!");
-    //获得当前it_row对映的page_id（依稀记得page_id是逻辑页）,便于pin页unpin页操作
-    page_id_t it_page_id = it_row->GetRowId().GetPageId();
-    //获得对映的逻辑数据页
-    //注意FetchPage已经将对映的page pin固定了，最后需要unpin
-    TablePage* true_page = reinterpret_cast<TablePage*>(it_tableheap->buffer_pool_manager_->FetchPage(it_page_id));
-    //通过rowid获得++后的结果
-    RowId next_rowid;
-    //写数据上锁,确保一致性（尝试）
-    true_page->RLatch();
-    //判断下一rowid是否在本页，若在本页，则直接读取
-    bool next_rowid_result = true_page->GetNextTupleRid(it_row->GetRowId(),&next_rowid);
-    //若搜得next_rowid且已经返回
-    if(next_rowid_result)
-    {
-    //注意指针的赋值，不能直接作等
-    delete it_row;
-    it_row = new Row(next_rowid);
-    }
-    else
-    {
-    //本页判断完成，解开read latch并unpin该页面
-    true_page->RUnlatch();
-    it_tableheap->buffer_pool_manager_->UnpinPage(it_page_id,false);
-    //next_rowid/it_page_id/true_page/next_rowid_result可继续使用
-    while(1)
-    {
-      //获取下一page_id
-      it_page_id = true_page->GetNextPageId();
-      //若page_id已至结尾，说明没有下一rowid，重新构造unvalid it_row并返回
-      if(it_page_id == INVALID_PAGE_ID)
-      {
-        delete it_row;
-        it_row = new Row(INVALID_ROWID);
-        return *this;
-      }
-      //通过逻辑页号取回数据页
-      //注意fetch已pin页面
-      true_page = reinterpret_cast<TablePage*>(it_tableheap->buffer_pool_manager_->FetchPage(it_page_id));
-      //上锁
-      true_page->RLatch();
-      //判断首个rowid是否为下一个rowid，因为顺序存放，所以非本页时，必然为下一页的第一项（下一页可能不存在，所以需要遍历）
-      if(true_page->GetFirstTupleRid(&next_rowid))
-      {
-        delete it_row;
-        //若寻得则直接获得相应rowid用于更新迭代器
-        it_row = new Row(next_rowid);
-        break;
-      }
-      //解锁
-      true_page->RUnlatch();
-      //unpin使用页面
-      it_tableheap->buffer_pool_manager_->UnpinPage(it_page_id,false);
-    }
-    }
-    //对于读到it_tableheap结尾的情况，不需要再读取数据
-    if(it_row->GetRowId().GetPageId() != INVALID_PAGE_ID)
-    it_tableheap->GetTuple(it_row,nullptr);
-    true_page->RUnlatch();
-    //unpin该数据页
-    //仅读数据，is_dirty无需置位
-    it_tableheap->buffer_pool_manager_->UnpinPage(it_page_id,false);
+  //特别注意，rowid没有重载!=运算符
+  ASSERT(!(it_rid == INVALID_ROWID) && it_page != nullptr,"RowId is illegal!");
+  it_view_bound = false;
+  it_row_valid = false;
+  RowId next_rowid;
+  //当前页已被pin住，先在本页内寻找下一rowid
+  it_page->RLatch();
+  bool next_rowid_result = it_page->GetNextTupleRid(it_rid, &next_rowid);
+  page_id_t next_page_id = it_page->GetNextPageId();
+  it_page->RUnlatch();
+  if (next_rowid_result) {
+    it_rid = next_rowid;
     return *this;
+  }
+  //本页已读完，沿链表寻找下一个含有元组的页，新页pin住后才释放旧页
+  auto *bpm = it_tableheap->buffer_pool_manager_;
+  next_page_id = it_tableheap->SkipPages(next_page_id, it_page_filter);
+  while (next_page_id != INVALID_PAGE_ID) {
+    auto *next_page = reinterpret_cast<TablePage *>(bpm->FetchPage(next_page_id));
+    ASSERT(next_page != nullptr, "Page not exist!");
+    bpm->UnpinPage(it_page->GetTablePageId(), false);
+    it_page = next_page;
+    it_page->RLatch();
+    bool found = it_tableheap->PageMayMatch(it_page, it_page_filter, nullptr) && it_page->GetFirstTupleRid(&next_rowid);
+    next_page_id = it_tableheap->SkipPages(it_page->GetNextPageId(), it_page_filter);
+    it_page->RUnlatch();
+    if (found) {
+      it_rid = next_rowid;
+      return *this;
+    }
+  }
+  //已至结尾，构造无效迭代器
+  Unpin();
+  it_rid = INVALID_ROWID;
+  return *this;
 }
 
 // iter++
 TableIterator TableIterator::operator++(int) {
-  TableIterator temp(it_tableheap,it_row->GetRowId());
+  TableIterator temp(*this);
   //利用前置完成自增操作
   ++(*this);
-  //没办法直接返回temp，故使用拷贝赋值函数
   return TableIterator(temp);
 }
@@ -0,0 +1,79 @@
+#include "storage/zone_map.h"
+
+#include <limits>
+
+#include "record/row_view.h"
+
+ZoneMap::ZoneMap(Schema *schema) : schema_(schema) {
+  for (auto column : schema->GetColumns()) {
+    tracked_.push_back(column->GetType() == kTypeInt || column->GetType() == kTypeFloat);
+  }
+}
+
+double ZoneMap::ValueOf(const Field &field) {
+  char buf[sizeof(uint32_t)];
+  field.SerializeTo(buf);
+  if (field.GetTypeId() == kTypeInt) {
+    return MACH_READ_FROM(int32_t, buf);
+  }
+  return MACH_READ_FROM(float, buf);
+}
+
+ZoneMap::Zone ZoneMap::NewZone(page_id_t next_page_id) const {
+  Zone zone;
+  zone.next_page_id = next_page_id;
+  zone.min.assign(tracked_.size(), std::numeric_limits<double>::infinity());
+  zone.max.assign(tracked_.size(), -std::numeric_limits<double>::infinity());
+  return zone;
+}
+
+const ZoneMap::Zone *ZoneMap::Find(page_id_t page_id) const {
+  auto iter = zones_.find(page_id);
+  return iter == zones_.end() ? nullptr : &iter->second;
+}
+
+const ZoneMap::Zone &ZoneMap::Build(TablePage *page, Transaction *txn, LockManager *lock_manager) {
+  Zone &zone = zones_[page->GetTablePageId()] = NewZone(page->GetNextPageId());
+  RowView view;
+  RowId rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    if (!page->GetTupleView(rid, &view, schema_, txn, lock_manager)) {
+      continue;
+    }
+    for (uint32_t i = 0; i < tracked_.size(); i++) {
+      if (!tracked_[i] || view.IsNull(i)) {
+        continue;
+      }
+      double value = ValueOf(view.GetField(i));
+      zone.min[i] = std::min(zone.min[i], value);
+      zone.max[i] = std::max(zone.max[i], value);
+    }
+  }
+  return zone;
+}
+
+void ZoneMap::AddEmpty(page_id_t page_id, page_id_t next_page_id) { zones_[page_id] = NewZone(next_page_id); }
+
+void ZoneMap::Widen(page_id_t page_id, const Row &row) {
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end()) {
+    return;
+  }
+  Zone &zone = iter->second;
+  for (uint32_t i = 0; i < tracked_.size(); i++) {
+    const Field *field = row.GetField(i);
+    if (!tracked_[i] || field->IsNull()) {
+      continue;
+    }
+    double value = ValueOf(*field);
+    zone.min[i] = std::min(zone.min[i], value);
+    zone.max[i] = std::max(zone.max[i], value);
+  }
+}
+
+void ZoneMap::SetNextPageId(page_id_t page_id, page_id_t next_page_id) {
+  auto iter = zones_.find(page_id);
+  if (iter != zones_.end()) {
+    iter->second.next_page_id = next_page_id;
+  }
+}